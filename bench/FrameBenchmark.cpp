@@ -0,0 +1,409 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+#include "tinyxml/tinyxml.h"
+
+#include "ork/core/Timer.h"
+#include "ork/render/FrameBuffer.h"
+#include "ork/resource/ResourceManager.h"
+#include "ork/resource/XMLResourceLoader.h"
+#include "ork/scenegraph/SceneManager.h"
+#include "ork/taskgraph/MultithreadScheduler.h"
+#include "ork/ui/HeadlessWindow.h"
+
+using namespace std;
+using namespace ork;
+
+/*
+ * End-to-end frame benchmark. Generates a scene with N object nodes, M
+ * distinct meshes and K distinct programs, using the camera, light and
+ * object nodes of examples/scenes/cubesScene.xml as templates, and renders
+ * it in a HeadlessWindow with a rotating camera. Reports the CPU time of the
+ * update, culling, task graph construction, scheduling and task execution
+ * (i.e. GL submission) steps of SceneManager, and the time spent waiting for
+ * the GPU, with percentiles over all the measured frames.
+ *
+ * Usage: ork-bench <examples dir> [-nodes N] [-meshes M] [-programs K]
+ *      [-frames F] [-warmup W] [-size WxH] [-data dir]
+ */
+
+struct Options
+{
+    string examples; // the examples directory, with the templates
+
+    string data; // the directory where the generated scene is written
+
+    int nodes;
+
+    int meshes;
+
+    int programs;
+
+    int frames;
+
+    int warmup;
+
+    int width;
+
+    int height;
+
+    Options() : data("ork-bench-data"), nodes(1000), meshes(4), programs(4),
+        frames(500), warmup(50), width(1280), height(720)
+    {
+    }
+};
+
+static const char *MESH_TEMPLATES[] = { "cube.mesh", "sphere.mesh", "plane.mesh", "quad.mesh" };
+
+static string toString(int i)
+{
+    char buf[16];
+    sprintf(buf, "%d", i);
+    return string(buf);
+}
+
+static bool copyFile(const string &src, const string &dst)
+{
+    FILE *in = fopen(src.c_str(), "rb");
+    if (in == NULL) {
+        return false;
+    }
+    FILE *out = fopen(dst.c_str(), "wb");
+    if (out == NULL) {
+        fclose(in);
+        return false;
+    }
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+        fwrite(buf, 1, n, out);
+    }
+    fclose(in);
+    fclose(out);
+    return true;
+}
+
+static TiXmlElement *findNode(TiXmlElement *root, const char *flags)
+{
+    for (TiXmlElement *e = root->FirstChildElement("node"); e != NULL; e = e->NextSiblingElement("node")) {
+        const char *f = e->Attribute("flags");
+        if (f != NULL && strcmp(f, flags) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Writes the meshes and the "benchScene" archive in the data directory.
+ */
+static bool generateScene(const Options &o)
+{
+#ifdef _WIN32
+    _mkdir(o.data.c_str());
+#else
+    mkdir(o.data.c_str(), 0755);
+#endif
+    for (int i = 0; i < o.meshes; ++i) {
+        string src = o.examples + "/meshes/" + MESH_TEMPLATES[i % 4];
+        string dst = o.data + "/mesh" + toString(i) + ".mesh";
+        if (!copyFile(src, dst)) {
+            printf("cannot copy %s to %s\n", src.c_str(), dst.c_str());
+            return false;
+        }
+    }
+
+    string templateFile = o.examples + "/scenes/cubesScene.xml";
+    TiXmlDocument templateDoc(templateFile.c_str());
+    if (!templateDoc.LoadFile() || templateDoc.RootElement() == NULL) {
+        printf("cannot load %s\n", templateFile.c_str());
+        return false;
+    }
+    TiXmlElement *camera = findNode(templateDoc.RootElement(), "camera");
+    TiXmlElement *light = findNode(templateDoc.RootElement(), "light");
+    TiXmlElement *object = findNode(templateDoc.RootElement(), "object");
+    if (camera == NULL || light == NULL || object == NULL) {
+        printf("%s must contain camera, light and object nodes\n", templateFile.c_str());
+        return false;
+    }
+
+    TiXmlElement archive("archive");
+    TiXmlElement scene("node");
+    scene.SetAttribute("name", "benchScene");
+    scene.InsertEndChild(*camera);
+    scene.InsertEndChild(*light);
+
+    // the objects are placed on a regular 3D grid centered at the origin
+    int side = int(ceil(pow(double(o.nodes), 1.0 / 3.0)));
+    for (int i = 0; i < o.nodes; ++i) {
+        TiXmlElement *n = scene.InsertEndChild(*object)->ToElement();
+        TiXmlElement *t = n->FirstChildElement("translate");
+        t->SetDoubleAttribute("x", 4.0 * (i % side - 0.5 * (side - 1)));
+        t->SetDoubleAttribute("y", 4.0 * ((i / side) % side - 0.5 * (side - 1)));
+        t->SetDoubleAttribute("z", 4.0 * (i / (side * side) - 0.5 * (side - 1)));
+        n->FirstChildElement("mesh")->SetAttribute("value", ("mesh" + toString(i % o.meshes) + ".mesh").c_str());
+        n->FirstChildElement("module")->SetAttribute("value", ("benchProgram" + toString(i % o.programs)).c_str());
+        TiXmlElement *c = n->FirstChildElement("uniform4f");
+        c->SetDoubleAttribute("x", (i % 7) / 6.0);
+        c->SetDoubleAttribute("y", (i % 5) / 4.0);
+        c->SetDoubleAttribute("z", (i % 3) / 2.0);
+    }
+    archive.InsertEndChild(scene);
+
+    // distinct options give distinct shader sources, hence distinct programs
+    for (int i = 0; i < o.programs; ++i) {
+        TiXmlElement module("module");
+        module.SetAttribute("name", ("benchProgram" + toString(i)).c_str());
+        module.SetAttribute("version", "330");
+        module.SetAttribute("source", "flat.glsl");
+        module.SetAttribute("options", ("BENCH_PROGRAM_" + toString(i)).c_str());
+        archive.InsertEndChild(module);
+    }
+
+    TiXmlDocument doc;
+    doc.InsertEndChild(TiXmlDeclaration("1.0", "", ""));
+    doc.InsertEndChild(archive);
+    return doc.SaveFile((o.data + "/benchScene.xml").c_str());
+}
+
+/*
+ * The durations of one step for all the measured frames, in micro seconds.
+ */
+struct Samples
+{
+    const char *name;
+
+    vector<double> values;
+
+    Samples(const char *name) : name(name)
+    {
+    }
+
+    void report()
+    {
+        if (values.empty()) {
+            return;
+        }
+        vector<double> v = values;
+        sort(v.begin(), v.end());
+        double sum = 0.0;
+        for (unsigned int i = 0; i < v.size(); ++i) {
+            sum += v[i];
+        }
+        printf("%-12s %9.3f %9.3f %9.3f %9.3f %9.3f\n", name,
+            sum / v.size() / 1000.0, percentile(v, 50) / 1000.0,
+            percentile(v, 90) / 1000.0, percentile(v, 99) / 1000.0,
+            v.back() / 1000.0);
+    }
+
+    static double percentile(const vector<double> &sorted, int p)
+    {
+        return sorted[(sorted.size() - 1) * p / 100];
+    }
+};
+
+class FrameBenchmark : public HeadlessWindow
+{
+public:
+    ptr<SceneManager> manager;
+
+    ptr<MultithreadScheduler> scheduler;
+
+    int warmup;
+
+    float fov;
+
+    float dist;
+
+    Samples update, culling, taskGraph, schedule, execute, gpuWait, total;
+
+    FrameBenchmark(const Options &o) :
+        HeadlessWindow(Window::Parameters().size(o.width, o.height).depth(true), o.warmup + o.frames),
+        warmup(o.warmup), fov(80.0f), update("update"), culling("culling"), taskGraph("task graph"),
+        schedule("scheduling"), execute("execution"), gpuWait("gpu wait"), total("total")
+    {
+        ptr<XMLResourceLoader> resLoader = new XMLResourceLoader();
+        resLoader->addPath(o.data);
+        resLoader->addArchive(o.data + "/benchScene.xml");
+        resLoader->addPath(o.examples + "/textures");
+        resLoader->addPath(o.examples + "/shaders");
+        resLoader->addPath(o.examples + "/methods");
+
+        ptr<ResourceManager> resManager = new ResourceManager(resLoader, 8);
+
+        scheduler = new MultithreadScheduler();
+        manager = new SceneManager();
+        manager->setResourceManager(resManager);
+        manager->setScheduler(scheduler);
+        manager->setRoot(resManager->loadResource("benchScene").cast<SceneNode>());
+        manager->setCameraNode("camera");
+        manager->setCameraMethod("draw");
+
+        int side = int(ceil(pow(double(o.nodes), 1.0 / 3.0)));
+        dist = 4.0f * side;
+    }
+
+    void redisplay(double t, double dt)
+    {
+        // the camera turns around the scene in 360 frames
+        float alpha = float(getFrameCount() % 360);
+        mat4f cameraToWorld = mat4f::rotatex(90);
+        cameraToWorld = cameraToWorld * mat4f::rotatey(-alpha);
+        cameraToWorld = cameraToWorld * mat4f::rotatex(-30);
+        cameraToWorld = cameraToWorld * mat4f::translate(vec3f(0.0, 0.0, dist));
+        manager->getCameraNode()->setLocalToParent(cameraToWorld.cast<double>());
+
+        Timer timer;
+        double start = timer.start();
+        FrameBuffer::getDefault()->clear(true, false, true);
+        manager->update(t, dt);
+        manager->draw();
+        timer.start();
+        glFinish();
+        double wait = timer.end();
+
+        if (int(getFrameCount()) >= warmup) {
+            const SceneManager::FrameTimes &times = manager->getFrameTimes();
+            update.values.push_back(times.update);
+            culling.values.push_back(times.culling);
+            taskGraph.values.push_back(times.taskGraph);
+            schedule.values.push_back(scheduler->getScheduleTime());
+            execute.values.push_back(times.run - scheduler->getScheduleTime());
+            gpuWait.values.push_back(wait);
+            total.values.push_back(timer.start() - start);
+        }
+
+        HeadlessWindow::redisplay(t, dt);
+    }
+
+    void reshape(int x, int y)
+    {
+        ptr<FrameBuffer> fb = FrameBuffer::getDefault();
+        fb->setViewport(vec4<GLint>(0, 0, x, y));
+        fb->setDepthTest(true, LESS);
+
+        float vfov = degrees(2 * atan(float(y) / float(x) * tan(radians(fov) / 2)));
+        manager->setCameraToScreen(mat4d::perspectiveProjection(vfov, float(x) / float(y), 0.1f, 1e5f));
+
+        HeadlessWindow::reshape(x, y);
+    }
+
+    void report()
+    {
+        printf("%-12s %9s %9s %9s %9s %9s\n", "step (ms)", "mean", "p50", "p90", "p99", "max");
+        update.report();
+        culling.report();
+        taskGraph.report();
+        schedule.report();
+        execute.report();
+        gpuWait.report();
+        total.report();
+    }
+};
+
+static void usage()
+{
+    printf("usage: ork-bench <examples dir> [-nodes N] [-meshes M] [-programs K] [-frames F] [-warmup W] [-size WxH] [-data dir]\n");
+    ::exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        usage();
+    }
+    Options o;
+    o.examples = argv[1];
+    for (int i = 2; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            usage();
+        }
+        if (strcmp(argv[i], "-nodes") == 0) {
+            o.nodes = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "-meshes") == 0) {
+            o.meshes = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "-programs") == 0) {
+            o.programs = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "-frames") == 0) {
+            o.frames = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "-warmup") == 0) {
+            o.warmup = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "-size") == 0) {
+            if (sscanf(argv[i + 1], "%dx%d", &o.width, &o.height) != 2) {
+                usage();
+            }
+        } else if (strcmp(argv[i], "-data") == 0) {
+            o.data = argv[i + 1];
+        } else {
+            usage();
+        }
+    }
+    if (o.nodes < 1 || o.meshes < 1 || o.programs < 1 || o.frames < 1 || o.warmup < 0) {
+        usage();
+    }
+
+    atexit(Object::exit);
+    if (!generateScene(o)) {
+        return 1;
+    }
+    printf("%d nodes, %d meshes, %d programs, %d frames (%d warmup), %dx%d\n",
+        o.nodes, o.meshes, o.programs, o.frames, o.warmup, o.width, o.height);
+
+    ptr<FrameBenchmark> bench = new FrameBenchmark(o);
+    printf("renderer: %s\n", glGetString(GL_RENDERER));
+    bench->start();
+    bench->report();
+    return 0;
+}
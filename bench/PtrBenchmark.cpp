@@ -0,0 +1,233 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <vector>
+#include <pthread.h>
+
+#include "ork/core/Object.h"
+#include "ork/core/Timer.h"
+
+using namespace std;
+using namespace ork;
+
+/*
+ * Micro benchmark of the ptr smart pointer: copies, moves, conversions from
+ * raw pointers, casts and insertions in sets, in a single thread and with
+ * several threads sharing the same objects. Build it in each reference
+ * counting mode (USE_SHARED_PTR, USE_ATOMIC_REFCOUNT, or none) to compare
+ * them. Usage: ork-ptr-bench [iterations]
+ */
+
+class BenchBase : public Object
+{
+public:
+    BenchBase() : Object("BenchBase")
+    {
+    }
+};
+
+class BenchDerived : public BenchBase
+{
+public:
+    int value;
+
+    BenchDerived() : value(0)
+    {
+    }
+};
+
+static int iterations = 10000000;
+
+static volatile void *sink = NULL;
+
+static void report(const char *name, double time, int n)
+{
+    printf("%-24s %10.2f ns/op\n", name, 1000.0 * time / n);
+}
+
+static void benchCopy(ptr<BenchBase> p)
+{
+    Timer t;
+    t.start();
+    for (int i = 0; i < iterations; ++i) {
+        ptr<BenchBase> q = p;
+        sink = q.get();
+    }
+    report("copy", t.end(), iterations);
+}
+
+static void benchAssign(ptr<BenchBase> p)
+{
+    ptr<BenchBase> q;
+    Timer t;
+    t.start();
+    for (int i = 0; i < iterations; ++i) {
+        q = p;
+        q = NULL;
+    }
+    sink = q.get();
+    report("assign", t.end(), iterations);
+}
+
+static void benchMove(ptr<BenchBase> p)
+{
+#ifdef ORK_CPP11
+    ptr<BenchBase> q;
+    Timer t;
+    t.start();
+    for (int i = 0; i < iterations; ++i) {
+        q = std::move(p);
+        sink = q.get();
+        p = std::move(q);
+    }
+    sink = p.get();
+    report("move", t.end(), 2 * iterations);
+#else
+    (void) p;
+    printf("%-24s (requires C++11)\n", "move");
+#endif
+}
+
+static void benchRaw(ptr<BenchBase> p)
+{
+    BenchBase *raw = p.get();
+    Timer t;
+    t.start();
+    for (int i = 0; i < iterations; ++i) {
+        ptr<BenchBase> q(raw);
+        sink = q.get();
+    }
+    report("from raw pointer", t.end(), iterations);
+}
+
+static void benchCast(ptr<BenchBase> p)
+{
+    Timer t;
+    t.start();
+    for (int i = 0; i < iterations; ++i) {
+        ptr<BenchDerived> q = p.cast<BenchDerived>();
+        sink = q.get();
+    }
+    report("cast", t.end(), iterations);
+}
+
+static void benchSet()
+{
+    vector< ptr<BenchBase> > objects;
+    for (int i = 0; i < 64; ++i) {
+        objects.push_back(new BenchDerived());
+    }
+    int n = iterations / 64;
+    Timer t;
+    t.start();
+    for (int i = 0; i < n; ++i) {
+        set< ptr<BenchBase> > s;
+        for (unsigned int j = 0; j < objects.size(); ++j) {
+            s.insert(objects[j]);
+        }
+        sink = &s;
+    }
+    report("set insert", t.end(), n * 64);
+}
+
+struct ThreadData
+{
+    ptr<BenchBase> p;
+    double time;
+};
+
+static void *copyThread(void *arg)
+{
+    ThreadData *data = (ThreadData*) arg;
+    Timer t;
+    t.start();
+    for (int i = 0; i < iterations; ++i) {
+        ptr<BenchBase> q = data->p;
+        sink = q.get();
+    }
+    data->time = t.end();
+    return NULL;
+}
+
+static void benchSharedCopy(ptr<BenchBase> p, int threads)
+{
+    vector<pthread_t> ids(threads);
+    vector<ThreadData> data(threads);
+    for (int i = 0; i < threads; ++i) {
+        data[i].p = p;
+        pthread_create(&ids[i], NULL, copyThread, &data[i]);
+    }
+    double time = 0.0;
+    for (int i = 0; i < threads; ++i) {
+        pthread_join(ids[i], NULL);
+        time += data[i].time;
+    }
+    char name[64];
+    sprintf(name, "copy (%d threads)", threads);
+    report(name, time / threads, iterations);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1) {
+        iterations = atoi(argv[1]);
+    }
+#if defined(USE_SHARED_PTR)
+    printf("mode: shared_ptr\n");
+#elif defined(USE_ATOMIC_REFCOUNT)
+    printf("mode: intrusive, std::atomic\n");
+#else
+    printf("mode: intrusive, Atomic.h\n");
+#endif
+    ptr<BenchBase> p = new BenchDerived();
+    benchCopy(p);
+    benchAssign(p);
+    benchMove(p);
+    benchRaw(p);
+    benchCast(p);
+    benchSet();
+    benchSharedCopy(p, 4);
+    return 0;
+}
@@ -0,0 +1,437 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#include "ork/core/AsyncLogger.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/time.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "ork/core/Atomic.h"
+
+using namespace std;
+
+namespace ork
+{
+
+/**
+ * Maximum topic size, including the final 0.
+ */
+#define MAX_TOPIC_SIZE 32
+
+/**
+ * Maximum size of messages stored in the queue itself, including the final
+ * 0. Longer messages logged with AsyncLogger#log are stored on the heap.
+ */
+#define MAX_MESSAGE_SIZE 512
+
+/**
+ * A bounded multiple producers, single consumer lock-free message queue,
+ * with a background writer thread consuming the messages. Each queue slot
+ * has a sequence number telling if it is free for the producer whose
+ * position is equal to this number, or if it contains a message for the
+ * consumer (if it is equal to this position plus one).
+ */
+class AsyncLogQueue
+{
+public:
+    /**
+     * The queue shared by all the asynchronous loggers.
+     */
+    static AsyncLogQueue *INSTANCE;
+
+    /**
+     * Number of asynchronous loggers using #INSTANCE.
+     */
+    static int users;
+
+    /**
+     * Mutex used to create and delete #INSTANCE.
+     */
+    static pthread_mutex_t instanceMutex;
+
+    AsyncLogQueue(unsigned int capacity);
+
+    ~AsyncLogQueue();
+
+    /**
+     * Reserves a slot for a new message. Waits if the queue is full, unless
+     * this method is called from the writer thread itself (e.g. by a logger
+     * used by AsyncLogger#write), in which case the message is dropped.
+     *
+     * @param[out] pos the position of the reserved slot.
+     * @return the message buffer of the reserved slot, or NULL if the
+     *      message must be dropped.
+     */
+    char *reserve(AsyncLogger *logger, const char *topic, unsigned int &pos);
+
+    /**
+     * Makes the message in the given slot visible to the writer thread.
+     *
+     * @param pos a position returned by #reserve.
+     * @param longMessage a heap allocated message to use instead of the
+     *      message buffer of the slot, or NULL.
+     */
+    void commit(unsigned int pos, char *longMessage);
+
+    /**
+     * Waits until all the messages committed so far have been written. Does
+     * nothing if called from the writer thread, which would wait for itself.
+     */
+    void flush();
+
+    /**
+     * Returns true if the current thread is the writer thread.
+     */
+    bool isWriterThread() const;
+
+private:
+    /**
+     * A queue slot.
+     */
+    struct Slot
+    {
+        volatile unsigned int sequence; ///< see AsyncLogQueue.
+
+        AsyncLogger *logger; ///< the logger of the message in this slot.
+
+        char *longMessage; ///< a heap allocated message, or NULL.
+
+        char topic[MAX_TOPIC_SIZE]; ///< the topic of the message in this slot.
+
+        char message[MAX_MESSAGE_SIZE]; ///< the message in this slot.
+    };
+
+    Slot *slots; ///< the queue slots.
+
+    unsigned int mask; ///< the number of slots minus one.
+
+    volatile unsigned int enqueuePos; ///< the position of the next slot to reserve.
+
+    volatile unsigned int dequeuePos; ///< the position of the next slot to write.
+
+    volatile bool sleeping; ///< true if the writer thread is waiting for messages.
+
+    volatile bool stop; ///< true to stop the writer thread.
+
+    pthread_t thread; ///< the writer thread.
+
+    pthread_mutex_t mutex; ///< mutex used with #condition.
+
+    pthread_cond_t condition; ///< condition used to wake up the writer thread.
+
+    /**
+     * Wakes up the writer thread, if it is waiting for messages.
+     */
+    void signal();
+
+    /**
+     * Writes the messages available in the queue. Returns false if the queue
+     * was empty.
+     */
+    bool writeMessages();
+
+    /**
+     * The writer thread function.
+     */
+    static void *writerThread(void *arg);
+};
+
+AsyncLogQueue *AsyncLogQueue::INSTANCE = NULL;
+
+int AsyncLogQueue::users = 0;
+
+pthread_mutex_t AsyncLogQueue::instanceMutex = PTHREAD_MUTEX_INITIALIZER;
+
+AsyncLogQueue::AsyncLogQueue(unsigned int capacity) :
+    enqueuePos(0), dequeuePos(0), sleeping(false), stop(false)
+{
+    unsigned int size = 2;
+    while (size < capacity) {
+        size *= 2;
+    }
+    slots = new Slot[size];
+    mask = size - 1;
+    for (unsigned int i = 0; i < size; ++i) {
+        slots[i].sequence = i;
+        slots[i].longMessage = NULL;
+    }
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&condition, NULL);
+    pthread_create(&thread, NULL, writerThread, this);
+}
+
+AsyncLogQueue::~AsyncLogQueue()
+{
+    flush();
+    pthread_mutex_lock(&mutex);
+    stop = true;
+    pthread_cond_signal(&condition);
+    pthread_mutex_unlock(&mutex);
+    pthread_join(thread, NULL);
+    pthread_cond_destroy(&condition);
+    pthread_mutex_destroy(&mutex);
+    delete[] slots;
+}
+
+char *AsyncLogQueue::reserve(AsyncLogger *logger, const char *topic, unsigned int &pos)
+{
+    pos = enqueuePos;
+    while (true) {
+        Slot &s = slots[pos & mask];
+        int diff = int(s.sequence - pos);
+        if (diff == 0) {
+            if (atomic_compare_and_swap(&enqueuePos, pos, pos + 1)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // the queue is full: waits until the writer thread frees a slot,
+            // or drops the message if we are in this thread
+            if (isWriterThread()) {
+                return NULL;
+            }
+            signal();
+            sched_yield();
+        }
+        pos = enqueuePos;
+    }
+    Slot &s = slots[pos & mask];
+    s.logger = logger;
+    s.longMessage = NULL;
+    strncpy(s.topic, topic, MAX_TOPIC_SIZE - 1);
+    s.topic[MAX_TOPIC_SIZE - 1] = 0;
+    return s.message;
+}
+
+void AsyncLogQueue::commit(unsigned int pos, char *longMessage)
+{
+    Slot &s = slots[pos & mask];
+    s.longMessage = longMessage;
+    // publishes the slot content before the new sequence number
+    memory_barrier();
+    s.sequence = pos + 1;
+    if (sleeping) {
+        signal();
+    }
+}
+
+void AsyncLogQueue::flush()
+{
+    if (isWriterThread()) {
+        return;
+    }
+    unsigned int pos = enqueuePos;
+    while (int(dequeuePos - pos) < 0) {
+        signal();
+        sched_yield();
+    }
+}
+
+void AsyncLogQueue::signal()
+{
+    pthread_mutex_lock(&mutex);
+    pthread_cond_signal(&condition);
+    pthread_mutex_unlock(&mutex);
+}
+
+bool AsyncLogQueue::isWriterThread() const
+{
+    return pthread_equal(pthread_self(), thread) != 0;
+}
+
+bool AsyncLogQueue::writeMessages()
+{
+    bool written = false;
+    while (true) {
+        unsigned int pos = dequeuePos;
+        Slot &s = slots[pos & mask];
+        if (s.sequence != pos + 1) {
+            break;
+        }
+        memory_barrier();
+        if (s.longMessage != NULL) {
+            s.logger->write(s.topic, s.longMessage);
+            free(s.longMessage);
+            s.longMessage = NULL;
+        } else {
+            s.logger->write(s.topic, s.message);
+        }
+        // frees the slot for the producer that will wrap around to it
+        memory_barrier();
+        s.sequence = pos + mask + 1;
+        dequeuePos = pos + 1;
+        written = true;
+    }
+    return written;
+}
+
+void *AsyncLogQueue::writerThread(void *arg)
+{
+    AsyncLogQueue *q = (AsyncLogQueue*) arg;
+    while (true) {
+        if (q->writeMessages()) {
+            continue;
+        }
+        pthread_mutex_lock(&q->mutex);
+        if (q->stop) {
+            pthread_mutex_unlock(&q->mutex);
+            break;
+        }
+        q->sleeping = true;
+        memory_barrier();
+        // a message may have been committed before 'sleeping' was set, in
+        // which case no signal was sent: we use a timed wait to catch it
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        struct timespec timeout;
+        timeout.tv_sec = now.tv_sec;
+        timeout.tv_nsec = now.tv_usec * 1000 + 10000000;
+        if (timeout.tv_nsec >= 1000000000) {
+            timeout.tv_sec += 1;
+            timeout.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&q->condition, &q->mutex, &timeout);
+        q->sleeping = false;
+        pthread_mutex_unlock(&q->mutex);
+    }
+    q->writeMessages();
+    return NULL;
+}
+
+AsyncLogger::AsyncLogger(const string &type, ptr<Logger> next, unsigned int capacity) :
+    Logger(type), next(next)
+{
+    pthread_mutex_lock(&AsyncLogQueue::instanceMutex);
+    if (AsyncLogQueue::INSTANCE == NULL) {
+        AsyncLogQueue::INSTANCE = new AsyncLogQueue(capacity);
+    }
+    AsyncLogQueue::users += 1;
+    pthread_mutex_unlock(&AsyncLogQueue::instanceMutex);
+}
+
+AsyncLogger::~AsyncLogger()
+{
+    pthread_mutex_lock(&AsyncLogQueue::instanceMutex);
+    AsyncLogQueue::INSTANCE->flush();
+    AsyncLogQueue::users -= 1;
+    if (AsyncLogQueue::users == 0) {
+        delete AsyncLogQueue::INSTANCE;
+        AsyncLogQueue::INSTANCE = NULL;
+    }
+    pthread_mutex_unlock(&AsyncLogQueue::instanceMutex);
+}
+
+ptr<Logger> AsyncLogger::getNext()
+{
+    pthread_mutex_lock((pthread_mutex_t*) mutex);
+    ptr<Logger> n = next;
+    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+    return n;
+}
+
+void AsyncLogger::setNext(ptr<Logger> next)
+{
+    AsyncLogQueue::INSTANCE->flush();
+    pthread_mutex_lock((pthread_mutex_t*) mutex);
+    this->next = next;
+    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+}
+
+void AsyncLogger::log(const string &topic, const string &msg)
+{
+    if (hasTopic(topic)) {
+        unsigned int pos;
+        char *buf = AsyncLogQueue::INSTANCE->reserve(this, topic.c_str(), pos);
+        if (buf == NULL) {
+            return;
+        }
+        char *longMessage = NULL;
+        if (msg.size() < MAX_MESSAGE_SIZE) {
+            memcpy(buf, msg.c_str(), msg.size() + 1);
+        } else {
+            longMessage = (char*) malloc(msg.size() + 1);
+            memcpy(longMessage, msg.c_str(), msg.size() + 1);
+        }
+        AsyncLogQueue::INSTANCE->commit(pos, longMessage);
+    }
+}
+
+void AsyncLogger::logv(const char *topic, const char *fmt, va_list args)
+{
+    if (hasTopic(topic)) {
+        unsigned int pos;
+        char *buf = AsyncLogQueue::INSTANCE->reserve(this, topic, pos);
+        if (buf == NULL) {
+            return;
+        }
+        vsnprintf(buf, MAX_MESSAGE_SIZE, fmt, args);
+        AsyncLogQueue::INSTANCE->commit(pos, NULL);
+    }
+}
+
+void AsyncLogger::flush()
+{
+    if (AsyncLogQueue::INSTANCE->isWriterThread()) {
+        // called from a logger used by #write: waiting for the queue, or
+        // locking our mutex (if we are this logger), would never return
+        return;
+    }
+    AsyncLogQueue::INSTANCE->flush();
+    ptr<Logger> n = getNext();
+    if (n != NULL) {
+        n->flush();
+    }
+}
+
+void AsyncLogger::write(const char *topic, const char *msg)
+{
+    pthread_mutex_lock((pthread_mutex_t*) mutex);
+    if (next != NULL) {
+        next->log(topic, msg);
+    }
+    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+}
+
+}
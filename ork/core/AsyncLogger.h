@@ -0,0 +1,137 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#ifndef _ORK_ASYNC_LOGGER_H_
+#define _ORK_ASYNC_LOGGER_H_
+
+#include "ork/core/Logger.h"
+
+namespace ork
+{
+
+/**
+ * A Logger that forwards messages to another logger asynchronously. The
+ * messages are copied into a lock-free queue, shared by all the asynchronous
+ * loggers, and are forwarded to the next loggers by a background writer
+ * thread. Hence the calling threads do not wait for the formatting and the
+ * writing of the messages (in a FileLogger for instance). Messages logged
+ * with #logf are formatted directly in the queue, without any memory
+ * allocation. The messages logged by all the asynchronous loggers are
+ * forwarded in the order in which they were logged. Typical use:
+ *
+ * <pre>
+ * FileLogger::File *out = new FileLogger::File("log.html");
+ * Logger::INFO_LOGGER = new AsyncLogger("INFO", new FileLogger("INFO", out, Logger::INFO_LOGGER));
+ * </pre>
+ *
+ * If the queue is full, the calling threads wait until some messages have
+ * been written, so that no message is lost.
+ * @ingroup core
+ */
+class ORK_API AsyncLogger : public Logger
+{
+public:
+    /**
+     * Creates a new asynchronous logger.
+     *
+     * @param type the type of this logger.
+     * @param next the logger to which messages must be forwarded by the
+     *      background writer thread.
+     * @param capacity the capacity of the message queue, in number of
+     *      messages. This capacity is only used by the first asynchronous
+     *      logger created, since the queue is shared by all loggers. It is
+     *      rounded to the next power of two.
+     */
+    AsyncLogger(const std::string &type, ptr<Logger> next, unsigned int capacity = 1024);
+
+    /**
+     * Destroys this logger. Waits until all the messages logged by this logger
+     * have been forwarded to the next logger.
+     */
+    virtual ~AsyncLogger();
+
+    /**
+     * Returns the logger to which messages are forwarded.
+     */
+    ptr<Logger> getNext();
+
+    /**
+     * Sets the logger to which messages are forwarded. Messages logged before
+     * this call are forwarded to the previous next logger.
+     */
+    void setNext(ptr<Logger> next);
+
+    /**
+     * Adds the given message to the queue of messages to be forwarded to the
+     * next logger.
+     */
+    virtual void log(const std::string &topic, const std::string &msg);
+
+    /**
+     * Waits until all the messages logged so far have been forwarded to the
+     * next logger, and then flushes it. Does nothing if called from the
+     * writer thread.
+     */
+    virtual void flush();
+
+protected:
+    /**
+     * Formats the given message directly in the message queue.
+     */
+    virtual void logv(const char *topic, const char *fmt, va_list args);
+
+private:
+    /**
+     * The logger to which messages are forwarded by the writer thread.
+     */
+    ptr<Logger> next;
+
+    /**
+     * Forwards a message to the next logger. Called by the writer thread.
+     */
+    void write(const char *topic, const char *msg);
+
+    friend class AsyncLogQueue;
+};
+
+}
+
+#endif
@@ -64,6 +64,15 @@ namespace ork
  *
  * - atomic_decrement(*pw)
  *        adds 1 to *pw and returns its *previous* value
+ *
+ * - atomic_compare_and_swap(*pw, oldv, newv)
+ *        sets *pw to newv if it is equal to oldv, and returns true in this case
+ *
+ * - atomic_compare_and_swap_ptr(*pw, oldv, newv)
+ *        same as atomic_compare_and_swap, for a pointer of type void*
+ *
+ * - memory_barrier()
+ *        full memory barrier (for the compiler and for the processor)
  */
 
 #if defined(_MSC_VER)
@@ -91,16 +100,44 @@ static FORCE_INLINE int atomic_decrement(int volatile * pw)
     return (*pw)--;
 }
 
+static FORCE_INLINE bool atomic_compare_and_swap(unsigned int volatile * pw, unsigned int oldv, unsigned int newv)
+{
+    if (*pw == oldv) {
+        *pw = newv;
+        return true;
+    }
+    return false;
+}
+
+static FORCE_INLINE bool atomic_compare_and_swap_ptr(void * volatile * pw, void *oldv, void *newv)
+{
+    if (*pw == oldv) {
+        *pw = newv;
+        return true;
+    }
+    return false;
+}
+
+#define memory_barrier()
+
 #elif defined(_MSC_VER) // MSVC
 
 #define atomic_exchange_and_add(pw,dv) _InterlockedExchangeAdd((volatile long*)(pw),(dv))
 #define atomic_increment(pw) (_InterlockedIncrement((volatile long*)(pw)))
 #define atomic_decrement(pw) (_InterlockedDecrement((volatile long*)(pw))+1)
+#define atomic_compare_and_swap(pw,oldv,newv) (_InterlockedCompareExchange((volatile long*)(pw),(long)(newv),(long)(oldv))==(long)(oldv))
+#define atomic_compare_and_swap_ptr(pw,oldv,newv) (_InterlockedCompareExchangePointer((void* volatile*)(pw),(newv),(oldv))==(oldv))
+#define memory_barrier() _mm_mfence()
 #elif defined(__GNUC__) // GCC
 
-#define atomic_exchange_and_add(pw,dv) __sync_fetch_and_add((volatile long*)(pw), dv)
-#define atomic_increment(pw) __sync_fetch_and_add((volatile long*)(pw), 1)
-#define atomic_decrement(pw) __sync_fetch_and_sub((volatile long*)(pw), 1)
+// the GCC builtins are overloaded on the type of pw: they must not be cast
+// to long, which is 64 bits wide on LP64 systems while the counters are ints
+#define atomic_exchange_and_add(pw,dv) __sync_fetch_and_add((pw), (dv))
+#define atomic_increment(pw) __sync_fetch_and_add((pw), 1)
+#define atomic_decrement(pw) __sync_fetch_and_sub((pw), 1)
+#define atomic_compare_and_swap(pw,oldv,newv) __sync_bool_compare_and_swap((pw), (oldv), (newv))
+#define atomic_compare_and_swap_ptr(pw,oldv,newv) __sync_bool_compare_and_swap((pw), (oldv), (newv))
+#define memory_barrier() __sync_synchronize()
 
 #else
 
@@ -0,0 +1,191 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#include "ork/core/GPUProfiler.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "ork/core/Logger.h"
+#include "ork/render/Query.h"
+
+using namespace std;
+
+namespace ork
+{
+
+static_ptr<GPUProfiler> GPUProfiler::INSTANCE(NULL);
+
+GPUProfiler::PassStatistics::PassStatistics() :
+    n(0), lastDuration(0.0), totalDuration(0.0), minDuration(1e9), maxDuration(0.0)
+{
+}
+
+double GPUProfiler::PassStatistics::getAvgDuration() const
+{
+    return n == 0 ? 0.0 : totalDuration / n;
+}
+
+GPUProfiler::Frame::Frame() : usedQueries(0)
+{
+}
+
+GPUProfiler::GPUProfiler(unsigned int latency) :
+    Object("GPUProfiler"), frames(max(latency, 1u)), current(0), droppedFrames(0)
+{
+}
+
+GPUProfiler::~GPUProfiler()
+{
+}
+
+unsigned int GPUProfiler::getLatency() const
+{
+    return (unsigned int) frames.size();
+}
+
+int GPUProfiler::beginPass(const string &name)
+{
+    Frame &f = frames[current];
+    Pass p;
+    p.name = name;
+    p.begin = timestamp();
+    p.end = -1;
+    f.passes.push_back(p);
+    return (int) f.passes.size() - 1;
+}
+
+void GPUProfiler::endPass(int pass)
+{
+    Frame &f = frames[current];
+    assert(pass >= 0 && pass < (int) f.passes.size());
+    f.passes[pass].end = timestamp();
+}
+
+void GPUProfiler::endFrame()
+{
+    current = (current + 1) % frames.size();
+    collect(frames[current]);
+}
+
+GPUProfiler::PassIterator GPUProfiler::getPasses()
+{
+    return PassIterator(statistics);
+}
+
+const GPUProfiler::PassStatistics *GPUProfiler::getPass(const string &name)
+{
+    map<string, PassStatistics>::iterator i = statistics.find(name);
+    return i == statistics.end() ? NULL : &(i->second);
+}
+
+unsigned int GPUProfiler::getDroppedFrames() const
+{
+    return droppedFrames;
+}
+
+void GPUProfiler::reset()
+{
+    statistics.clear();
+    droppedFrames = 0;
+}
+
+void GPUProfiler::logStatistics()
+{
+    if (Logger::INFO_LOGGER == NULL) {
+        return;
+    }
+    map<string, PassStatistics>::iterator i = statistics.begin();
+    while (i != statistics.end()) {
+        const PassStatistics &s = i->second;
+        ostringstream oss;
+        oss.setf(ios::fixed, ios::floatfield);
+        oss.precision(3);
+        oss << i->first << ": " << s.getAvgDuration() / 1000.0 << " ms; last " << s.lastDuration / 1000.0;
+        oss << "; min/max " << s.minDuration / 1000.0 << " " << s.maxDuration / 1000.0;
+        Logger::INFO_LOGGER->log("GPU", oss.str());
+        ++i;
+    }
+}
+
+int GPUProfiler::timestamp()
+{
+    Frame &f = frames[current];
+    if (f.usedQueries == f.queries.size()) {
+        f.queries.push_back(new Query(TIME_STAMP));
+    }
+    f.queries[f.usedQueries]->timestamp();
+    return f.usedQueries++;
+}
+
+void GPUProfiler::collect(Frame &f)
+{
+    // timestamps complete in order, so if the last query of the frame is not
+    // available yet, we do not even test the other ones
+    bool available = f.usedQueries == 0 || f.queries[f.usedQueries - 1]->available();
+    for (unsigned int i = 0; available && i < f.passes.size(); ++i) {
+        const Pass &p = f.passes[i];
+        available = f.queries[p.begin]->available() && (p.end < 0 || f.queries[p.end]->available());
+    }
+    if (available) {
+        for (unsigned int i = 0; i < f.passes.size(); ++i) {
+            const Pass &p = f.passes[i];
+            if (p.end < 0) {
+                continue;
+            }
+            GLuint64 t0 = f.queries[p.begin]->getResult();
+            GLuint64 t1 = f.queries[p.end]->getResult();
+            double duration = t1 > t0 ? (t1 - t0) / 1000.0 : 0.0;
+            PassStatistics &s = statistics[p.name];
+            s.n += 1;
+            s.lastDuration = duration;
+            s.totalDuration += duration;
+            s.minDuration = min(duration, s.minDuration);
+            s.maxDuration = max(duration, s.maxDuration);
+        }
+    } else {
+        ++droppedFrames;
+    }
+    f.usedQueries = 0;
+    f.passes.clear();
+}
+
+}
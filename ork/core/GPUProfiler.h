@@ -0,0 +1,241 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#ifndef _ORK_GPU_PROFILER_H_
+#define _ORK_GPU_PROFILER_H_
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "ork/core/Object.h"
+#include "ork/core/Iterator.h"
+
+namespace ork
+{
+
+class Query;
+
+/**
+ * A GPU profiler to measure the GPU time of named passes, without stalling
+ * the pipeline. Each pass is delimited with two GL_TIMESTAMP queries, taken
+ * from a pool of Query objects which is recycled every #getLatency() frames.
+ * The results of the queries issued at a given frame are read only when
+ * this pool is about to be reused, i.e. #getLatency() frames later, and only
+ * if they are available (otherwise they are discarded). When the static
+ * #INSTANCE profiler is not NULL, the MultithreadScheduler automatically
+ * profiles each GPU task (per task type), and each scene graph Method
+ * (per node and method name).
+ * @ingroup core
+ */
+class ORK_API GPUProfiler : public Object
+{
+public:
+    /**
+     * Execution time statistics for a pass. All durations are in micro seconds.
+     */
+    struct ORK_API PassStatistics
+    {
+        int n; ///< number of measured executions of this pass.
+
+        double lastDuration; ///< the last measured duration of this pass.
+
+        double totalDuration; ///< the sum of the measured durations.
+
+        double minDuration; ///< minimum measured duration.
+
+        double maxDuration; ///< maximum measured duration.
+
+        /**
+         * Creates empty statistics.
+         */
+        PassStatistics();
+
+        /**
+         * Returns the average measured duration of this pass.
+         */
+        double getAvgDuration() const;
+    };
+
+    /**
+     * An iterator over the statistics of the profiled passes.
+     */
+    typedef MapIterator<std::string, PassStatistics> PassIterator;
+
+    /**
+     * The profiler used by the task scheduler and the scene graph to
+     * automatically profile GPU tasks and methods. NULL by default.
+     */
+    static static_ptr<GPUProfiler> INSTANCE;
+
+    /**
+     * Creates a new GPUProfiler.
+     *
+     * @param latency the number of frames after which query results are read.
+     *      Must be at least 2 to avoid stalls (3 is a safe default).
+     */
+    GPUProfiler(unsigned int latency = 3);
+
+    /**
+     * Deletes this GPUProfiler.
+     */
+    virtual ~GPUProfiler();
+
+    /**
+     * Returns the number of frames after which query results are read.
+     */
+    unsigned int getLatency() const;
+
+    /**
+     * Starts a new pass in the current frame. Passes can be nested.
+     *
+     * @param name the pass name. Passes with the same name share the same
+     *      statistics.
+     * @return a pass identifier, to be given to #endPass.
+     */
+    int beginPass(const std::string &name);
+
+    /**
+     * Ends a pass started with #beginPass.
+     *
+     * @param pass a pass identifier returned by #beginPass at the current frame.
+     */
+    void endPass(int pass);
+
+    /**
+     * Ends the current frame. This reads the results of the queries issued
+     * #getLatency() frames ago, if they are available, and recycles them for
+     * the next frame. This method is called by SceneManager#draw; it must be
+     * called explicitely at each frame if no SceneManager is used.
+     */
+    void endFrame();
+
+    /**
+     * Returns the statistics of all the passes measured so far.
+     */
+    PassIterator getPasses();
+
+    /**
+     * Returns the statistics of the given pass, or NULL if this pass has not
+     * been measured yet.
+     *
+     * @param name a pass name.
+     */
+    const PassStatistics *getPass(const std::string &name);
+
+    /**
+     * Returns the number of frames whose results were discarded because they
+     * were still not available after #getLatency() frames.
+     */
+    unsigned int getDroppedFrames() const;
+
+    /**
+     * Clears the statistics of all passes.
+     */
+    void reset();
+
+    /**
+     * Logs the statistics of all passes to the INFO logger.
+     */
+    void logStatistics();
+
+private:
+    /**
+     * A pass issued in a frame.
+     */
+    struct Pass
+    {
+        std::string name; ///< the pass name.
+
+        int begin; ///< index of the begin timestamp query in the frame pool.
+
+        int end; ///< index of the end timestamp query, or -1 if not ended.
+    };
+
+    /**
+     * The queries and passes issued in a frame.
+     */
+    struct Frame
+    {
+        std::vector< ptr<Query> > queries; ///< the timestamp queries of this frame.
+
+        unsigned int usedQueries; ///< the number of queries used in #queries.
+
+        std::vector<Pass> passes; ///< the passes issued in this frame.
+
+        Frame();
+    };
+
+    /**
+     * The ring of frames, of size #getLatency().
+     */
+    std::vector<Frame> frames;
+
+    /**
+     * The index of the current frame in #frames.
+     */
+    unsigned int current;
+
+    /**
+     * The number of frames whose results were discarded.
+     */
+    unsigned int droppedFrames;
+
+    /**
+     * The statistics of each pass.
+     */
+    std::map<std::string, PassStatistics> statistics;
+
+    /**
+     * Issues a new timestamp query in the current frame and returns its index.
+     */
+    int timestamp();
+
+    /**
+     * Reads the results of the given frame, if they are available, and
+     * resets this frame.
+     */
+    void collect(Frame &f);
+};
+
+}
+
+#endif
@@ -48,35 +48,40 @@
 namespace ork
 {
 
-GPUTimer::GPUTimer() : Timer()
+GPUTimer::GPUTimer() : Timer(), current(0)
 {
-    glGenQueries(1, &query);
+    glGenQueries(QUERY_COUNT, queries);
+    for (int i = 0; i < QUERY_COUNT; ++i) {
+        pending[i] = false;
+    }
 }
 
 GPUTimer::~GPUTimer()
 {
-    glDeleteQueries(1, &query);
+    glDeleteQueries(QUERY_COUNT, queries);
 }
 
 double GPUTimer::start()
 {
     getQueryResult();
     numCycles++;
-    glBeginQuery(GL_TIME_ELAPSED, query);
+    current = (current + 1) % QUERY_COUNT;
+    // if the result of this query is still not available, it is lost
+    pending[current] = false;
+    glBeginQuery(GL_TIME_ELAPSED, queries[current]);
     return 0.0;
 }
 
 double GPUTimer::end()
 {
     glEndQuery(GL_TIME_ELAPSED);
+    pending[current] = true;
     return lastDuration;
 }
 
 double GPUTimer::getTime()
 {
-    if (lastDuration == 0) {
-        getQueryResult();
-    }
+    getQueryResult();
     return lastDuration;
 }
 
@@ -90,9 +95,21 @@ double GPUTimer::getAvgTime()
 
 void GPUTimer::getQueryResult()
 {
-    if (numCycles > 0) {
+    // the queries are read in the order in which they were issued, starting
+    // with the oldest one, and we stop at the first unavailable result
+    for (int i = 1; i <= QUERY_COUNT; ++i) {
+        int q = (current + i) % QUERY_COUNT;
+        if (!pending[q]) {
+            continue;
+        }
+        GLuint available = 0;
+        glGetQueryObjectuiv(queries[q], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == 0) {
+            break;
+        }
         GLuint64 timeElapsed;
-        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &timeElapsed);
+        glGetQueryObjectui64v(queries[q], GL_QUERY_RESULT, &timeElapsed);
+        pending[q] = false;
         if (timeElapsed != 0) {
             lastDuration = (double) timeElapsed;
             totalDuration += lastDuration;
@@ -50,7 +50,10 @@ namespace ork
 /**
  * A timer to measure time and time intervals on GPU. Since GPU computations
  * are asynchroneous, we can't just use CPU time to check the duration of
- * an operation.
+ * an operation. In order to never stall the pipeline, this timer uses a small
+ * ring of GPU queries, and only reads the results of the queries that are
+ * available. Hence the measured durations are delayed by a few calls to
+ * #start(). See also GPUProfiler.
  * @ingroup core
  */
 class ORK_API GPUTimer : public Timer
@@ -87,9 +90,15 @@ public:
     virtual double getAvgTime();
 
 protected:
-    unsigned int query; ///< GPU query used to measure time on GPU.
+    static const int QUERY_COUNT = 4; ///< number of queries in #queries.
 
-    void getQueryResult(); ///< Returns the result of the query #query.
+    unsigned int queries[QUERY_COUNT]; ///< GPU queries used to measure time on GPU.
+
+    bool pending[QUERY_COUNT]; ///< true for the queries whose result has not been read yet.
+
+    int current; ///< index of the query used by the last call to #start().
+
+    void getQueryResult(); ///< Reads the results of the available queries, without blocking.
 };
 
 }
@@ -52,10 +52,15 @@ namespace ork
  * A set iterator.
  * @ingroup core
  */
-template <typename type>
+template <typename type, typename alloc = std::allocator<type> >
 class SetIterator
 {
 public:
+    /**
+     * The type of the sets iterated by this iterator.
+     */
+    typedef std::set<type, std::less<type>, alloc> container;
+
     /**
      * Creates a set iterator for an empty set.
      */
@@ -64,7 +69,7 @@ public:
     /**
      * Creates a set iterator for the given set.
      */
-    SetIterator(std::set<type> &c);
+    SetIterator(container &c);
 
     /**
      * Returns the size of the set for which this iterator has been created.
@@ -91,17 +96,17 @@ private:
     /**
      * The current iterator position.
      */
-    typename std::set<type>::iterator i;
+    typename container::iterator i;
 
     /**
      * The iterator position corresponding to the end of the set.
      */
-    typename std::set<type>::iterator end;
+    typename container::iterator end;
 
     /**
      * The empty set used for creating empty iterators.
      */
-    static std::set<type> emptySet;
+    static container emptySet;
 };
 
 /**
@@ -236,36 +241,36 @@ private:
     static std::multimap<key,type> emptyMap;
 };
 
-template <typename type>
-SetIterator<type>::SetIterator() : n(0), i(emptySet.begin()), end(emptySet.end())
+template <typename type, typename alloc>
+SetIterator<type, alloc>::SetIterator() : n(0), i(emptySet.begin()), end(emptySet.end())
 {
 }
 
-template <typename type>
-SetIterator<type>::SetIterator(std::set<type> &c) : n((unsigned int)c.size()), i(c.begin()), end(c.end())
+template <typename type, typename alloc>
+SetIterator<type, alloc>::SetIterator(container &c) : n((unsigned int)c.size()), i(c.begin()), end(c.end())
 {
 }
 
-template <typename type>
-unsigned int SetIterator<type>::size()
+template <typename type, typename alloc>
+unsigned int SetIterator<type, alloc>::size()
 {
     return n;
 }
 
-template <typename type>
-bool SetIterator<type>::hasNext()
+template <typename type, typename alloc>
+bool SetIterator<type, alloc>::hasNext()
 {
     return i != end;
 }
 
-template <typename type>
-type SetIterator<type>::next()
+template <typename type, typename alloc>
+type SetIterator<type, alloc>::next()
 {
     return *(i++);
 }
 
-template <typename type>
-std::set<type> SetIterator<type>::emptySet;
+template <typename type, typename alloc>
+typename SetIterator<type, alloc>::container SetIterator<type, alloc>::emptySet;
 
 template <typename key, typename type>
 MapIterator<key, type>::MapIterator() : n(0), i(emptyMap.begin()), end(emptyMap.end())
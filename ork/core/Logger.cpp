@@ -60,6 +60,13 @@ static_ptr<Logger> Logger::WARNING_LOGGER(new Logger("WARNING"));
 
 static_ptr<Logger> Logger::ERROR_LOGGER(new Logger("ERROR"));
 
+int Logger::TOPIC_LEVELS[TOPIC_COUNT] = { ORK_LOG_DEBUG, ORK_LOG_DEBUG, ORK_LOG_DEBUG, ORK_LOG_DEBUG, ORK_LOG_DEBUG };
+
+void Logger::setLevel(topic t, int level)
+{
+    TOPIC_LEVELS[t] = level;
+}
+
 Logger::Logger(const string &type) : Object("Logger"), type(type)
 {
     mutex = new pthread_mutex_t;
@@ -82,6 +89,11 @@ bool Logger::hasTopic(const string &topic)
     return topics.size() == 0 || topics.find(topic, 0) != string::npos;
 }
 
+bool Logger::hasTopic(const char *topic)
+{
+    return topics.size() == 0 || topics.find(topic, 0) != string::npos;
+}
+
 void Logger::log(const string &topic, const string &msg)
 {
     if (hasTopic(topic)) {
@@ -93,13 +105,18 @@ void Logger::log(const string &topic, const string &msg)
 
 void Logger::logf(const char * topic, const char *fmt, ...)
 {
-    static const int MAX_LOG_SIZE = 512;
-    char buf[MAX_LOG_SIZE];
-
     va_list vl;
     va_start(vl, fmt);
-    vsnprintf(buf, MAX_LOG_SIZE, fmt, vl);
+    logv(topic, fmt, vl);
     va_end(vl);
+}
+
+void Logger::logv(const char *topic, const char *fmt, va_list args)
+{
+    static const int MAX_LOG_SIZE = 512;
+    char buf[MAX_LOG_SIZE];
+
+    vsnprintf(buf, MAX_LOG_SIZE, fmt, args);
     std::string topicStr = topic;
     std::string msgStr = buf;
     log(topicStr, msgStr);
@@ -42,6 +42,7 @@
 #ifndef _ORK_LOGGER_H_
 #define _ORK_LOGGER_H_
 
+#include <cstdarg>
 #include <string>
 #include "ork/core/Object.h"
 
@@ -79,6 +80,38 @@ public:
      */
     static static_ptr<Logger> ERROR_LOGGER;
 
+    /**
+     * The topics that can be used with the ORK_DEBUG, ORK_INFO, etc logging
+     * macros. Each topic has a compile time level (see ORK_LOG_LEVEL) and a
+     * runtime level (see #setLevel).
+     */
+    enum topic {
+        TOPIC_CORE, ///< the CORE topic
+        TOPIC_RENDER, ///< the RENDER topic
+        TOPIC_RESOURCE, ///< the RESOURCE topic
+        TOPIC_SCENEGRAPH, ///< the SCENEGRAPH topic
+        TOPIC_SCHEDULER, ///< the SCHEDULER topic
+        TOPIC_COUNT ///< the number of topics
+    };
+
+    /**
+     * The runtime level of each topic (see #setLevel). <i>For internal use
+     * only</i>. Read by the logging macros.
+     */
+    static int TOPIC_LEVELS[TOPIC_COUNT];
+
+    /**
+     * Sets the maximum level of the messages of the given topic that are
+     * logged with the logging macros. This level can not exceed the compile
+     * time level of this topic. The default runtime level is ORK_LOG_DEBUG
+     * (all messages are logged).
+     *
+     * @param t a topic.
+     * @param level one of ORK_LOG_NONE, ORK_LOG_ERROR, ORK_LOG_WARNING,
+     *      ORK_LOG_INFO or ORK_LOG_DEBUG.
+     */
+    static void setLevel(topic t, int level);
+
     /**
      * Creates a new logger of the given type (debug, info, warning, etc).
      */
@@ -102,6 +135,12 @@ public:
      */
     bool hasTopic(const std::string &topic);
 
+    /**
+     * Returns true if messages of the given topic are logged by this logger.
+     * Same as #hasTopic(const std::string&), without creating a string.
+     */
+    bool hasTopic(const char *topic);
+
     /**
      * Logs a message given by its topic and its content. The default
      * implementation of this method sends the message to the standard error
@@ -126,6 +165,16 @@ public:
     virtual void flush();
 
 protected:
+    /**
+     * Logs a formatted message. This method is called by #logf. The default
+     * implementation formats the message in a local buffer and calls #log.
+     *
+     * @param topic the topic of the message.
+     * @param fmt the printf format of the message.
+     * @param args the arguments of the format.
+     */
+    virtual void logv(const char *topic, const char *fmt, va_list args);
+
     /**
      * The type of this logger (debug, info, warning, error, etc).
      */
@@ -143,6 +192,78 @@ protected:
     void *mutex;
 };
 
+/**
+ * Macros to log messages on performance critical code paths. Unlike calls
+ * to Logger#log, the message arguments are only evaluated if the message is
+ * actually logged. Furthermore, the messages whose level is greater than
+ * the compile time level of their topic are completely removed by the
+ * compiler. The compile time level of a topic XXX is ORK_LOG_LEVEL_XXX,
+ * which defaults to ORK_LOG_LEVEL, which defaults to ORK_LOG_DEBUG. For
+ * instance, compiling with -DORK_LOG_LEVEL=ORK_LOG_INFO removes all the
+ * debug messages logged with ORK_DEBUG and ORK_DEBUGF. Usage:
+ *
+ * <pre>
+ * ORK_DEBUG(RENDER, "Set Program");
+ * ORK_DEBUGF(RENDER, "Draw Mesh (%d vertices)", count);
+ * </pre>
+ */
+
+#define ORK_LOG_NONE 0
+#define ORK_LOG_ERROR 1
+#define ORK_LOG_WARNING 2
+#define ORK_LOG_INFO 3
+#define ORK_LOG_DEBUG 4
+
+#ifndef ORK_LOG_LEVEL
+#define ORK_LOG_LEVEL ORK_LOG_DEBUG
+#endif
+
+#ifndef ORK_LOG_LEVEL_CORE
+#define ORK_LOG_LEVEL_CORE ORK_LOG_LEVEL
+#endif
+
+#ifndef ORK_LOG_LEVEL_RENDER
+#define ORK_LOG_LEVEL_RENDER ORK_LOG_LEVEL
+#endif
+
+#ifndef ORK_LOG_LEVEL_RESOURCE
+#define ORK_LOG_LEVEL_RESOURCE ORK_LOG_LEVEL
+#endif
+
+#ifndef ORK_LOG_LEVEL_SCENEGRAPH
+#define ORK_LOG_LEVEL_SCENEGRAPH ORK_LOG_LEVEL
+#endif
+
+#ifndef ORK_LOG_LEVEL_SCHEDULER
+#define ORK_LOG_LEVEL_SCHEDULER ORK_LOG_LEVEL
+#endif
+
+/**
+ * True if messages of the given topic and level must be logged.
+ */
+#define ORK_LOG_ENABLED(topic, level) \
+    (ORK_LOG_LEVEL_##topic >= (level) && ork::Logger::TOPIC_LEVELS[ork::Logger::TOPIC_##topic] >= (level))
+
+/**
+ * Calls the given method of the given logger, if it is not NULL, and if
+ * messages of the given topic and level must be logged.
+ */
+#define ORK_LOG_CALL(logger, topic, level, call) \
+    do { \
+        if (ORK_LOG_ENABLED(topic, level) && ork::Logger::logger != NULL) { \
+            ork::Logger::logger->call; \
+        } \
+    } while (false)
+
+#define ORK_DEBUG(topic, msg) ORK_LOG_CALL(DEBUG_LOGGER, topic, ORK_LOG_DEBUG, log(#topic, msg))
+#define ORK_DEBUGF(topic, ...) ORK_LOG_CALL(DEBUG_LOGGER, topic, ORK_LOG_DEBUG, logf(#topic, __VA_ARGS__))
+#define ORK_INFO(topic, msg) ORK_LOG_CALL(INFO_LOGGER, topic, ORK_LOG_INFO, log(#topic, msg))
+#define ORK_INFOF(topic, ...) ORK_LOG_CALL(INFO_LOGGER, topic, ORK_LOG_INFO, logf(#topic, __VA_ARGS__))
+#define ORK_WARNING(topic, msg) ORK_LOG_CALL(WARNING_LOGGER, topic, ORK_LOG_WARNING, log(#topic, msg))
+#define ORK_WARNINGF(topic, ...) ORK_LOG_CALL(WARNING_LOGGER, topic, ORK_LOG_WARNING, logf(#topic, __VA_ARGS__))
+#define ORK_ERROR(topic, msg) ORK_LOG_CALL(ERROR_LOGGER, topic, ORK_LOG_ERROR, log(#topic, msg))
+#define ORK_ERRORF(topic, ...) ORK_LOG_CALL(ERROR_LOGGER, topic, ORK_LOG_ERROR, logf(#topic, __VA_ARGS__))
+
 }
 
 #endif
@@ -45,14 +45,36 @@
 #include <cstdio>
 #include <cassert>
 
+// ORK_CPP11 is defined if the compiler supports C++11, in which case
+// ptr has move constructors and move assignment operators
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1600)
+#define ORK_CPP11
+#endif
+
+// ORK_NOEXCEPT marks the ptr move operations as not throwing, so that
+// standard containers move them instead of copying them (Visual C++
+// supports noexcept only since Visual Studio 2015)
+#ifdef ORK_CPP11
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define ORK_NOEXCEPT
+#else
+#define ORK_NOEXCEPT noexcept
+#endif
+#endif
+
 #ifdef USE_SHARED_PTR
-#ifdef _MSC_VER
+#if defined(_MSC_VER) || defined(ORK_CPP11)
 #include <memory>
 #define TR1 std
 #else
 #include <tr1/memory>
 #define TR1 std::tr1
 #endif
+#elif defined(USE_ATOMIC_REFCOUNT)
+#ifndef ORK_CPP11
+#error USE_ATOMIC_REFCOUNT requires C++11
+#endif
+#include <atomic>
 #else
 #include "ork/core/Atomic.h"
 #endif
@@ -178,6 +200,28 @@ public: // in fact should be private, but then ptr could not access these member
             o->doRelease();
         }
     }
+#elif defined(USE_ATOMIC_REFCOUNT)
+    /*
+     * Increments the reference counter of this object. A new reference can
+     * only be created from an existing one, so no ordering is needed here.
+     */
+    inline void acquire()
+    {
+        references.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /*
+     * Decrements the reference counter of this object. The release order
+     * makes all the accesses to this object done through this reference
+     * visible to the thread that deletes it, and the acquire order makes
+     * this thread see them before deleting the object.
+     */
+    inline void release()
+    {
+        if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            doRelease();
+        }
+    }
 #else
     /*
      * Increments the reference counter of this object.
@@ -242,7 +286,12 @@ private:
     char *type;
 #endif
 
-#ifndef USE_SHARED_PTR
+#if defined(USE_ATOMIC_REFCOUNT) && !defined(USE_SHARED_PTR)
+    /**
+     * The number of references to this object.
+     */
+    std::atomic<int> references;
+#elif !defined(USE_SHARED_PTR)
     /**
      * The number of references to this object.
      */
@@ -300,12 +349,13 @@ public:
     }
 
     /**
-     * Creates a pointer to the given object.
+     * Creates a pointer to the given object. Since ref_this points to target
+     * itself, a static cast is sufficient to convert it to a pointer of type T.
      */
     inline ptr(T *target) :
         TR1::shared_ptr<T>(target == NULL ? TR1::shared_ptr<T>() :
             target->ref_this.expired() ? ptr<T>(target, Object::release) :
-                TR1::dynamic_pointer_cast<T>(TR1::shared_ptr<Object>(target->ref_this)))
+                TR1::static_pointer_cast<T>(TR1::shared_ptr<Object>(target->ref_this)))
     {
     }
 
@@ -317,6 +367,48 @@ public:
     {
     }
 
+#ifdef ORK_CPP11
+    /**
+     * Creates a pointer as a copy of the given pointer.
+     */
+    inline ptr(const ptr<T> &p) : TR1::shared_ptr<T>(p)
+    {
+    }
+
+    /**
+     * Creates a pointer by moving the given pointer, which becomes NULL.
+     */
+    inline ptr(ptr<T> &&p) ORK_NOEXCEPT : TR1::shared_ptr<T>(std::move(p))
+    {
+    }
+
+    /**
+     * Creates a pointer by moving the given pointer, which becomes NULL.
+     */
+    template<class U>
+    inline ptr(TR1::shared_ptr<U> &&p) ORK_NOEXCEPT : TR1::shared_ptr<T>(std::move(p))
+    {
+    }
+
+    /**
+     * Assigns the given pointer to this pointer.
+     */
+    inline ptr<T> &operator=(const ptr<T> &p)
+    {
+        TR1::shared_ptr<T>::operator=(p);
+        return *this;
+    }
+
+    /**
+     * Moves the given pointer to this pointer. The given pointer becomes NULL.
+     */
+    inline ptr<T> &operator=(ptr<T> &&p) ORK_NOEXCEPT
+    {
+        TR1::shared_ptr<T>::operator=(std::move(p));
+        return *this;
+    }
+#endif
+
     /**
      * Creates a pointer as a copy of the given pointer.
      */
@@ -377,6 +469,27 @@ public:
         }
     }
 
+#ifdef ORK_CPP11
+    /**
+     * Creates a strong pointer by moving the given pointer, which becomes
+     * NULL. The reference count of the target object is not changed.
+     */
+    inline ptr(ptr<T> &&p) ORK_NOEXCEPT : target(p.target)
+    {
+        p.target = 0;
+    }
+
+    /**
+     * Creates a strong pointer by moving the given pointer, which becomes
+     * NULL. The reference count of the target object is not changed.
+     */
+    template<class U>
+    inline ptr(ptr<U> &&p) ORK_NOEXCEPT : target(p.target)
+    {
+        p.target = 0;
+    }
+#endif
+
     /**
      * Destroys this strong pointer.
      */
@@ -406,6 +519,24 @@ public:
         }
     }
 
+#ifdef ORK_CPP11
+    /**
+     * Moves the given pointer to this strong pointer. The given pointer
+     * becomes NULL.
+     */
+    inline void operator=(ptr<T> &&v) ORK_NOEXCEPT
+    {
+        if (&v != this) {
+            T* oldTarget = target;
+            target = v.target;
+            v.target = 0;
+            if (oldTarget != 0) {
+                oldTarget->release();
+            }
+        }
+    }
+#endif
+
     /**
      * Returns the target object of this strong pointer.
      */
@@ -491,6 +622,8 @@ protected:
      * The object pointed by this strong pointer.
      */
     T *target;
+
+    template<class U> friend class ptr;
 };
 #endif
 
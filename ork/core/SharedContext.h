@@ -0,0 +1,116 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+
+#ifndef _ORK_SHARED_CONTEXT_H_
+#define _ORK_SHARED_CONTEXT_H_
+
+#include "ork/core/Object.h"
+
+namespace ork
+{
+
+/**
+ * An OpenGL context that shares its objects (buffers, textures, etc) with
+ * the main OpenGL context of the application. Such a context can be used to
+ * create or fill GPU resources in another thread than the main thread. It
+ * does not have a default framebuffer. Shared contexts are created with
+ * Window#createSharedContext.
+ *
+ * The state caches of Ork (texture unit bindings, current program, etc)
+ * describe the main context. Code running with a shared context must not
+ * rely on them, and can test this with #getCurrent. Textures must be deleted
+ * or swapped in the main thread.
+ * @ingroup core
+ */
+class ORK_API SharedContext : public Object
+{
+public:
+    /**
+     * Creates a new shared context.
+     */
+    SharedContext() : Object("SharedContext")
+    {
+    }
+
+    /**
+     * Deletes this shared context. This context must not be current in any
+     * thread.
+     */
+    virtual ~SharedContext()
+    {
+    }
+
+    /**
+     * Makes this context current in the calling thread.
+     *
+     * @return true if this context could be made current.
+     */
+    bool makeCurrent();
+
+    /**
+     * Releases this context from the calling thread.
+     */
+    void doneCurrent();
+
+    /**
+     * Returns the shared context that is current in the calling thread, or
+     * NULL if this thread uses the main context, or no context.
+     */
+    static SharedContext *getCurrent();
+
+protected:
+    /**
+     * Makes this context current in the calling thread.
+     *
+     * @return true if this context could be made current.
+     */
+    virtual bool makeContextCurrent() = 0;
+
+    /**
+     * Releases this context from the calling thread.
+     */
+    virtual void releaseContext() = 0;
+};
+
+}
+
+#endif
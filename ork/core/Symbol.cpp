@@ -0,0 +1,159 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+
+#include "ork/core/Symbol.h"
+
+#include <map>
+#include <pthread.h>
+
+#include "ork/core/Logger.h"
+
+using namespace std;
+
+namespace ork
+{
+
+#define SYMBOL_PAGE_SIZE 256
+
+#define SYMBOL_MAX_PAGES 4096
+
+#define SYMBOL_NOT_FOUND 0xFFFFFFFF // the identifier returned by Symbol#find for unknown strings
+
+static pthread_once_t symbolsOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * The lock used to synchronize the accesses to symbolIds. Lookups of existing
+ * symbols only take a read lock, so that they can be done concurrently.
+ */
+static pthread_rwlock_t symbolsLock;
+
+static map<string, unsigned int> *symbolIds = NULL; ///< the identifiers of the interned strings
+
+/**
+ * The interned strings, indexed by their identifier. They are stored in fixed
+ * size pages that are never moved, so that Symbol#str() can read them without
+ * locking symbolsMutex.
+ */
+static string *symbolPages[SYMBOL_MAX_PAGES];
+
+static unsigned int symbolCount = 0; ///< the number of interned strings
+
+static void initSymbols()
+{
+    pthread_rwlock_init(&symbolsLock, NULL);
+    symbolIds = new map<string, unsigned int>();
+    symbolPages[0] = new string[SYMBOL_PAGE_SIZE];
+    symbolIds->insert(make_pair(string(), 0u));
+    symbolCount = 1;
+}
+
+Symbol::Symbol() : id(0)
+{
+}
+
+Symbol::Symbol(const char *s) : id(intern(string(s)))
+{
+}
+
+Symbol::Symbol(const string &s) : id(intern(s))
+{
+}
+
+Symbol Symbol::find(const string &s)
+{
+    Symbol result;
+    if (!s.empty()) {
+        pthread_once(&symbolsOnce, initSymbols);
+        pthread_rwlock_rdlock(&symbolsLock);
+        map<string, unsigned int>::iterator i = symbolIds->find(s);
+        result.id = i == symbolIds->end() ? SYMBOL_NOT_FOUND : i->second;
+        pthread_rwlock_unlock(&symbolsLock);
+    }
+    return result;
+}
+
+const string &Symbol::str() const
+{
+    pthread_once(&symbolsOnce, initSymbols);
+    if (id == SYMBOL_NOT_FOUND) {
+        return symbolPages[0][0];
+    }
+    return symbolPages[id / SYMBOL_PAGE_SIZE][id % SYMBOL_PAGE_SIZE];
+}
+
+unsigned int Symbol::intern(const string &s)
+{
+    if (s.empty()) {
+        return 0;
+    }
+    Symbol existing = find(s);
+    if (existing.id != SYMBOL_NOT_FOUND) {
+        return existing.id;
+    }
+    pthread_rwlock_wrlock(&symbolsLock);
+    // the string may have been interned by another thread in the meantime
+    map<string, unsigned int>::iterator i = symbolIds->find(s);
+    unsigned int result;
+    if (i != symbolIds->end()) {
+        result = i->second;
+    } else {
+        result = symbolCount;
+        unsigned int page = result / SYMBOL_PAGE_SIZE;
+        if (page >= SYMBOL_MAX_PAGES) {
+            pthread_rwlock_unlock(&symbolsLock);
+            if (Logger::ERROR_LOGGER != NULL) {
+                Logger::ERROR_LOGGER->log("CORE", "Too many symbols");
+            }
+            throw exception();
+        }
+        if (symbolPages[page] == NULL) {
+            symbolPages[page] = new string[SYMBOL_PAGE_SIZE];
+        }
+        symbolPages[page][result % SYMBOL_PAGE_SIZE] = s;
+        symbolIds->insert(make_pair(s, result));
+        ++symbolCount;
+    }
+    pthread_rwlock_unlock(&symbolsLock);
+    return result;
+}
+
+}
@@ -0,0 +1,390 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+
+#ifndef _ORK_SYMBOL_H_
+#define _ORK_SYMBOL_H_
+
+#include <string>
+#include <vector>
+
+namespace ork
+{
+
+/**
+ * An interned string. Each distinct string is associated with a unique
+ * integer identifier the first time a Symbol is created for it, so that
+ * symbols can then be copied, compared and ordered as integers. Symbols are
+ * never freed: they should be used for a bounded set of names, such as scene
+ * node flags or property names, and not for arbitrary user data.
+ * Symbols can be created and used concurrently from several threads.
+ * @ingroup core
+ */
+class ORK_API Symbol
+{
+public:
+    /**
+     * Creates the symbol of the empty string.
+     */
+    Symbol();
+
+    /**
+     * Creates the symbol of the given string. This requires a lookup in the
+     * global symbol table, and should therefore be done once, outside of
+     * performance critical code.
+     *
+     * @param s a string.
+     */
+    explicit Symbol(const char *s);
+
+    /**
+     * Creates the symbol of the given string. This requires a lookup in the
+     * global symbol table, and should therefore be done once, outside of
+     * performance critical code.
+     *
+     * @param s a string.
+     */
+    explicit Symbol(const std::string &s);
+
+    /**
+     * Returns the symbol of the given string if it has already been created,
+     * or a symbol different from all the others otherwise. Unlike the
+     * constructors, this method never adds a string to the global symbol
+     * table. It should be used to look up names given by the user, which
+     * are found only if some object already uses them.
+     *
+     * @param s a string.
+     */
+    static Symbol find(const std::string &s);
+
+    /**
+     * Returns the unique identifier of this symbol. The identifier of the
+     * empty string is 0.
+     */
+    inline unsigned int getId() const
+    {
+        return id;
+    }
+
+    /**
+     * Returns the string associated with this symbol.
+     */
+    const std::string &str() const;
+
+    /**
+     * Returns true if this symbol is the symbol of the empty string.
+     */
+    inline bool empty() const
+    {
+        return id == 0;
+    }
+
+    /**
+     * Returns true if this symbol is equal to the given one.
+     */
+    inline bool operator==(const Symbol &s) const
+    {
+        return id == s.id;
+    }
+
+    /**
+     * Returns true if this symbol is different from the given one.
+     */
+    inline bool operator!=(const Symbol &s) const
+    {
+        return id != s.id;
+    }
+
+    /**
+     * Compares the identifiers of this symbol and of the given one. This
+     * order is not the lexicographic order of the associated strings.
+     */
+    inline bool operator<(const Symbol &s) const
+    {
+        return id < s.id;
+    }
+
+private:
+    /**
+     * The unique identifier of this symbol.
+     */
+    unsigned int id;
+
+    /**
+     * Returns the unique identifier associated with the given string,
+     * creating it if necessary.
+     *
+     * @param s a string.
+     */
+    static unsigned int intern(const std::string &s);
+};
+
+/**
+ * A small associative container indexed by symbols. The elements are stored
+ * in insertion order in a flat vector, and are found with a linear search on
+ * the symbol identifiers. This is faster than a std::map for the few elements
+ * stored in a SceneNode.
+ * @ingroup core
+ */
+template <typename type>
+class SymbolMap
+{
+public:
+    /**
+     * The type of the elements of this map.
+     */
+    typedef std::pair<Symbol, type> entry;
+
+    /**
+     * Returns the number of elements of this map.
+     */
+    inline unsigned int size() const
+    {
+        return (unsigned int) entries.size();
+    }
+
+    /**
+     * Returns the element associated with the given symbol, or NULL if there
+     * is no such element.
+     */
+    inline type *find(Symbol k)
+    {
+        for (unsigned int i = 0; i < entries.size(); ++i) {
+            if (entries[i].first == k) {
+                return &(entries[i].second);
+            }
+        }
+        return NULL;
+    }
+
+    /**
+     * Associates the given element with the given symbol.
+     *
+     * @param replace true to replace an element already associated with this
+     *      symbol, false to keep it.
+     */
+    inline void set(Symbol k, const type &t, bool replace = true)
+    {
+        type *e = find(k);
+        if (e == NULL) {
+            entries.push_back(entry(k, t));
+        } else if (replace) {
+            *e = t;
+        }
+    }
+
+    /**
+     * Removes the element associated with the given symbol, if any. The order
+     * of the other elements is preserved.
+     */
+    inline void erase(Symbol k)
+    {
+        for (unsigned int i = 0; i < entries.size(); ++i) {
+            if (entries[i].first == k) {
+                entries.erase(entries.begin() + i);
+                return;
+            }
+        }
+    }
+
+    /**
+     * Swaps the content of this map with the given one.
+     */
+    inline void swap(SymbolMap<type> &m)
+    {
+        entries.swap(m.entries);
+    }
+
+    /**
+     * The elements of this map.
+     */
+    std::vector<entry> entries;
+};
+
+/**
+ * An iterator over a vector of symbols, returning them as strings.
+ * @ingroup core
+ */
+class ORK_API SymbolSetIterator
+{
+public:
+    /**
+     * Creates an iterator for the given symbols.
+     */
+    SymbolSetIterator(const std::vector<Symbol> &c) : n((unsigned int) c.size()), i(0), c(&c)
+    {
+    }
+
+    /**
+     * Returns the number of symbols for which this iterator has been created.
+     */
+    unsigned int size()
+    {
+        return n;
+    }
+
+    /**
+     * Returns true if the iteration is not yet finished.
+     */
+    bool hasNext()
+    {
+        return i < n;
+    }
+
+    /**
+     * Returns the string of the symbol at the current iterator position.
+     * The iterator position is then incremented.
+     */
+    std::string next()
+    {
+        return (*c)[i++].str();
+    }
+
+    /**
+     * Returns the symbol at the current iterator position.
+     * The iterator position is then incremented.
+     */
+    Symbol nextSymbol()
+    {
+        return (*c)[i++];
+    }
+
+private:
+    /**
+     * The number of symbols for which this iterator has been created.
+     */
+    unsigned int n;
+
+    /**
+     * The current iterator position.
+     */
+    unsigned int i;
+
+    /**
+     * The symbols for which this iterator has been created.
+     */
+    const std::vector<Symbol> *c;
+};
+
+/**
+ * An iterator over a SymbolMap.
+ * @ingroup core
+ */
+template <typename type>
+class SymbolMapIterator
+{
+public:
+    /**
+     * Creates an iterator for the given map.
+     */
+    SymbolMapIterator(SymbolMap<type> &c) : n(c.size()), i(0), c(&c)
+    {
+    }
+
+    /**
+     * Returns the size of the map for which this iterator has been created.
+     */
+    unsigned int size()
+    {
+        return n;
+    }
+
+    /**
+     * Returns true if the iteration is not yet finished.
+     */
+    bool hasNext()
+    {
+        return i < n;
+    }
+
+    /**
+     * Returns the element at the current iterator position.
+     * The iterator position is then incremented.
+     */
+    type next()
+    {
+        return c->entries[i++].second;
+    }
+
+    /**
+     * Returns the element at the current iterator position.
+     * The iterator position is then incremented.
+     *
+     * @param[out] k the key of this element.
+     */
+    type next(std::string &k)
+    {
+        k = c->entries[i].first.str();
+        return c->entries[i++].second;
+    }
+
+    /**
+     * Returns the element at the current iterator position.
+     * The iterator position is then incremented.
+     *
+     * @param[out] k the key of this element.
+     */
+    type next(Symbol &k)
+    {
+        k = c->entries[i].first;
+        return c->entries[i++].second;
+    }
+
+private:
+    /**
+     * The size of the map for which this iterator has been created.
+     */
+    unsigned int n;
+
+    /**
+     * The current iterator position.
+     */
+    unsigned int i;
+
+    /**
+     * The map for which this iterator has been created.
+     */
+    SymbolMap<type> *c;
+};
+
+}
+
+#endif
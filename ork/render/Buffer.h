@@ -249,6 +249,8 @@ private:
 
     friend class FrameBuffer;
 
+    friend class Texture;
+
     friend class Texture1D;
 
     friend class Texture1DArray;
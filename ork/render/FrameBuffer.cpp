@@ -210,9 +210,7 @@ FrameBuffer::Parameters::Parameters() :
 
 void FrameBuffer::Parameters::set(const Parameters &p)
 {
-    if (Logger::DEBUG_LOGGER != NULL) {
-        Logger::DEBUG_LOGGER->log("RENDER", "Set FrameBuffer Parameters");
-    }
+    ORK_DEBUG(RENDER, "Set FrameBuffer Parameters");
     GLint version = 0;
     glGetIntegerv(GL_MAJOR_VERSION, &version);
 
@@ -1344,9 +1342,7 @@ void FrameBuffer::setStencilMask(GLuint frontMask, GLuint backMask)
 
 void FrameBuffer::clear(bool color, bool stencil, bool depth)
 {
-    if (Logger::DEBUG_LOGGER != NULL) {
-        Logger::DEBUG_LOGGER->log("RENDER", "Clear FrameBuffer");
-    }
+    ORK_DEBUG(RENDER, "Clear FrameBuffer");
     set();
     int buffers = 0;
     if (color) {
@@ -1369,12 +1365,11 @@ void FrameBuffer::draw(ptr<Program> p, const MeshBuffers &mesh, MeshMode m, GLin
     assert(TransformFeedback::TRANSFORM == NULL);
     set();
     p->set();
-    if (Logger::DEBUG_LOGGER != NULL) {
-        Logger::DEBUG_LOGGER->logf("RENDER", "Draw Mesh (%d vertices)", count);
-    }
+    ORK_DEBUGF(RENDER, "Draw Mesh (%d vertices)", count);
     beginConditionalRender();
     mesh.draw(m, first, count, primCount, base);
     endConditionalRender();
+    p->dirtyStorageBlocks();
 }
 
 void FrameBuffer::multiDraw(ptr<Program> p, const MeshBuffers &mesh, MeshMode m, GLint *firsts, GLsizei *counts, GLsizei primCount, GLint* bases)
@@ -1382,12 +1377,11 @@ void FrameBuffer::multiDraw(ptr<Program> p, const MeshBuffers &mesh, MeshMode m,
     assert(TransformFeedback::TRANSFORM == NULL);
     set();
     p->set();
-    if (Logger::DEBUG_LOGGER != NULL) {
-        Logger::DEBUG_LOGGER->logf("RENDER", "MultiDraw (%d instances)", primCount);
-    }
+    ORK_DEBUGF(RENDER, "MultiDraw (%d instances)", primCount);
     beginConditionalRender();
     mesh.multiDraw(m, firsts, counts, primCount, bases);
     endConditionalRender();
+    p->dirtyStorageBlocks();
 }
 
 void FrameBuffer::drawIndirect(ptr<Program> p, const MeshBuffers &mesh, MeshMode m, const Buffer &buf)
@@ -1395,12 +1389,11 @@ void FrameBuffer::drawIndirect(ptr<Program> p, const MeshBuffers &mesh, MeshMode
     assert(TransformFeedback::TRANSFORM == NULL);
     set();
     p->set();
-    if (Logger::DEBUG_LOGGER != NULL) {
-        Logger::DEBUG_LOGGER->log("RENDER", "DrawIndirect");
-    }
+    ORK_DEBUG(RENDER, "DrawIndirect");
     beginConditionalRender();
     mesh.drawIndirect(m, buf);
     endConditionalRender();
+    p->dirtyStorageBlocks();
 }
 
 void FrameBuffer::drawFeedback(ptr<Program> p, const MeshBuffers &mesh, MeshMode m, const TransformFeedback &tfb, int stream)
@@ -1408,12 +1401,11 @@ void FrameBuffer::drawFeedback(ptr<Program> p, const MeshBuffers &mesh, MeshMode
     assert(TransformFeedback::TRANSFORM == NULL && tfb.id != 0);
     set();
     p->set();
-    if (Logger::DEBUG_LOGGER != NULL) {
-        Logger::DEBUG_LOGGER->log("RENDER", "DrawFeedBack");
-    }
+    ORK_DEBUG(RENDER, "DrawFeedBack");
     beginConditionalRender();
     mesh.drawFeedback(m, tfb.id, stream);
     endConditionalRender();
+    p->dirtyStorageBlocks();
 }
 
 void FrameBuffer::drawQuad(ptr<Program> p)
@@ -1430,11 +1422,34 @@ void FrameBuffer::drawQuad(ptr<Program> p)
     draw(p, *QUAD);
 }
 
+void FrameBuffer::dispatch(ptr<Program> p, int groupsX, int groupsY, int groupsZ)
+{
+    p->set();
+    ORK_DEBUG(RENDER, "Dispatch");
+    glDispatchCompute(GLuint(groupsX), GLuint(groupsY), GLuint(groupsZ));
+    p->dirtyStorageBlocks();
+    assert(getError() == 0);
+}
+
+void FrameBuffer::dispatchIndirect(ptr<Program> p, const Buffer &buf, int offset)
+{
+    p->set();
+    ORK_DEBUG(RENDER, "DispatchIndirect");
+    buf.bind(GL_DISPATCH_INDIRECT_BUFFER);
+    glDispatchComputeIndirect(GLintptr(buf.data(offset)));
+    buf.unbind(GL_DISPATCH_INDIRECT_BUFFER);
+    p->dirtyStorageBlocks();
+    assert(getError() == 0);
+}
+
+void FrameBuffer::memoryBarrier(GLbitfield barriers)
+{
+    glMemoryBarrier(barriers);
+}
+
 void FrameBuffer::readPixels(int x, int y, int w, int h, TextureFormat f, PixelType t, const Buffer::Parameters &s, const Buffer &dstBuf, bool clamp)
 {
-    if (Logger::DEBUG_LOGGER != NULL) {
-        Logger::DEBUG_LOGGER->logf("RENDER", "read %d pixels", w * h);
-    }
+    ORK_DEBUGF(RENDER, "read %d pixels", w * h);
     set();
     dstBuf.bind(GL_PIXEL_PACK_BUFFER);
     s.set();
@@ -1541,9 +1556,7 @@ GLenum FrameBuffer::getError()
 
 void FrameBuffer::resetAllStates()
 {
-    if (Logger::DEBUG_LOGGER != NULL) {
-        Logger::DEBUG_LOGGER->log("RENDER", "Reset GL STATES");
-    }
+    ORK_DEBUG(RENDER, "Reset GL STATES");
     if (MeshBuffers::CURRENT != NULL) {
         MeshBuffers::CURRENT->reset();
     }
@@ -1560,9 +1573,7 @@ void FrameBuffer::set()
 {
     bool framebufferChanged = false;
     if (CURRENT != this) {
-        if (Logger::DEBUG_LOGGER != NULL) {
-            Logger::DEBUG_LOGGER->log("RENDER", "Changing Current Framebuffer");
-        }
+        ORK_DEBUG(RENDER, "Changing Current Framebuffer");
         glBindFramebuffer(GL_FRAMEBUFFER, framebufferId);
         CURRENT = this;
         framebufferChanged = true;
@@ -1594,9 +1605,7 @@ void FrameBuffer::set()
 
 void FrameBuffer::setAttachments()
 {
-    if (Logger::DEBUG_LOGGER != NULL) {
-        Logger::DEBUG_LOGGER->log("RENDER", "Setting Framebuffer attachments");
-    }
+    ORK_DEBUG(RENDER, "Setting Framebuffer attachments");
     const int ATTACHMENTS[] = {
         GL_COLOR_ATTACHMENT0,
         GL_COLOR_ATTACHMENT1,
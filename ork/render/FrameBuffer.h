@@ -1390,6 +1390,38 @@ public:
      */
     void drawQuad(ptr<Program> p);
 
+    /**
+     * Executes a compute program. The uniforms, textures and uniform blocks
+     * of the program are bound as for a draw call, but this framebuffer is
+     * not used. Only available with OpenGL 4.3 or more.
+     *
+     * @param p a program made of a compute shader.
+     * @param groupsX the number of work groups to execute in x.
+     * @param groupsY the number of work groups to execute in y.
+     * @param groupsZ the number of work groups to execute in z.
+     */
+    void dispatch(ptr<Program> p, int groupsX, int groupsY = 1, int groupsZ = 1);
+
+    /**
+     * Executes a compute program with a number of work groups read from a
+     * GPU buffer. Only available with OpenGL 4.3 or more.
+     *
+     * @param p a program made of a compute shader.
+     * @param buf a GPU buffer containing the number of work groups in x, y
+     *      and z, in this order, as 32 bit unsigned integers.
+     * @param offset the offset of these values in buf, in bytes.
+     */
+    void dispatchIndirect(ptr<Program> p, const Buffer &buf, int offset = 0);
+
+    /**
+     * Makes the memory writes of the previous shader invocations (e.g. from
+     * a compute program) visible to the given subsequent operations.
+     *
+     * @param barriers the operations that must see the previous writes, as
+     *      a combination of GL_*_BARRIER_BIT values.
+     */
+    static void memoryBarrier(GLbitfield barriers);
+
     /**
      * Reads pixels from the attached color buffers into the given buffer.
      *
@@ -1678,7 +1710,11 @@ inline void FrameBuffer::draw(ptr<Program> p, const Mesh<vertex, index> &mesh, i
     set();
     p->set();
     beginConditionalRender();
-    mesh.getBuffers()->draw(mesh.getMode(), 0, mesh.getIndiceCount() == 0 ? mesh.getVertexCount() : mesh.getIndiceCount(), primCount, 0);
+    ptr<MeshBuffers> buffers = mesh.getBuffers();
+    // GPU_TRANSIENT meshes are stored at some offset in a shared buffer
+    GLint first = mesh.transientFirst;
+    GLint base = mesh.getIndiceCount() == 0 ? 0 : mesh.transientBase;
+    buffers->draw(mesh.getMode(), first, mesh.getIndiceCount() == 0 ? mesh.getVertexCount() : mesh.getIndiceCount(), primCount, base);
     endConditionalRender();
 }
 
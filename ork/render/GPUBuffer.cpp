@@ -67,13 +67,13 @@ GLenum getBufferAccess(BufferAccess a);
 
 /**
  * A uniform buffer unit.
- * Used to bind buffers used as uniform blocks in programs.
+ * Used to bind buffers used as uniform blocks or storage blocks in programs.
  */
 class UniformBufferUnit
 {
 public:
-    UniformBufferUnit(GLuint unit) :
-        unit(unit), lastBindingTime(0), currentBufferBinding(NULL)
+    UniformBufferUnit(GLenum target, GLuint unit) :
+        target(target), unit(unit), lastBindingTime(0), currentBufferBinding(NULL)
     {
     }
 
@@ -82,19 +82,19 @@ public:
         lastBindingTime = time;
 
         if (currentBufferBinding != NULL) {
-            currentBufferBinding->currentUniformUnit = -1;
+            getCurrentUnit(currentBufferBinding) = -1;
         }
         currentBufferBinding = buffer;
         if (currentBufferBinding != NULL) {
-            currentBufferBinding->currentUniformUnit = unit;
+            getCurrentUnit(currentBufferBinding) = unit;
         }
 
         if (buffer == NULL) {
-            glBindBufferBase(GL_UNIFORM_BUFFER, unit, 0);
+            glBindBufferBase(target, unit, 0);
         } else {
             // TODO add support for glBindBufferRange
-            //glBindBufferRange(GL_UNIFORM_BUFFER, unit, buffer->getId(), offset, size);
-            glBindBufferBase(GL_UNIFORM_BUFFER, unit, buffer->getId());
+            //glBindBufferRange(target, unit, buffer->getId(), offset, size);
+            glBindBufferBase(target, unit, buffer->getId());
         }
         assert(FrameBuffer::getError() == GL_NO_ERROR);
     }
@@ -115,24 +115,39 @@ public:
     }
 
 private:
+    GLenum target;
+
     GLuint unit;
 
     unsigned int lastBindingTime;
 
     const GPUBuffer *currentBufferBinding;
+
+    int &getCurrentUnit(const GPUBuffer *buffer)
+    {
+        if (target == GL_UNIFORM_BUFFER) {
+            return buffer->currentUniformUnit;
+        }
+        return buffer->currentStorageUnit;
+    }
 };
 
 /**
- * A uniform buffer unit manager.
+ * A uniform buffer unit manager. Also used to manage the shader storage buffer
+ * units, with GL_SHADER_STORAGE_BUFFER as target.
  */
 class UniformBufferManager
 {
 public:
-    UniformBufferManager() : time(0)
+    UniformBufferManager(GLenum target = GL_UNIFORM_BUFFER) : time(0)
     {
-        GLuint maxUnits = getMaxUniformBufferUnits();
+        if (target == GL_UNIFORM_BUFFER) {
+            maxUnits = getMaxUniformBufferUnits();
+        } else {
+            maxUnits = getMaxStorageBufferUnits();
+        }
         for (GLuint i = 0; i < maxUnits; ++i) {
-            units[i] = new UniformBufferUnit(i);
+            units[i] = new UniformBufferUnit(target, i);
         }
     }
 
@@ -186,7 +201,8 @@ public:
 
     static unsigned int getMaxUniformBufferUnits()
     {
-        if (maxUnits == 0) {
+        static GLuint maxUniformUnits = 0;
+        if (maxUniformUnits == 0) {
             GLint maxUniformBufferBindings;
             GLint v, f, g, h;
             glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &maxUniformBufferBindings);
@@ -194,17 +210,35 @@ public:
             glGetIntegerv(GL_MAX_GEOMETRY_UNIFORM_BLOCKS, &f);
             glGetIntegerv(GL_MAX_FRAGMENT_UNIFORM_BLOCKS, &g);
             glGetIntegerv(GL_MAX_COMBINED_UNIFORM_BLOCKS, &h);
-            maxUnits = std::min(maxUniformBufferBindings, MAX_UNIFORM_BUFFER_UNITS);
-            maxUnits = std::min(maxUnits, GLuint(v));
-            maxUnits = std::min(maxUnits, GLuint(f));
-            maxUnits = std::min(maxUnits, GLuint(g));
-            maxUnits = std::min(maxUnits, GLuint(h));
+            maxUniformUnits = std::min(maxUniformBufferBindings, MAX_UNIFORM_BUFFER_UNITS);
+            maxUniformUnits = std::min(maxUniformUnits, GLuint(v));
+            maxUniformUnits = std::min(maxUniformUnits, GLuint(f));
+            maxUniformUnits = std::min(maxUniformUnits, GLuint(g));
+            maxUniformUnits = std::min(maxUniformUnits, GLuint(h));
 
             if (Logger::DEBUG_LOGGER != NULL) {
                 Logger::DEBUG_LOGGER->logf("OPENGL", "MAX_UNIFORM_BUFFER_BINDINGS = %d", maxUniformBufferBindings);
             }
         }
-        return maxUnits;
+        return maxUniformUnits;
+    }
+
+    static unsigned int getMaxStorageBufferUnits()
+    {
+        static GLuint maxStorageUnits = 0;
+        if (maxStorageUnits == 0) {
+            GLint maxStorageBufferBindings;
+            GLint maxCombinedStorageBlocks;
+            glGetIntegerv(GL_MAX_SHADER_STORAGE_BUFFER_BINDINGS, &maxStorageBufferBindings);
+            glGetIntegerv(GL_MAX_COMBINED_SHADER_STORAGE_BLOCKS, &maxCombinedStorageBlocks);
+            maxStorageUnits = std::min(maxStorageBufferBindings, MAX_UNIFORM_BUFFER_UNITS);
+            maxStorageUnits = std::min(maxStorageUnits, GLuint(maxCombinedStorageBlocks));
+
+            if (Logger::DEBUG_LOGGER != NULL) {
+                Logger::DEBUG_LOGGER->logf("OPENGL", "MAX_SHADER_STORAGE_BUFFER_BINDINGS = %d", maxStorageBufferBindings);
+            }
+        }
+        return maxStorageUnits;
     }
 
 private:
@@ -212,14 +246,14 @@ private:
 
     unsigned int time;
 
-    static GLuint maxUnits;
+    GLuint maxUnits;
 };
 
-GLuint UniformBufferManager::maxUnits = 0;
-
 static UniformBufferManager* UNIFORM_BUFFER_MANAGER = NULL;
 
-GPUBuffer::GPUBuffer() : size(0), mappedData(NULL), cpuData(NULL), isDirty(false), currentUniformUnit(-1)
+static UniformBufferManager* STORAGE_BUFFER_MANAGER = NULL;
+
+GPUBuffer::GPUBuffer() : size(0), mappedData(NULL), cpuData(NULL), isDirty(false), currentUniformUnit(-1), currentStorageUnit(-1)
 {
     if (UNIFORM_BUFFER_MANAGER == NULL) {
         UNIFORM_BUFFER_MANAGER = new UniformBufferManager();
@@ -232,6 +266,9 @@ GPUBuffer::GPUBuffer() : size(0), mappedData(NULL), cpuData(NULL), isDirty(false
 GPUBuffer::~GPUBuffer()
 {
     UNIFORM_BUFFER_MANAGER->unbind(this);
+    if (STORAGE_BUFFER_MANAGER != NULL) {
+        STORAGE_BUFFER_MANAGER->unbind(this);
+    }
 
     if (cpuData != NULL) {
         delete[] cpuData;
@@ -319,6 +356,23 @@ volatile void *GPUBuffer::map(BufferAccess a)
     return mappedData;
 }
 
+volatile void *GPUBuffer::mapPersistent(int size)
+{
+    assert(mappedData == NULL);
+    this->size = size;
+    if (cpuData != NULL) {
+        delete[] cpuData;
+        cpuData = NULL;
+    }
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, size, NULL, flags);
+    mappedData = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    assert(FrameBuffer::getError() == GL_NO_ERROR);
+    return mappedData;
+}
+
 volatile void *GPUBuffer::getMappedData()
 {
     return mappedData;
@@ -394,4 +448,19 @@ GLint GPUBuffer::bindToUniformBufferUnit(const vector<GLuint> &programIds) const
     return unit;
 }
 
+GLint GPUBuffer::bindToStorageBufferUnit(const vector<GLuint> &programIds) const
+{
+    if (STORAGE_BUFFER_MANAGER == NULL) {
+        // created lazily, since it requires OpenGL 4.3
+        STORAGE_BUFFER_MANAGER = new UniformBufferManager(GL_SHADER_STORAGE_BUFFER);
+    }
+    GLint unit = currentStorageUnit;
+    if (unit == -1) {
+        unit = STORAGE_BUFFER_MANAGER->findFreeUnit(programIds);
+        assert(unit >= 0);
+    }
+    STORAGE_BUFFER_MANAGER->bind(GLuint(unit), this);
+    return unit;
+}
+
 }
@@ -114,6 +114,18 @@ public:
      */
     volatile void *map(BufferAccess a);
 
+    /**
+     * Allocates an immutable storage of the given size for this buffer, and
+     * maps it persistently and coherently for writing. The previous content
+     * is erased. The returned pointer remains valid until this buffer is
+     * destroyed, and writes to it are visible to the GPU without unmapping
+     * the buffer (but the caller must synchronize with the GPU before
+     * overwriting data that may still be in use). Requires OpenGL 4.4.
+     *
+     * @param size the size of the storage in bytes.
+     */
+    volatile void *mapPersistent(int size);
+
     /**
      * Returns the mapped data of this buffer, or NULL if it is currently unmapped.
      */
@@ -170,7 +182,14 @@ private:
     mutable int currentUniformUnit;
 
     /**
-     * Identifiers of the programs that use this buffer as a uniform block.
+     * The shader storage block binding unit to which this buffer is currently
+     * bound, or -1 if it is not bound to any storage block binding unit.
+     */
+    mutable int currentStorageUnit;
+
+    /**
+     * Identifiers of the programs that use this buffer as a uniform block
+     * or as a storage block.
      */
     mutable std::vector<GLuint> programIds;
 
@@ -203,6 +222,17 @@ private:
      */
     GLint bindToUniformBufferUnit(const std::vector<GLuint> &programIds) const;
 
+    /**
+     * Binds this buffer to a shader storage block binding unit not currently
+     * used by the given programs. See #bindToUniformBufferUnit.
+     *
+     * @param programIds the ids of programs that must use this buffer as a
+     *      storage block.
+     * @return the storage block binding unit to which this buffer has been
+     *      bound, or -1 if no unit was available.
+     */
+    GLint bindToStorageBufferUnit(const std::vector<GLuint> &programIds) const;
+
     friend class UniformBufferUnit;
 
     friend class UniformBufferManager;
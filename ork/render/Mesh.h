@@ -42,6 +42,7 @@
 #ifndef _ORK_MESH_H_
 #define _ORK_MESH_H_
 
+#include <algorithm>
 #include <cstring> // for memcpy
 
 #include <GL/glew.h>
@@ -49,6 +50,7 @@
 #include "ork/render/CPUBuffer.h"
 #include "ork/render/GPUBuffer.h"
 #include "ork/render/MeshBuffers.h"
+#include "ork/render/TransientBuffer.h"
 
 namespace ork
 {
@@ -57,6 +59,19 @@ class FrameBuffer;
 
 /**
  * A MeshBuffers wrapper that provides a convenient API to define the mesh content.
+ * For GPU_DYNAMIC and GPU_STREAM meshes, only the vertices and indices that
+ * have changed since the last upload are sent to the GPU (with a single
+ * glBufferSubData call covering the modified range), and the GPU buffers
+ * keep their capacity when the mesh is cleared, so that dynamic geometry
+ * rebuilt at each frame (e.g. text) does not reallocate GPU memory. When
+ * the whole content is modified, the GPU buffer is orphaned before being
+ * updated, to avoid waiting for the draw calls still using it.
+ *
+ * GPU_TRANSIENT meshes do not have their own GPU buffers. Instead, their
+ * content is copied at each frame where they are drawn in a range allocated
+ * in TransientBuffer#INSTANCE. They must be drawn with
+ * FrameBuffer#draw(ptr<Program>, const Mesh&, int), which takes the offset
+ * of this range into account.
  * @ingroup render
  *
  * @tparam vertex the type of the vertices of this mesh.
@@ -147,7 +162,7 @@ public:
 
     /**
      * Sets the capacity of the vertex and indice array of this mesh. Does
-     * nothing if the provided sizes are smaller than the current ones.
+     * nothing if the provided sizes are smaller than the current capacities.
      *
      * @param vertexCount the new vertex array capacity.
      * @param indiceCount the new indice array capacity.
@@ -202,12 +217,14 @@ public:
     inline void setPatchVertices(GLint vertices);
 
     /**
-     * Removes all the vertices and indices of this mesh.
+     * Removes all the vertices and indices of this mesh. The capacity of the
+     * vertex and indice arrays, and of the GPU buffers, is unchanged.
      */
     inline void clear();
 
     /**
-     * Clears the MeshBuffers.
+     * Clears the MeshBuffers. The GPU buffers are recreated at the next
+     * call to #getBuffers.
      */
     inline void clearBuffers();
 
@@ -229,14 +246,56 @@ private:
     mutable ptr<Buffer> indexBuffer;
 
     /**
-     * True if the vertex data has changed since last call to #uploadVertexDataToGPU.
+     * The first vertex that has changed since the last call to
+     * #uploadVertexDataToGPU.
+     */
+    mutable int vertexDirtyBegin;
+
+    /**
+     * The vertex after the last vertex that has changed since the last call
+     * to #uploadVertexDataToGPU (equal to #vertexDirtyBegin if no vertex
+     * has changed).
+     */
+    mutable int vertexDirtyEnd;
+
+    /**
+     * The first indice that has changed since the last call to
+     * #uploadIndexDataToGPU.
+     */
+    mutable int indexDirtyBegin;
+
+    /**
+     * The indice after the last indice that has changed since the last call
+     * to #uploadIndexDataToGPU (equal to #indexDirtyBegin if no indice has
+     * changed).
+     */
+    mutable int indexDirtyEnd;
+
+    /**
+     * The capacity of the GPU vertex buffer, in number of vertices.
+     */
+    mutable int vertexBufferLength;
+
+    /**
+     * The capacity of the GPU index buffer, in number of indices.
+     */
+    mutable int indexBufferLength;
+
+    /**
+     * The TransientBuffer frame at which the content of this GPU_TRANSIENT
+     * mesh was last copied in TransientBuffer#INSTANCE.
      */
-    mutable bool vertexDataHasChanged;
+    mutable unsigned int transientFrame;
 
     /**
-     * True if the index data has changed since last call to #uploadIndexDataToGPU.
+     * The first vertex or indice to draw, for GPU_TRANSIENT meshes.
      */
-    mutable bool indexDataHasChanged;
+    mutable GLint transientFirst;
+
+    /**
+     * The base vertex to use with indices, for GPU_TRANSIENT meshes.
+     */
+    mutable GLint transientBase;
 
     /**
      * True if the CPU or GPU mesh buffers have been created.
@@ -302,21 +361,68 @@ private:
      * Resizes the indice array to expand its capacity.
      */
     void resizeIndices(int newSize);
+
+    /**
+     * Marks the given range of vertices as modified.
+     */
+    inline void setVerticesChanged(int begin, int end) const;
+
+    /**
+     * Marks the given range of indices as modified.
+     */
+    inline void setIndicesChanged(int begin, int end) const;
+
     /**
      * Creates the CPU of GPU buffers based on the current content of the
      * vertex and indice arrays.
      */
     void createBuffers() const;
+
     /**
-     * Send the vertices to the GPU.
+     * Creates the index buffer, and sets it in the MeshBuffers.
+     */
+    void createIndexBuffer() const;
+
+    /**
+     * Copies the content of this GPU_TRANSIENT mesh in TransientBuffer#INSTANCE,
+     * if this has not been done yet in the current frame or if this content
+     * has changed since then. Returns false if this is not possible.
+     */
+    bool uploadTransientData() const;
+
+    /**
+     * Replaces the transient buffer, if used, with dedicated GPU buffers for
+     * this GPU_TRANSIENT mesh.
+     */
+    void useDedicatedBuffers() const;
+
+    /**
+     * Sends the modified vertices to the GPU.
      */
     void uploadVertexDataToGPU(BufferUsage u) const;
 
     /**
-     * Send the indices to the GPU.
+     * Sends the modified indices to the GPU.
      */
     void uploadIndexDataToGPU(BufferUsage u) const;
 
+    /**
+     * Sends the [begin,end) range of the given data to the given GPU buffer,
+     * reallocating or orphaning it if needed.
+     *
+     * @param b a GPU buffer.
+     * @param[in,out] bufferLength the capacity of b, in elements.
+     * @param data the data to upload.
+     * @param elementSize the size of each element of data.
+     * @param count the number of elements in data.
+     * @param capacity the capacity of the CPU array containing data.
+     * @param begin the first modified element.
+     * @param end the element after the last modified element.
+     * @param u the GPU buffer usage.
+     */
+    static void uploadDataToGPU(GPUBuffer *b, int &bufferLength, const void *data, int elementSize,
+        int count, int capacity, int begin, int end, BufferUsage u);
+
     friend class FrameBuffer;
 };
 
@@ -336,8 +442,13 @@ Mesh<vertex, index>::Mesh(MeshMode m, MeshUsage usage, int vertexCount, int indi
     indicesCount = 0;
     primitiveRestart = -1;
     patchVertices = 0;
-    vertexDataHasChanged = true;
-    indexDataHasChanged = true;
+    vertexDirtyBegin = vertexDirtyEnd = 0;
+    indexDirtyBegin = indexDirtyEnd = 0;
+    vertexBufferLength = 0;
+    indexBufferLength = 0;
+    transientFrame = (unsigned int) -1;
+    transientFirst = 0;
+    transientBase = 0;
 }
 
 template<class vertex, class index>
@@ -356,8 +467,13 @@ Mesh<vertex, index>::Mesh(ptr<MeshBuffers> target, MeshMode m, MeshUsage usage,
     indicesCount = 0;
     primitiveRestart = -1;
     patchVertices = 0;
-    vertexDataHasChanged = true;
-    indexDataHasChanged = true;
+    vertexDirtyBegin = vertexDirtyEnd = 0;
+    indexDirtyBegin = indexDirtyEnd = 0;
+    vertexBufferLength = 0;
+    indexBufferLength = 0;
+    transientFrame = (unsigned int) -1;
+    transientFirst = 0;
+    transientBase = 0;
 }
 
 template<class vertex, class index>
@@ -409,13 +525,42 @@ GLint Mesh<vertex, index>::getPatchVertices() const
     return patchVertices;
 }
 
+template<class vertex, class index>
+void Mesh<vertex, index>::uploadDataToGPU(GPUBuffer *b, int &bufferLength, const void *data, int elementSize,
+    int count, int capacity, int begin, int end, BufferUsage u)
+{
+    end = std::min(end, count);
+    if (u == STATIC_DRAW) {
+        // static data is uploaded once, without extra capacity
+        b->setData(count * elementSize, data, u);
+        bufferLength = count;
+        return;
+    }
+    if (bufferLength < count) {
+        // grows the GPU buffer to the capacity of the CPU array, which grows
+        // geometrically, so that reallocations are rare
+        b->setData(capacity * elementSize, NULL, u);
+        bufferLength = capacity;
+        begin = 0;
+        end = count;
+    } else if (end > begin && begin == 0 && end == count) {
+        // the whole content changes: orphans the buffer storage to avoid
+        // synchronizing with the previous draw calls using it
+        b->setData(bufferLength * elementSize, NULL, u);
+    }
+    if (end > begin) {
+        b->setSubData(begin * elementSize, (end - begin) * elementSize, ((const unsigned char*) data) + begin * elementSize);
+    }
+}
+
 template<class vertex, class index>
 void Mesh<vertex, index>::uploadVertexDataToGPU(BufferUsage u) const
 {
     ptr<GPUBuffer> vb = vertexBuffer.cast<GPUBuffer>();
     assert(vb != NULL); // check it's a GPU mesh
-    vb->setData(verticesCount * sizeof(vertex), vertices, u);
-    vertexDataHasChanged = false;
+    uploadDataToGPU(vb.get(), vertexBufferLength, vertices, sizeof(vertex), verticesCount, verticesLength,
+        vertexDirtyBegin, vertexDirtyEnd, u);
+    vertexDirtyBegin = vertexDirtyEnd = 0;
 }
 
 template<class vertex, class index>
@@ -423,8 +568,9 @@ void Mesh<vertex, index>::uploadIndexDataToGPU(BufferUsage u) const
 {
     ptr<GPUBuffer> ib = indexBuffer.cast<GPUBuffer>();
     assert(ib != NULL);
-    ib->setData(indicesCount * sizeof(index), indices, u);
-    indexDataHasChanged = false;
+    uploadDataToGPU(ib.get(), indexBufferLength, indices, sizeof(index), indicesCount, indicesLength,
+        indexDirtyBegin, indexDirtyEnd, u);
+    indexDirtyBegin = indexDirtyEnd = 0;
 }
 
 template<class vertex, class index>
@@ -434,22 +580,121 @@ ptr<MeshBuffers> Mesh<vertex, index>::getBuffers() const
         createBuffers();
     }
 
-    if ((usage == GPU_DYNAMIC) || (usage == GPU_STREAM)) { // upload data to GPU if needed
+    bool transient = usage == GPU_TRANSIENT && uploadTransientData();
+    if (usage == GPU_TRANSIENT && !transient) {
+        useDedicatedBuffers();
+    }
+
+    if ((usage == GPU_DYNAMIC) || (usage == GPU_STREAM) || (usage == GPU_TRANSIENT && !transient)) { // upload data to GPU if needed
         BufferUsage u = usage == GPU_DYNAMIC ? DYNAMIC_DRAW : STREAM_DRAW;
-        if (vertexDataHasChanged) {
+        if (vertexDirtyEnd > vertexDirtyBegin || vertexBufferLength < verticesCount) {
             uploadVertexDataToGPU(u);
         }
-        if ((indicesCount != 0) && indexDataHasChanged) {
-            uploadIndexDataToGPU(u);
+        if (indicesCount != 0) {
+            if (buffers->getIndiceBuffer() == NULL) {
+                createIndexBuffer();
+            }
+            if (indexDirtyEnd > indexDirtyBegin || indexBufferLength < indicesCount) {
+                uploadIndexDataToGPU(u);
+            }
+        } else if (buffers->getIndiceBuffer() != NULL) {
+            buffers->reset();
+            buffers->setIndicesBuffer(NULL);
+        }
+    } else if (usage == GPU_STATIC) {
+        // static data added within the current capacity, after the buffers
+        // were created, must also be uploaded before being drawn
+        if (vertexBufferLength < verticesCount) {
+            uploadVertexDataToGPU(STATIC_DRAW);
+        }
+        if (indicesCount != 0) {
+            if (buffers->getIndiceBuffer() == NULL) {
+                createIndexBuffer();
+            } else if (indexBufferLength < indicesCount) {
+                uploadIndexDataToGPU(STATIC_DRAW);
+            }
         }
     }
 
+    buffers->mode = m;
+    buffers->nvertices = verticesCount;
+    buffers->nindices = indicesCount;
     buffers->primitiveRestart = primitiveRestart;
     buffers->patchVertices = patchVertices;
 
     return buffers;
 }
 
+template<class vertex, class index>
+bool Mesh<vertex, index>::uploadTransientData() const
+{
+    TransientBuffer *t = TransientBuffer::INSTANCE.get();
+    if (t == NULL) {
+        return false;
+    }
+    ptr<Buffer> tb = t->getBuffer();
+    bool changed = vertexDirtyEnd > vertexDirtyBegin || indexDirtyEnd > indexDirtyBegin;
+    if (vertexBuffer == tb && transientFrame == t->getFrame() && !changed) {
+        return true;
+    }
+    int vertexOffset = t->upload(vertices, verticesCount * sizeof(vertex), sizeof(vertex));
+    int indexOffset = 0;
+    if (vertexOffset >= 0 && indicesCount != 0) {
+        indexOffset = t->upload(indices, indicesCount * sizeof(index), sizeof(index));
+    }
+    if (vertexOffset < 0 || indexOffset < 0) {
+        return false;
+    }
+    t->flush();
+
+    if (vertexBuffer != tb) {
+        vertexBuffer = tb;
+        for (int i = 0; i < buffers->getAttributeCount(); ++i) {
+            buffers->getAttributeBuffer(i)->setBuffer(vertexBuffer);
+        }
+        buffers->reset();
+    }
+    if (indicesCount != 0) {
+        if (indexBuffer != tb || buffers->getIndiceBuffer() == NULL) {
+            indexBuffer = tb;
+            createIndexBuffer();
+        }
+    } else if (buffers->getIndiceBuffer() != NULL) {
+        buffers->reset();
+        buffers->setIndicesBuffer(NULL);
+        indexBuffer = NULL;
+    }
+    transientBase = vertexOffset / sizeof(vertex);
+    transientFirst = indicesCount != 0 ? indexOffset / sizeof(index) : transientBase;
+    transientFrame = t->getFrame();
+    vertexDirtyBegin = vertexDirtyEnd = 0;
+    indexDirtyBegin = indexDirtyEnd = 0;
+    return true;
+}
+
+template<class vertex, class index>
+void Mesh<vertex, index>::useDedicatedBuffers() const
+{
+    transientFirst = 0;
+    transientBase = 0;
+    TransientBuffer *t = TransientBuffer::INSTANCE.get();
+    if (vertexBuffer != NULL && (t == NULL || vertexBuffer != t->getBuffer())) {
+        return;
+    }
+    // no transient allocator or not enough space left in the current
+    // frame: uses dedicated buffers, as GPU_STREAM meshes
+    vertexBuffer = new GPUBuffer();
+    vertexBufferLength = 0;
+    setVerticesChanged(0, verticesCount);
+    for (int i = 0; i < buffers->getAttributeCount(); ++i) {
+        buffers->getAttributeBuffer(i)->setBuffer(vertexBuffer);
+    }
+    indexBuffer = NULL;
+    buffers->reset();
+    buffers->setIndicesBuffer(NULL);
+    setIndicesChanged(0, indicesCount);
+}
+
 template<class vertex, class index>
 void Mesh<vertex, index>::addAttributeType(int id, int size, AttributeType type, bool norm)
 {
@@ -459,30 +704,60 @@ void Mesh<vertex, index>::addAttributeType(int id, int size, AttributeType type,
 template<class vertex, class index>
 void Mesh<vertex, index>::setCapacity(int vertexCount, int indiceCount)
 {
-    if (verticesCount < vertexCount) {
+    if (verticesLength < vertexCount) {
         resizeVertices(vertexCount);
     }
-    if (indicesCount < indiceCount) {
+    if (indicesLength < indiceCount) {
         resizeIndices(indiceCount);
     }
 }
 
+template<class vertex, class index>
+void Mesh<vertex, index>::setVerticesChanged(int begin, int end) const
+{
+    if (vertexDirtyEnd > vertexDirtyBegin) {
+        vertexDirtyBegin = std::min(vertexDirtyBegin, begin);
+        vertexDirtyEnd = std::max(vertexDirtyEnd, end);
+    } else {
+        vertexDirtyBegin = begin;
+        vertexDirtyEnd = end;
+    }
+}
+
+template<class vertex, class index>
+void Mesh<vertex, index>::setIndicesChanged(int begin, int end) const
+{
+    if (indexDirtyEnd > indexDirtyBegin) {
+        indexDirtyBegin = std::min(indexDirtyBegin, begin);
+        indexDirtyEnd = std::max(indexDirtyEnd, end);
+    } else {
+        indexDirtyBegin = begin;
+        indexDirtyEnd = end;
+    }
+}
+
 template<class vertex, class index>
 void Mesh<vertex, index>::addVertex(const vertex &v)
 {
     if (verticesCount == verticesLength) {
         resizeVertices(2 * verticesLength);
     }
-    vertices[verticesCount++] = v;
-    vertexDataHasChanged = true;
+    vertices[verticesCount] = v;
+    setVerticesChanged(verticesCount, verticesCount + 1);
+    ++verticesCount;
 }
 
 template<class vertex, class index>
 void Mesh<vertex, index>::addVertices(const vertex *v, int count)
 {
+    if (verticesCount + count > verticesLength) {
+        resizeVertices(std::max(2 * verticesLength, verticesCount + count));
+    }
     for (int i = 0; i < count; ++i) {
-        addVertex(v[i]);
+        vertices[verticesCount + i] = v[i];
     }
+    setVerticesChanged(verticesCount, verticesCount + count);
+    verticesCount += count;
 }
 
 template<class vertex, class index>
@@ -491,8 +766,9 @@ void Mesh<vertex, index>::addIndice(index i)
     if (indicesCount == indicesLength) {
         resizeIndices(2 * indicesLength);
     }
-    indices[indicesCount++] = i;
-    indexDataHasChanged = true;
+    indices[indicesCount] = i;
+    setIndicesChanged(indicesCount, indicesCount + 1);
+    ++indicesCount;
 }
 
 template<class vertex, class index>
@@ -505,14 +781,14 @@ template<class vertex, class index>
 void Mesh<vertex, index>::setVertex(int i, const vertex &v)
 {
     vertices[i] = v;
-    vertexDataHasChanged = true;
+    setVerticesChanged(i, i + 1);
 }
 
 template<class vertex, class index>
 void Mesh<vertex, index>::setIndice(int i, index ind)
 {
     indices[i] = ind;
-    indexDataHasChanged = true;
+    setIndicesChanged(i, i + 1);
 }
 
 template<class vertex, class index>
@@ -531,11 +807,14 @@ template<class vertex, class index>
 void Mesh<vertex, index>::resizeVertices(int newSize)
 {
     vertex *newVertices = new vertex[newSize];
-    memcpy(newVertices, vertices, verticesLength * sizeof(vertex));
+    memcpy(newVertices, vertices, verticesCount * sizeof(vertex));
     delete[] vertices;
     vertices = newVertices;
     verticesLength = newSize;
-    if (created) {
+    // dynamic GPU buffers are resized lazily in #uploadDataToGPU, but CPU
+    // buffers point directly to the vertex array, and static GPU buffers are
+    // only uploaded in #createBuffers
+    if (created && (usage == CPU || usage == GPU_STATIC)) {
         buffers->reset();
         created = false;
     }
@@ -545,11 +824,11 @@ template<class vertex, class index>
 void Mesh<vertex, index>::resizeIndices(int newSize)
 {
     index *newIndices = new index[newSize];
-    memcpy(newIndices, indices, indicesLength * sizeof(index));
+    memcpy(newIndices, indices, indicesCount * sizeof(index));
     delete[] indices;
     indices = newIndices;
     indicesLength = newSize;
-    if (created) {
+    if (created && (usage == CPU || usage == GPU_STATIC)) {
         buffers->reset();
         created = false;
     }
@@ -560,9 +839,9 @@ void Mesh<vertex, index>::clear()
 {
     verticesCount = 0;
     indicesCount = 0;
-    vertexDataHasChanged = true;
-    indexDataHasChanged = true;
-    if (created) {
+    vertexDirtyBegin = vertexDirtyEnd = 0;
+    indexDirtyBegin = indexDirtyEnd = 0;
+    if (created && usage != GPU_DYNAMIC && usage != GPU_STREAM) {
         buffers->reset();
         buffers->setIndicesBuffer(NULL);
         created = false;
@@ -574,6 +853,7 @@ void Mesh<vertex, index>::clearBuffers()
 {
     if (created) {
         buffers->reset();
+        buffers->setIndicesBuffer(NULL);
         created = false;
     }
 }
@@ -581,11 +861,23 @@ void Mesh<vertex, index>::clearBuffers()
 template<class vertex, class index>
 void Mesh<vertex, index>::createBuffers() const
 {
+    if (usage == GPU_TRANSIENT) {
+        // the buffers are selected at each frame in getBuffers
+        vertexBuffer = NULL;
+        indexBuffer = NULL;
+        buffers->setIndicesBuffer(NULL);
+        transientFrame = (unsigned int) -1;
+        created = true;
+        return;
+    }
     if (usage == GPU_STATIC || usage == GPU_DYNAMIC || usage ==  GPU_STREAM) {
         GPUBuffer *gpub = new GPUBuffer();
         vertexBuffer = ptr<Buffer>(gpub);
+        vertexBufferLength = 0;
         if (usage == GPU_STATIC) {
             uploadVertexDataToGPU(STATIC_DRAW);
+        } else {
+            setVerticesChanged(0, verticesCount);
         }
     } else if (usage == CPU) {
         CPUBuffer *cpub = new CPUBuffer(vertices);
@@ -597,40 +889,53 @@ void Mesh<vertex, index>::createBuffers() const
         buffers->getAttributeBuffer(i)->setBuffer(vertexBuffer);
     }
 
+    indexBuffer = NULL;
+    buffers->setIndicesBuffer(NULL);
     if (indicesCount != 0) {
-        if (usage == GPU_STATIC || usage == GPU_DYNAMIC || usage == GPU_STREAM) {
+        createIndexBuffer();
+    }
+    buffers->mode = m;
+    buffers->nvertices = verticesCount;
+    buffers->nindices = indicesCount;
+    created = true;
+}
+
+template<class vertex, class index>
+void Mesh<vertex, index>::createIndexBuffer() const
+{
+    if (indexBuffer == NULL) {
+        if (usage == GPU_STATIC || usage == GPU_DYNAMIC || usage == GPU_STREAM || usage == GPU_TRANSIENT) {
             GPUBuffer *gpub = new GPUBuffer();
             indexBuffer = ptr<Buffer>(gpub);
+            indexBufferLength = 0;
             if (usage == GPU_STATIC) {
                 uploadIndexDataToGPU(STATIC_DRAW);
+            } else {
+                setIndicesChanged(0, indicesCount);
             }
         } else if (usage == CPU) {
             CPUBuffer *cpub = new CPUBuffer(indices);
             indexBuffer = ptr<Buffer>(cpub);
         }
+    }
 
-        AttributeType type;
-        switch (sizeof(index)) {
-        case 1:
-            type = A8UI;
-            break;
-        case 2:
-            type = A16UI;
-            break;
-        default:
-            type = A32UI;
-            break;
-        }
-        buffers->setIndicesBuffer(new AttributeBuffer(0, 1, type, false, indexBuffer));
+    AttributeType type;
+    switch (sizeof(index)) {
+    case 1:
+        type = A8UI;
+        break;
+    case 2:
+        type = A16UI;
+        break;
+    default:
+        type = A32UI;
+        break;
     }
-    buffers->mode = m;
-    buffers->nvertices = verticesCount;
-    buffers->nindices = indicesCount;
-    created = true;
+    buffers->reset();
+    buffers->setIndicesBuffer(new AttributeBuffer(0, 1, type, false, indexBuffer));
 }
 
 
-
 }
 
 #endif
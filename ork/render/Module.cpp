@@ -86,7 +86,8 @@ void Module::init(int version, const char *source)
         "#define _TESS_CONTROL_\n", strstr(source, "_TESS_CONTROL_") != NULL ? source : NULL,
         "#define _TESS_EVAL_\n", strstr(source, "_TESS_EVAL_") != NULL ? source : NULL,
         "#define _GEOMETRY_\n", strstr(source, "_GEOMETRY_") != NULL ? source : NULL,
-        "#define _FRAGMENT_\n", strstr(source, "_FRAGMENT_") != NULL ? source : NULL);
+        "#define _FRAGMENT_\n", strstr(source, "_FRAGMENT_") != NULL ? source : NULL,
+        "#define _COMPUTE_\n", strstr(source, "_COMPUTE_") != NULL ? source : NULL);
 }
 
 void Module::init(int version,
@@ -94,7 +95,8 @@ void Module::init(int version,
     const char* tessControlHeader, const char *tessControl,
     const char* tessEvaluationHeader, const char* tessEvaluation,
     const char* geometryHeader, const char* geometry,
-    const char* fragmentHeader, const char* fragment)
+    const char* fragmentHeader, const char* fragment,
+    const char* computeHeader, const char* compute)
 {
     int lineCount;
     const char* lines[3];
@@ -255,6 +257,47 @@ void Module::init(int version,
         fragmentShaderId = -1;
     }
 
+    //compiles and checks the compute shader part
+    if (compute != NULL) {
+        lineCount = computeHeader != NULL ? 3 : 2;
+        lines[1] = lineCount == 3 ? computeHeader : compute;
+        lines[2] = compute;
+        computeShaderId = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(computeShaderId, lineCount, lines, NULL);
+        glCompileShader(computeShaderId);
+        error = !check(computeShaderId);
+        printLog(computeShaderId, lineCount, lines, error);
+        if (error) {
+            // deletes already allocated objects
+            if (vertexShaderId != -1) {
+                glDeleteShader(vertexShaderId);
+                vertexShaderId = -1;
+            }
+            if (tessControlShaderId != -1) {
+                glDeleteShader(tessControlShaderId);
+                tessControlShaderId = -1;
+            }
+            if (tessEvalShaderId != -1) {
+                glDeleteShader(tessEvalShaderId);
+                tessEvalShaderId = -1;
+            }
+            if (geometryShaderId != -1) {
+                glDeleteShader(geometryShaderId);
+                geometryShaderId = -1;
+            }
+            if (fragmentShaderId != -1) {
+                glDeleteShader(fragmentShaderId);
+                fragmentShaderId = -1;
+            }
+            glDeleteShader(computeShaderId);
+            computeShaderId = -1;
+            assert(FrameBuffer::getError() == 0);
+            throw exception();
+        }
+    } else {
+        computeShaderId = -1;
+    }
+
     if (glGetError() != 0) {
         assert(false);
         throw exception();
@@ -280,6 +323,9 @@ Module::~Module()
     if (fragmentShaderId != -1) {
         glDeleteShader(fragmentShaderId);
     }
+    if (computeShaderId != -1) {
+        glDeleteShader(computeShaderId);
+    }
     assert(FrameBuffer::getError() == 0);
 
     users.clear();
@@ -312,6 +358,11 @@ int Module::getFragmentShaderId() const
     return fragmentShaderId;
 }
 
+int Module::getComputeShaderId() const
+{
+    return computeShaderId;
+}
+
 const set<Program*> &Module::getUsers() const
 {
     return users;
@@ -347,6 +398,9 @@ void Module::addInitialValue(ptr<Value> value)
         case FRAGMENT:
             initialValues.insert(make_pair("FRAGMENT " + value->getName(), value));
             break;
+        case COMPUTE:
+            initialValues.insert(make_pair("COMPUTE " + value->getName(), value));
+            break;
         }
     } else {
         initialValues.insert(make_pair(value->getName(), value));
@@ -360,6 +414,7 @@ void Module::swap(ptr<Module> s)
     std::swap(tessEvalShaderId, s->tessEvalShaderId);
     std::swap(geometryShaderId, s->geometryShaderId);
     std::swap(fragmentShaderId, s->fragmentShaderId);
+    std::swap(computeShaderId, s->computeShaderId);
     std::swap(initialValues, s->initialValues);
 }
 
@@ -435,7 +490,7 @@ public:
     {
         e = e == NULL ? desc->descriptor : e;
         try {
-            checkParameters(desc, e, "name,version, source,vertex,tessControl,tessEvaluation,geometry,fragment,feedback,varyings,options,");
+            checkParameters(desc, e, "name,version, source,vertex,tessControl,tessEvaluation,geometry,fragment,compute,feedback,varyings,options,");
 
             int version;
             getIntParameter(desc, e, "version", &version);
@@ -786,6 +841,8 @@ public:
                             v = new ValueSubroutine(GEOMETRY, n, string(f->Attribute("subroutine")));
                         } else if (strcmp(f->Attribute("stage"), "FRAGMENT") == 0) {
                             v = new ValueSubroutine(FRAGMENT, n, string(f->Attribute("subroutine")));
+                        } else if (strcmp(f->Attribute("stage"), "COMPUTE") == 0) {
+                            v = new ValueSubroutine(COMPUTE, n, string(f->Attribute("subroutine")));
                         } else {
                             if (Logger::ERROR_LOGGER != NULL) {
                                 log(Logger::ERROR_LOGGER, desc, e, "Invalid shader stage '" + string(f->Attribute("stage")) + "'");
@@ -822,13 +879,19 @@ public:
                 const char* p3 = p2 + strlen(p2) + 1;
                 const char* p4 = p3 + strlen(p3) + 1;
                 const char* p5 = p4 + strlen(p4) + 1;
+                const char* p6 = p5 + strlen(p5) + 1;
+                if (p6 >= ((const char*) desc->getData()) + desc->getSize()) {
+                    // data without a compute part
+                    p6 = "";
+                }
                 const char* head = header.c_str();
                 const char* vertex = strlen(p1) == 0 ? NULL : p1;
                 const char* tessControl = strlen(p2) == 0 ? NULL : p2;
                 const char* tessEval = strlen(p3) == 0 ? NULL : p3;
                 const char* geometry = strlen(p4) == 0 ? NULL : p4;
                 const char* fragment = strlen(p5) == 0 ? NULL : p5;
-                init(version, head, vertex, head, tessControl, head, tessEval, head, geometry, head, fragment);
+                const char* compute = strlen(p6) == 0 ? NULL : p6;
+                init(version, head, vertex, head, tessControl, head, tessEval, head, geometry, head, fragment, head, compute);
             } else {
                 if (e->Attribute("options") != NULL) {
                     header += (const char*) desc->getData();
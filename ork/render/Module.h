@@ -58,9 +58,11 @@ class Program;
 
 /**
  * A module made of a vertex, a tesselation, a geometry, and a fragment shader
- * parts. All parts are optional. These parts must be defined either each in its
- * own GLSL compilation unit, or all grouped in a single compilation unit but
- * separated with the following preprocessor directives:
+ * parts, or of a compute shader part. All parts are optional, but a compute
+ * part cannot be used in the same Program as the other parts. These parts
+ * must be defined either each in its own GLSL compilation unit, or all
+ * grouped in a single compilation unit but separated with the following
+ * preprocessor directives:
 @verbatim
  ... common code ...
 #ifdef _VERTEX_
@@ -78,6 +80,9 @@ class Program;
 #ifdef _FRAGMENT_
  ... fragment shader code ...
 #endif
+#ifdef _COMPUTE_
+ ... compute shader code ...
+#endif
 @endverbatim
  * A module can specify some initial values for its uniform variables, and
  * can also specify which output varying variable must be recorded in transform
@@ -162,6 +167,11 @@ public:
      */
     int getFragmentShaderId() const;
 
+    /**
+     * Returns the id of the compute shader part of this shader.
+     */
+    int getComputeShaderId() const;
+
     /**
      * Returns the programs that use this Module.
      */
@@ -242,13 +252,17 @@ protected:
      * @param fragmentHeader an optional header for the the fragment shader
      *      source code (maybe NULL).
      * @param fragment the fragment shader source code (maybe NULL).
+     * @param computeHeader an optional header for the the compute shader
+     *      source code (maybe NULL).
+     * @param compute the compute shader source code (maybe NULL).
      */
     void init(int version,
         const char* vertexHeader, const char* vertex,
         const char* tessControlHeader, const char *tessControl,
         const char* tessEvaluationHeader, const char* tessEvaluation,
         const char* geometryHeader, const char* geometry,
-        const char* fragmentHeader, const char* fragment);
+        const char* fragmentHeader, const char* fragment,
+        const char* computeHeader = NULL, const char* compute = NULL);
 
     /**
      * Swaps this module with the given one.
@@ -286,6 +300,11 @@ private:
      */
     int fragmentShaderId;
 
+    /**
+     * The id of the compute shader part of this shader.
+     */
+    int computeShaderId;
+
     /**
      * The transform feedback mode to use with this module.
      * 0 means 'any mode', 1 means 'interleaved attribs', 2 means 'separate attribs'.
@@ -45,29 +45,29 @@ GLenum getStage(Stage s);
 
 Program *Program::CURRENT = NULL;
 
-Program::Program() : Object("Program")
+Program::Program() : Object("Program"), version(0)
 {
 }
 
-Program::Program(const vector< ptr<Module> > &modules, bool separable) : Object("Program")
+Program::Program(const vector< ptr<Module> > &modules, bool separable) : Object("Program"), version(0)
 {
     init(modules, separable);
 }
 
-Program::Program(ptr<Module> module, bool separable) : Object("Program")
+Program::Program(ptr<Module> module, bool separable) : Object("Program"), version(0)
 {
     vector< ptr<Module> > modules;
     modules.push_back(module);
     init(modules, separable);
 }
 
-Program::Program(GLenum format, GLsizei length, unsigned char *binary, bool separable) : Object("Program")
+Program::Program(GLenum format, GLsizei length, unsigned char *binary, bool separable) : Object("Program"), version(0)
 {
     init(format, length, binary, separable);
 }
 
 Program::Program(ptr<Program> vertex, ptr<Program> tessControl, ptr<Program> tessEval, ptr<Program> geometry, ptr<Program> fragment) :
-    Object("Program")
+    Object("Program"), version(0)
 {
     programId = 0;
     glGenProgramPipelines(1, &pipelineId);
@@ -130,6 +130,9 @@ void Program::init(const vector< ptr<Module> > &modules, bool separable)
         if ((*i)->fragmentShaderId != -1) {
             glAttachShader(programId, (*i)->fragmentShaderId);
         }
+        if ((*i)->computeShaderId != -1) {
+            glAttachShader(programId, (*i)->computeShaderId);
+        }
         feedbackVaryingCount += (*i)->feedbackVaryings.size();
     }
 
@@ -198,6 +201,274 @@ void Program::init(Stage s, ptr<Program> p)
     pipelineStages.push_back(1 << s);
 }
 
+ptr<Uniform> Program::newUniform(UniformBlock *block, GLenum type, const string &name, GLuint offset, GLuint matrixStride, int isRowMajor)
+{
+    ptr<Uniform> u = NULL;
+    switch (type) {
+    case GL_FLOAT:
+        u = new Uniform1f(this, block, name, offset);
+        break;
+    case GL_FLOAT_VEC2:
+        u = new Uniform2f(this, block, name, offset);
+        break;
+    case GL_FLOAT_VEC3:
+        u = new Uniform3f(this, block, name, offset);
+        break;
+    case GL_FLOAT_VEC4:
+        u = new Uniform4f(this, block, name, offset);
+        break;
+    case GL_DOUBLE:
+        u = new Uniform1d(this, block, name, offset);
+        break;
+    case GL_DOUBLE_VEC2:
+        u = new Uniform2d(this, block, name, offset);
+        break;
+    case GL_DOUBLE_VEC3:
+        u = new Uniform3d(this, block, name, offset);
+        break;
+    case GL_DOUBLE_VEC4:
+        u = new Uniform4d(this, block, name, offset);
+        break;
+    case GL_INT:
+        u = new Uniform1i(this, block, name, offset);
+        break;
+    case GL_INT_VEC2:
+        u = new Uniform2i(this, block, name, offset);
+        break;
+    case GL_INT_VEC3:
+        u = new Uniform3i(this, block, name, offset);
+        break;
+    case GL_INT_VEC4:
+        u = new Uniform4i(this, block, name, offset);
+        break;
+    case GL_UNSIGNED_INT:
+        u = new Uniform1ui(this, block, name, offset);
+        break;
+    case GL_UNSIGNED_INT_VEC2:
+        u = new Uniform2ui(this, block, name, offset);
+        break;
+    case GL_UNSIGNED_INT_VEC3:
+        u = new Uniform3ui(this, block, name, offset);
+        break;
+    case GL_UNSIGNED_INT_VEC4:
+        u = new Uniform4ui(this, block, name, offset);
+        break;
+    case GL_BOOL:
+        u = new Uniform1b(this, block, name, offset);
+        break;
+    case GL_BOOL_VEC2:
+        u = new Uniform2b(this, block, name, offset);
+        break;
+    case GL_BOOL_VEC3:
+        u = new Uniform3b(this, block, name, offset);
+        break;
+    case GL_BOOL_VEC4:
+        u = new Uniform4b(this, block, name, offset);
+        break;
+    case GL_FLOAT_MAT2:
+        u = new UniformMatrix2f(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_FLOAT_MAT3:
+        u = new UniformMatrix3f(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_FLOAT_MAT4:
+        u = new UniformMatrix4f(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_FLOAT_MAT2x3:
+        u = new UniformMatrix2x3f(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_FLOAT_MAT2x4:
+        u = new UniformMatrix2x4f(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_FLOAT_MAT3x2:
+        u = new UniformMatrix3x2f(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_FLOAT_MAT3x4:
+        u = new UniformMatrix3x4f(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_FLOAT_MAT4x2:
+        u = new UniformMatrix4x2f(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_FLOAT_MAT4x3:
+        u = new UniformMatrix4x3f(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_DOUBLE_MAT2:
+        u = new UniformMatrix2d(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_DOUBLE_MAT3:
+        u = new UniformMatrix3d(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_DOUBLE_MAT4:
+        u = new UniformMatrix4d(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_DOUBLE_MAT2x3:
+        u = new UniformMatrix2x3d(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_DOUBLE_MAT2x4:
+        u = new UniformMatrix2x4d(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_DOUBLE_MAT3x2:
+        u = new UniformMatrix3x2d(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_DOUBLE_MAT3x4:
+        u = new UniformMatrix3x4d(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_DOUBLE_MAT4x2:
+        u = new UniformMatrix4x2d(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_DOUBLE_MAT4x3:
+        u = new UniformMatrix4x3d(this, block, name, offset, matrixStride, isRowMajor);
+        break;
+    case GL_SAMPLER_1D:
+    case GL_SAMPLER_1D_SHADOW:
+        u = new UniformSampler(SAMPLER_1D, this, block, name, offset);
+        break;
+    case GL_SAMPLER_2D:
+    case GL_SAMPLER_2D_SHADOW:
+        u = new UniformSampler(SAMPLER_2D, this, block, name, offset);
+        break;
+    case GL_SAMPLER_3D:
+        u = new UniformSampler(SAMPLER_3D, this, block, name, offset);
+        break;
+    case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_CUBE_SHADOW:
+        u = new UniformSampler(SAMPLER_CUBE, this, block, name, offset);
+        break;
+    case GL_SAMPLER_1D_ARRAY:
+    case GL_SAMPLER_1D_ARRAY_SHADOW:
+        u = new UniformSampler(SAMPLER_1D_ARRAY, this, block, name, offset);
+        break;
+    case GL_SAMPLER_2D_ARRAY:
+    case GL_SAMPLER_2D_ARRAY_SHADOW:
+        u = new UniformSampler(SAMPLER_2D_ARRAY, this, block, name, offset);
+        break;
+    case GL_SAMPLER_CUBE_MAP_ARRAY:
+    case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+        u = new UniformSampler(SAMPLER_CUBE_MAP_ARRAY, this, block, name, offset);
+        break;
+    case GL_SAMPLER_2D_MULTISAMPLE:
+        u = new UniformSampler(SAMPLER_2D_MULTISAMPLE, this, block, name, offset);
+        break;
+    case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        u = new UniformSampler(SAMPLER_2D_MULTISAMPLE_ARRAY, this, block, name, offset);
+        break;
+    case GL_SAMPLER_BUFFER:
+        u = new UniformSampler(SAMPLER_BUFFER, this, block, name, offset);
+        break;
+    case GL_SAMPLER_2D_RECT:
+    case GL_SAMPLER_2D_RECT_SHADOW:
+        u = new UniformSampler(SAMPLER_2D_RECT, this, block, name, offset);
+        break;
+    case GL_INT_SAMPLER_1D:
+        u = new UniformSampler(INT_SAMPLER_1D, this, block, name, offset);
+        break;
+    case GL_INT_SAMPLER_2D:
+        u = new UniformSampler(INT_SAMPLER_2D, this, block, name, offset);
+        break;
+    case GL_INT_SAMPLER_3D:
+        u = new UniformSampler(INT_SAMPLER_3D, this, block, name, offset);
+        break;
+    case GL_INT_SAMPLER_CUBE:
+        u = new UniformSampler(INT_SAMPLER_CUBE, this, block, name, offset);
+        break;
+    case GL_INT_SAMPLER_1D_ARRAY:
+        u = new UniformSampler(INT_SAMPLER_1D_ARRAY, this, block, name, offset);
+        break;
+    case GL_INT_SAMPLER_2D_ARRAY:
+        u = new UniformSampler(INT_SAMPLER_2D_ARRAY, this, block, name, offset);
+        break;
+    case GL_INT_SAMPLER_CUBE_MAP_ARRAY:
+        u = new UniformSampler(INT_SAMPLER_CUBE_MAP_ARRAY, this, block, name, offset);
+        break;
+    case GL_INT_SAMPLER_2D_MULTISAMPLE:
+        u = new UniformSampler(INT_SAMPLER_2D_MULTISAMPLE, this, block, name, offset);
+        break;
+    case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        u = new UniformSampler(INT_SAMPLER_2D_MULTISAMPLE_ARRAY, this, block, name, offset);
+        break;
+    case GL_INT_SAMPLER_BUFFER:
+        u = new UniformSampler(INT_SAMPLER_BUFFER, this, block, name, offset);
+        break;
+    case GL_INT_SAMPLER_2D_RECT:
+        u = new UniformSampler(INT_SAMPLER_2D_RECT, this, block, name, offset);
+        break;
+    case GL_UNSIGNED_INT_SAMPLER_1D:
+        u = new UniformSampler(UNSIGNED_INT_SAMPLER_1D, this, block, name, offset);
+        break;
+    case GL_UNSIGNED_INT_SAMPLER_2D:
+        u = new UniformSampler(UNSIGNED_INT_SAMPLER_2D, this, block, name, offset);
+        break;
+    case GL_UNSIGNED_INT_SAMPLER_3D:
+        u = new UniformSampler(UNSIGNED_INT_SAMPLER_3D, this, block, name, offset);
+        break;
+    case GL_UNSIGNED_INT_SAMPLER_CUBE:
+        u = new UniformSampler(UNSIGNED_INT_SAMPLER_CUBE, this, block, name, offset);
+        break;
+    case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+        u = new UniformSampler(UNSIGNED_INT_SAMPLER_1D_ARRAY, this, block, name, offset);
+        break;
+    case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+        u = new UniformSampler(UNSIGNED_INT_SAMPLER_2D_ARRAY, this, block, name, offset);
+        break;
+    case GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:
+        u = new UniformSampler(UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY, this, block, name, offset);
+        break;
+    case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+        u = new UniformSampler(UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE, this, block, name, offset);
+        break;
+    case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        u = new UniformSampler(UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY, this, block, name, offset);
+        break;
+    case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+        u = new UniformSampler(UNSIGNED_INT_SAMPLER_BUFFER, this, block, name, offset);
+        break;
+    case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+        u = new UniformSampler(UNSIGNED_INT_SAMPLER_2D_RECT, this, block, name, offset);
+        break;
+    case GL_IMAGE_1D:
+    case GL_IMAGE_2D:
+    case GL_IMAGE_3D:
+    case GL_IMAGE_2D_RECT:
+    case GL_IMAGE_CUBE:
+    case GL_IMAGE_BUFFER:
+    case GL_IMAGE_1D_ARRAY:
+    case GL_IMAGE_2D_ARRAY:
+    case GL_IMAGE_CUBE_MAP_ARRAY:
+    case GL_IMAGE_2D_MULTISAMPLE:
+    case GL_IMAGE_2D_MULTISAMPLE_ARRAY:
+    case GL_INT_IMAGE_1D:
+    case GL_INT_IMAGE_2D:
+    case GL_INT_IMAGE_3D:
+    case GL_INT_IMAGE_2D_RECT:
+    case GL_INT_IMAGE_CUBE:
+    case GL_INT_IMAGE_BUFFER:
+    case GL_INT_IMAGE_1D_ARRAY:
+    case GL_INT_IMAGE_2D_ARRAY:
+    case GL_INT_IMAGE_CUBE_MAP_ARRAY:
+    case GL_INT_IMAGE_2D_MULTISAMPLE:
+    case GL_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+    case GL_UNSIGNED_INT_IMAGE_1D:
+    case GL_UNSIGNED_INT_IMAGE_2D:
+    case GL_UNSIGNED_INT_IMAGE_3D:
+    case GL_UNSIGNED_INT_IMAGE_2D_RECT:
+    case GL_UNSIGNED_INT_IMAGE_CUBE:
+    case GL_UNSIGNED_INT_IMAGE_BUFFER:
+    case GL_UNSIGNED_INT_IMAGE_1D_ARRAY:
+    case GL_UNSIGNED_INT_IMAGE_2D_ARRAY:
+    case GL_UNSIGNED_INT_IMAGE_CUBE_MAP_ARRAY:
+    case GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE:
+    case GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+        // the value of an image uniform is the index of the image
+        // unit it is bound to (see Texture#bindToImageUnit)
+        u = new Uniform1i(this, block, name, offset);
+        break;
+    default:
+        assert(false);
+        break;
+    }
+    return u;
+}
+
 void Program::initUniforms()
 {
     GLint linked;
@@ -224,8 +495,19 @@ void Program::initUniforms()
     glGetProgramiv(programId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
     glGetProgramiv(programId, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
     maxNameLength = max(maxNameLength, maxLength);
+    bool storage = FrameBuffer::getMajorVersion() > 4 ||
+        (FrameBuffer::getMajorVersion() == 4 && FrameBuffer::getMinorVersion() >= 3);
+    if (storage) {
+        glGetProgramInterfaceiv(programId, GL_SHADER_STORAGE_BLOCK, GL_MAX_NAME_LENGTH, &maxLength);
+        maxNameLength = max(maxNameLength, maxLength);
+        glGetProgramInterfaceiv(programId, GL_BUFFER_VARIABLE, GL_MAX_NAME_LENGTH, &maxLength);
+        maxNameLength = max(maxNameLength, maxLength);
+    }
     if (FrameBuffer::getMajorVersion() >= 4) {
-        for (Stage s = VERTEX; s <= FRAGMENT; s = Stage(s + 1)) {
+        for (Stage s = VERTEX; s <= COMPUTE; s = Stage(s + 1)) {
+            if (!hasStage(s)) {
+                continue;
+            }
             glGetProgramStageiv(programId, getStage(s), GL_ACTIVE_SUBROUTINE_UNIFORM_MAX_LENGTH, &maxLength);
             maxNameLength = max(maxNameLength, maxLength);
             glGetProgramStageiv(programId, getStage(s), GL_ACTIVE_SUBROUTINE_MAX_LENGTH, &maxLength);
@@ -304,231 +586,7 @@ void Program::initUniforms()
                 uoffset = offset + j * arrayStride;
             }
 
-            switch (type) {
-            case GL_FLOAT:
-                u = new Uniform1f(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_FLOAT_VEC2:
-                u = new Uniform2f(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_FLOAT_VEC3:
-                u = new Uniform3f(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_FLOAT_VEC4:
-                u = new Uniform4f(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_DOUBLE:
-                u = new Uniform1d(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_DOUBLE_VEC2:
-                u = new Uniform2d(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_DOUBLE_VEC3:
-                u = new Uniform3d(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_DOUBLE_VEC4:
-                u = new Uniform4d(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_INT:
-                u = new Uniform1i(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_INT_VEC2:
-                u = new Uniform2i(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_INT_VEC3:
-                u = new Uniform3i(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_INT_VEC4:
-                u = new Uniform4i(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_UNSIGNED_INT:
-                u = new Uniform1ui(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_UNSIGNED_INT_VEC2:
-                u = new Uniform2ui(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_UNSIGNED_INT_VEC3:
-                u = new Uniform3ui(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_UNSIGNED_INT_VEC4:
-                u = new Uniform4ui(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_BOOL:
-                u = new Uniform1b(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_BOOL_VEC2:
-                u = new Uniform2b(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_BOOL_VEC3:
-                u = new Uniform3b(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_BOOL_VEC4:
-                u = new Uniform4b(this, block, uname, GLuint(uoffset));
-                break;
-            case GL_FLOAT_MAT2:
-                u = new UniformMatrix2f(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_FLOAT_MAT3:
-                u = new UniformMatrix3f(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_FLOAT_MAT4:
-                u = new UniformMatrix4f(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_FLOAT_MAT2x3:
-                u = new UniformMatrix2x3f(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_FLOAT_MAT2x4:
-                u = new UniformMatrix2x4f(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_FLOAT_MAT3x2:
-                u = new UniformMatrix3x2f(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_FLOAT_MAT3x4:
-                u = new UniformMatrix3x4f(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_FLOAT_MAT4x2:
-                u = new UniformMatrix4x2f(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_FLOAT_MAT4x3:
-                u = new UniformMatrix4x3f(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_DOUBLE_MAT2:
-                u = new UniformMatrix2d(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_DOUBLE_MAT3:
-                u = new UniformMatrix3d(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_DOUBLE_MAT4:
-                u = new UniformMatrix4d(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_DOUBLE_MAT2x3:
-                u = new UniformMatrix2x3d(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_DOUBLE_MAT2x4:
-                u = new UniformMatrix2x4d(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_DOUBLE_MAT3x2:
-                u = new UniformMatrix3x2d(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_DOUBLE_MAT3x4:
-                u = new UniformMatrix3x4d(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_DOUBLE_MAT4x2:
-                u = new UniformMatrix4x2d(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_DOUBLE_MAT4x3:
-                u = new UniformMatrix4x3d(this, block, uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
-                break;
-            case GL_SAMPLER_1D:
-            case GL_SAMPLER_1D_SHADOW:
-                u = new UniformSampler(SAMPLER_1D, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_SAMPLER_2D:
-            case GL_SAMPLER_2D_SHADOW:
-                u = new UniformSampler(SAMPLER_2D, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_SAMPLER_3D:
-                u = new UniformSampler(SAMPLER_3D, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_SAMPLER_CUBE:
-            case GL_SAMPLER_CUBE_SHADOW:
-                u = new UniformSampler(SAMPLER_CUBE, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_SAMPLER_1D_ARRAY:
-            case GL_SAMPLER_1D_ARRAY_SHADOW:
-                u = new UniformSampler(SAMPLER_1D_ARRAY, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_SAMPLER_2D_ARRAY:
-            case GL_SAMPLER_2D_ARRAY_SHADOW:
-                u = new UniformSampler(SAMPLER_2D_ARRAY, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_SAMPLER_CUBE_MAP_ARRAY:
-            case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
-                u = new UniformSampler(SAMPLER_CUBE_MAP_ARRAY, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_SAMPLER_2D_MULTISAMPLE:
-                u = new UniformSampler(SAMPLER_2D_MULTISAMPLE, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
-                u = new UniformSampler(SAMPLER_2D_MULTISAMPLE_ARRAY, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_SAMPLER_BUFFER:
-                u = new UniformSampler(SAMPLER_BUFFER, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_SAMPLER_2D_RECT:
-            case GL_SAMPLER_2D_RECT_SHADOW:
-                u = new UniformSampler(SAMPLER_2D_RECT, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_INT_SAMPLER_1D:
-                u = new UniformSampler(INT_SAMPLER_1D, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_INT_SAMPLER_2D:
-                u = new UniformSampler(INT_SAMPLER_2D, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_INT_SAMPLER_3D:
-                u = new UniformSampler(INT_SAMPLER_3D, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_INT_SAMPLER_CUBE:
-                u = new UniformSampler(INT_SAMPLER_CUBE, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_INT_SAMPLER_1D_ARRAY:
-                u = new UniformSampler(INT_SAMPLER_1D_ARRAY, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_INT_SAMPLER_2D_ARRAY:
-                u = new UniformSampler(INT_SAMPLER_2D_ARRAY, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_INT_SAMPLER_CUBE_MAP_ARRAY:
-                u = new UniformSampler(INT_SAMPLER_CUBE_MAP_ARRAY, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_INT_SAMPLER_2D_MULTISAMPLE:
-                u = new UniformSampler(INT_SAMPLER_2D_MULTISAMPLE, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
-                u = new UniformSampler(INT_SAMPLER_2D_MULTISAMPLE_ARRAY, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_INT_SAMPLER_BUFFER:
-                u = new UniformSampler(INT_SAMPLER_BUFFER, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_INT_SAMPLER_2D_RECT:
-                u = new UniformSampler(INT_SAMPLER_2D_RECT, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_UNSIGNED_INT_SAMPLER_1D:
-                u = new UniformSampler(UNSIGNED_INT_SAMPLER_1D, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_UNSIGNED_INT_SAMPLER_2D:
-                u = new UniformSampler(UNSIGNED_INT_SAMPLER_2D, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_UNSIGNED_INT_SAMPLER_3D:
-                u = new UniformSampler(UNSIGNED_INT_SAMPLER_3D, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_UNSIGNED_INT_SAMPLER_CUBE:
-                u = new UniformSampler(UNSIGNED_INT_SAMPLER_CUBE, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
-                u = new UniformSampler(UNSIGNED_INT_SAMPLER_1D_ARRAY, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
-                u = new UniformSampler(UNSIGNED_INT_SAMPLER_2D_ARRAY, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:
-                u = new UniformSampler(UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
-                u = new UniformSampler(UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
-                u = new UniformSampler(UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_UNSIGNED_INT_SAMPLER_BUFFER:
-                u = new UniformSampler(UNSIGNED_INT_SAMPLER_BUFFER, this, block, uname, GLuint(uoffset));
-                break;
-            case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
-                u = new UniformSampler(UNSIGNED_INT_SAMPLER_2D_RECT, this, block, uname, GLuint(uoffset));
-                break;
-            default:
-                assert(false);
-                break;
-            }
+            u = newUniform(block, GLenum(type), uname, GLuint(uoffset), GLuint(matrixStride), int(isRowMajor));
 
             uniforms.insert(make_pair(uname, u));
             if (b != NULL) {
@@ -540,11 +598,91 @@ void Program::initUniforms()
         }
     }
 
+    if (storage) {
+        GLint nBlocks;
+        glGetProgramInterfaceiv(programId, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &nBlocks);
+        vector<StorageBlock*> blocks;
+        for (GLuint i = 0; i < (GLuint) nBlocks; ++i) {
+            GLsizei length;
+            GLenum prop = GL_BUFFER_DATA_SIZE;
+            GLint blockSize;
+            glGetProgramResourceName(programId, GL_SHADER_STORAGE_BLOCK, i, GLsizei(maxNameLength), &length, buf);
+            glGetProgramResourceiv(programId, GL_SHADER_STORAGE_BLOCK, i, 1, &prop, 1, NULL, &blockSize);
+            string blockName = string(buf);
+            ptr<StorageBlock> b = new StorageBlock(this, blockName, i, GLuint(blockSize));
+            storageBlocks.insert(make_pair(blockName, b));
+            blocks.push_back(b.get());
+        }
+
+        GLint nVariables;
+        glGetProgramInterfaceiv(programId, GL_BUFFER_VARIABLE, GL_ACTIVE_RESOURCES, &nVariables);
+        for (GLuint i = 0; i < (GLuint) nVariables; ++i) {
+            const GLenum props[9] = {
+                GL_BLOCK_INDEX, GL_TYPE, GL_ARRAY_SIZE, GL_OFFSET, GL_ARRAY_STRIDE,
+                GL_MATRIX_STRIDE, GL_IS_ROW_MAJOR, GL_TOP_LEVEL_ARRAY_SIZE, GL_TOP_LEVEL_ARRAY_STRIDE
+            };
+            GLint values[9];
+            GLsizei length;
+            glGetProgramResourceName(programId, GL_BUFFER_VARIABLE, i, GLsizei(maxNameLength), &length, buf);
+            glGetProgramResourceiv(programId, GL_BUFFER_VARIABLE, i, 9, props, 9, NULL, values);
+            StorageBlock *block = blocks[values[0]];
+            GLint size = values[2];
+            GLint topLevelSize = values[7];
+
+            // only the first element of an array of structures is reported,
+            // and only the first element of an array of basic types is
+            // reported if this array is the last member of a structure
+            string name = string(buf);
+            if (size != 1 && name.size() > 3 && name.substr(name.size() - 3) == "[0]") {
+                name = name.substr(0, name.size() - 3);
+            }
+            string::size_type bracket = name.find('[');
+            bool structArray = bracket != string::npos && name.find('.', bracket) != string::npos;
+
+            for (GLint k = 0; k < (structArray ? max(topLevelSize, 1) : 1); ++k) {
+                string kname = name;
+                if (structArray) {
+                    ostringstream oss;
+                    oss << name.substr(0, bracket) << '[' << k << ']' << name.substr(name.find(']', bracket) + 1);
+                    kname = oss.str();
+                }
+                for (GLint j = 0; j < max(size, 1); ++j) {
+                    string uname = kname;
+                    if (size != 1) {
+                        ostringstream oss;
+                        oss << kname << '[' << j << ']';
+                        uname = oss.str();
+                    }
+                    GLuint uoffset = GLuint(values[3] + k * values[8] + j * values[4]);
+                    if (topLevelSize == 0) {
+                        // a variable of the first element of the unsized
+                        // array of the block (see StorageBlock#getUniform)
+                        StorageBlock::ArrayVariable v;
+                        v.type = GLenum(values[1]);
+                        v.offset = uoffset;
+                        v.matrixStride = GLuint(values[5]);
+                        v.isRowMajor = int(values[6]);
+                        block->arrayVariables[uname] = v;
+                        block->arrayOffset = min(block->arrayOffset, uoffset);
+                        block->arrayStride = GLuint(values[8]);
+                    } else {
+                        ptr<Uniform> u = newUniform(block, GLenum(values[1]), uname, uoffset, GLuint(values[5]), int(values[6]));
+                        uniforms.insert(make_pair(uname, u));
+                        block->uniforms.insert(make_pair(uname, u));
+                    }
+                }
+            }
+        }
+    }
+
     uniformSubroutines = NULL;
     dirtyStages = 0;
 
     if (FrameBuffer::getMajorVersion() >= 4) {
-        for (Stage s = VERTEX; s <= FRAGMENT; s = Stage(s + 1)) {
+        for (Stage s = VERTEX; s <= COMPUTE; s = Stage(s + 1)) {
+            if (!hasStage(s)) {
+                continue;
+            }
             GLint n;
             glGetProgramStageiv(programId, getStage(s), GL_ACTIVE_SUBROUTINE_UNIFORMS, &n);
             for (GLint i = 0; i < n; ++i) {
@@ -593,14 +731,17 @@ void Program::initUniforms()
                     case FRAGMENT:
                         uniforms.insert(make_pair("FRAGMENT " + sruName, u));
                         break;
+                    case COMPUTE:
+                        uniforms.insert(make_pair("COMPUTE " + sruName, u));
+                        break;
                     }
                 }
             }
             glGetProgramStageiv(programId, getStage(s), GL_ACTIVE_SUBROUTINE_UNIFORM_LOCATIONS, &n);
             if (n > 0) {
                 if (uniformSubroutines == NULL) {
-                    uniformSubroutines = new GLuint*[FRAGMENT - VERTEX + 1];
-                    for (Stage t = VERTEX; t <= FRAGMENT; t = Stage(t + 1)) {
+                    uniformSubroutines = new GLuint*[COMPUTE - VERTEX + 1];
+                    for (Stage t = VERTEX; t <= COMPUTE; t = Stage(t + 1)) {
                         uniformSubroutines[t] = NULL;
                     }
                 }
@@ -616,7 +757,18 @@ void Program::initUniforms()
     for (map<string, ptr<UniformBlock> >::iterator it = uniformBlocks.begin(); it != uniformBlocks.end(); ++it) {
         ptr<UniformBlock> u = it->second;
         ostringstream oss;
-        oss << u->getName() << "-" << u->size << "-" << u->uniforms.size(); //example : deformation-8-32
+        oss << "uniform-" << u->getName() << "-" << u->size << "-" << u->uniforms.size(); //example : uniform-deformation-8-32
+        ptr<GPUBuffer> buffer = UniformBlock::buffers->get(oss.str());
+        if (buffer->getSize() == 0) {
+            buffer->setData(u->size, NULL, DYNAMIC_DRAW);
+            newBlocks.insert(u->getName());
+        }
+        u->setBuffer(buffer);
+    }
+    for (map<string, ptr<StorageBlock> >::iterator it = storageBlocks.begin(); it != storageBlocks.end(); ++it) {
+        ptr<StorageBlock> u = it->second;
+        ostringstream oss;
+        oss << "storage-" << u->getName() << "-" << u->size << "-" << u->uniforms.size();
         ptr<GPUBuffer> buffer = UniformBlock::buffers->get(oss.str());
         if (buffer->getSize() == 0) {
             buffer->setData(u->size, NULL, DYNAMIC_DRAW);
@@ -676,7 +828,7 @@ Program::~Program()
     }
 
     if (uniformSubroutines != NULL) {
-        for (Stage s = VERTEX; s <= FRAGMENT; s = Stage(s + 1)) {
+        for (Stage s = VERTEX; s <= COMPUTE; s = Stage(s + 1)) {
             if (uniformSubroutines[s] != NULL) {
                 delete[] uniformSubroutines[s];
             }
@@ -692,6 +844,42 @@ Program::~Program()
     }
 }
 
+bool Program::hasStage(Stage s) const
+{
+    if (modules.empty()) {
+        // programs created from a binary or from other programs: the stages
+        // are unknown
+        return true;
+    }
+    for (vector< ptr<Module> >::const_iterator i = modules.begin(); i != modules.end(); ++i) {
+        int shaderId;
+        switch (s) {
+        case VERTEX:
+            shaderId = (*i)->vertexShaderId;
+            break;
+        case TESSELATION_CONTROL:
+            shaderId = (*i)->tessControlShaderId;
+            break;
+        case TESSELATION_EVALUATION:
+            shaderId = (*i)->tessEvalShaderId;
+            break;
+        case GEOMETRY:
+            shaderId = (*i)->geometryShaderId;
+            break;
+        case COMPUTE:
+            shaderId = (*i)->computeShaderId;
+            break;
+        default:
+            shaderId = (*i)->fragmentShaderId;
+            break;
+        }
+        if (shaderId != -1) {
+            return true;
+        }
+    }
+    return false;
+}
+
 int Program::getId() const
 {
     return programId > 0 ? programId : pipelineId;
@@ -707,6 +895,11 @@ ptr<Module> Program::getModule(int index) const
     return modules[index];
 }
 
+unsigned int Program::getVersion() const
+{
+    return version;
+}
+
 vector< ptr<Uniform> > Program::getUniforms() const
 {
     vector< ptr<Uniform> > result;
@@ -737,6 +930,15 @@ ptr<UniformBlock> Program::getUniformBlock(const string &name)
     return i->second;
 }
 
+ptr<StorageBlock> Program::getStorageBlock(const string &name)
+{
+    map<string, ptr<StorageBlock> >::iterator i = storageBlocks.find(name);
+    if (i == storageBlocks.end()) {
+        return NULL;
+    }
+    return i->second;
+}
+
 unsigned char *Program::getBinary(GLsizei &length, GLenum &format)
 {
     if (programId == 0) {
@@ -770,7 +972,10 @@ void Program::swap(ptr<Program> p)
     std::swap(pipelineStages, p->pipelineStages);
     std::swap(uniforms, p->uniforms);
     std::swap(uniformBlocks, p->uniformBlocks);
+    std::swap(storageBlocks, p->storageBlocks);
     std::swap(uniformSubroutines, p->uniformSubroutines);
+    ++version;
+    ++p->version;
 
     map<string, ptr<Uniform> >::iterator i = p->uniforms.begin();
     while (i != p->uniforms.end()) {
@@ -833,8 +1038,18 @@ void Program::swap(ptr<Program> p)
         ++k;
     }
 
+    map<string, ptr<StorageBlock> >::iterator l = storageBlocks.begin();
+    while (l != storageBlocks.end()) {
+        ptr<StorageBlock> b = l->second;
+        map<string, ptr<StorageBlock> >::iterator i = p->storageBlocks.find(b->getName());
+        if (i != p->storageBlocks.end()) {
+            std::swap(l->second, i->second);
+        }
+        ++l;
+    }
+
     if (uniformSubroutines != NULL && p->uniformSubroutines != NULL) {
-        for (Stage s = VERTEX; s <= FRAGMENT; s = Stage(s + 1)) {
+        for (Stage s = VERTEX; s <= COMPUTE; s = Stage(s + 1)) {
             if (uniformSubroutines[s] != NULL && p->uniformSubroutines[s] != NULL) {
                 if (uniformSubroutines[s][0] == p->uniformSubroutines[s][0]) {
                     std::swap(uniformSubroutines[s], p->uniformSubroutines[s]);
@@ -848,7 +1063,7 @@ void Program::swap(ptr<Program> p)
 
     dirtyStages = 0;
     p->dirtyStages = 0;
-    for (Stage s = VERTEX; s <= FRAGMENT; s = Stage(s + 1)) {
+    for (Stage s = VERTEX; s <= COMPUTE; s = Stage(s + 1)) {
         if (uniformSubroutines != NULL && uniformSubroutines[s] != NULL) {
             dirtyStages |= 1 << s;
         }
@@ -890,9 +1105,7 @@ void Program::set()
             glBindProgramPipeline(pipelineId);
             glUseProgram(0);
         }
-		if (Logger::DEBUG_LOGGER != NULL) {
-			Logger::DEBUG_LOGGER->log("RENDER", "Set Program");
-		}
+        ORK_DEBUG(RENDER, "Set Program");
 
         if (pipelineId == 0) {
             bindTexturesAndUniformBlocks();
@@ -927,6 +1140,15 @@ void Program::bindTexturesAndUniformBlocks()
         j++;
     }
 
+    map<string, ptr<StorageBlock> >::iterator k = storageBlocks.begin();
+    while (k != storageBlocks.end()) {
+        ptr<StorageBlock> s = k->second;
+        GLint unit = s->buffer->bindToStorageBufferUnit(Program::CURRENT->programIds);
+        assert(unit >= 0);
+        glShaderStorageBlockBinding(programId, s->index, GLuint(unit));
+        k++;
+    }
+
     assert(FrameBuffer::getError() == 0);
 }
 
@@ -941,6 +1163,15 @@ void Program::updateDirtyUniforms(int stages)
         j++;
     }
 
+    map<string, ptr<StorageBlock> >::iterator k = storageBlocks.begin();
+    while (k != storageBlocks.end()) {
+        ptr<StorageBlock> s = k->second;
+        if (s->isMapped()) {
+            s->unmapBuffer();
+        }
+        k++;
+    }
+
 #ifdef ORK_NO_GLPROGRAMUNIFORM
     map<string, ptr<Uniform> >::iterator i = uniforms.begin();
     while (i != uniforms.end()) {
@@ -957,7 +1188,7 @@ void Program::updateDirtyUniforms(int stages)
 #endif
 
     if ((dirtyStages & stages) != 0) {
-        for (Stage s = VERTEX; s <= FRAGMENT; s = Stage(s + 1)) {
+        for (Stage s = VERTEX; s <= COMPUTE; s = Stage(s + 1)) {
             if (((dirtyStages & stages) & (1 << s)) != 0) {
                 glUniformSubroutinesuiv(getStage(s), uniformSubroutines[s][0], uniformSubroutines[s] + 1);
             }
@@ -966,6 +1197,24 @@ void Program::updateDirtyUniforms(int stages)
     }
 }
 
+void Program::dirtyStorageBlocks()
+{
+    if (pipelineId != 0) {
+        for (unsigned int i = 0; i < pipelinePrograms.size(); ++i) {
+            pipelinePrograms[i]->dirtyStorageBlocks();
+        }
+        return;
+    }
+    map<string, ptr<StorageBlock> >::iterator k = storageBlocks.begin();
+    while (k != storageBlocks.end()) {
+        ptr<StorageBlock> s = k->second;
+        if (s->buffer != NULL) {
+            s->buffer->dirty();
+        }
+        k++;
+    }
+}
+
 void Program::updateTextureUsers(bool add)
 {
     for (unsigned int i = 0; i < uniformSamplers.size(); ++i) {
@@ -995,6 +1244,16 @@ void Program::updateUniformBlocks(bool add)
             }
             ++j;
         }
+        map<string, ptr<StorageBlock> >::iterator k = storageBlocks.begin();
+        while (k != storageBlocks.end()) {
+            ptr<StorageBlock> b = k->second;
+            map<string, ptr<Uniform> >::iterator i = b->uniforms.begin();
+            while (i != b->uniforms.end()) {
+                uniforms.insert(make_pair(i->second->getName(), i->second));
+                ++i;
+            }
+            ++k;
+        }
     } else {
         map<string, ptr<Uniform> >::iterator i = uniforms.begin();
         while (i != uniforms.end()) {
@@ -1041,6 +1300,27 @@ void Program::updateUniforms(Program *owner)
         ++k;
     }
 
+    map<string, ptr<StorageBlock> >::iterator l = storageBlocks.begin();
+    while (l != storageBlocks.end()) {
+        ptr<StorageBlock> b = l->second;
+        if (b->buffer != NULL && b->isMapped()) {
+            b->unmapBuffer();
+        }
+        if (owner == NULL) {
+            b->setBuffer(NULL);
+        }
+        b->program = owner;
+        map<string, ptr<Uniform> >::iterator i = b->uniforms.begin();
+        while (i != b->uniforms.end()) {
+            i->second->program = owner;
+            i->second->block = b.get();
+            ++i;
+        }
+        // the layout of the unsized array may have changed
+        b->elements.clear();
+        ++l;
+    }
+
     if (owner != NULL) {
         updateUniformBlocks(true);
     }
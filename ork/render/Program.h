@@ -52,8 +52,8 @@ class FrameBuffer;
 
 /**
  * A GPU program. A GPU program can define vertex, tessellation, geometry and
- * fragment programs. It is made of one or more Module, themselves made of one
- * or more GLSL shaders.
+ * fragment programs, or a compute program (see FrameBuffer#dispatch). It is
+ * made of one or more Module, themselves made of one or more GLSL shaders.
  *
  * @ingroup render
  */
@@ -120,6 +120,13 @@ public:
      */
     ptr<Module> getModule(int index) const;
 
+    /**
+     * Returns the version of this program. This number is incremented each
+     * time this program is swapped with a new version (see #swap). It can be
+     * used to invalidate uniforms cached by users of this program.
+     */
+    unsigned int getVersion() const;
+
     /**
      * Returns the uniforms of this program.
      */
@@ -504,6 +511,16 @@ public:
      */
     ptr<UniformBlock> getUniformBlock(const std::string &name);
 
+    /**
+     * Returns the shader storage block of this program whose name is given.
+     * Only available with OpenGL 4.3 or more.
+     *
+     * @param name a GLSL shader storage block name.
+     * @return the storage block of this program whose name is given,
+     *       or NULL if there is no such block.
+     */
+    ptr<StorageBlock> getStorageBlock(const std::string &name);
+
     /**
      * Returns a compiled version of this program.
      *
@@ -557,6 +574,15 @@ protected:
      */
     void initUniforms();
 
+    /**
+     * Returns true if this program may have a shader for the given stage.
+     * Querying the subroutines of a missing stage is an error with some
+     * drivers (e.g. Mesa).
+     *
+     * @param s a shader type (vertex, fragment, etc).
+     */
+    bool hasStage(Stage s) const;
+
     /**
      * Swaps this program with the given one.
      */
@@ -568,6 +594,11 @@ private:
      */
     GLuint programId;
 
+    /**
+     * The version of this program.
+     */
+    unsigned int version;
+
     /**
      * The pipeline object id of this program, if applicable.
      */
@@ -622,6 +653,11 @@ private:
      */
     std::map<std::string, ptr<UniformBlock> > uniformBlocks;
 
+    /**
+     * The shader storage blocks of this program.
+     */
+    std::map<std::string, ptr<StorageBlock> > storageBlocks;
+
     /**
      * The program currently in use.
      */
@@ -634,19 +670,35 @@ private:
      */
     bool checkSamplers();
 
+    /**
+     * Creates a new uniform of this program.
+     *
+     * @param block the uniform or storage block containing the uniform, or
+     *      NULL if it is outside any block.
+     * @param type the OpenGL type of the uniform.
+     * @param name the name of the uniform.
+     * @param offset the location of the uniform, or its offset in its block.
+     * @param matrixStride the stride between columns or rows of a matrix
+     *      uniform in its block.
+     * @param isRowMajor 1 if a matrix uniform is stored in row major order
+     *      in its block.
+     */
+    ptr<Uniform> newUniform(UniformBlock *block, GLenum type, const std::string &name, GLuint offset, GLuint matrixStride, int isRowMajor);
+
     /**
      * Sets this program as the current program.
      */
     void set();
 
     /**
-     * Binds the textures and uniform blocks of this program to available units.
+     * Binds the textures, uniform blocks and storage blocks of this program
+     * to available units.
      */
     void bindTexturesAndUniformBlocks();
 
     /**
      * Updates the value of the uniforms of this program. This method unmaps the
-     * buffers of the uniform blocks, updates the uniform subroutines, and
+     * buffers of the uniform and storage blocks, updates the uniform subroutines, and
      * optionally updates the value of the "regular" uniforms whose value has
      * changed since the last time this program was used (this only happens with
      * the ORK_NO_GLPROGRAMUNIFORM preprocessor option).
@@ -656,6 +708,13 @@ private:
      */
     void updateDirtyUniforms(int stages);
 
+    /**
+     * Marks the buffers of the storage blocks of this program as dirty. This
+     * method must be called after each draw or dispatch call with this
+     * program, since the shaders may have written to these buffers.
+     */
+    void dirtyStorageBlocks();
+
     /**
      * Adds or removes this program as a user of the textures bound to
      * the uniform samplers of this program.
@@ -664,7 +723,7 @@ private:
 
     /**
      * Adds to or removes from #uniforms the uniforms that are inside
-     * unifom blocks.
+     * unifom blocks or storage blocks.
      */
     void updateUniformBlocks(bool add);
 
@@ -688,6 +747,8 @@ private:
 
     friend class UniformSubroutine;
 
+    friend class StorageBlock;
+
     friend class Texture;
 
     friend class MeshBuffers;
@@ -905,6 +966,8 @@ inline ptr<UniformSubroutine> Program::getUniformSubroutine(Stage stage, const s
         return getUniform("GEOMETRY " + name).cast<UniformSubroutine>();
     case FRAGMENT:
         return getUniform("FRAGMENT " + name).cast<UniformSubroutine>();
+    case COMPUTE:
+        return getUniform("COMPUTE " + name).cast<UniformSubroutine>();
     }
     throw std::exception();
 }
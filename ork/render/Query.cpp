@@ -85,11 +85,9 @@ GLuint Query::getId()
 
 void Query::begin()
 {
+    resultAvailable = false;
     resultRead = false;
     glBeginQuery(target, id);
-    if (target == GL_TIME_ELAPSED) {
-        glQueryCounter(id, GL_TIMESTAMP);
-    }
 }
 
 void Query::end()
@@ -97,6 +95,14 @@ void Query::end()
     glEndQuery(target);
 }
 
+void Query::timestamp()
+{
+    assert(type == TIME_STAMP);
+    resultAvailable = false;
+    resultRead = false;
+    glQueryCounter(id, GL_TIMESTAMP);
+}
+
 bool Query::available()
 {
     if (!resultAvailable) {
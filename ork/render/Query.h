@@ -52,7 +52,10 @@ namespace ork
  * An asynchronous GPU query. A query measures some value, depending on its type,
  * between the calls to #begin() and #end(). After #end() has been called, the
  * result is available asynchronously. Its availability can be tested with
- * #available(), and its value with #getResult().
+ * #available(), and its value with #getResult(). A TIME_STAMP query can also
+ * be used to record the GPU time at which all previous commands have been
+ * completed, with #timestamp(). A query can be reused once its result has
+ * been read.
  *
  * @ingroup render
  */
@@ -92,7 +95,15 @@ public:
     void end();
 
     /**
-     * Returns true if the result of this query is available.
+     * Records the GPU time, in nano seconds, at which all the previously
+     * issued commands will be completed. This query must be of TIME_STAMP
+     * type, and must not be used with #begin() and #end() at the same time.
+     */
+    void timestamp();
+
+    /**
+     * Returns true if the result of this query is available. This method
+     * never blocks the caller.
      */
     bool available();
 
@@ -0,0 +1,192 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+
+#include "ork/render/ReadbackManager.h"
+
+#include <cassert>
+
+#include "ork/core/Logger.h"
+
+using namespace std;
+
+namespace ork
+{
+
+unsigned int getFormatSize(TextureFormat f, PixelType t);
+
+ReadbackManager::Callback::Callback() : Object("ReadbackManager::Callback")
+{
+}
+
+ReadbackManager::Callback::~Callback()
+{
+}
+
+static_ptr<ReadbackManager> ReadbackManager::INSTANCE(NULL);
+
+ReadbackManager::ReadbackManager(int maxReadbacks, int bufferSize) :
+    Object("ReadbackManager"), bufferSize(bufferSize)
+{
+    assert(maxReadbacks > 0);
+    for (int i = 0; i < maxReadbacks; ++i) {
+        ptr<GPUBuffer> b = new GPUBuffer();
+        b->setData(bufferSize, NULL, STREAM_READ);
+        freeBuffers.push_back(b);
+    }
+    assert(FrameBuffer::getError() == GL_NO_ERROR);
+}
+
+ReadbackManager::~ReadbackManager()
+{
+    list<Readback>::iterator i = pending.begin();
+    while (i != pending.end()) {
+        glDeleteSync(i->fence);
+        ++i;
+    }
+}
+
+bool ReadbackManager::canReadback() const
+{
+    return !freeBuffers.empty();
+}
+
+int ReadbackManager::getPendingCount() const
+{
+    return int(pending.size());
+}
+
+bool ReadbackManager::readPixels(ptr<FrameBuffer> fb, int x, int y, int w, int h, TextureFormat f, PixelType t, ptr<Callback> cb)
+{
+    // rows are aligned on 4 bytes, except the last one
+    int rowSize = w * int(getFormatSize(f, t));
+    int alignedRowSize = (rowSize + 3) & ~3;
+    if (h > 0 && (h - 1) * alignedRowSize + rowSize > bufferSize) {
+        if (Logger::WARNING_LOGGER != NULL) {
+            Logger::WARNING_LOGGER->log("RENDER", "Readback larger than the readback buffers");
+        }
+        return false;
+    }
+    ptr<GPUBuffer> b = getFreeBuffer();
+    if (b == NULL) {
+        return false;
+    }
+    fb->readPixels(x, y, w, h, f, t, Buffer::Parameters(), *b);
+    addReadback(b, cb);
+    return true;
+}
+
+bool ReadbackManager::getImage(ptr<Texture> tex, int level, TextureFormat f, PixelType t, ptr<Callback> cb)
+{
+    if (tex->getImageSize(level, f, t) > bufferSize) {
+        if (Logger::WARNING_LOGGER != NULL) {
+            Logger::WARNING_LOGGER->log("RENDER", "Readback larger than the readback buffers");
+        }
+        return false;
+    }
+    ptr<GPUBuffer> b = getFreeBuffer();
+    if (b == NULL) {
+        return false;
+    }
+    tex->getImage(level, f, t, *b);
+    addReadback(b, cb);
+    return true;
+}
+
+void ReadbackManager::newFrame()
+{
+    while (!pending.empty()) {
+        // fences are passed in the order in which they were inserted
+        GLenum status = glClientWaitSync(pending.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        readDone();
+    }
+}
+
+void ReadbackManager::flush()
+{
+    while (!pending.empty()) {
+        GLenum status;
+        do {
+            status = glClientWaitSync(pending.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        } while (status == GL_TIMEOUT_EXPIRED);
+        readDone();
+    }
+}
+
+ptr<GPUBuffer> ReadbackManager::getFreeBuffer()
+{
+    if (freeBuffers.empty()) {
+        if (Logger::WARNING_LOGGER != NULL) {
+            Logger::WARNING_LOGGER->log("RENDER", "Too many pending readbacks");
+        }
+        return NULL;
+    }
+    ptr<GPUBuffer> b = freeBuffers.back();
+    freeBuffers.pop_back();
+    return b;
+}
+
+void ReadbackManager::addReadback(ptr<GPUBuffer> buffer, ptr<Callback> cb)
+{
+    Readback r;
+    r.buffer = buffer;
+    r.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    r.callback = cb;
+    pending.push_back(r);
+    assert(FrameBuffer::getError() == GL_NO_ERROR);
+}
+
+void ReadbackManager::readDone()
+{
+    Readback r = pending.front();
+    pending.pop_front();
+    glDeleteSync(r.fence);
+    volatile void *data = r.buffer->map(READ_ONLY);
+    r.callback->dataRead(data);
+    r.buffer->unmap();
+    freeBuffers.push_back(r.buffer);
+    assert(FrameBuffer::getError() == GL_NO_ERROR);
+}
+
+}
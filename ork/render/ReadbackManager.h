@@ -0,0 +1,217 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+
+#ifndef _ORK_READBACK_MANAGER_H_
+#define _ORK_READBACK_MANAGER_H_
+
+#include <list>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "ork/render/FrameBuffer.h"
+
+namespace ork
+{
+
+/**
+ * An asynchronous readback of pixels from framebuffers or textures to client
+ * memory. Each readback copies the pixels in a pixel pack GPUBuffer, taken
+ * from a pool of buffers, and inserts a fence after this copy. The copy is
+ * executed by the GPU without blocking the CPU, and #newFrame delivers the
+ * pixels to a Callback once the fence has been passed, usually a few frames
+ * later. This avoids the pipeline stall caused by FrameBuffer#readPixels or
+ * Texture#getImage with client memory destinations.
+ *
+ * The #newFrame method of the static #INSTANCE manager is called by
+ * SceneManager#draw.
+ * @ingroup render
+ */
+class ORK_API ReadbackManager : public Object
+{
+public:
+    /**
+     * A callback called when the data of a readback is available.
+     */
+    class ORK_API Callback : public Object
+    {
+    public:
+        /**
+         * Creates a new callback.
+         */
+        Callback();
+
+        /**
+         * Deletes this callback.
+         */
+        virtual ~Callback();
+
+        /**
+         * Called when the data of a readback is available.
+         *
+         * @param data the pixels read back. Only valid during this call.
+         */
+        virtual void dataRead(volatile void *data) = 0;
+    };
+
+    /**
+     * The manager whose #newFrame method is called by SceneManager#draw.
+     * NULL by default.
+     */
+    static static_ptr<ReadbackManager> INSTANCE;
+
+    /**
+     * Creates a new ReadbackManager.
+     *
+     * @param maxReadbacks the maximum number of pending readbacks, i.e. the
+     *      number of pixel pack buffers in the pool.
+     * @param bufferSize the size in bytes of each pixel pack buffer, i.e.
+     *      the maximum size of the data of a readback.
+     */
+    ReadbackManager(int maxReadbacks = 8, int bufferSize = 1024 * 1024);
+
+    /**
+     * Deletes this ReadbackManager. The pending readbacks are cancelled.
+     */
+    virtual ~ReadbackManager();
+
+    /**
+     * Returns true if a new readback can be started, i.e. if there is a free
+     * pixel pack buffer in the pool.
+     */
+    bool canReadback() const;
+
+    /**
+     * Returns the number of pending readbacks.
+     */
+    int getPendingCount() const;
+
+    /**
+     * Starts an asynchronous readback of pixels from a framebuffer. See
+     * FrameBuffer#readPixels.
+     *
+     * @param fb the framebuffer to read from.
+     * @param x lower left corner of the area where the pixels must be read.
+     * @param y lower left corner of the area where the pixels must be read.
+     * @param w width of the area where the pixels must be read.
+     * @param h height of the area where the pixels must be read.
+     * @param f the components to be read.
+     * @param t the type to be used to store the read components.
+     * @param cb the callback to call when the pixels are available.
+     * @return false if the readback cannot be started (see #canReadback), or
+     *      if the pixels do not fit in a pixel pack buffer.
+     */
+    bool readPixels(ptr<FrameBuffer> fb, int x, int y, int w, int h, TextureFormat f, PixelType t, ptr<Callback> cb);
+
+    /**
+     * Starts an asynchronous readback of the pixels of a texture. See
+     * Texture#getImage.
+     *
+     * @param tex the texture to read from.
+     * @param level the texture LOD level to be read.
+     * @param f the format in which data must be returned.
+     * @param t the type in which pixel components must be returned.
+     * @param cb the callback to call when the pixels are available.
+     * @return false if the readback cannot be started (see #canReadback), or
+     *      if the pixels do not fit in a pixel pack buffer.
+     */
+    bool getImage(ptr<Texture> tex, int level, TextureFormat f, PixelType t, ptr<Callback> cb);
+
+    /**
+     * Calls the callbacks of the pending readbacks that are done, without
+     * waiting for the others. Should be called once per frame.
+     */
+    void newFrame();
+
+    /**
+     * Waits for all the pending readbacks, and calls their callbacks.
+     */
+    void flush();
+
+private:
+    /**
+     * A pending readback.
+     */
+    struct Readback
+    {
+        ptr<GPUBuffer> buffer; ///< the buffer containing the read pixels
+
+        GLsync fence; ///< the fence following the copy in #buffer
+
+        ptr<Callback> callback; ///< the callback to call with the read pixels
+    };
+
+    /**
+     * The size in bytes of each pixel pack buffer.
+     */
+    int bufferSize;
+
+    /**
+     * The free pixel pack buffers.
+     */
+    std::vector< ptr<GPUBuffer> > freeBuffers;
+
+    /**
+     * The pending readbacks, in the order in which they were started.
+     */
+    std::list<Readback> pending;
+
+    /**
+     * Returns a free pixel pack buffer, or NULL if there is none.
+     */
+    ptr<GPUBuffer> getFreeBuffer();
+
+    /**
+     * Adds a pending readback using the given buffer, after the last
+     * OpenGL command.
+     */
+    void addReadback(ptr<GPUBuffer> buffer, ptr<Callback> cb);
+
+    /**
+     * Calls the callback of the first pending readback and removes it.
+     */
+    void readDone();
+};
+
+}
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+
+#include "ork/render/RenderTargetPool.h"
+
+#include <cstring>
+
+#include "ork/render/CPUBuffer.h"
+
+using namespace std;
+
+namespace ork
+{
+
+static_ptr<RenderTargetPool> RenderTargetPool::INSTANCE(NULL);
+
+bool RenderTargetPool::Key::operator<(const Key &k) const
+{
+    if (width != k.width) {
+        return width < k.width;
+    }
+    if (height != k.height) {
+        return height < k.height;
+    }
+    if (internalFormat != k.internalFormat) {
+        return internalFormat < k.internalFormat;
+    }
+    if (params.wrapS() != k.params.wrapS()) {
+        return params.wrapS() < k.params.wrapS();
+    }
+    if (params.wrapT() != k.params.wrapT()) {
+        return params.wrapT() < k.params.wrapT();
+    }
+    if (params.wrapR() != k.params.wrapR()) {
+        return params.wrapR() < k.params.wrapR();
+    }
+    if (params.min() != k.params.min()) {
+        return params.min() < k.params.min();
+    }
+    if (params.mag() != k.params.mag()) {
+        return params.mag() < k.params.mag();
+    }
+    if (params.borderType() != k.params.borderType()) {
+        return params.borderType() < k.params.borderType();
+    }
+    // the four border components, whatever their type
+    int border = memcmp(params.borderi(), k.params.borderi(), 4 * sizeof(GLint));
+    if (border != 0) {
+        return border < 0;
+    }
+    if (params.lodMin() != k.params.lodMin()) {
+        return params.lodMin() < k.params.lodMin();
+    }
+    if (params.lodMax() != k.params.lodMax()) {
+        return params.lodMax() < k.params.lodMax();
+    }
+    if (params.lodBias() != k.params.lodBias()) {
+        return params.lodBias() < k.params.lodBias();
+    }
+    if (params.compareFunc() != k.params.compareFunc()) {
+        return params.compareFunc() < k.params.compareFunc();
+    }
+    if (params.maxAnisotropyEXT() != k.params.maxAnisotropyEXT()) {
+        return params.maxAnisotropyEXT() < k.params.maxAnisotropyEXT();
+    }
+    int swizzle = memcmp(params.swizzle(), k.params.swizzle(), 4);
+    if (swizzle != 0) {
+        return swizzle < 0;
+    }
+    if (params.minLevel() != k.params.minLevel()) {
+        return params.minLevel() < k.params.minLevel();
+    }
+    return params.maxLevel() < k.params.maxLevel();
+}
+
+RenderTargetPool::RenderTargetPool(unsigned int maxUnusedFrames) :
+    Object("RenderTargetPool"), maxUnusedFrames(maxUnusedFrames), frame(0)
+{
+}
+
+RenderTargetPool::~RenderTargetPool()
+{
+}
+
+int RenderTargetPool::getTextureCount() const
+{
+    return int(freeTextures.size() + usedTextures.size());
+}
+
+int RenderTargetPool::getUsedCount() const
+{
+    return int(usedTextures.size());
+}
+
+ptr<Texture2D> RenderTargetPool::acquireTexture(int w, int h, TextureInternalFormat tf, TextureFormat f, PixelType t,
+    const Texture::Parameters &params)
+{
+    Key k;
+    k.width = w;
+    k.height = h;
+    k.internalFormat = tf;
+    k.params = params;
+
+    ptr<Texture2D> texture;
+    multimap<Key, FreeTexture>::iterator i = freeTextures.find(k);
+    if (i != freeTextures.end()) {
+        texture = i->second.texture;
+        freeTextures.erase(i);
+    } else {
+        texture = new Texture2D(w, h, tf, f, t, params, Buffer::Parameters(), CPUBuffer(NULL));
+    }
+    usedTextures.insert(make_pair(texture, k));
+    return texture;
+}
+
+void RenderTargetPool::releaseTexture(ptr<Texture2D> t)
+{
+    map<ptr<Texture2D>, Key>::iterator i = usedTextures.find(t);
+    if (i != usedTextures.end()) {
+        FreeTexture f;
+        f.texture = t;
+        f.lastUse = frame;
+        freeTextures.insert(make_pair(i->second, f));
+        usedTextures.erase(i);
+    }
+}
+
+void RenderTargetPool::endFrame()
+{
+    while (!usedTextures.empty()) {
+        releaseTexture(usedTextures.begin()->first);
+    }
+    multimap<Key, FreeTexture>::iterator i = freeTextures.begin();
+    while (i != freeTextures.end()) {
+        if (frame - i->second.lastUse >= maxUnusedFrames) {
+            freeTextures.erase(i++);
+        } else {
+            ++i;
+        }
+    }
+    ++frame;
+}
+
+}
@@ -0,0 +1,180 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+
+#ifndef _ORK_RENDER_TARGET_POOL_H_
+#define _ORK_RENDER_TARGET_POOL_H_
+
+#include <map>
+
+#include "ork/render/Texture2D.h"
+
+namespace ork
+{
+
+/**
+ * A pool of transient 2D render targets. A pass calls #acquireTexture to get
+ * a texture of a given internal format, size and sampling parameters when it
+ * starts writing to it, and #releaseTexture when no later pass reads it
+ * anymore. A released texture can then be returned by #acquireTexture to
+ * another pass of the same frame, so that targets whose lifetimes do not
+ * overlap share the same memory. Textures still acquired at the end of a
+ * frame are released by #endFrame, and free textures that have not been used
+ * for a few frames (e.g. after a viewport resize) are deleted.
+ *
+ * SetTargetTask uses the static #INSTANCE pool for its transient targets.
+ * @ingroup render
+ */
+class ORK_API RenderTargetPool : public Object
+{
+public:
+    /**
+     * The pool used by SetTargetTask for transient targets. Created by
+     * SetTargetTask when needed. Its #endFrame method is called by
+     * SceneManager#draw.
+     */
+    static static_ptr<RenderTargetPool> INSTANCE;
+
+    /**
+     * Creates a new RenderTargetPool.
+     *
+     * @param maxUnusedFrames the number of frames without use after which a
+     *      texture is deleted.
+     */
+    RenderTargetPool(unsigned int maxUnusedFrames = 2);
+
+    /**
+     * Deletes this RenderTargetPool.
+     */
+    virtual ~RenderTargetPool();
+
+    /**
+     * Returns the number of textures allocated by this pool.
+     */
+    int getTextureCount() const;
+
+    /**
+     * Returns the number of textures currently acquired.
+     */
+    int getUsedCount() const;
+
+    /**
+     * Returns a texture that is not currently acquired, creating it if
+     * necessary. A free texture is returned only if its internal format,
+     * size and texture parameters are equal to the requested ones. Its
+     * content is undefined.
+     *
+     * @param w the texture width.
+     * @param h the texture height.
+     * @param tf the texture internal format.
+     * @param f the format of the (undefined) initial pixels.
+     * @param t the type of the (undefined) initial pixels.
+     * @param params the texture parameters.
+     */
+    ptr<Texture2D> acquireTexture(int w, int h, TextureInternalFormat tf, TextureFormat f, PixelType t,
+        const Texture::Parameters &params);
+
+    /**
+     * Gives back a texture returned by #acquireTexture, so that it can be
+     * reused by later passes. Does nothing if the texture is not currently
+     * acquired.
+     *
+     * @param t a texture returned by #acquireTexture.
+     */
+    void releaseTexture(ptr<Texture2D> t);
+
+    /**
+     * Releases all the acquired textures and deletes the textures that have
+     * not been used during the last maxUnusedFrames frames.
+     */
+    void endFrame();
+
+private:
+    /**
+     * The properties used to find a matching free texture.
+     */
+    struct Key
+    {
+        int width; ///< the texture width
+
+        int height; ///< the texture height
+
+        TextureInternalFormat internalFormat; ///< the texture internal format
+
+        Texture::Parameters params; ///< the texture parameters
+
+        bool operator<(const Key &k) const;
+    };
+
+    /**
+     * A free texture.
+     */
+    struct FreeTexture
+    {
+        ptr<Texture2D> texture; ///< the texture
+
+        unsigned int lastUse; ///< the frame where this texture was released
+    };
+
+    /**
+     * The number of frames after which an unused texture is deleted.
+     */
+    unsigned int maxUnusedFrames;
+
+    /**
+     * The current frame number.
+     */
+    unsigned int frame;
+
+    /**
+     * The textures that are not currently acquired.
+     */
+    std::multimap<Key, FreeTexture> freeTextures;
+
+    /**
+     * The textures that are currently acquired.
+     */
+    std::map<ptr<Texture2D>, Key> usedTextures;
+};
+
+}
+
+#endif
@@ -46,6 +46,7 @@
 
 #include <GL/glew.h>
 
+#include "ork/core/SharedContext.h"
 #include "ork/resource/ResourceManager.h"
 #include "ork/render/FrameBuffer.h"
 
@@ -535,8 +536,14 @@ GLenum getTextureSwizzle(char c);
 
 unsigned int getTextureComponents(TextureFormat f);
 
+unsigned int getFormatSize(TextureFormat f, PixelType t);
+
 const char *getTextureInternalFormatName(TextureInternalFormat f);
 
+GLenum getTextureInternalFormat(TextureInternalFormat f);
+
+GLenum getBufferAccess(BufferAccess a);
+
 /**
  * A texture unit.
  */
@@ -781,6 +788,18 @@ GLuint TextureUnitManager::maxUnits = 0;
 
 static TextureUnitManager *TEXTURE_UNIT_MANAGER = NULL;
 
+/**
+ * Returns the texture unit manager of the main context. Shared contexts do
+ * not use it (see SharedContext).
+ */
+static TextureUnitManager *getTextureUnitManager()
+{
+    if (TEXTURE_UNIT_MANAGER == NULL) {
+        TEXTURE_UNIT_MANAGER = new TextureUnitManager();
+    }
+    return TEXTURE_UNIT_MANAGER;
+}
+
 Texture::Parameters::Parameters() : Sampler::Parameters(),
         _minLevel(0), _maxLevel(1000)
 {
@@ -991,9 +1010,6 @@ Texture::Parameters& Texture::Parameters::maxLevel(GLint maxLevel)
 
 Texture::Texture(const char *type, int t) : Object(type), textureTarget(t)
 {
-    if (TEXTURE_UNIT_MANAGER == NULL) {
-        TEXTURE_UNIT_MANAGER = new TextureUnitManager();
-    }
 }
 
 void Texture::init(TextureInternalFormat tf, const Texture::Parameters &params)
@@ -1057,7 +1073,7 @@ void Texture::init(TextureInternalFormat tf, const Texture::Parameters &params)
 
 Texture::~Texture()
 {
-    TEXTURE_UNIT_MANAGER->unbind(this);
+    getTextureUnitManager()->unbind(this);
 
     glDeleteTextures(1, &textureId);
     assert(FrameBuffer::getError() == 0);
@@ -1296,6 +1312,24 @@ GLsizei Texture::getCompressedSize(int level) const
     return GLsizei(size);
 }
 
+GLsizei Texture::getImageSize(int level, TextureFormat f, PixelType t) const
+{
+    GLenum target = textureTarget == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X : textureTarget;
+    GLint w, h, d;
+    bindToTextureUnit();
+    glGetTexLevelParameteriv(target, level, GL_TEXTURE_WIDTH, &w);
+    glGetTexLevelParameteriv(target, level, GL_TEXTURE_HEIGHT, &h);
+    glGetTexLevelParameteriv(target, level, GL_TEXTURE_DEPTH, &d);
+    assert(FrameBuffer::getError() == 0);
+    if (textureTarget == GL_TEXTURE_CUBE_MAP) {
+        d = 6;
+    }
+    // rows are aligned on 4 bytes, except the last one
+    GLsizei rowSize = GLsizei(w * getFormatSize(f, t));
+    GLsizei alignedRowSize = (rowSize + 3) & ~3;
+    return w == 0 ? 0 : (h * d - 1) * alignedRowSize + rowSize;
+}
+
 void Texture::getImage(int level, TextureFormat f, PixelType t, void *pixels)
 {
     bindToTextureUnit();
@@ -1303,6 +1337,16 @@ void Texture::getImage(int level, TextureFormat f, PixelType t, void *pixels)
     assert(FrameBuffer::getError() == 0);
 }
 
+void Texture::getImage(int level, TextureFormat f, PixelType t, const Buffer &pixels)
+{
+    bindToTextureUnit();
+    pixels.bind(GL_PIXEL_PACK_BUFFER);
+    glGetTexImage(textureTarget, level, getTextureFormat(f), getPixelType(t), pixels.data(0));
+    pixels.unbind(GL_PIXEL_PACK_BUFFER);
+    pixels.dirty();
+    assert(FrameBuffer::getError() == 0);
+}
+
 void Texture::getCompressedImage(int level, void *pixels) const
 {
     bindToTextureUnit();
@@ -1321,6 +1365,13 @@ void Texture::generateMipMap()
     }
 }
 
+void Texture::bindToImageUnit(GLuint unit, int level, BufferAccess access, int layer) const
+{
+    glBindImageTexture(unit, textureId, level, layer < 0 ? GL_TRUE : GL_FALSE, layer < 0 ? 0 : layer,
+        getBufferAccess(access), getTextureInternalFormat(internalFormat));
+    assert(FrameBuffer::getError() == 0);
+}
+
 GLint Texture::bindToTextureUnit(ptr<Sampler> sampler, const vector<GLuint> &programIds) const
 {
     GLuint samplerId = sampler == NULL ? 0 : sampler->getId();
@@ -1328,27 +1379,34 @@ GLint Texture::bindToTextureUnit(ptr<Sampler> sampler, const vector<GLuint> &pro
 
     GLint unit;
     if (i == currentTextureUnits.end()) {
-        unit = TEXTURE_UNIT_MANAGER->findFreeTextureUnit(programIds);
+        unit = getTextureUnitManager()->findFreeTextureUnit(programIds);
     } else {
         unit = i->second;
     }
 
-    TEXTURE_UNIT_MANAGER->bind(GLuint(unit), sampler.get(), this);
+    getTextureUnitManager()->bind(GLuint(unit), sampler.get(), this);
 
     return unit;
 }
 
 GLint Texture::bindToTextureUnit() const
 {
+    if (SharedContext::getCurrent() != NULL) {
+        // the texture unit bindings are those of the main context; a shared
+        // context always uses its first unit, without any caching
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(textureTarget, textureId);
+        return 0;
+    }
     if (currentTextureUnits.empty()) {
         GLint unit;
         if (Program::CURRENT == NULL) {
-            unit = TEXTURE_UNIT_MANAGER->findFreeTextureUnit(vector<GLuint>());
+            unit = getTextureUnitManager()->findFreeTextureUnit(vector<GLuint>());
         } else {
-            unit = TEXTURE_UNIT_MANAGER->findFreeTextureUnit(Program::CURRENT->programIds);
+            unit = getTextureUnitManager()->findFreeTextureUnit(Program::CURRENT->programIds);
         }
         assert(unit != -1);
-        TEXTURE_UNIT_MANAGER->bind(GLuint(unit), NULL, this);
+        getTextureUnitManager()->bind(GLuint(unit), NULL, this);
         return unit;
     } else {
         GLuint unit = currentTextureUnits.begin()->second;
@@ -1359,8 +1417,8 @@ GLint Texture::bindToTextureUnit() const
 
 void Texture::swap(ptr<Texture> t)
 {
-    TEXTURE_UNIT_MANAGER->unbind(this);
-    TEXTURE_UNIT_MANAGER->unbind(t.get());
+    getTextureUnitManager()->unbind(this);
+    getTextureUnitManager()->unbind(t.get());
     if (Program::CURRENT != NULL && isUsedBy(Program::CURRENT->programIds)) {
         Program::CURRENT = NULL;
     }
@@ -1395,12 +1453,12 @@ unsigned int Texture::getMaxTextureUnits()
 
 void Texture::unbindSampler(Sampler *sampler)
 {
-    TEXTURE_UNIT_MANAGER->unbind(sampler);
+    getTextureUnitManager()->unbind(sampler);
 }
 
 void Texture::unbindAll()
 {
-    TEXTURE_UNIT_MANAGER->unbindAll();
+    getTextureUnitManager()->unbindAll();
 }
 
 }
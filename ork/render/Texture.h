@@ -44,6 +44,7 @@
 
 #include <vector>
 
+#include "ork/render/Buffer.h"
 #include "ork/render/Sampler.h"
 
 namespace ork
@@ -228,6 +229,17 @@ public:
      */
     GLsizei getCompressedSize(int level) const;
 
+    /**
+     * Returns the size in bytes of the pixels returned by #getImage for the
+     * given level and pixel format, with the default pack alignment of
+     * 4 bytes.
+     *
+     * @param level the texture LOD level.
+     * @param f the format in which data must be returned.
+     * @param t the type in which pixel components must be returned.
+     */
+    GLsizei getImageSize(int level, TextureFormat f, PixelType t) const;
+
     /**
      * Returns the texture pixels in the specified format.
      *
@@ -238,6 +250,19 @@ public:
      */
     void getImage(int level, TextureFormat f, PixelType t, void *pixels);
 
+    /**
+     * Returns the texture pixels in the specified format, in the given
+     * buffer. If this buffer is a GPUBuffer, the copy is done on GPU and
+     * does not wait for the previous commands to complete (see
+     * ReadbackManager).
+     *
+     * @param level the texture LOD level to be read.
+     * @param f the format in which data must be returned.
+     * @param t the type in which pixel components must be returned.
+     * @param[out] pixels the buffer where the data must be returned.
+     */
+    void getImage(int level, TextureFormat f, PixelType t, const Buffer &pixels);
+
     /**
      * Returns the compressed data of this texture. Must be used only for a
      * compressed texture (see #isCompressed).
@@ -252,6 +277,20 @@ public:
      */
     void generateMipMap();
 
+    /**
+     * Binds a level of this texture to an image unit, for image load and
+     * store operations in shaders (typically compute shaders). The image
+     * uniform of the program must be set to this unit. Only available with
+     * OpenGL 4.2 or more.
+     *
+     * @param unit the image unit to which this texture must be bound.
+     * @param level the LOD level to bind.
+     * @param access the allowed image access operations.
+     * @param layer the layer to bind for array, cube or 3D textures, or -1
+     *      to bind all the layers.
+     */
+    void bindToImageUnit(GLuint unit, int level, BufferAccess access, int layer = -1) const;
+
 protected:
     /**
      * Creates a new unitialized texture.
@@ -131,6 +131,7 @@ void TransformFeedback::transform(const MeshBuffers &mesh, GLint first, GLsizei
     TRANSFORMFEEDBACK_FRAMEBUFFER->beginConditionalRender();
     mesh.draw(MODE, first, count, primCount, base);
     TRANSFORMFEEDBACK_FRAMEBUFFER->endConditionalRender();
+    TRANSFORM->dirtyStorageBlocks();
 }
 
 void TransformFeedback::multiTransform(const MeshBuffers &mesh, GLint *firsts, GLsizei *counts, GLsizei primCount, GLint* bases)
@@ -140,6 +141,7 @@ void TransformFeedback::multiTransform(const MeshBuffers &mesh, GLint *firsts, G
     TRANSFORMFEEDBACK_FRAMEBUFFER->beginConditionalRender();
     mesh.multiDraw(MODE, firsts, counts, primCount, bases);
     TRANSFORMFEEDBACK_FRAMEBUFFER->endConditionalRender();
+    TRANSFORM->dirtyStorageBlocks();
 }
 
 void TransformFeedback::transformIndirect(const MeshBuffers &mesh, const Buffer &buf)
@@ -149,6 +151,7 @@ void TransformFeedback::transformIndirect(const MeshBuffers &mesh, const Buffer
     TRANSFORMFEEDBACK_FRAMEBUFFER->beginConditionalRender();
     mesh.drawIndirect(MODE, buf);
     TRANSFORMFEEDBACK_FRAMEBUFFER->endConditionalRender();
+    TRANSFORM->dirtyStorageBlocks();
 }
 
 void TransformFeedback::transformFeedback(const MeshBuffers &mesh, const TransformFeedback &tfb, int stream)
@@ -159,6 +162,7 @@ void TransformFeedback::transformFeedback(const MeshBuffers &mesh, const Transfo
     TRANSFORMFEEDBACK_FRAMEBUFFER->beginConditionalRender();
     mesh.drawFeedback(MODE, tfb.id, stream);
     TRANSFORMFEEDBACK_FRAMEBUFFER->endConditionalRender();
+    TRANSFORM->dirtyStorageBlocks();
 }
 
 void TransformFeedback::pause()
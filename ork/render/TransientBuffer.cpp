@@ -0,0 +1,192 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#include "ork/render/TransientBuffer.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ork/core/Logger.h"
+#include "ork/render/FrameBuffer.h"
+
+using namespace std;
+
+namespace ork
+{
+
+static_ptr<TransientBuffer> TransientBuffer::INSTANCE(NULL);
+
+TransientBuffer::TransientBuffer(int frameSize, int framesInFlight) :
+    Object("TransientBuffer"), mappedData(NULL), stagingData(NULL), frameSize(frameSize),
+    fences(framesInFlight, (GLsync) NULL), region(0), used(0), flushed(0), frame(0), stalls(0)
+{
+    assert(framesInFlight > 0);
+    buffer = new GPUBuffer();
+    GLint major = FrameBuffer::getMajorVersion();
+    GLint minor = FrameBuffer::getMinorVersion();
+    if (major > 4 || (major == 4 && minor >= 4)) {
+        mappedData = (unsigned char*) buffer->mapPersistent(frameSize * framesInFlight);
+    }
+    if (mappedData == NULL) {
+        buffer->setData(frameSize * framesInFlight, NULL, STREAM_DRAW);
+        stagingData = new unsigned char[frameSize];
+    }
+    GLint alignment;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    uniformAlignment = alignment;
+    assert(FrameBuffer::getError() == GL_NO_ERROR);
+}
+
+TransientBuffer::~TransientBuffer()
+{
+    for (unsigned int i = 0; i < fences.size(); ++i) {
+        if (fences[i] != NULL) {
+            glDeleteSync(fences[i]);
+        }
+    }
+    if (stagingData != NULL) {
+        delete[] stagingData;
+    }
+}
+
+ptr<GPUBuffer> TransientBuffer::getBuffer() const
+{
+    return buffer;
+}
+
+bool TransientBuffer::isPersistent() const
+{
+    return mappedData != NULL;
+}
+
+int TransientBuffer::getFrameSize() const
+{
+    return frameSize;
+}
+
+int TransientBuffer::getUsedSize() const
+{
+    return used;
+}
+
+unsigned int TransientBuffer::getFrame() const
+{
+    return frame;
+}
+
+unsigned int TransientBuffer::getStallCount() const
+{
+    return stalls;
+}
+
+int TransientBuffer::getUniformAlignment() const
+{
+    return uniformAlignment;
+}
+
+int TransientBuffer::allocate(int size, int alignment, volatile void **data)
+{
+    int base = region * frameSize;
+    // offsets are aligned in the whole buffer, not only in the region
+    int offset = base + used;
+    if (alignment > 1) {
+        offset = ((offset + alignment - 1) / alignment) * alignment;
+    }
+    if (offset + size > base + frameSize) {
+        return -1;
+    }
+    used = offset + size - base;
+    if (mappedData != NULL) {
+        *data = mappedData + offset;
+    } else {
+        *data = stagingData + (offset - base);
+    }
+    return offset;
+}
+
+int TransientBuffer::upload(const void *data, int size, int alignment)
+{
+    volatile void *dst;
+    int offset = allocate(size, alignment, &dst);
+    if (offset >= 0) {
+        memcpy((void*) dst, data, size);
+    }
+    return offset;
+}
+
+void TransientBuffer::flush()
+{
+    if (mappedData == NULL && used > flushed) {
+        buffer->setSubData(region * frameSize + flushed, used - flushed, stagingData + flushed);
+    }
+    flushed = used;
+}
+
+void TransientBuffer::endFrame()
+{
+    flush();
+    if (fences[region] != NULL) {
+        glDeleteSync(fences[region]);
+    }
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    region = (region + 1) % int(fences.size());
+    used = 0;
+    flushed = 0;
+    ++frame;
+
+    GLsync fence = fences[region];
+    if (fence != NULL) {
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            ++stalls;
+            ORK_DEBUGF(RENDER, "TransientBuffer waiting for frame %u", frame - (unsigned int) fences.size());
+            do {
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            } while (status == GL_TIMEOUT_EXPIRED);
+        }
+        glDeleteSync(fence);
+        fences[region] = NULL;
+    }
+    assert(FrameBuffer::getError() == GL_NO_ERROR);
+}
+
+}
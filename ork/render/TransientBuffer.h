@@ -0,0 +1,230 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#ifndef _ORK_TRANSIENT_BUFFER_H_
+#define _ORK_TRANSIENT_BUFFER_H_
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "ork/render/GPUBuffer.h"
+
+namespace ork
+{
+
+/**
+ * A frame scoped linear allocator for transient GPU data (vertices, indices
+ * or uniforms written once per frame). The allocator manages a single large
+ * GPUBuffer, divided in one region per frame in flight. Each frame
+ * sub-allocates ranges linearly in its region, and #endFrame puts a fence
+ * after the commands of the current frame and moves to the next region,
+ * waiting if necessary until the GPU has finished reading it. No GL object
+ * is created per allocation.
+ *
+ * With OpenGL 4.4 or more the buffer is persistently and coherently mapped,
+ * so that writes to allocated ranges are directly visible to the GPU, and
+ * #flush does nothing. Otherwise, allocations are made in a CPU staging
+ * area, and #flush uploads the ranges allocated since the last flush with a
+ * single glBufferSubData call.
+ *
+ * Meshes whose usage is GPU_TRANSIENT copy their content in the static
+ * #INSTANCE allocator when they are drawn.
+ * @ingroup render
+ */
+class ORK_API TransientBuffer : public Object
+{
+public:
+    /**
+     * The allocator used by GPU_TRANSIENT meshes. NULL by default. Its
+     * #endFrame method is called by SceneManager#draw.
+     */
+    static static_ptr<TransientBuffer> INSTANCE;
+
+    /**
+     * Creates a new TransientBuffer. Requires a current OpenGL context.
+     *
+     * @param frameSize the size in bytes of the region of each frame.
+     * @param framesInFlight the number of frames that can be processed by
+     *      the GPU while the CPU prepares the current one.
+     */
+    TransientBuffer(int frameSize = 4 * 1024 * 1024, int framesInFlight = 3);
+
+    /**
+     * Deletes this TransientBuffer.
+     */
+    virtual ~TransientBuffer();
+
+    /**
+     * Returns the GPU buffer containing the allocated ranges.
+     */
+    ptr<GPUBuffer> getBuffer() const;
+
+    /**
+     * Returns true if the GPU buffer is persistently mapped.
+     */
+    bool isPersistent() const;
+
+    /**
+     * Returns the size in bytes of the region of each frame.
+     */
+    int getFrameSize() const;
+
+    /**
+     * Returns the number of bytes allocated so far in the current frame.
+     */
+    int getUsedSize() const;
+
+    /**
+     * Returns the number of the current frame (incremented by #endFrame).
+     */
+    unsigned int getFrame() const;
+
+    /**
+     * Returns the number of times #endFrame had to wait for the GPU.
+     */
+    unsigned int getStallCount() const;
+
+    /**
+     * Returns the alignment required for the offsets of uniform buffer
+     * ranges (GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT).
+     */
+    int getUniformAlignment() const;
+
+    /**
+     * Allocates a range of the given size in the current frame.
+     *
+     * @param size the size of the range in bytes.
+     * @param alignment the alignment of the range offset, in bytes (not
+     *      necessarily a power of two).
+     * @param[out] data a pointer where the range content must be written.
+     *      Valid until the next call to #flush or #endFrame.
+     * @return the offset of the range in #getBuffer, or -1 if there is not
+     *      enough space left in the current frame.
+     */
+    int allocate(int size, int alignment, volatile void **data);
+
+    /**
+     * Allocates a range in the current frame and copies the given data in it.
+     *
+     * @param data the data to copy.
+     * @param size the size of data in bytes.
+     * @param alignment the alignment of the range offset, in bytes.
+     * @return the offset of the range in #getBuffer, or -1 if there is not
+     *      enough space left in the current frame.
+     */
+    int upload(const void *data, int size, int alignment = 16);
+
+    /**
+     * Makes the ranges written since the last call to this method visible
+     * to the GPU. Must be called before drawing with these ranges.
+     */
+    void flush();
+
+    /**
+     * Ends the current frame. Inserts a fence after the commands of this
+     * frame and starts a new frame in the next region, after waiting for the
+     * fence of the last frame that used it.
+     */
+    void endFrame();
+
+private:
+    /**
+     * The GPU buffer containing the regions of all the frames.
+     */
+    ptr<GPUBuffer> buffer;
+
+    /**
+     * The persistently mapped content of #buffer, or NULL.
+     */
+    unsigned char *mappedData;
+
+    /**
+     * The CPU staging area of the current frame, if #buffer is not
+     * persistently mapped.
+     */
+    unsigned char *stagingData;
+
+    /**
+     * The size in bytes of the region of each frame.
+     */
+    int frameSize;
+
+    /**
+     * The fence following the commands of the last frame that used each
+     * region, or NULL.
+     */
+    std::vector<GLsync> fences;
+
+    /**
+     * The region of the current frame.
+     */
+    int region;
+
+    /**
+     * The number of bytes allocated in the current frame.
+     */
+    int used;
+
+    /**
+     * The number of bytes of the current frame already made visible by #flush.
+     */
+    int flushed;
+
+    /**
+     * The number of the current frame.
+     */
+    unsigned int frame;
+
+    /**
+     * The number of times #endFrame had to wait for the GPU.
+     */
+    unsigned int stalls;
+
+    /**
+     * The value of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+     */
+    int uniformAlignment;
+};
+
+}
+
+#endif
@@ -946,6 +946,8 @@ GLenum getStage(Stage s)
         return GL_GEOMETRY_SHADER;
     case FRAGMENT:
         return GL_FRAGMENT_SHADER;
+    case COMPUTE:
+        return GL_COMPUTE_SHADER;
     }
     assert(false);
     throw exception();
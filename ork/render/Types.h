@@ -243,7 +243,8 @@ enum MeshUsage
     CPU, ///< &nbsp;
     GPU_STATIC, ///< &nbsp;
     GPU_DYNAMIC, ///< &nbsp;
-    GPU_STREAM ///< &nbsp;
+    GPU_STREAM, ///< &nbsp;
+    GPU_TRANSIENT ///< data copied at each frame in TransientBuffer#INSTANCE (or GPU_STREAM if there is not enough space)
 };
 
 /**
@@ -541,7 +542,8 @@ enum Stage {
     TESSELATION_CONTROL = 1, ///< &nbsp;
     TESSELATION_EVALUATION = 2, ///< &nbsp;
     GEOMETRY = 3, ///< &nbsp;
-    FRAGMENT = 4 ///< &nbsp;
+    FRAGMENT = 4, ///< &nbsp;
+    COMPUTE = 5 ///< &nbsp;
 };
 
 /**
@@ -762,4 +762,88 @@ void UniformBlock::unmapBuffer()
     buffer->unmap();
 }
 
+// ----------------------------------------------------------------------------
+
+StorageBlock::StorageBlock(Program *program, const string &name, GLuint index, GLuint size) :
+    UniformBlock(program, name, index, size), arrayOffset(size), arrayStride(0)
+{
+}
+
+StorageBlock::~StorageBlock()
+{
+}
+
+ptr<Uniform> StorageBlock::getUniform(const string &name) const
+{
+    ptr<Uniform> u = UniformBlock::getUniform(name);
+    if (u != NULL) {
+        return u;
+    }
+    map<string, ptr<Uniform> >::const_iterator i = elements.find(name);
+    if (i != elements.end()) {
+        return i->second;
+    }
+    // looks for the first element variable corresponding to 'name'
+    string::size_type b = name.find('[');
+    string::size_type e = b == string::npos ? b : name.find(']', b);
+    if (e == string::npos || program == NULL) {
+        return NULL;
+    }
+    GLuint k = GLuint(atoi(name.substr(b + 1, e - b - 1).c_str()));
+    string first = name.substr(0, b) + "[0]" + name.substr(e + 1);
+    map<string, ArrayVariable>::const_iterator j = arrayVariables.find(first);
+    if (j == arrayVariables.end()) {
+        j = arrayVariables.find(getName() + "." + first);
+        if (j == arrayVariables.end()) {
+            return NULL;
+        }
+    }
+    if (k >= getArraySize()) {
+        return NULL;
+    }
+    const ArrayVariable &v = j->second;
+    u = program->newUniform(const_cast<StorageBlock*>(this), v.type, name, v.offset + k * arrayStride, v.matrixStride, v.isRowMajor);
+    elements.insert(make_pair(name, u));
+    return u;
+}
+
+GLuint StorageBlock::getArrayOffset() const
+{
+    return arrayOffset;
+}
+
+GLuint StorageBlock::getArrayStride() const
+{
+    return arrayStride;
+}
+
+GLuint StorageBlock::getArraySize() const
+{
+    if (arrayStride == 0 || buffer == NULL || GLuint(buffer->getSize()) <= arrayOffset) {
+        return 0;
+    }
+    return (GLuint(buffer->getSize()) - arrayOffset) / arrayStride;
+}
+
+void StorageBlock::setArraySize(GLuint n)
+{
+    assert(buffer != NULL && arrayStride > 0);
+    int oldSize = buffer->getSize();
+    int newSize = int(max(size, arrayOffset + n * arrayStride));
+    if (newSize != oldSize) {
+        if (isMapped()) {
+            unmapBuffer();
+        }
+        vector<unsigned char> data(newSize, 0);
+        if (oldSize > 0) {
+            buffer->getSubData(0, min(oldSize, newSize), &(data[0]));
+        }
+        buffer->setData(newSize, &(data[0]), DYNAMIC_DRAW);
+        if (newSize < oldSize) {
+            // the uniforms of the removed elements must no longer be used
+            elements.clear();
+        }
+    }
+}
+
 }
@@ -62,6 +62,8 @@ class Program;
 
 class UniformBlock;
 
+class StorageBlock;
+
 #ifdef ORK_NO_GLPROGRAMUNIFORM
 #define SETVALUE setValueIfCurrent
 #else
@@ -1300,7 +1302,7 @@ public:
      * @return the uniform of this block whose name is given, or NULL if there
      *       is no such uniform.
      */
-    ptr<Uniform> getUniform(const std::string &name) const;
+    virtual ptr<Uniform> getUniform(const std::string &name) const;
 
     /**
      * Returns the uniform1f of this block whose name is given.
@@ -1940,6 +1942,115 @@ inline ptr<UniformSampler> UniformBlock::getUniformSampler(const std::string &na
     return getUniform(name).cast<UniformSampler>();
 }
 
+/**
+ * A named block of variables stored in a shader storage buffer. The variables
+ * of a storage block are accessed like the uniforms of a UniformBlock, but the
+ * buffer of a storage block is not limited to the size of uniform buffers,
+ * and it can be written by shaders. The last variable of a storage block can
+ * be an array without declared size. The size of this array is given by the
+ * size of the buffer, which can be changed with #setArraySize. The elements of
+ * this array are accessed with their index, as in "lights[10].color". Storage
+ * blocks are only available with OpenGL 4.3 or more.
+ *
+ * @ingroup render
+ */
+class ORK_API StorageBlock : public UniformBlock
+{
+public:
+    /**
+     * Deletes this storage block.
+     */
+    virtual ~StorageBlock();
+
+    /**
+     * Returns the variable of this block whose name is given. If this name
+     * designates an element of the unsized array of this block, and if
+     * this element is in the current buffer of this block, a uniform is
+     * created to access it.
+     *
+     * @param name a GLSL buffer variable name.
+     * @return the variable of this block whose name is given, or NULL if
+     *       there is no such variable.
+     */
+    virtual ptr<Uniform> getUniform(const std::string &name) const;
+
+    /**
+     * Returns the offset of the unsized array of this block, or the size of
+     * this block if it does not have such an array.
+     */
+    GLuint getArrayOffset() const;
+
+    /**
+     * Returns the stride between the elements of the unsized array of this
+     * block, or 0 if it does not have such an array.
+     */
+    GLuint getArrayStride() const;
+
+    /**
+     * Returns the number of elements of the unsized array of this block that
+     * fit in its current buffer.
+     */
+    GLuint getArraySize() const;
+
+    /**
+     * Resizes the buffer of this block so that its unsized array contains
+     * the given number of elements. The current content of the buffer is
+     * preserved.
+     *
+     * @param n a number of array elements.
+     */
+    void setArraySize(GLuint n);
+
+protected:
+    /**
+     * The layout of a variable of the first element of the unsized array of
+     * a storage block.
+     */
+    struct ArrayVariable
+    {
+        GLenum type; ///< the OpenGL type of this variable
+
+        GLuint offset; ///< the offset of this variable in the first element
+
+        GLuint matrixStride; ///< the stride between columns or rows of a matrix
+
+        int isRowMajor; ///< 1 if a matrix is stored in row major order
+    };
+
+    /**
+     * The variables of the first element of the unsized array of this block.
+     */
+    std::map<std::string, ArrayVariable> arrayVariables;
+
+    /**
+     * The offset of the unsized array of this block.
+     */
+    GLuint arrayOffset;
+
+    /**
+     * The stride between the elements of the unsized array of this block.
+     */
+    GLuint arrayStride;
+
+    /**
+     * The uniforms created by #getUniform to access the elements of the
+     * unsized array of this block.
+     */
+    mutable std::map< std::string, ptr<Uniform> > elements;
+
+    /**
+     * Creates a new storage block.
+     *
+     * @param program the Program to which the storage block belongs.
+     * @param name the name of the storage block in the GLSL code.
+     * @param index the index of the storage block in the program.
+     * @param size the minimum size of the storage block's variables.
+     */
+    StorageBlock(Program *program, const std::string &name, GLuint index, GLuint size);
+
+    friend class Program;
+};
+
 #undef SETVALUE
 
 }
@@ -0,0 +1,506 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#include "ork/resource/CompactXML.h"
+
+#include <string.h>
+#include <deque>
+
+#include <pthread.h>
+
+using namespace std;
+
+namespace ork
+{
+
+/**
+ * The size of the memory blocks allocated by CompactXML.
+ */
+static const unsigned int BLOCK_SIZE = 16 * 1024;
+
+/**
+ * The interned element and attribute names, shared by all CompactXML.
+ */
+struct KeyTable
+{
+    deque<string> names; ///< the interned names, indexed by their key
+
+    vector<unsigned int> hashes; ///< the hash codes of #names
+
+    vector<int> slots; ///< an open addressing hash table of keys, -1 if empty
+
+    pthread_mutex_t mutex; ///< the mutex used to access this table
+
+    KeyTable() : slots(256, -1)
+    {
+        pthread_mutex_init(&mutex, NULL);
+    }
+
+    ~KeyTable()
+    {
+        pthread_mutex_destroy(&mutex);
+    }
+};
+
+static KeyTable &getKeyTable()
+{
+    static KeyTable table;
+    return table;
+}
+
+static unsigned int getHash(const char *s, int length)
+{
+    unsigned int h = 2166136261U;
+    for (int i = 0; i < length; ++i) {
+        h = (h ^ (unsigned char) s[i]) * 16777619U;
+    }
+    return h;
+}
+
+int CompactXML::getKey(const char *name, int length)
+{
+    if (length < 0) {
+        length = int(strlen(name));
+    }
+    unsigned int h = getHash(name, length);
+    KeyTable &t = getKeyTable();
+    pthread_mutex_lock(&t.mutex);
+    unsigned int mask = t.slots.size() - 1;
+    unsigned int i = h & mask;
+    while (t.slots[i] >= 0) {
+        int k = t.slots[i];
+        const string &n = t.names[k];
+        if (t.hashes[k] == h && int(n.size()) == length && memcmp(n.data(), name, length) == 0) {
+            pthread_mutex_unlock(&t.mutex);
+            return k;
+        }
+        i = (i + 1) & mask;
+    }
+    int key = int(t.names.size());
+    t.names.push_back(string(name, length));
+    t.hashes.push_back(h);
+    t.slots[i] = key;
+    if (2 * t.names.size() > t.slots.size()) {
+        // the table is half full: we double its size
+        t.slots.assign(2 * t.slots.size(), -1);
+        mask = t.slots.size() - 1;
+        for (int k = 0; k < int(t.names.size()); ++k) {
+            i = t.hashes[k] & mask;
+            while (t.slots[i] >= 0) {
+                i = (i + 1) & mask;
+            }
+            t.slots[i] = k;
+        }
+    }
+    pthread_mutex_unlock(&t.mutex);
+    return key;
+}
+
+const char *CompactXML::getName(int key)
+{
+    KeyTable &t = getKeyTable();
+    pthread_mutex_lock(&t.mutex);
+    const char *name = t.names[key].c_str();
+    pthread_mutex_unlock(&t.mutex);
+    return name;
+}
+
+const char *CompactXML::Element::getAttribute(int key) const
+{
+    for (int i = 0; i < attributeCount; ++i) {
+        if (attributes[i].key == key) {
+            return attributes[i].value;
+        }
+    }
+    return NULL;
+}
+
+CompactXML::CompactXML() : available(NULL), availableSize(0), text(NULL), root(NULL)
+{
+}
+
+CompactXML::CompactXML(const TiXmlElement *e) : available(NULL), availableSize(0), text(NULL), root(NULL)
+{
+    root = build(e);
+    indexChildren();
+}
+
+CompactXML::~CompactXML()
+{
+    clear();
+}
+
+bool CompactXML::parse(char *text)
+{
+    clear();
+    this->text = text;
+    char *p = text;
+    while (p != NULL && *p != '\0') {
+        if (*p != '<') {
+            // text outside the root element is ignored
+            ++p;
+        } else if (strncmp(p, "<!--", 4) == 0) {
+            p = strstr(p + 4, "-->");
+            p = p == NULL ? NULL : p + 3;
+        } else if (p[1] == '?' || p[1] == '!') {
+            p = strchr(p, '>');
+            p = p == NULL ? NULL : p + 1;
+        } else if (root == NULL) {
+            p = parseElement(p, root);
+        } else {
+            // the elements following the root element are ignored
+            Element *e;
+            p = parseElement(p, e);
+        }
+    }
+    if (p == NULL || root == NULL) {
+        root = NULL;
+        return false;
+    }
+    indexChildren();
+    return true;
+}
+
+const CompactXML::Element *CompactXML::getRoot() const
+{
+    return root;
+}
+
+const CompactXML::Element *CompactXML::findChild(const string &name) const
+{
+    map<string, const Element*>::const_iterator i = children.find(name);
+    return i == children.end() ? NULL : i->second;
+}
+
+TiXmlElement *CompactXML::toElement(const Element *e)
+{
+    TiXmlElement *result = new TiXmlElement(getName(e->tag));
+    for (int i = 0; i < e->attributeCount; ++i) {
+        result->SetAttribute(getName(e->attributes[i].key), e->attributes[i].value);
+    }
+    for (const Element *c = e->firstChild; c != NULL; c = c->nextSibling) {
+        result->LinkEndChild(toElement(c));
+    }
+    return result;
+}
+
+bool CompactXML::equal(const Element *e1, const Element *e2)
+{
+    while (e1 != NULL && e2 != NULL) {
+        if (e1->tag != e2->tag || e1->attributeCount != e2->attributeCount) {
+            return false;
+        }
+        for (int i = 0; i < e1->attributeCount; ++i) {
+            const Attribute &a1 = e1->attributes[i];
+            const Attribute &a2 = e2->attributes[i];
+            if (a1.key != a2.key || strcmp(a1.value, a2.value) != 0) {
+                return false;
+            }
+        }
+        if (!equal(e1->firstChild, e2->firstChild)) {
+            return false;
+        }
+        e1 = e1->nextSibling;
+        e2 = e2->nextSibling;
+    }
+    return e1 == e2;
+}
+
+void CompactXML::clear()
+{
+    for (unsigned int i = 0; i < blocks.size(); ++i) {
+        delete[] blocks[i];
+    }
+    blocks.clear();
+    available = NULL;
+    availableSize = 0;
+    delete[] text;
+    text = NULL;
+    root = NULL;
+    children.clear();
+}
+
+void *CompactXML::allocate(unsigned int size)
+{
+    size = (size + 7) & ~7;
+    if (size > availableSize) {
+        unsigned int blockSize = max(size, BLOCK_SIZE);
+        blocks.push_back(new char[blockSize]);
+        available = blocks.back();
+        availableSize = blockSize;
+    }
+    void *result = available;
+    available += size;
+    availableSize -= size;
+    return result;
+}
+
+CompactXML::Element *CompactXML::newElement(int tag, const Attribute *attributes, int count)
+{
+    Element *e = (Element*) allocate(sizeof(Element));
+    e->tag = tag;
+    e->attributeCount = count;
+    e->attributes = NULL;
+    if (count > 0) {
+        e->attributes = (Attribute*) allocate(count * sizeof(Attribute));
+        memcpy(e->attributes, attributes, count * sizeof(Attribute));
+    }
+    e->firstChild = NULL;
+    e->nextSibling = NULL;
+    return e;
+}
+
+CompactXML::Element *CompactXML::build(const TiXmlElement *e)
+{
+    vector<Attribute> attributes;
+    for (const TiXmlAttribute *a = e->FirstAttribute(); a != NULL; a = a->Next()) {
+        Attribute attribute;
+        attribute.key = getKey(a->Name());
+        unsigned int length = strlen(a->Value()) + 1;
+        char *value = (char*) allocate(length);
+        memcpy(value, a->Value(), length);
+        attribute.value = value;
+        attributes.push_back(attribute);
+    }
+    Element *result = newElement(getKey(e->Value()), attributes.empty() ? NULL : &attributes[0], int(attributes.size()));
+    Element **next = &result->firstChild;
+    for (const TiXmlElement *c = e->FirstChildElement(); c != NULL; c = c->NextSiblingElement()) {
+        *next = build(c);
+        next = &(*next)->nextSibling;
+    }
+    return result;
+}
+
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool isNameChar(char c)
+{
+    return c != '\0' && !isSpace(c) && c != '/' && c != '>' && c != '=' && c != '<';
+}
+
+/**
+ * Decodes the XML entity starting at p, writes the result at w, and returns
+ * the position following the entity. The decoded entity is never longer than
+ * the encoded one.
+ */
+static char *decodeEntity(char *p, char *&w)
+{
+    static const char *names[5] = { "&lt;", "&gt;", "&amp;", "&quot;", "&apos;" };
+    static const char values[5] = { '<', '>', '&', '"', '\'' };
+    for (int i = 0; i < 5; ++i) {
+        int n = int(strlen(names[i]));
+        if (strncmp(p, names[i], n) == 0) {
+            *w++ = values[i];
+            return p + n;
+        }
+    }
+    if (p[1] == '#') {
+        char *start = p[2] == 'x' ? p + 3 : p + 2;
+        char *end;
+        unsigned long c = strtoul(start, &end, p[2] == 'x' ? 16 : 10);
+        if (*end == ';' && end > start) {
+            // writes the character code in UTF-8
+            if (c < 0x80) {
+                *w++ = (char) c;
+            } else if (c < 0x800) {
+                *w++ = (char) (0xC0 | (c >> 6));
+                *w++ = (char) (0x80 | (c & 0x3F));
+            } else if (c < 0x10000) {
+                *w++ = (char) (0xE0 | (c >> 12));
+                *w++ = (char) (0x80 | ((c >> 6) & 0x3F));
+                *w++ = (char) (0x80 | (c & 0x3F));
+            } else {
+                *w++ = (char) (0xF0 | ((c >> 18) & 0x07));
+                *w++ = (char) (0x80 | ((c >> 12) & 0x3F));
+                *w++ = (char) (0x80 | ((c >> 6) & 0x3F));
+                *w++ = (char) (0x80 | (c & 0x3F));
+            }
+            return end + 1;
+        }
+    }
+    // unknown entities are kept as is
+    *w++ = *p;
+    return p + 1;
+}
+
+char *CompactXML::parseElement(char *p, Element *&e)
+{
+    // we first parse the element name
+    char *name = ++p;
+    while (isNameChar(*p)) {
+        ++p;
+    }
+    if (p == name) {
+        return NULL;
+    }
+    int tag = getKey(name, int(p - name));
+    int nameLength = int(p - name);
+
+    // then its attributes, whose values are decoded in place
+    bool empty = false;
+    pending.clear();
+    while (true) {
+        while (isSpace(*p)) {
+            ++p;
+        }
+        if (*p == '/' && p[1] == '>') {
+            empty = true;
+            p += 2;
+            break;
+        }
+        if (*p == '>') {
+            ++p;
+            break;
+        }
+        char *attribute = p;
+        while (isNameChar(*p)) {
+            ++p;
+        }
+        if (p == attribute) {
+            return NULL;
+        }
+        Attribute a;
+        a.key = getKey(attribute, int(p - attribute));
+        while (isSpace(*p)) {
+            ++p;
+        }
+        if (*p != '=') {
+            return NULL;
+        }
+        ++p;
+        while (isSpace(*p)) {
+            ++p;
+        }
+        char quote = *p;
+        if (quote != '"' && quote != '\'') {
+            return NULL;
+        }
+        char *w = ++p;
+        a.value = w;
+        while (*p != quote) {
+            if (*p == '\0') {
+                return NULL;
+            }
+            if (*p == '&') {
+                p = decodeEntity(p, w);
+            } else {
+                *w++ = *p++;
+            }
+        }
+        // the closing quote, or a character before it, is replaced with the
+        // string terminator
+        *w = '\0';
+        ++p;
+        pending.push_back(a);
+    }
+    e = newElement(tag, pending.empty() ? NULL : &pending[0], int(pending.size()));
+    if (empty) {
+        return p;
+    }
+
+    // and finally its sub elements, until the end tag
+    Element **next = &e->firstChild;
+    while (true) {
+        while (*p != '\0' && *p != '<') {
+            // text content is ignored
+            ++p;
+        }
+        if (*p == '\0') {
+            return NULL;
+        }
+        if (p[1] == '/') {
+            p += 2;
+            if (strncmp(p, name, nameLength) != 0 || isNameChar(p[nameLength])) {
+                return NULL;
+            }
+            p += nameLength;
+            while (isSpace(*p)) {
+                ++p;
+            }
+            return *p == '>' ? p + 1 : NULL;
+        }
+        if (strncmp(p, "<!--", 4) == 0) {
+            p = strstr(p + 4, "-->");
+            if (p == NULL) {
+                return NULL;
+            }
+            p += 3;
+        } else if (strncmp(p, "<![CDATA[", 9) == 0) {
+            p = strstr(p + 9, "]]>");
+            if (p == NULL) {
+                return NULL;
+            }
+            p += 3;
+        } else if (p[1] == '?' || p[1] == '!') {
+            p = strchr(p, '>');
+            if (p == NULL) {
+                return NULL;
+            }
+            ++p;
+        } else {
+            p = parseElement(p, *next);
+            if (p == NULL) {
+                return NULL;
+            }
+            next = &(*next)->nextSibling;
+        }
+    }
+}
+
+void CompactXML::indexChildren()
+{
+    children.clear();
+    if (root == NULL) {
+        return;
+    }
+    int nameKey = getKey("name");
+    for (const Element *c = root->firstChild; c != NULL; c = c->nextSibling) {
+        const char *n = c->getAttribute(nameKey);
+        if (n != NULL && children.find(n) == children.end()) {
+            children.insert(make_pair(string(n), c));
+        }
+    }
+}
+
+}
@@ -0,0 +1,262 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#ifndef _ORK_COMPACT_XML_H_
+#define _ORK_COMPACT_XML_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tinyxml/tinyxml.h"
+
+namespace ork
+{
+
+/**
+ * A compact, read-only representation of XML %resource descriptors. The
+ * elements and attributes of a CompactXML are allocated in a few large
+ * memory blocks, and its element and attribute names are interned as
+ * integer keys, shared by all CompactXML. A CompactXML can be parsed in situ
+ * from the content of an XML file, i.e. the attribute values are decoded and
+ * stored in the file content itself. It can also be built from a TinyXml
+ * element, and converted back to a TinyXml element.
+ *
+ * Only elements and attributes are kept: text, comments, processing
+ * instructions and document type declarations are ignored.
+ *
+ * @ingroup resource
+ */
+class ORK_API CompactXML
+{
+public:
+    /**
+     * An attribute of an Element.
+     */
+    struct Attribute
+    {
+        int key; ///< the interned name of this attribute (see #getKey)
+
+        const char *value; ///< the value of this attribute
+    };
+
+    /**
+     * An element of a CompactXML.
+     */
+    struct Element
+    {
+        int tag; ///< the interned name of this element (see #getKey)
+
+        int attributeCount; ///< the number of attributes of this element
+
+        Attribute *attributes; ///< the attributes of this element
+
+        Element *firstChild; ///< the first sub element of this element
+
+        Element *nextSibling; ///< the next sibling element of this element
+
+        /**
+         * Returns the value of the attribute of the given interned name, or
+         * NULL if this element does not have this attribute.
+         *
+         * @param key an interned attribute name (see #getKey).
+         */
+        const char *getAttribute(int key) const;
+    };
+
+    /**
+     * Returns the interned key of the given element or attribute name. Equal
+     * names always have the same key, and different names different keys.
+     *
+     * @param name an element or attribute name.
+     * @param length the length of this name, or -1 if it is null terminated.
+     */
+    static int getKey(const char *name, int length = -1);
+
+    /**
+     * Returns the element or attribute name of the given interned key.
+     *
+     * @param key a key returned by #getKey.
+     */
+    static const char *getName(int key);
+
+    /**
+     * Creates a new, empty CompactXML.
+     */
+    CompactXML();
+
+    /**
+     * Creates a new CompactXML containing a copy of the given element.
+     *
+     * @param e a TinyXml element.
+     */
+    CompactXML(const TiXmlElement *e);
+
+    /**
+     * Deletes this CompactXML.
+     */
+    ~CompactXML();
+
+    /**
+     * Parses the given XML content in situ. The content of this CompactXML,
+     * if any, is replaced with the parsed document.
+     *
+     * @param text a null terminated XML content, allocated with new[]. This
+     *      array is modified and then owned by this CompactXML, even if a
+     *      syntax error is found.
+     * @return true if the content was successfully parsed.
+     */
+    bool parse(char *text);
+
+    /**
+     * Returns the root element of this CompactXML, or NULL if it is empty.
+     */
+    const Element *getRoot() const;
+
+    /**
+     * Returns the sub element of the root element whose "name" attribute is
+     * equal to the given name, or NULL if there is no such element.
+     *
+     * @param name the value of a "name" attribute.
+     */
+    const Element *findChild(const std::string &name) const;
+
+    /**
+     * Returns a TinyXml copy of the given element and of its sub elements.
+     * The result must be deleted by the caller.
+     *
+     * @param e an element of a CompactXML.
+     */
+    static TiXmlElement *toElement(const Element *e);
+
+    /**
+     * Returns true if the given elements are equal. This means that they
+     * have the same name, the same attributes in the same order, and the
+     * same sub elements.
+     */
+    static bool equal(const Element *e1, const Element *e2);
+
+private:
+    /**
+     * The memory blocks where the elements, attributes and copied strings
+     * of this CompactXML are allocated.
+     */
+    std::vector<char*> blocks;
+
+    /**
+     * The next available byte in the last block of #blocks.
+     */
+    char *available;
+
+    /**
+     * The number of available bytes in the last block of #blocks.
+     */
+    unsigned int availableSize;
+
+    /**
+     * The XML content parsed in situ by #parse, or NULL.
+     */
+    char *text;
+
+    /**
+     * The root element of this CompactXML, or NULL if it is empty.
+     */
+    Element *root;
+
+    /**
+     * The sub elements of #root, indexed by their "name" attribute.
+     */
+    std::map<std::string, const Element*> children;
+
+    /**
+     * The attributes of the element currently parsed by #parseElement.
+     */
+    std::vector<Attribute> pending;
+
+    /**
+     * Deletes the content of this CompactXML.
+     */
+    void clear();
+
+    /**
+     * Allocates the given number of bytes in #blocks.
+     */
+    void *allocate(unsigned int size);
+
+    /**
+     * Allocates a new element with the given name and attributes.
+     */
+    Element *newElement(int tag, const Attribute *attributes, int count);
+
+    /**
+     * Copies a TinyXml element and its sub elements in #blocks.
+     */
+    Element *build(const TiXmlElement *e);
+
+    /**
+     * Parses the element starting at the given position, and its sub
+     * elements. Returns the position following the element, or NULL if a
+     * syntax error was found.
+     *
+     * @param p the position of the '<' character starting the element.
+     * @param[out] e the parsed element.
+     */
+    char *parseElement(char *p, Element *&e);
+
+    /**
+     * Indexes the sub elements of #root in #children.
+     */
+    void indexChildren();
+
+    /**
+     * Forbidden copy constructor.
+     */
+    CompactXML(const CompactXML &);
+
+    /**
+     * Forbidden assignment operator.
+     */
+    CompactXML &operator=(const CompactXML &);
+};
+
+}
+
+#endif
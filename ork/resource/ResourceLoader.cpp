@@ -41,6 +41,8 @@
 
 #include "ork/resource/ResourceLoader.h"
 
+using namespace std;
+
 namespace ork
 {
 
@@ -52,4 +54,12 @@ ResourceLoader::~ResourceLoader()
 {
 }
 
+void ResourceLoader::loadResources(const vector<string> &names, vector< ptr<ResourceDescriptor> > &descs)
+{
+    descs.clear();
+    for (unsigned int i = 0; i < names.size(); ++i) {
+        descs.push_back(loadResource(names[i]));
+    }
+}
+
 }
@@ -42,6 +42,8 @@
 #ifndef _ORK_RESOURCE_LOADER_H_
 #define _ORK_RESOURCE_LOADER_H_
 
+#include <vector>
+
 #include "ork/resource/ResourceDescriptor.h"
 
 namespace ork
@@ -84,6 +86,17 @@ public:
      */
     virtual ptr<ResourceDescriptor> loadResource(const std::string &name) = 0;
 
+    /**
+     * Loads the ResourceDescriptor of the given names. The default
+     * implementation calls #loadResource for each name. Subclasses can
+     * override it to load the descriptors in parallel.
+     *
+     * @param names the names of the ResourceDescriptor to be loaded.
+     * @param[out] descs returns the ResourceDescriptor of the given names,
+     *      in the same order, with NULL for the resources that are not found.
+     */
+    virtual void loadResources(const std::vector<std::string> &names, std::vector< ptr<ResourceDescriptor> > &descs);
+
     /**
      * Reloads the ResourceDescriptor of the given name.
      *
@@ -41,6 +41,9 @@
 
 #include "ork/resource/ResourceManager.h"
 
+#include <set>
+#include <sstream>
+
 using namespace std;
 
 namespace ork
@@ -93,22 +96,10 @@ ptr<Object> ResourceManager::loadResource(const string &name)
         Logger::INFO_LOGGER->log("RESOURCE", "Loading resource '" + name + "'");
     }
     // otherwise the resource is not already loaded; we first load its descriptor
-    ptr<Object> r = NULL;
-    ptr<ResourceDescriptor> d = loader->loadResource(name);
-
-    if (d != NULL) {
-        // then we create the actual resource from this descriptor
-        try {
-            r = ResourceFactory::getInstance()->create(this, name, d).cast<Object>();
-        } catch (...) {
-        }
-        if (r != NULL) {
-            // and we register this resource with this manager
-            Resource *res = dynamic_cast<Resource*>(r.get());
-            resources[name] = make_pair(res->getUpdateOrder(), res);
-            resourceOrder[make_pair(res->getUpdateOrder(), res->getName())] = res;
-            return r;
-        }
+    // and then we create the actual resource from this descriptor
+    ptr<Object> r = createResource(name, loader->loadResource(name));
+    if (r != NULL) {
+        return r;
     }
     if (Logger::ERROR_LOGGER != NULL) {
         Logger::ERROR_LOGGER->log("RESOURCE", "Missing or invalid resource '" + name + "'");
@@ -149,6 +140,67 @@ ptr<Object> ResourceManager::loadResource(ptr<ResourceDescriptor> desc, const Ti
     throw exception();
 }
 
+void ResourceManager::loadResources(const vector<string> &names, vector< ptr<Object> > &result)
+{
+    // we first find the resources that are not already loaded
+    vector<string> missing;
+    set<string> missingSet;
+    for (unsigned int i = 0; i < names.size(); ++i) {
+        if (resources.find(names[i]) == resources.end() && missingSet.insert(names[i]).second) {
+            missing.push_back(names[i]);
+        }
+    }
+    // then we load their descriptors together, and create them
+    vector< ptr<Object> > created;
+    if (missing.size() > 0) {
+        if (Logger::INFO_LOGGER != NULL) {
+            ostringstream os;
+            os << "Loading " << missing.size() << " resources";
+            Logger::INFO_LOGGER->log("RESOURCE", os.str());
+        }
+        vector< ptr<ResourceDescriptor> > descs;
+        loader->loadResources(missing, descs);
+        for (unsigned int i = 0; i < missing.size(); ++i) {
+            // a previous resource may have loaded this one as a dependency
+            if (resources.find(missing[i]) != resources.end()) {
+                continue;
+            }
+            ptr<Object> r = createResource(missing[i], descs[i]);
+            if (r == NULL && Logger::ERROR_LOGGER != NULL) {
+                Logger::ERROR_LOGGER->log("RESOURCE", "Missing or invalid resource '" + missing[i] + "'");
+            }
+            created.push_back(r);
+        }
+    }
+    // finally we return all the requested resources
+    result.clear();
+    for (unsigned int i = 0; i < names.size(); ++i) {
+        ptr<Object> r = NULL;
+        if (resources.find(names[i]) != resources.end()) {
+            r = loadResource(names[i]);
+        }
+        result.push_back(r);
+    }
+}
+
+ptr<Object> ResourceManager::createResource(const string &name, ptr<ResourceDescriptor> desc)
+{
+    ptr<Object> r = NULL;
+    if (desc != NULL) {
+        try {
+            r = ResourceFactory::getInstance()->create(this, name, desc).cast<Object>();
+        } catch (...) {
+        }
+        if (r != NULL) {
+            // we register this resource with this manager
+            Resource *res = dynamic_cast<Resource*>(r.get());
+            resources[name] = make_pair(res->getUpdateOrder(), res);
+            resourceOrder[make_pair(res->getUpdateOrder(), res->getName())] = res;
+        }
+    }
+    return r;
+}
+
 bool ResourceManager::updateResources()
 {
     if (Logger::INFO_LOGGER != NULL) {
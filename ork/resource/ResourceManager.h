@@ -108,6 +108,20 @@ public:
      */
     ptr<Object> loadResource(ptr<ResourceDescriptor> desc, const TiXmlElement *f);
 
+    /**
+     * Loads the given resources. The descriptors of the resources that are
+     * not already loaded are loaded together with ResourceLoader#loadResources,
+     * which can decode texture images in parallel. The resources are then
+     * created in the caller thread with ResourceFactory. Use this method
+     * rather than several calls to #loadResource to load many textures.
+     *
+     * @param names the names of the resources to be loaded.
+     * @param[out] result returns the resources corresponding to the given
+     *      names, in the same order, with NULL for the resources that are not
+     *      found or invalid.
+     */
+    void loadResources(const std::vector<std::string> &names, std::vector< ptr<Object> > &result);
+
     /**
      * Updates the already loaded resources if their descriptors have changed.
      * This update is atomic, i.e. either all resources are updated, or none are
@@ -180,6 +194,16 @@ private:
      */
     std::list<Resource*> unusedResourcesOrder;
 
+    /**
+     * Creates a %resource from its descriptor with ResourceFactory, and
+     * registers it in this manager.
+     *
+     * @param name the name of the %resource to be created.
+     * @param desc the descriptor of this %resource.
+     * @return the created %resource, or NULL if it cannot be created.
+     */
+    ptr<Object> createResource(const std::string &name, ptr<ResourceDescriptor> desc);
+
     /**
      * The maximum number of unused resources that can be stored in cache.
      */
@@ -55,8 +55,11 @@
 #include <sys/unistd.h>
 #endif
 
+#include <pthread.h>
+
 #include "stbi/stb_image.h"
 
+#include "ork/math/half.h"
 #include "ork/resource/ResourceManager.h"
 
 using namespace std;
@@ -86,6 +89,32 @@ static bool isTextureFile(const string &name)
     return false;
 }
 
+/**
+ * Returns the 64 bits FNV-1a hash of the given data.
+ */
+static unsigned long long getContentHash(const unsigned char *data, unsigned int size)
+{
+    unsigned long long h = 14695981039346656037ULL;
+    for (unsigned int i = 0; i < size; ++i) {
+        h = (h ^ data[i]) * 1099511628211ULL;
+    }
+    return h;
+}
+
+/**
+ * Returns the number of processors of this computer.
+ */
+static int getProcessorCount()
+{
+#ifdef _MSC_VER
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return int(info.dwNumberOfProcessors);
+#else
+    return int(sysconf(_SC_NPROCESSORS_ONLN));
+#endif
+}
+
 /**
  * A ResourceDescriptor that also stores a set of last modification times.
  */
@@ -98,6 +127,9 @@ public:
      * Creates a new XMLResourceDescriptor.
      *
      * @param descriptor the XML part of this descriptor.
+     * @param source the XML part of this descriptor, in compact form, as it
+     *      was before the ASCII or binary part was loaded (loading a texture
+     *      image adds attributes to the XML part).
      * @param data the ASCII or binary part of this descriptor.
      * @param size the size in bytes of the ASCII or binary part.
      * @param stamp the last modification time of the file that contain the XML
@@ -105,9 +137,9 @@ public:
      * @param stamps the last modification time(s) of the file(s) that contain
      *      the ASCII or binary part.
      */
-    XMLResourceDescriptor(const TiXmlElement *descriptor, unsigned char *data, unsigned int size,
-            time_t stamp, const Stamps &dataStamps) :
-        ResourceDescriptor(descriptor, data, size), stamp(stamp), dataStamps(dataStamps)
+    XMLResourceDescriptor(const TiXmlElement *descriptor, const CompactXML *source, unsigned char *data,
+            unsigned int size, time_t stamp, const Stamps &dataStamps) :
+        ResourceDescriptor(descriptor, data, size), source(source), stamp(stamp), dataStamps(dataStamps)
     {
     }
 
@@ -116,83 +148,16 @@ public:
      */
     virtual ~XMLResourceDescriptor()
     {
+        delete source;
     }
 
+private:
     /**
-     * Returns true if this descriptor is equal to the given one.
-     *
-     * @param desc the XML part of another XMLResourceDescriptor.
-     * @param stamp the stamp of another XMLResourceDescriptor.
-     * @param dataStamps the dataStamps of another XMLResourceDescriptor.
-     * @return true if the XML parts of both XMLResourceDescriptor are equal and
-     *      if the modification times of the binary parts are equal.
-     */
-    bool equal(const TiXmlElement *desc, time_t stamp, const Stamps &dataStamps)
-    {
-        if (dataStamps.size() != this->dataStamps.size()) {
-            return false;
-        }
-        for (unsigned int i = 0; i < dataStamps.size(); ++i) {
-            if (difftime(dataStamps[i].second, this->dataStamps[i].second) != 0) {
-                return false;
-            }
-        }
-        if (difftime(stamp, this->stamp) == 0) {
-            return true;
-        }
-        return equal(desc, this->descriptor);
-    }
-
-    /**
-     * Returns true if the given XML elements are equal. This means that they
-     * have the same attibutes and the same sub elements.
+     * The XML part of this descriptor, as it was before the ASCII or binary
+     * part was loaded.
      */
-    static bool equal(const TiXmlNode *n1, const TiXmlNode *n2)
-    {
-        if (strcmp(n1->Value(), n2->Value()) != 0) {
-            return false;
-        }
-        const TiXmlElement *e1 = n1->ToElement();
-        const TiXmlElement *e2 = n2->ToElement();
-        if ((e1 == NULL) != (e2 == NULL)) {
-            return false;
-        }
-        if (e1 != NULL) {
-            const TiXmlAttribute *a1 = e1->FirstAttribute();
-            const TiXmlAttribute *a2 = e2->FirstAttribute();
-            while (a1 != NULL) {
-                if (a2 == NULL) {
-                    return false;
-                }
-                if (strcmp(a1->Name(), a2->Name()) != 0) {
-                    return false;
-                }
-                if (strcmp(a1->Value(), a2->Value()) != 0) {
-                    return false;
-                }
-                a1 = a1->Next();
-                a2 = a2->Next();
-            }
-            if (a2 != NULL) {
-                return false;
-            }
-        }
-        const TiXmlNode *c1 = n1->FirstChild();
-        const TiXmlNode *c2 = n2->FirstChild();
-        while (c1 != NULL) {
-            if (c2 == NULL) {
-                return false;
-            }
-            if (!equal(c1, c2)) {
-                return false;
-            }
-            c1 = c1->NextSibling();
-            c2 = c2->NextSibling();
-        }
-        return c2 == NULL;
-    }
+    const CompactXML *source;
 
-private:
     /**
      * The last modification time of the file that contains the XML part of this
      * %resource descriptor.
@@ -209,16 +174,54 @@ private:
     friend class XMLResourceLoader;
 };
 
-XMLResourceLoader::XMLResourceLoader() : ResourceLoader()
+/**
+ * A texture image loaded by a thread of XMLResourceLoader::loadResources.
+ */
+struct DecodeJob
+{
+    TiXmlElement *desc; ///< the XML part of the texture %resource
+
+    CompactXML *source; ///< the XML part before the image is loaded
+
+    unsigned char *data; ///< the decoded image, or NULL if not loaded yet
+
+    unsigned int size; ///< the size of #data in bytes
+
+    XMLResourceDescriptor::Stamps stamps; ///< the stamps of the image file
+
+    bool failed; ///< true if the image cannot be loaded
+};
+
+/**
+ * The texture images loaded by the threads of XMLResourceLoader::loadResources.
+ */
+struct DecodeBatch
+{
+    XMLResourceLoader *loader; ///< the loader that created this batch
+
+    vector<DecodeJob> jobs; ///< the texture images to be loaded
+
+    unsigned int next; ///< the index of the next image to be loaded
+
+    pthread_mutex_t mutex; ///< the mutex used to access #next
+};
+
+XMLResourceLoader::XMLResourceLoader() : ResourceLoader(), decodeThreads(0),
+    decodedSize(0), maxDecodedSize(64 * 1024 * 1024)
 {
+    mutex = new pthread_mutex_t;
+    pthread_mutex_init((pthread_mutex_t*) mutex, NULL);
 }
 
 XMLResourceLoader::~XMLResourceLoader()
 {
-    for (map<string, pair<TiXmlDocument*, time_t> >::iterator i = cache.begin(); i != cache.end(); ++i) {
+    for (map<string, pair<CompactXML*, time_t> >::iterator i = cache.begin(); i != cache.end(); ++i) {
         delete i->second.first;
     }
     cache.clear();
+    setDecodedCacheSize(0);
+    pthread_mutex_destroy((pthread_mutex_t*) mutex);
+    delete (pthread_mutex_t*) mutex;
 }
 
 void XMLResourceLoader::addPath(const string &path)
@@ -231,6 +234,25 @@ void XMLResourceLoader::addArchive(const string &archive)
     archives.push_back(archive);
 }
 
+void XMLResourceLoader::setDecodeThreads(int n)
+{
+    decodeThreads = n;
+}
+
+void XMLResourceLoader::setDecodedCacheSize(unsigned int size)
+{
+    pthread_mutex_lock((pthread_mutex_t*) mutex);
+    maxDecodedSize = size;
+    while (decodedSize > maxDecodedSize) {
+        map<pair<unsigned long long, bool>, DecodedImage>::iterator i = decodedImages.find(decodedOrder.front());
+        decodedSize -= i->second.size;
+        delete[] i->second.data;
+        decodedImages.erase(i);
+        decodedOrder.pop_front();
+    }
+    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+}
+
 string XMLResourceLoader::findResource(const string &name)
 {
     TiXmlElement desc(name);
@@ -240,6 +262,120 @@ string XMLResourceLoader::findResource(const string &name)
 ptr<ResourceDescriptor> XMLResourceLoader::loadResource(const string &name)
 {
     time_t stamp = 0;
+    TiXmlElement *desc = loadDescriptor(name, stamp);
+    if (desc != NULL) {
+        // when we have the XML part we can load the binary part, if any
+        CompactXML *source = new CompactXML(desc);
+        XMLResourceDescriptor::Stamps dataStamps;
+        try {
+            unsigned int size = 0;
+            unsigned char *data = loadData(desc, size, dataStamps);
+            return new XMLResourceDescriptor(desc, source, data, size, stamp, dataStamps);
+        } catch (...) {
+            delete desc;
+            delete source;
+        }
+    }
+    return NULL;
+}
+
+void XMLResourceLoader::loadResources(const vector<string> &names, vector< ptr<ResourceDescriptor> > &descs)
+{
+    vector<time_t> stamps(names.size(), 0);
+    vector<TiXmlElement*> xmlDescs(names.size(), NULL);
+    vector<int> jobIndices(names.size(), -1);
+    DecodeBatch batch;
+    batch.loader = this;
+    batch.next = 0;
+
+    descs.clear();
+    descs.resize(names.size());
+    // we first load the XML parts, and the binary parts of non texture
+    // resources, in the caller thread (archives are cached in 'cache')
+    for (unsigned int i = 0; i < names.size(); ++i) {
+        TiXmlElement *desc = loadDescriptor(names[i], stamps[i]);
+        if (desc == NULL) {
+            continue;
+        }
+        if (strncmp(desc->Value(), "texture", 7) == 0 && desc->Attribute("source") != NULL) {
+            DecodeJob job;
+            job.desc = desc;
+            job.source = new CompactXML(desc);
+            job.data = NULL;
+            job.size = 0;
+            job.failed = false;
+            jobIndices[i] = batch.jobs.size();
+            batch.jobs.push_back(job);
+        } else {
+            CompactXML *source = new CompactXML(desc);
+            XMLResourceDescriptor::Stamps dataStamps;
+            try {
+                unsigned int size = 0;
+                unsigned char *data = loadData(desc, size, dataStamps);
+                descs[i] = new XMLResourceDescriptor(desc, source, data, size, stamps[i], dataStamps);
+            } catch (...) {
+                delete desc;
+                delete source;
+            }
+        }
+    }
+
+    // we then load the texture images in parallel, the caller thread being
+    // one of the decoding threads
+    int threadCount = decodeThreads > 0 ? decodeThreads : getProcessorCount();
+    threadCount = min(threadCount, int(batch.jobs.size()));
+    if (threadCount > 0) {
+        vector<pthread_t> threads;
+        pthread_mutex_init(&batch.mutex, NULL);
+        for (int i = 0; i < threadCount - 1; ++i) {
+            // if a thread cannot be created its jobs are done by the others
+            pthread_t thread;
+            if (pthread_create(&thread, NULL, decodeThread, &batch) == 0) {
+                threads.push_back(thread);
+            }
+        }
+        decodeThread(&batch);
+        for (unsigned int i = 0; i < threads.size(); ++i) {
+            pthread_join(threads[i], NULL);
+        }
+        pthread_mutex_destroy(&batch.mutex);
+    }
+
+    for (unsigned int i = 0; i < names.size(); ++i) {
+        if (jobIndices[i] >= 0) {
+            DecodeJob &job = batch.jobs[jobIndices[i]];
+            if (job.failed) {
+                delete job.desc;
+                delete job.source;
+            } else {
+                descs[i] = new XMLResourceDescriptor(job.desc, job.source, job.data, job.size, stamps[i], job.stamps);
+            }
+        }
+    }
+}
+
+void *XMLResourceLoader::decodeThread(void *batch)
+{
+    DecodeBatch *b = (DecodeBatch*) batch;
+    while (true) {
+        pthread_mutex_lock(&b->mutex);
+        unsigned int i = b->next++;
+        pthread_mutex_unlock(&b->mutex);
+        if (i >= b->jobs.size()) {
+            break;
+        }
+        DecodeJob &job = b->jobs[i];
+        try {
+            job.data = b->loader->loadData(job.desc, job.size, job.stamps);
+        } catch (...) {
+            job.failed = true;
+        }
+    }
+    return NULL;
+}
+
+TiXmlElement *XMLResourceLoader::loadDescriptor(const string &name, time_t &stamp)
+{
     TiXmlElement *desc = NULL;
     if (strncmp(name.c_str(), "renderbuffer", 12) == 0) {
         // resource names of the form "renderbuffer-X-Y" describe texture
@@ -278,18 +414,7 @@ ptr<ResourceDescriptor> XMLResourceLoader::loadResource(const string &name)
         // which must be loaded
         desc = findDescriptor(name, stamp);
     }
-    if (desc != NULL) {
-        // when we have the XML part we can load the binary part, if any
-        XMLResourceDescriptor::Stamps dataStamps;
-        try {
-            unsigned int size = 0;
-            unsigned char *data = loadData(desc, size, dataStamps);
-            return new XMLResourceDescriptor(desc, data, size, stamp, dataStamps);
-        } catch (...) {
-            delete desc;
-        }
-    }
-    return NULL;
+    return desc;
 }
 
 ptr<ResourceDescriptor> XMLResourceLoader::reloadResource(const string &name, ptr<ResourceDescriptor> currentValue)
@@ -306,29 +431,43 @@ ptr<ResourceDescriptor> XMLResourceLoader::reloadResource(const string &name, pt
         // we first test if the XML part has changed or not. If it has changed
         // desc contains the new value, and stamp the new last modification time
         desc = findDescriptor(name, stamp);
+        if (desc != NULL && CompactXML::equal(CompactXML(desc).getRoot(), cur->source->getRoot())) {
+            // if the file has been modified but its content is the same, we
+            // just remember its new modification time
+            delete desc;
+            desc = NULL;
+            cur->stamp = stamp;
+        }
     }
+    bool changed = desc != NULL;
     if (desc == NULL) {
-        // if the XML part has not changed we clone the current value
-        desc = cur->descriptor->Clone()->ToElement();
+        // if the XML part has not changed we clone its current value
+        desc = CompactXML::toElement(cur->source->getRoot());
     }
     XMLResourceDescriptor::Stamps dataStamps = cur->dataStamps;
-    if (difftime(cur->stamp, stamp) != 0) {
+    if (changed) {
         // if the XML part has changed the files describing the binary part may
         // no longer be the same, so we clear the corresponding modification
         // time vector to force a reloading of the binary part.
         dataStamps.clear();
     }
+    CompactXML *source = new CompactXML(desc);
     try {
         unsigned int size = 0;
-        // we now test if the ASCII or binary part has changed
+        // we now test if the ASCII or binary part has changed; the files are
+        // loaded and decoded only if their content has changed
         unsigned char* data = loadData(desc, size, dataStamps);
-        if (!cur->equal(desc, stamp, dataStamps)) {
+        if (data != NULL || changed) {
             // if the XML part and/or the binary part has changed
-            return new XMLResourceDescriptor(desc, data, size, stamp, dataStamps);
+            return new XMLResourceDescriptor(desc, source, data, size, stamp, dataStamps);
         }
+        // otherwise we just remember the new modification times of the files
+        // whose content has not changed, so that next checks are cheaper
+        cur->dataStamps = dataStamps;
     } catch (...) {
-        delete desc;
     }
+    delete desc;
+    delete source;
     return NULL;
 }
 
@@ -397,7 +536,7 @@ TiXmlElement *XMLResourceLoader::findDescriptor(const string &name, time_t &t, b
     // we first look in the archive files
     for (unsigned int i = 0; i < archives.size(); ++i) {
         time_t u = t;
-        TiXmlDocument *archive = loadArchive(archives[i], u);
+        CompactXML *archive = loadArchive(archives[i], u);
         if (archive != NULL) {
             TiXmlElement *desc = findDescriptor(archive, name);
             if (desc != NULL) {
@@ -427,17 +566,15 @@ TiXmlElement *XMLResourceLoader::findDescriptor(const string &name, time_t &t, b
             }
             unsigned int size = 0;
             unsigned char *data = loadFile(n, size);
-            TiXmlDocument doc(n);
-            if (doc.Parse((const char*) data)) {
+            // the file content is parsed in situ, and the resulting document
+            // owns and deletes it
+            CompactXML doc;
+            if (doc.parse((char*) data)) {
                 if (Logger::INFO_LOGGER != NULL) {
                     Logger::INFO_LOGGER->log("RESOURCE", "Loaded file '" + n + "'");
                 }
-                delete[] data;
-                return doc.RootElement()->Clone()->ToElement();
+                return CompactXML::toElement(doc.getRoot());
             } else {
-                if (data != NULL) {
-                    delete[] data;
-                }
                 if (Logger::ERROR_LOGGER != NULL) {
                     Logger::ERROR_LOGGER->log("RESOURCE", "Syntax error in '" + n + "'");
                 }
@@ -451,23 +588,11 @@ TiXmlElement *XMLResourceLoader::findDescriptor(const string &name, time_t &t, b
     return NULL;
 }
 
-TiXmlElement *XMLResourceLoader::findDescriptor(const TiXmlDocument *archive, const string &name)
+TiXmlElement *XMLResourceLoader::findDescriptor(const CompactXML *archive, const string &name)
 {
-    // we first load the archive ...
-    const TiXmlElement *root = archive->RootElement();
-    if (root != NULL) {
-        // ... then we look for our descriptor in the archive content
-        for (const TiXmlNode *child = root->FirstChild(); child != NULL; child = child->NextSibling()) {
-            const TiXmlElement *desc = child->ToElement();
-            if (desc != NULL) {
-                const char *n = desc->Attribute("name");
-                if (n != NULL && strcmp(n, name.c_str()) == 0) {
-                    return desc->Clone()->ToElement();
-                }
-            }
-        }
-    }
-    return NULL;
+    // the sub elements of the archive root element are indexed by name
+    const CompactXML::Element *desc = archive->findChild(name);
+    return desc == NULL ? NULL : CompactXML::toElement(desc);
 }
 
 TiXmlElement *XMLResourceLoader::buildTextureDescriptor(const string &name)
@@ -507,10 +632,10 @@ TiXmlElement *XMLResourceLoader::buildProgramDescriptor(const string &name)
     return p;
 }
 
-TiXmlDocument *XMLResourceLoader::loadArchive(const string &name, time_t &t)
+CompactXML *XMLResourceLoader::loadArchive(const string &name, time_t &t)
 {
     // we first look in the cache
-    map<string, pair<TiXmlDocument*, time_t> >::iterator i = cache.find(name);
+    map<string, pair<CompactXML*, time_t> >::iterator i = cache.find(name);
     if (i != cache.end()) {
         t = i->second.second;
         // if the last modification time of the file is equal to the last
@@ -523,10 +648,10 @@ TiXmlDocument *XMLResourceLoader::loadArchive(const string &name, time_t &t)
     }
     unsigned int size = 0;
     unsigned char *data = loadFile(name, size);
-    // then we try to load the archive file
-    TiXmlDocument *doc = new TiXmlDocument(name);
-    if (doc->Parse((const char*) data)) {
-        delete[] data;
+    // then we try to load the archive file (the content is parsed in situ,
+    // and owned by the resulting document)
+    CompactXML *doc = new CompactXML();
+    if (doc->parse((char*) data)) {
         if (Logger::INFO_LOGGER != NULL) {
             Logger::INFO_LOGGER->log("RESOURCE", "Loaded file '" + name + "'");
         }
@@ -540,9 +665,6 @@ TiXmlDocument *XMLResourceLoader::loadArchive(const string &name, time_t &t)
         cache[name] = make_pair(doc, t);
         return doc;
     } else {
-        if (data != NULL) {
-            delete[] data;
-        }
         if (Logger::ERROR_LOGGER != NULL) {
             Logger::ERROR_LOGGER->log("RESOURCE", "File not found or syntax error in '" + name + "'");
         }
@@ -594,10 +716,11 @@ unsigned char* XMLResourceLoader::loadData(TiXmlElement *desc, unsigned int &siz
                 desc->Attribute("tessControl") != NULL ||
                 desc->Attribute("tessEvaluation") != NULL ||
                 desc->Attribute("geometry") != NULL ||
-                desc->Attribute("fragment") != NULL)))
+                desc->Attribute("fragment") != NULL ||
+                desc->Attribute("compute") != NULL)))
             {
                 // a module may not have a 'source' attribute if it has one
-                // of the vertex, tessControl, ... or fragment attribute
+                // of the vertex, tessControl, ..., fragment or compute attribute
                 if (Logger::ERROR_LOGGER != NULL) {
                     Resource::log(Logger::ERROR_LOGGER, desc, desc, "Missing 'source' attribute");
                 }
@@ -612,13 +735,17 @@ unsigned char* XMLResourceLoader::loadData(TiXmlElement *desc, unsigned int &siz
         if (stamps.size() == 0) { // if the binary part has not been loaded yet
             doLoad = true; // we load it
         } else {
-            // otherwise we load it only if the last modification times have changed
+            // otherwise we load it only if the last modification times have
+            // changed, and if the content of the modified files has changed
             for (unsigned int i = 0; i < stamps.size(); ++i) {
                 time_t newt = 0;
                 getTimeStamp(stamps[i].first, newt);
                 if (difftime(newt, stamps[i].second) != 0) {
-                    doLoad = true;
-                    break;
+                    if (!hasSameContent(stamps[i].first, stamps[i].second, newt)) {
+                        doLoad = true;
+                        break;
+                    }
+                    stamps[i].second = newt;
                 }
             }
         }
@@ -664,7 +791,14 @@ unsigned char* XMLResourceLoader::loadData(TiXmlElement *desc, unsigned int &siz
                 unsigned char *data = loadFile(path, fragmentSize);
                 fragmentData = loadShaderData(desc, paths, path, data, fragmentSize, stamps);
             }
-            size = vertexSize + tessControlSize + tessEvalSize + geometrySize + fragmentSize + 5;
+            unsigned char *computeData = NULL;
+            unsigned int computeSize = 0;
+            if (desc->Attribute("compute") != NULL) {
+                string path = findFile(desc, paths, desc->Attribute("compute"));
+                unsigned char *data = loadFile(path, computeSize);
+                computeData = loadShaderData(desc, paths, path, data, computeSize, stamps);
+            }
+            size = vertexSize + tessControlSize + tessEvalSize + geometrySize + fragmentSize + computeSize + 6;
             unsigned char *data = new unsigned char[size];
             unsigned int offset = 0;
             if (vertexData != NULL) {
@@ -697,6 +831,12 @@ unsigned char* XMLResourceLoader::loadData(TiXmlElement *desc, unsigned int &siz
                 delete[] fragmentData;
             }
             data[offset++] = 0;
+            if (computeData != NULL) {
+                memcpy(data + offset, computeData, computeSize);
+                offset += computeSize;
+                delete[] computeData;
+            }
+            data[offset++] = 0;
             return data;
         }
 
@@ -716,9 +856,7 @@ unsigned char* XMLResourceLoader::loadData(TiXmlElement *desc, unsigned int &siz
                    strcmp(desc->Value(), "program") == 0)
         {
             // for a mesh or compiled program resource, no processing is needed
-            time_t t;
-            getTimeStamp(path, t);
-            stamps.push_back(make_pair(path, t));
+            addStamp(path, data, size, stamps);
             return data;
         } else {
             // for a texture we need to decompress the file (PNG, JPG, etc)
@@ -731,9 +869,7 @@ unsigned char* XMLResourceLoader::loadData(TiXmlElement *desc, unsigned int &siz
 unsigned char* XMLResourceLoader::loadShaderData(TiXmlElement *desc, const vector<string> &paths,
         const string &path, unsigned char *data, unsigned int &size, vector< pair<string, time_t> > &stamps)
 {
-    time_t t = 0;
-    getTimeStamp(path, t);
-    stamps.push_back(make_pair(path, t));
+    addStamp(path, data, size, stamps);
     if (strstr((char*) data, "#include") == NULL) {
         // if there is no #include directive in 'data' then we can directly return
         return data;
@@ -780,17 +916,10 @@ unsigned char* XMLResourceLoader::loadShaderData(TiXmlElement *desc, const vecto
                             delete[] data;
                             throw exception();
                         }
-                        unsigned int incSize;
-                        // we can then load the content of the referenced file
-                        unsigned char* incData = loadFile(incFile, incSize);
-                        // and then analyze its content with a recursive call
-                        // to process the #include directives that this file may
-                        // in turn contain
-                        unsigned char* incShader = loadShaderData(desc, paths, incFile, incData, incSize, stamps);
-                        // finally we append this processed content to the
-                        // result data, instead of the #include directive itself
-                        result.append((char*) incShader);
-                        delete[] incShader;
+                        // we can then append the processed content of the
+                        // referenced file to the result data, instead of the
+                        // #include directive itself
+                        loadIncludeData(desc, paths, incFile, result, stamps);
 
                         i = (e - (char*) data) + 1;
                         continue;
@@ -823,6 +952,72 @@ unsigned char* XMLResourceLoader::loadShaderData(TiXmlElement *desc, const vecto
 
 unsigned char* XMLResourceLoader::loadTextureData(TiXmlElement *desc, const string &path,
         unsigned char *data, unsigned int &size, vector< pair<string, time_t> > &stamps)
+{
+    unsigned long long hash = addStamp(path, data, size, stamps);
+    // floating point images are converted to half floats if they are
+    // stored in a 16 bits floating point texture
+    const char *f = desc->Attribute("internalformat");
+    bool half = f != NULL && (strcmp(f, "R16F") == 0 || strcmp(f, "RG16F") == 0 ||
+        strcmp(f, "RGB16F") == 0 || strcmp(f, "RGBA16F") == 0);
+
+    DecodedImage image;
+    unsigned char *result = NULL;
+    // we first look for this image in the cache of decoded images
+    pthread_mutex_lock((pthread_mutex_t*) mutex);
+    map<pair<unsigned long long, bool>, DecodedImage>::iterator i = decodedImages.find(make_pair(hash, half));
+    if (i != decodedImages.end()) {
+        image = i->second;
+        result = new unsigned char[image.size];
+        memcpy(result, image.data, image.size);
+        decodedOrder.splice(decodedOrder.end(), decodedOrder, image.lru);
+    }
+    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+
+    if (result != NULL) {
+        delete[] data;
+    } else {
+        // if it is not found we decode it and put a copy in the cache
+        decodeImage(path, data, size, half, image);
+        result = image.data;
+        if (image.size <= maxDecodedSize) {
+            pthread_mutex_lock((pthread_mutex_t*) mutex);
+            pair<unsigned long long, bool> key = make_pair(hash, half);
+            if (decodedImages.find(key) == decodedImages.end()) {
+                image.data = new unsigned char[image.size];
+                memcpy(image.data, result, image.size);
+                image.lru = decodedOrder.insert(decodedOrder.end(), key);
+                decodedImages[key] = image;
+                decodedSize += image.size;
+                while (decodedSize > maxDecodedSize) {
+                    i = decodedImages.find(decodedOrder.front());
+                    decodedSize -= i->second.size;
+                    delete[] i->second.data;
+                    decodedImages.erase(i);
+                    decodedOrder.pop_front();
+                }
+            }
+            pthread_mutex_unlock((pthread_mutex_t*) mutex);
+        }
+    }
+
+    if (image.depth > 0) {
+        desc->SetAttribute("depth", image.depth);
+    }
+    desc->SetAttribute("width", image.width);
+    if (desc->Attribute("height") == NULL) {
+        desc->SetAttribute("height", image.height);
+    }
+    if (desc->Attribute("format") == NULL) {
+        const char *formats[4] = { "RED", "RG", "RGB", "RGBA" };
+        desc->SetAttribute("format", formats[image.channels - 1]);
+    }
+    desc->SetAttribute("type", image.type);
+    size = image.size;
+    return result;
+}
+
+void XMLResourceLoader::decodeImage(const string &path, unsigned char *data, unsigned int size,
+        bool half, DecodedImage &image)
 {
     unsigned char* trailer = data + size - 5 * sizeof(int);
     unsigned char *result = NULL;
@@ -839,9 +1034,6 @@ unsigned char* XMLResourceLoader::loadTextureData(TiXmlElement *desc, const stri
         d = ((int*) trailer)[3]; // texture depth (0 for 2D textures)
         channels = ((int*) trailer)[4]; // number of channels per pixel (1..4)
         result = data;
-        if (d > 0) {
-            desc->SetAttribute("depth", d);
-        }
     } else if (hdr) { // file in radiance HDR file format
         result = (unsigned char*) stbi_loadf_from_memory(data, size, &w, &h, &channels, 0);
         delete[] data;
@@ -855,28 +1047,7 @@ unsigned char* XMLResourceLoader::loadTextureData(TiXmlElement *desc, const stri
         }
         throw exception();
     }
-
-    desc->SetAttribute("width", w);
-    if (desc->Attribute("height") == NULL) {
-        desc->SetAttribute("height", h);
-    }
-    if (channels == 1) {
-        if (desc->Attribute("format") == NULL) {
-            desc->SetAttribute("format", "RED");
-        }
-    } else if (channels == 2) {
-        if (desc->Attribute("format") == NULL) {
-            desc->SetAttribute("format", "RG");
-        }
-    } else if (channels == 3) {
-        if (desc->Attribute("format") == NULL) {
-            desc->SetAttribute("format", "RGB");
-        }
-    } else if (channels == 4) {
-        if (desc->Attribute("format") == NULL) {
-            desc->SetAttribute("format", "RGBA");
-        }
-    } else {
+    if (channels < 1 || channels > 4) {
         if (raw) {
             delete[] data;
         } else {
@@ -887,39 +1058,170 @@ unsigned char* XMLResourceLoader::loadTextureData(TiXmlElement *desc, const stri
         }
         throw exception();
     }
-    if (raw || hdr) {
-        desc->SetAttribute("type", "FLOAT");
-    } else {
-        desc->SetAttribute("type", "UNSIGNED_BYTE");
-    }
 
-    int lineSize = w * channels * (raw || hdr ? sizeof(float) : 1);
-    size = lineSize * h;
+    half = half && (raw || hdr);
+    image.width = w;
+    image.height = h;
+    image.depth = d;
+    image.channels = channels;
+    image.type = half ? "HALF" : (raw || hdr ? "FLOAT" : "UNSIGNED_BYTE");
 
-    unsigned char* flippedResult;
+    int srcLineSize = w * channels * (raw || hdr ? sizeof(float) : 1);
+    int lineSize = half ? w * channels * sizeof(unsigned short) : srcLineSize;
+    image.size = lineSize * h;
 
-    if (raw) {
-        flippedResult = result;
+    if (raw && !half) {
+        image.data = result;
     } else {
         // all formats except 'raw' store the image from top to bottom
         // while OpenGL requires a bottom to top layout; so we revert the
         // order of lines here to get a good orientation in OpenGL
-        flippedResult = new unsigned char[lineSize * h];
+        image.data = new unsigned char[lineSize * h];
         int srcOffset = 0;
-        int dstOffset = lineSize * (h - 1);
+        int dstOffset = raw ? 0 : lineSize * (h - 1);
+        int dstStep = raw ? lineSize : -lineSize;
         for (int i = 0; i < h; ++i) {
-            memcpy(flippedResult + dstOffset, result + srcOffset, lineSize);
-            srcOffset += lineSize;
-            dstOffset -= lineSize;
+            if (half) {
+                const float *src = (const float*) (result + srcOffset);
+                unsigned short *dst = (unsigned short*) (image.data + dstOffset);
+                for (int j = 0; j < w * channels; ++j) {
+                    dst[j] = floatToHalf(src[j]);
+                }
+            } else {
+                memcpy(image.data + dstOffset, result + srcOffset, lineSize);
+            }
+            srcOffset += srcLineSize;
+            dstOffset += dstStep;
+        }
+        if (raw) {
+            delete[] result;
+        } else {
+            stbi_image_free(result);
         }
-        stbi_image_free(result);
     }
+}
 
+unsigned long long XMLResourceLoader::addStamp(const string &path, const unsigned char *data, unsigned int size,
+        vector< pair<string, time_t> > &stamps)
+{
     time_t t = 0;
     getTimeStamp(path, t);
     stamps.push_back(make_pair(path, t));
+    unsigned long long hash = getContentHash(data, size);
+    pthread_mutex_lock((pthread_mutex_t*) mutex);
+    fileHashes[path] = make_pair(t, hash);
+    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+    return hash;
+}
 
-    return flippedResult;
+bool XMLResourceLoader::hasSameContent(const string &path, time_t oldTime, time_t newTime)
+{
+    pthread_mutex_lock((pthread_mutex_t*) mutex);
+    map<string, pair<time_t, unsigned long long> >::iterator i = fileHashes.find(path);
+    bool found = i != fileHashes.end() && difftime(i->second.first, oldTime) == 0;
+    unsigned long long oldHash = found ? i->second.second : 0;
+    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+    if (!found) {
+        return false;
+    }
+    unsigned int size;
+    unsigned char *data;
+    try {
+        data = loadFile(path, size);
+    } catch (...) {
+        return false;
+    }
+    unsigned long long newHash = getContentHash(data, size);
+    delete[] data;
+    pthread_mutex_lock((pthread_mutex_t*) mutex);
+    fileHashes[path] = make_pair(newTime, newHash);
+    // if this file is a cached shader include file we update its stamp or,
+    // if its content has changed, we remove it and the files that include it
+    map<string, IncludeFile>::iterator j = includeFiles.find(path);
+    if (j != includeFiles.end() && j->second.hash == newHash) {
+        j->second.stamp = newTime;
+    } else {
+        removeIncludeFile(path);
+    }
+    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+    return newHash == oldHash;
+}
+
+void XMLResourceLoader::loadIncludeData(TiXmlElement *desc, const vector<string> &paths,
+        const string &path, string &result, vector< pair<string, time_t> > &stamps)
+{
+    pthread_mutex_lock((pthread_mutex_t*) mutex);
+    map<string, IncludeFile>::iterator i = includeFiles.find(path);
+    if (i != includeFiles.end()) {
+        // the files may have changed since they were cached, so we must
+        // check their last modification times
+        time_t t = 0;
+        getTimeStamp(path, t);
+        bool valid = difftime(t, i->second.stamp) == 0;
+        for (unsigned int j = 0; valid && j < i->second.dependencies.size(); ++j) {
+            const string &dep = i->second.dependencies[j];
+            map<string, IncludeFile>::iterator k = includeFiles.find(dep);
+            getTimeStamp(dep, t);
+            valid = k != includeFiles.end() && difftime(t, k->second.stamp) == 0;
+        }
+        if (!valid) {
+            removeIncludeFile(path);
+            i = includeFiles.end();
+        }
+    }
+    if (i != includeFiles.end()) {
+        // if the file is in the cache we directly use its expanded content
+        result.append(i->second.data);
+        stamps.push_back(make_pair(path, i->second.stamp));
+        for (unsigned int j = 0; j < i->second.dependencies.size(); ++j) {
+            map<string, IncludeFile>::iterator k = includeFiles.find(i->second.dependencies[j]);
+            if (k != includeFiles.end()) {
+                stamps.push_back(make_pair(k->first, k->second.stamp));
+            }
+        }
+        pthread_mutex_unlock((pthread_mutex_t*) mutex);
+        return;
+    }
+    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+
+    // otherwise we load the content of the referenced file, and analyze it
+    // with a recursive call to process the #include directives that this file
+    // may in turn contain
+    unsigned int size;
+    unsigned char *data = loadFile(path, size);
+    vector< pair<string, time_t> > incStamps;
+    data = loadShaderData(desc, paths, path, data, size, incStamps);
+    result.append((char*) data);
+
+    // finally we put the result in the cache, and we update the include
+    // dependency graph
+    pthread_mutex_lock((pthread_mutex_t*) mutex);
+    IncludeFile &f = includeFiles[path];
+    f.stamp = incStamps[0].second;
+    f.hash = fileHashes[path].second;
+    f.data = (char*) data;
+    f.dependencies.clear();
+    for (unsigned int j = 1; j < incStamps.size(); ++j) {
+        f.dependencies.push_back(incStamps[j].first);
+        includedBy[incStamps[j].first].insert(path);
+    }
+    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+    delete[] data;
+    stamps.insert(stamps.end(), incStamps.begin(), incStamps.end());
+}
+
+void XMLResourceLoader::removeIncludeFile(const string &path)
+{
+    map<string, set<string> >::iterator i = includedBy.find(path);
+    if (i != includedBy.end()) {
+        set<string>::iterator j = i->second.begin();
+        while (j != i->second.end()) {
+            includeFiles.erase(*j);
+            ++j;
+        }
+        includedBy.erase(i);
+    }
+    includeFiles.erase(path);
 }
 
 }
@@ -42,8 +42,11 @@
 #ifndef _ORK_XML_RESOURCE_LOADER_H_
 #define _ORK_XML_RESOURCE_LOADER_H_
 
+#include <list>
 #include <map>
+#include <set>
 #include <vector>
+#include "ork/resource/CompactXML.h"
 #include "ork/resource/ResourceLoader.h"
 
 namespace ork
@@ -82,6 +85,23 @@ public:
      */
     void addArchive(const std::string &archive);
 
+    /**
+     * Sets the number of threads used by #loadResources to decode texture
+     * images.
+     *
+     * @param n a number of threads, or 0 to use one thread per processor.
+     */
+    void setDecodeThreads(int n);
+
+    /**
+     * Sets the maximum size of the cache of decoded texture images. This
+     * cache is used to avoid decoding several times the same image file,
+     * when it is used by several resources or reloaded with the same content.
+     *
+     * @param size a size in bytes, or 0 to disable the cache.
+     */
+    void setDecodedCacheSize(unsigned int size);
+
     /**
      * Returns the path of the resource of the given name.
      *
@@ -101,7 +121,23 @@ public:
     virtual ptr<ResourceDescriptor> loadResource(const std::string &name);
 
     /**
-     * Reloads the ResourceDescriptor of the given name.
+     * Loads the ResourceDescriptor of the given names. The XML parts, and
+     * the ASCII or binary parts of non texture resources, are loaded in the
+     * caller thread. The texture images are then read, decoded, flipped and
+     * converted (see #loadTextureData) concurrently by several threads (see
+     * #setDecodeThreads).
+     *
+     * @param names the names of the ResourceDescriptor to be loaded.
+     * @param[out] descs returns the ResourceDescriptor of the given names,
+     *      in the same order, with NULL for the resources that are not found.
+     */
+    virtual void loadResources(const std::vector<std::string> &names, std::vector< ptr<ResourceDescriptor> > &descs);
+
+    /**
+     * Reloads the ResourceDescriptor of the given name. The XML part, and
+     * the files of the ASCII or binary part, are reloaded only if their last
+     * modification time has changed. In this case their content is compared
+     * with the previous one, via a content hash, before any decoding.
      *
      * @param name the name of the ResourceDescriptor to be loaded.
      * @param currentValue the current value of this ResourceDescriptor.
@@ -154,7 +190,187 @@ private:
      * A cache of the archive files. Maps archive file names to archive content
      * and last modification time on disk.
      */
-    std::map<std::string, std::pair<TiXmlDocument*, time_t> > cache;
+    std::map<std::string, std::pair<CompactXML*, time_t> > cache;
+
+    /**
+     * The number of threads used by #loadResources to decode texture images,
+     * or 0 to use one thread per processor.
+     */
+    int decodeThreads;
+
+    /**
+     * A decoded texture image.
+     */
+    struct DecodedImage
+    {
+        int width; ///< the image width
+
+        int height; ///< the image height
+
+        int depth; ///< the image depth (0 for 2D images)
+
+        int channels; ///< the number of components per pixel
+
+        const char *type; ///< the pixel type of #data, as a PixelType name
+
+        unsigned char *data; ///< the decoded pixels
+
+        unsigned int size; ///< the size of #data in bytes
+
+        std::list< std::pair<unsigned long long, bool> >::iterator lru; ///< position in #decodedOrder
+    };
+
+    /**
+     * The last modification time and content hash of the loaded files, for
+     * each file name. Only the last loaded version of each file is recorded.
+     */
+    std::map<std::string, std::pair<time_t, unsigned long long> > fileHashes;
+
+    /**
+     * The cached decoded images. Maps the content hash of an image file, and
+     * whether half float packing was requested, to the decoded image.
+     */
+    std::map<std::pair<unsigned long long, bool>, DecodedImage> decodedImages;
+
+    /**
+     * The keys of #decodedImages, from the least recently to the most
+     * recently used.
+     */
+    std::list< std::pair<unsigned long long, bool> > decodedOrder;
+
+    /**
+     * The total size in bytes of the images in #decodedImages.
+     */
+    unsigned int decodedSize;
+
+    /**
+     * The maximum size in bytes of the images in #decodedImages.
+     */
+    unsigned int maxDecodedSize;
+
+    /**
+     * A shader file referenced by a #include directive, with its own #include
+     * directives already expanded.
+     */
+    struct IncludeFile
+    {
+        time_t stamp; ///< the last modification time of this file
+
+        unsigned long long hash; ///< the content hash of this file
+
+        std::string data; ///< the content of this file, with includes expanded
+
+        /**
+         * The files included directly or indirectly by this file.
+         */
+        std::vector<std::string> dependencies;
+    };
+
+    /**
+     * The cached shader include files. Maps absolute file names to their
+     * expanded content. An entry is removed when the content of its file,
+     * or of one of its dependencies, changes (see #hasSameContent).
+     */
+    std::map<std::string, IncludeFile> includeFiles;
+
+    /**
+     * The include dependency graph. Maps each file of #includeFiles, or
+     * included by one of them, to the cached files that include it directly
+     * or indirectly.
+     */
+    std::map<std::string, std::set<std::string> > includedBy;
+
+    /**
+     * The mutex used to access #fileHashes, #decodedImages and #includeFiles,
+     * which are used by the threads created in #loadResources.
+     */
+    void *mutex;
+
+    /**
+     * Returns the XML part of the ResourceDescriptor of the given name. This
+     * XML part is either generated from the name, for image files, meshes,
+     * programs and render buffers, or loaded with #findDescriptor.
+     *
+     * @param name the name of a ResourceDescriptor.
+     * @param[out] t the last modification time of this %resource descriptor.
+     * @return the XML part of the ResourceDescriptor of the given name, or
+     *      NULL if the %resource is not found.
+     */
+    TiXmlElement *loadDescriptor(const std::string &name, time_t &t);
+
+    /**
+     * Adds the last modification time of a loaded file to the given stamps,
+     * and records its content hash.
+     *
+     * @param path the name of a loaded file.
+     * @param data the content of this file.
+     * @param size the size of data in bytes.
+     * @param[in,out] stamps the last modification times where the stamp of
+     *      the file must be added.
+     * @return the content hash of the file.
+     */
+    unsigned long long addStamp(const std::string &path, const unsigned char *data, unsigned int size,
+            std::vector< std::pair<std::string, time_t> > &stamps);
+
+    /**
+     * Returns true if the content of a file, whose last modification time
+     * has changed, is the same as the content it had when it was loaded.
+     * Returns false if the content hash of the file at its old modification
+     * time is no longer known, i.e. if the file has already been checked or
+     * loaded again since it was modified.
+     *
+     * @param path a file name.
+     * @param oldTime the last modification time of this file when it was
+     *      loaded.
+     * @param newTime its current last modification time.
+     */
+    bool hasSameContent(const std::string &path, time_t oldTime, time_t newTime);
+
+    /**
+     * Appends the content of a shader file referenced by a #include
+     * directive, with its own #include directives expanded. The expanded
+     * content is cached in #includeFiles, so that a shader file included by
+     * several modules is read and parsed only once.
+     *
+     * @param desc the XML part of the module that includes this file.
+     * @param paths the directories where included files must be looked for.
+     * @param path the absolute name of the included file.
+     * @param[in,out] result the string where the expanded content of the
+     *      included file must be appended.
+     * @param[in,out] stamps the last modification times where the stamps of
+     *      this file and of the files it includes must be added.
+     */
+    void loadIncludeData(TiXmlElement *desc, const std::vector<std::string> &paths,
+            const std::string &path, std::string &result, std::vector< std::pair<std::string, time_t> > &stamps);
+
+    /**
+     * Removes a shader file, and the files that include it, from the include
+     * cache. Must be called with #mutex locked.
+     *
+     * @param path the absolute name of a shader file.
+     */
+    void removeIncludeFile(const std::string &path);
+
+    /**
+     * Decodes a texture image and flips it vertically. Floating point
+     * images are converted to half floats in the same pass if requested.
+     *
+     * @param path the absolute name of the file containing the texture image.
+     * @param data the encoded image data. Deleted by this method.
+     * @param size the size of the encoded image data.
+     * @param half true to convert floating point images to half floats.
+     * @param[out] image the decoded image.
+     */
+    void decodeImage(const std::string &path, unsigned char *data, unsigned int size,
+            bool half, DecodedImage &image);
+
+    /**
+     * The main function of the threads created by #loadResources to load
+     * texture images.
+     *
+     * @param batch the texture images to be loaded and the next one to load.
+     */
+    static void *decodeThread(void *batch);
 
     /**
      * Returns the XML part of the ResourceDescriptor of the given name. This
@@ -181,7 +397,7 @@ private:
      * @return the XML part of the ResourceDescriptor, or NULL if the archive
      *      file does not contain this %resource descriptor.
      */
-    static TiXmlElement *findDescriptor(const TiXmlDocument *archive, const std::string &name);
+    static TiXmlElement *findDescriptor(const CompactXML *archive, const std::string &name);
 
     /**
      * Builds the XML part of texture %resource descriptors for the special textures
@@ -203,7 +419,7 @@ private:
      * @return the archive file of the given name, or NULL if this file is not
      *      found.
      */
-    TiXmlDocument *loadArchive(const std::string &name, time_t &t);
+    CompactXML *loadArchive(const std::string &name, time_t &t);
 
     /**
      * Loads the ASCII or binary part of a ResourceDescriptor.
@@ -242,7 +458,10 @@ private:
             const std::string &path, unsigned char *data, unsigned int &size, std::vector< std::pair<std::string, time_t> > &stamps);
 
     /**
-     * Loads the binary part of a texture %resource.
+     * Loads the binary part of a texture %resource. The image is decoded and
+     * flipped vertically. Floating point images whose internal format is a
+     * 16 bits floating point format are converted to half floats in the same
+     * pass, in order to halve the size of the data uploaded to the GPU.
      *
      * @param desc the XML part of the texture %resource descriptor.
      * @param path the absolute name of the file containing the texture image.
@@ -41,13 +41,13 @@
 
 #include "ork/scenegraph/AbstractTask.h"
 
-#include "ork/scenegraph/SceneManager.h"
-
 using namespace std;
 
 namespace ork
 {
 
+static const Symbol THIS_SYMBOL("this");
+
 AbstractTask::AbstractTask(const char* type) :
     TaskFactory(type)
 {
@@ -70,20 +70,30 @@ AbstractTask::QualifiedName::QualifiedName(const string &n)
     } else {
         name = n;
     }
+    targetSymbol = Symbol(target.size() > 0 && target[0] == '$' ? target.substr(1) : target);
+    nameSymbol = Symbol(name);
 }
 
 ptr<SceneNode> AbstractTask::QualifiedName::getTarget(ptr<SceneNode> context)
 {
     if (target.size() == 0) {
         return NULL;
-    } else if (strcmp(target.c_str(), "this") == 0) {
-        return context;
     } else if (target[0] == '$') {
-        return context->getOwner()->getNodeVar(target.substr(1));
+        return context->getOwner()->getNodeVar(targetSymbol);
+    } else if (targetSymbol == THIS_SYMBOL) {
+        return context;
     } else {
-        SceneManager::NodeIterator i = context->getOwner()->getNodes(target);
+        SceneManager::NodeIterator i = context->getOwner()->getNodes(targetSymbol);
         return i.hasNext() ? i.next() : NULL;
     }
 }
 
+SceneNode *AbstractTask::QualifiedName::getVariable(ptr<SceneNode> context)
+{
+    if (target.size() > 0 && target[0] == '$') {
+        return context->getOwner()->getNodeVar(targetSymbol).get();
+    }
+    return NULL;
+}
+
 }
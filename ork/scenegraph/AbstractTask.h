@@ -43,7 +43,7 @@
 #define _ORK_ABSTRACT_TASK_H_
 
 #include "ork/taskgraph/TaskFactory.h"
-#include "ork/scenegraph/SceneNode.h"
+#include "ork/scenegraph/SceneManager.h"
 
 namespace ork
 {
@@ -86,6 +86,17 @@ protected:
          */
         std::string name;
 
+        /**
+         * The symbol of the scene node flag or loop variable designated by
+         * #target (without the '$' prefix for loop variables).
+         */
+        Symbol targetSymbol;
+
+        /**
+         * The symbol of #name.
+         */
+        Symbol nameSymbol;
+
         /**
          * Creates an empty qualified name.
          */
@@ -106,6 +117,91 @@ protected:
          *      be looked for.
          */
         ptr<SceneNode> getTarget(ptr<SceneNode> context);
+
+        /**
+         * Returns the SceneNode currently bound to the loop variable
+         * designated by #target, or NULL if #target is not a loop variable.
+         *
+         * @param context the scene graph into which the loop variable must
+         *      be looked for.
+         */
+        SceneNode *getVariable(ptr<SceneNode> context);
+    };
+
+    /**
+     * A cache of values resolved from qualified names, such as meshes,
+     * modules or methods. Each value is associated with the SceneNode
+     * context in which it was resolved and, for qualified names referring
+     * to a loop variable, with the node bound to this variable. The whole
+     * cache is cleared when the scene graphs change (see
+     * SceneManager#getVersion), so that steady state frames can reuse these
+     * values without looking them up again.
+     */
+    template <class T>
+    class BindingCache
+    {
+    public:
+        /**
+         * Creates an empty cache.
+         */
+        BindingCache() : version(0)
+        {
+        }
+
+        /**
+         * Returns the value cached for the given context and variable nodes,
+         * or NULL if there is no such value.
+         *
+         * @param context the context in which the value was resolved.
+         * @param variable the loop variable node used to resolve it, or NULL.
+         */
+        T *find(SceneNode *context, SceneNode *variable)
+        {
+            if (version != SceneManager::getVersion()) {
+                values.clear();
+                version = SceneManager::getVersion();
+                return NULL;
+            }
+            typename std::map<std::pair<SceneNode*, SceneNode*>, T>::iterator i;
+            i = values.find(std::make_pair(context, variable));
+            return i == values.end() ? NULL : &(i->second);
+        }
+
+        /**
+         * Caches a value for the given context and variable nodes.
+         *
+         * @param context the context in which the value was resolved.
+         * @param variable the loop variable node used to resolve it, or NULL.
+         * @param value the resolved value.
+         */
+        void put(SceneNode *context, SceneNode *variable, const T &value)
+        {
+            if (version != SceneManager::getVersion()) {
+                values.clear();
+                version = SceneManager::getVersion();
+            }
+            values[std::make_pair(context, variable)] = value;
+        }
+
+        /**
+         * Removes all the values of this cache.
+         */
+        void clear()
+        {
+            values.clear();
+        }
+
+    private:
+        /**
+         * The version of the scene graphs for which the cached values are
+         * valid.
+         */
+        unsigned int version;
+
+        /**
+         * The cached values.
+         */
+        std::map<std::pair<SceneNode*, SceneNode*>, T> values;
     };
 };
 
@@ -72,10 +72,15 @@ CallMethodTask::~CallMethodTask()
 ptr<Task> CallMethodTask::getTask(ptr<Object> context)
 {
     ptr<SceneNode> n = context.cast<Method>()->getOwner();
-    ptr<SceneNode> target = method.getTarget(n);
-    if (target != NULL) {
-        ptr<Method> m = target->getMethod(method.name);
+    SceneNode *v = method.getVariable(n);
+    ptr<Method> *cached = methods.find(n.get(), v);
+    ptr<SceneNode> target = cached == NULL ? method.getTarget(n) : NULL;
+    if (cached != NULL || target != NULL) {
+        ptr<Method> m = cached != NULL ? *cached : target->getMethod(method.nameSymbol);
         if (m != NULL) {
+            if (cached == NULL) {
+                methods.put(n.get(), v, m);
+            }
             if (m->isEnabled()) {
                 return m->getTask();
             } else {
@@ -92,6 +97,8 @@ ptr<Task> CallMethodTask::getTask(ptr<Object> context)
 void CallMethodTask::swap(ptr<CallMethodTask> t)
 {
     std::swap(method, t->method);
+    methods.clear();
+    t->methods.clear();
 }
 
 /// @cond RESOURCES
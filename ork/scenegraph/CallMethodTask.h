@@ -99,6 +99,11 @@ private:
      * the method that must be called.
      */
     QualifiedName method;
+
+    /**
+     * The methods resolved by #getTask.
+     */
+    BindingCache< ptr<Method> > methods;
 };
 
 }
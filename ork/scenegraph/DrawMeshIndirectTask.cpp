@@ -0,0 +1,319 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+
+#include "ork/scenegraph/DrawMeshIndirectTask.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "ork/render/FrameBuffer.h"
+#include "ork/resource/ResourceTemplate.h"
+#include "ork/scenegraph/SceneManager.h"
+
+using namespace std;
+
+namespace ork
+{
+
+/**
+ * The compute shader that culls the scene nodes. The same planes as in
+ * SceneManager#getVisibility are used, i.e. the far plane is ignored.
+ */
+static const char *CULL_SHADER = "\
+#ifdef _COMPUTE_\n\
+layout(local_size_x = 64) in;\n\
+struct Node {\n\
+    mat4 localToWorld;\n\
+    vec4 worldMin;\n\
+    vec4 worldMax;\n\
+};\n\
+layout(std430, row_major) readonly buffer Nodes { Node nodes[]; };\n\
+layout(std430, row_major) writeonly buffer Visible { mat4 visible[]; };\n\
+layout(std430) buffer Command { uint command[5]; };\n\
+uniform uint nodeCount;\n\
+uniform vec4 frustumPlanes[5];\n\
+void main() {\n\
+    uint i = gl_GlobalInvocationID.x;\n\
+    if (i >= nodeCount) {\n\
+        return;\n\
+    }\n\
+    vec3 bmin = nodes[i].worldMin.xyz;\n\
+    vec3 bmax = nodes[i].worldMax.xyz;\n\
+    for (int j = 0; j < 5; ++j) {\n\
+        vec4 p = frustumPlanes[j];\n\
+        if (dot(mix(bmin, bmax, step(0.0, p.xyz)), p.xyz) + p.w <= 0.0) {\n\
+            return;\n\
+        }\n\
+    }\n\
+    visible[atomicAdd(command[1], 1u)] = nodes[i].localToWorld;\n\
+}\n\
+#endif\n";
+
+/**
+ * Writes the local to world transform and the world bounds of the given
+ * node, in the layout of the Node struct of CULL_SHADER.
+ */
+static void getNode(ptr<SceneNode> n, float node[24])
+{
+    mat4f l = n->getLocalToWorld().cast<float>();
+    box3d b = n->getWorldBounds();
+    copy(l.coefficients(), l.coefficients() + 16, node);
+    node[16] = float(b.xmin);
+    node[17] = float(b.ymin);
+    node[18] = float(b.zmin);
+    node[19] = 1.0f;
+    node[20] = float(b.xmax);
+    node[21] = float(b.ymax);
+    node[22] = float(b.zmax);
+    node[23] = 1.0f;
+}
+
+DrawMeshIndirectTask::DrawMeshIndirectTask() : AbstractTask("DrawMeshIndirectTask")
+{
+}
+
+DrawMeshIndirectTask::DrawMeshIndirectTask(const QualifiedName &mesh, const string &flag, const string &block) :
+    AbstractTask("DrawMeshIndirectTask")
+{
+    init(mesh, flag, block);
+}
+
+void DrawMeshIndirectTask::init(const QualifiedName &mesh, const string &flag, const string &block)
+{
+    this->mesh = mesh;
+    this->flag = Symbol(flag);
+    this->block = block;
+    this->manager = NULL;
+    this->nodesVersion = 0;
+    this->frameNumber = 0;
+    this->capacity = 0;
+}
+
+DrawMeshIndirectTask::~DrawMeshIndirectTask()
+{
+}
+
+ptr<Task> DrawMeshIndirectTask::getTask(ptr<Object> context)
+{
+    ptr<SceneNode> n = context.cast<Method>()->getOwner();
+    SceneNode *v = mesh.getVariable(n);
+    ptr<MeshBuffers> *cached = meshes.find(n.get(), v);
+    if (cached != NULL) {
+        return new Impl(this, n, *cached);
+    }
+    ptr<SceneNode> target = mesh.getTarget(n);
+    ptr<MeshBuffers> m = NULL;
+    if (target == NULL) {
+        m = n->getOwner()->getResourceManager()->loadResource(mesh.name + ".mesh").cast<MeshBuffers>();
+    } else {
+        m = target->getMesh(mesh.nameSymbol);
+    }
+    if (m == NULL) {
+        if (Logger::ERROR_LOGGER != NULL) {
+            Logger::ERROR_LOGGER->log("SCENEGRAPH", "DrawMeshIndirect : cannot find mesh '" + mesh.target + "." + mesh.name + "'");
+        }
+        throw exception();
+    }
+    meshes.put(n.get(), v, m);
+    return new Impl(this, n, m);
+}
+
+void DrawMeshIndirectTask::swap(ptr<DrawMeshIndirectTask> t)
+{
+    std::swap(mesh, t->mesh);
+    std::swap(flag, t->flag);
+    std::swap(block, t->block);
+    meshes.clear();
+    t->meshes.clear();
+    manager = NULL;
+    t->manager = NULL;
+}
+
+DrawMeshIndirectTask::Impl::Impl(ptr<DrawMeshIndirectTask> owner, ptr<SceneNode> context, ptr<MeshBuffers> m) :
+    Task("DrawMeshIndirect", true, 0), owner(owner), context(context), m(m)
+{
+}
+
+DrawMeshIndirectTask::Impl::~Impl()
+{
+}
+
+bool DrawMeshIndirectTask::Impl::run()
+{
+    if (m == NULL) {
+        return true;
+    }
+    if (ORK_LOG_ENABLED(SCENEGRAPH, ORK_LOG_DEBUG) && Logger::DEBUG_LOGGER != NULL) {
+        Resource *r = dynamic_cast<Resource*>(m.get());
+        Logger::DEBUG_LOGGER->log("SCENEGRAPH", r == NULL ? "DrawMeshIndirect" : "DrawMeshIndirect '" + r->getName() + "'");
+    }
+
+    // updates the nodes whose transform or bounds changed since the previous
+    // frame, and records the ranges of modified nodes in 'dirty'
+    ptr<SceneManager> manager = context->getOwner();
+    vector<float> &nodes = owner->nodes;
+    vector< pair<int, int> > dirty;
+    if (owner->manager != manager.get() || owner->nodesVersion != manager->getNodesVersion() ||
+            manager->getFrameNumber() - owner->frameNumber > 1) {
+        // the nodes with the flag may have changed: rebuilds all the nodes
+        owner->manager = manager.get();
+        owner->nodesVersion = manager->getNodesVersion();
+        owner->indices.clear();
+        nodes.clear();
+        SceneManager::NodeIterator i = manager->getNodes(owner->flag);
+        while (i.hasNext()) {
+            ptr<SceneNode> n = i.next();
+            owner->indices[n.get()] = int(nodes.size() / 24);
+            nodes.resize(nodes.size() + 24);
+            getNode(n, &(nodes[nodes.size() - 24]));
+        }
+        if (!nodes.empty()) {
+            dirty.push_back(make_pair(0, int(nodes.size() / 24)));
+        }
+    } else {
+        // only the nodes moved by SceneManager#update can have changed
+        const vector< ptr<SceneNode> > &moved = manager->getMovedNodes();
+        vector<int> changed;
+        for (unsigned int j = 0; j < moved.size(); ++j) {
+            map<SceneNode*, int>::iterator k = owner->indices.find(moved[j].get());
+            if (k != owner->indices.end()) {
+                float node[24];
+                getNode(moved[j], node);
+                if (!equal(node, node + 24, nodes.begin() + k->second * 24)) {
+                    copy(node, node + 24, nodes.begin() + k->second * 24);
+                    changed.push_back(k->second);
+                }
+            }
+        }
+        sort(changed.begin(), changed.end());
+        for (unsigned int j = 0; j < changed.size(); ++j) {
+            int index = changed[j];
+            if (!dirty.empty() && dirty.back().second >= index) {
+                dirty.back().second = index + 1;
+            } else {
+                dirty.push_back(make_pair(index, index + 1));
+            }
+        }
+    }
+    owner->frameNumber = manager->getFrameNumber();
+    int count = int(nodes.size() / 24);
+    if (count == 0) {
+        return true;
+    }
+
+    ptr<Program> prog = SceneManager::getCurrentProgram();
+    ptr<StorageBlock> visible = prog->getStorageBlock(owner->block);
+    if (visible == NULL) {
+        if (Logger::ERROR_LOGGER != NULL) {
+            Logger::ERROR_LOGGER->log("SCENEGRAPH", "DrawMeshIndirect : cannot find storage block '" + owner->block + "'");
+        }
+        return false;
+    }
+
+    if (owner->cullProgram == NULL) {
+        owner->cullProgram = new Program(new Module(430, CULL_SHADER));
+        owner->nodesBuffer = new GPUBuffer();
+        owner->visibleBuffer = new GPUBuffer();
+        owner->commandBuffer = new GPUBuffer();
+    }
+    if (count > owner->capacity) {
+        owner->capacity = count;
+        owner->nodesBuffer->setData(count * 24 * sizeof(float), &(nodes[0]), DYNAMIC_DRAW);
+        owner->visibleBuffer->setData(count * 16 * sizeof(float), NULL, STREAM_COPY);
+    } else {
+        for (unsigned int j = 0; j < dirty.size(); ++j) {
+            int offset = dirty[j].first * 24;
+            int size = (dirty[j].second - dirty[j].first) * 24;
+            owner->nodesBuffer->setSubData(offset * sizeof(float), size * sizeof(float), &(nodes[offset]));
+        }
+    }
+
+    // count, instance count (incremented by the compute shader), first, base, 0
+    GLuint command[5] = { GLuint(m->nindices == 0 ? m->nvertices : m->nindices), 0, 0, 0, 0 };
+    owner->commandBuffer->setData(sizeof(command), command, STREAM_COPY);
+
+    vec4d planes[6];
+    SceneManager::getFrustumPlanes(manager->getWorldToScreen(), planes);
+    ptr<Program> cull = owner->cullProgram;
+    for (int j = 0; j < 5; ++j) {
+        ostringstream name;
+        name << "frustumPlanes[" << j << "]";
+        cull->getUniform4f(name.str())->set(planes[j].cast<float>());
+    }
+    cull->getUniform1ui("nodeCount")->set(GLuint(count));
+
+    cull->getStorageBlock("Nodes")->setBuffer(owner->nodesBuffer);
+    cull->getStorageBlock("Visible")->setBuffer(owner->visibleBuffer);
+    cull->getStorageBlock("Command")->setBuffer(owner->commandBuffer);
+    ptr<FrameBuffer> fb = SceneManager::getCurrentFrameBuffer();
+    fb->dispatch(cull, (count + 63) / 64);
+    FrameBuffer::memoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    visible->setBuffer(owner->visibleBuffer);
+    fb->drawIndirect(prog, *m, m->mode, *(owner->commandBuffer));
+    return true;
+}
+
+/// @cond RESOURCES
+
+class DrawMeshIndirectTaskResource : public ResourceTemplate<40, DrawMeshIndirectTask>
+{
+public:
+    DrawMeshIndirectTaskResource(ptr<ResourceManager> manager, const string &name, ptr<ResourceDescriptor> desc, const TiXmlElement *e = NULL) :
+        ResourceTemplate<40, DrawMeshIndirectTask>(manager, name, desc)
+    {
+        e = e == NULL ? desc->descriptor : e;
+        checkParameters(desc, e, "name,flag,block,");
+        string n = getParameter(desc, e, "name");
+        string flag = getParameter(desc, e, "flag");
+        string block = getParameter(desc, e, "block");
+        init(QualifiedName(n), flag, block);
+    }
+};
+
+extern const char drawMeshIndirect[] = "drawMeshIndirect";
+
+static ResourceFactory::Type<drawMeshIndirect, DrawMeshIndirectTaskResource> DrawMeshIndirectTaskType;
+
+/// @endcond
+
+}
@@ -0,0 +1,248 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+
+#ifndef _ORK_DRAW_MESH_INDIRECT_TASK_H_
+#define _ORK_DRAW_MESH_INDIRECT_TASK_H_
+
+#include "ork/render/GPUBuffer.h"
+#include "ork/render/Program.h"
+#include "ork/scenegraph/AbstractTask.h"
+
+namespace ork
+{
+
+/**
+ * An AbstractTask to draw a mesh once per scene node, with a frustum culling
+ * done on the GPU. The world bounds and local to world transforms of the
+ * scene nodes that have a given flag are stored in a GPU buffer, and a
+ * compute program tests them against the frustum planes of the camera. The
+ * local to world transforms of the visible nodes are written, compacted, in
+ * a shader storage buffer, and their number is written in the instance count
+ * of an indirect draw command. The mesh is then drawn with
+ * FrameBuffer#drawIndirect, using the current framebuffer and the current
+ * program. This program must read the transform of each instance from a
+ * StorageBlock, such as:
+ *
+ * <pre>
+ * layout(std430, row_major) readonly buffer Visible {
+ *     mat4 localToWorld[];
+ * };
+ * ... localToWorld[gl_InstanceID] ...
+ * </pre>
+ *
+ * This task requires OpenGL 4.3 or more.
+ *
+ * @ingroup scenegraph
+ */
+class ORK_API DrawMeshIndirectTask : public AbstractTask
+{
+public:
+    /**
+     * Creates a new DrawMeshIndirectTask.
+     *
+     * @param mesh a "node.mesh" qualified name. The first part specifies the
+     *      scene node that contains the mesh. The second part specifies the
+     *      name of the mesh in this node.
+     * @param flag a flag that specifies the scene nodes for which the mesh
+     *      must be drawn.
+     * @param block the name of the storage block of the current program that
+     *      must contain the transforms of the visible nodes.
+     */
+    DrawMeshIndirectTask(const QualifiedName &mesh, const std::string &flag, const std::string &block);
+
+    /**
+     * Deletes this DrawMeshIndirectTask.
+     */
+    virtual ~DrawMeshIndirectTask();
+
+    virtual ptr<Task> getTask(ptr<Object> context);
+
+protected:
+    /**
+     * Creates an empty DrawMeshIndirectTask.
+     */
+    DrawMeshIndirectTask();
+
+    /**
+     * Initializes this DrawMeshIndirectTask.
+     *
+     * @param mesh a "node.mesh" qualified name. The first part specifies the
+     *      scene node that contains the mesh. The second part specifies the
+     *      name of the mesh in this node.
+     * @param flag a flag that specifies the scene nodes for which the mesh
+     *      must be drawn.
+     * @param block the name of the storage block of the current program that
+     *      must contain the transforms of the visible nodes.
+     */
+    void init(const QualifiedName &mesh, const std::string &flag, const std::string &block);
+
+    /**
+     * Swaps this DrawMeshIndirectTask with anoter one.
+     *
+     * @param t a DrawMeshIndirectTask.
+     */
+    void swap(ptr<DrawMeshIndirectTask> t);
+
+private:
+    /**
+     * A "node.mesh" qualified name. The first part specifies the scene node
+     * that contains the mesh. The second part specifies the name of the mesh in
+     * this node.
+     */
+    QualifiedName mesh;
+
+    /**
+     * The flag that specifies the scene nodes for which the mesh must be drawn.
+     */
+    Symbol flag;
+
+    /**
+     * The name of the storage block of the current program that must contain
+     * the transforms of the visible nodes, i.e. #visibleBuffer.
+     */
+    std::string block;
+
+    /**
+     * The meshes resolved by #getTask.
+     */
+    BindingCache< ptr<MeshBuffers> > meshes;
+
+    /**
+     * The compute program that culls the scene nodes.
+     */
+    ptr<Program> cullProgram;
+
+    /**
+     * The world bounds and local to world transforms of the scene nodes, as
+     * uploaded to #nodesBuffer. Only the nodes that differ from this copy are
+     * uploaded at each frame.
+     */
+    std::vector<float> nodes;
+
+    /**
+     * The index in #nodes of each scene node that has #flag.
+     */
+    std::map<SceneNode*, int> indices;
+
+    /**
+     * The SceneManager whose nodes are stored in #nodes. This pointer is only
+     * compared with the current one, and never dereferenced.
+     */
+    SceneManager *manager;
+
+    /**
+     * The SceneManager#getNodesVersion of #manager when #indices was built.
+     */
+    unsigned int nodesVersion;
+
+    /**
+     * The SceneManager#getFrameNumber of #manager when #nodes was last
+     * updated. If this task is not executed at each frame, the nodes that
+     * moved in the frames where it was not executed are unknown, and #nodes
+     * must be rebuilt from scratch.
+     */
+    unsigned int frameNumber;
+
+    /**
+     * The world bounds and local to world transforms of the scene nodes.
+     */
+    ptr<GPUBuffer> nodesBuffer;
+
+    /**
+     * The local to world transforms of the visible scene nodes.
+     */
+    ptr<GPUBuffer> visibleBuffer;
+
+    /**
+     * The indirect draw command written by #cullProgram.
+     */
+    ptr<GPUBuffer> commandBuffer;
+
+    /**
+     * The number of scene nodes that #nodesBuffer and #visibleBuffer can
+     * contain.
+     */
+    int capacity;
+
+    /**
+     * A ork::Task to cull the scene nodes and to draw the mesh.
+     */
+    class Impl : public Task
+    {
+    public:
+        /**
+         * The DrawMeshIndirectTask that created this task.
+         */
+        ptr<DrawMeshIndirectTask> owner;
+
+        /**
+         * The scene node to which this task belongs. Its owner is the scene
+         * manager containing the scene nodes.
+         */
+        ptr<SceneNode> context;
+
+        /**
+         * The mesh that must be drawn.
+         */
+        ptr<MeshBuffers> m;
+
+        /**
+         * Creates a new DrawMeshIndirectTask::Impl task.
+         *
+         * @param owner the DrawMeshIndirectTask that created this task.
+         * @param context the scene node to which this task belongs.
+         * @param m the mesh to be drawn.
+         */
+        Impl(ptr<DrawMeshIndirectTask> owner, ptr<SceneNode> context, ptr<MeshBuffers> m);
+
+        /**
+         * Deletes this DrawMeshIndirectTask::Impl task.
+         */
+        virtual ~Impl();
+
+        virtual bool run();
+    };
+};
+
+}
+
+#endif
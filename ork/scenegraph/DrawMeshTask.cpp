@@ -73,12 +73,17 @@ DrawMeshTask::~DrawMeshTask()
 ptr<Task> DrawMeshTask::getTask(ptr<Object> context)
 {
     ptr<SceneNode> n = context.cast<Method>()->getOwner();
+    SceneNode *v = mesh.getVariable(n);
+    ptr<MeshBuffers> *cached = meshes.find(n.get(), v);
+    if (cached != NULL) {
+        return new Impl(*cached, count);
+    }
     ptr<SceneNode> target = mesh.getTarget(n);
     ptr<MeshBuffers> m = NULL;
     if (target == NULL) {
         m = n->getOwner()->getResourceManager()->loadResource(mesh.name + ".mesh").cast<MeshBuffers>();
     } else {
-        m = target->getMesh(mesh.name);
+        m = target->getMesh(mesh.nameSymbol);
     }
     if (m == NULL) {
         if (Logger::ERROR_LOGGER != NULL) {
@@ -86,6 +91,7 @@ ptr<Task> DrawMeshTask::getTask(ptr<Object> context)
         }
         throw exception();
     }
+    meshes.put(n.get(), v, m);
     return new Impl(m, count);
 }
 
@@ -93,6 +99,8 @@ void DrawMeshTask::swap(ptr<DrawMeshTask> t)
 {
     std::swap(mesh, t->mesh);
     std::swap(count, t->count);
+    meshes.clear();
+    t->meshes.clear();
 }
 
 DrawMeshTask::Impl::Impl(ptr<MeshBuffers> m, int count) :
@@ -107,9 +115,9 @@ DrawMeshTask::Impl::~Impl()
 bool DrawMeshTask::Impl::run()
 {
     if (m != NULL) {
-        if (Logger::DEBUG_LOGGER != NULL) {
+        if (ORK_LOG_ENABLED(SCENEGRAPH, ORK_LOG_DEBUG) && Logger::DEBUG_LOGGER != NULL) {
             Resource *r = dynamic_cast<Resource*>(m.get());
-            Logger::DEBUG_LOGGER->log("SCENEGRAPH", r == NULL ? "DrawMesk" : "DrawMesh '" + r->getName() + "'");
+            Logger::DEBUG_LOGGER->log("SCENEGRAPH", r == NULL ? "DrawMesh" : "DrawMesh '" + r->getName() + "'");
         }
         ptr<Program> prog = SceneManager::getCurrentProgram();
         if (m->nindices == 0) {
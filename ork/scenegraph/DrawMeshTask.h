@@ -108,6 +108,11 @@ private:
      */
     int count;
 
+    /**
+     * The meshes resolved by #getTask.
+     */
+    BindingCache< ptr<MeshBuffers> > meshes;
+
     /**
      * A ork::Task to draw a mesh.
      */
@@ -63,8 +63,8 @@ LoopTask::LoopTask(const string &var, const string &flag, bool cull, bool parall
 
 void LoopTask::init(const string &var, const string &flag, bool cull, bool parallel, ptr<TaskFactory> subtask)
 {
-    this->var = var;
-    this->flag = flag;
+    this->var = Symbol(var);
+    this->flag = Symbol(flag);
     this->cull = cull;
     this->parallel = parallel;
     this->subtask = subtask;
@@ -102,12 +102,12 @@ private:
     /**
      * The loop variable name.
      */
-    std::string var;
+    Symbol var;
 
     /**
      * The flag thatt specifies the scene nodes to which the loop must be applied.
      */
-    std::string flag;
+    Symbol flag;
 
     /**
      * True to apply the loop to all scene nodes in parallel.
@@ -41,8 +41,12 @@
 
 #include "ork/scenegraph/Method.h"
 
+#include "ork/core/GPUProfiler.h"
+#include "ork/taskgraph/GPUProfilerTask.h"
 #include "ork/scenegraph/SceneNode.h"
 
+using namespace std;
+
 namespace ork
 {
 
@@ -82,7 +86,24 @@ void Method::setTaskFactory(ptr<TaskFactory> taskFactory)
 
 ptr<Task> Method::getTask()
 {
-    return taskFactory->getTask(this);
+    ptr<Task> t = taskFactory->getTask(this);
+    if (GPUProfiler::INSTANCE != NULL && owner != NULL) {
+        // the GPU time of each method is measured in a pass named after the
+        // first flag of its owner node and after the method name
+        string name;
+        SceneNode::FlagIterator i = owner->getFlags();
+        name = i.hasNext() ? i.next() : "node";
+        SceneNode::MethodIterator j = owner->getMethods();
+        while (j.hasNext()) {
+            string methodName;
+            if (j.next(methodName).get() == this) {
+                name = name + "." + methodName;
+                break;
+            }
+        }
+        t = GPUProfilerTask::annotate(t, name);
+    }
+    return t;
 }
 
 }
@@ -41,7 +41,12 @@
 
 #include "ork/scenegraph/SceneManager.h"
 
+#include "ork/core/GPUProfiler.h"
+#include "ork/core/Timer.h"
 #include "ork/render/FrameBuffer.h"
+#include "ork/render/ReadbackManager.h"
+#include "ork/render/RenderTargetPool.h"
+#include "ork/render/TransientBuffer.h"
 
 using namespace std;
 
@@ -49,8 +54,11 @@ namespace ork
 {
 
 FrameBuffer* SceneManager::CURRENTFB = NULL;
+
 Program* SceneManager::CURRENTPROG = NULL;
 
+unsigned int SceneManager::VERSION = 0;
+
 ptr<FrameBuffer> SceneManager::getCurrentFrameBuffer()
 {
     if (CURRENTFB == NULL) {
@@ -74,11 +82,21 @@ void SceneManager::setCurrentProgram(ptr<Program> prog)
     CURRENTPROG = prog.get();
 }
 
+unsigned int SceneManager::getVersion()
+{
+    return VERSION;
+}
+
 SceneManager::SceneManager()
   : Object("SceneManager"),
     worldToScreen(mat4d::ZERO), // should call update before using
+    nodesVersion(0),
     frameNumber(0)
 {
+    frameTimes.update = 0.0;
+    frameTimes.culling = 0.0;
+    frameTimes.taskGraph = 0.0;
+    frameTimes.run = 0.0;
 
 }
 
@@ -103,6 +121,7 @@ void SceneManager::setRoot(ptr<SceneNode> root)
     this->root = root;
     this->root->setOwner(this);
     this->camera = NULL;
+    clearNodeMap();
 }
 
 ptr<SceneNode> SceneManager::getCameraNode()
@@ -138,6 +157,11 @@ void SceneManager::setCameraMethod(const string &method)
 }
 
 SceneManager::NodeIterator SceneManager::getNodes(const string &flag)
+{
+    return getNodes(Symbol::find(flag));
+}
+
+SceneManager::NodeIterator SceneManager::getNodes(Symbol flag)
 {
     if (nodeMap.size() == 0 && root != NULL) {
         buildNodeMap(root);
@@ -145,9 +169,24 @@ SceneManager::NodeIterator SceneManager::getNodes(const string &flag)
     return SceneManager::NodeIterator(flag, nodeMap);
 }
 
+unsigned int SceneManager::getNodesVersion() const
+{
+    return nodesVersion;
+}
+
+const vector< ptr<SceneNode> > &SceneManager::getMovedNodes() const
+{
+    return movedNodes;
+}
+
 ptr<SceneNode> SceneManager::getNodeVar(const string &name)
 {
-    map<string, ptr<SceneNode> >::iterator i = nodeVariables.find(name);
+    return getNodeVar(Symbol::find(name));
+}
+
+ptr<SceneNode> SceneManager::getNodeVar(Symbol name)
+{
+    map<Symbol, ptr<SceneNode> >::iterator i = nodeVariables.find(name);
     if (i != nodeVariables.end()) {
         return i->second;
     }
@@ -155,6 +194,11 @@ ptr<SceneNode> SceneManager::getNodeVar(const string &name)
 }
 
 void SceneManager::setNodeVar(const string &name, ptr<SceneNode> node)
+{
+    setNodeVar(Symbol(name), node);
+}
+
+void SceneManager::setNodeVar(Symbol name, ptr<SceneNode> node)
 {
     nodeVariables[name] = node;
 }
@@ -281,12 +325,17 @@ void SceneManager::update(double t, double dt)
     this->dt = dt;
 
     if (root != NULL) {
+        Timer timer;
+        timer.start();
         root->updateLocalToWorld(NULL);
         mat4d cameraToScreen = getCameraToScreen();
         worldToScreen = cameraToScreen * getCameraNode()->getWorldToLocal();
         root->updateLocalToCamera(getCameraNode()->getWorldToLocal(), cameraToScreen);
+        frameTimes.update = timer.end();
+        timer.start();
         getFrustumPlanes(worldToScreen, worldFrustumPlanes);
         computeVisibility(root, PARTIALLY_VISIBLE);
+        frameTimes.culling = timer.end();
     }
 }
 
@@ -295,19 +344,37 @@ void SceneManager::draw()
     if (camera != NULL) {
         ptr<Method> m = camera->getMethod(cameraMethod);
         if (m != NULL) {
+            Timer timer;
+            timer.start();
             ptr<Task> newTask = NULL;
             try {
                 newTask = m->getTask();
             } catch (...) {
             }
+            frameTimes.taskGraph = timer.end();
+            timer.start();
             if (newTask != NULL) {
                 scheduler->run(newTask);
                 currentTask = newTask;
             } else if (currentTask != NULL) {
                 scheduler->run(currentTask);
             }
+            frameTimes.run = timer.end();
         }
     }
+    if (GPUProfiler::INSTANCE != NULL) {
+        GPUProfiler::INSTANCE->endFrame();
+    }
+    if (TransientBuffer::INSTANCE != NULL) {
+        TransientBuffer::INSTANCE->endFrame();
+    }
+    if (ReadbackManager::INSTANCE != NULL) {
+        ReadbackManager::INSTANCE->newFrame();
+    }
+    if (RenderTargetPool::INSTANCE != NULL) {
+        RenderTargetPool::INSTANCE->endFrame();
+    }
+    movedNodes.clear();
     ++frameNumber;
 }
 
@@ -316,6 +383,11 @@ unsigned int SceneManager::getFrameNumber()
     return frameNumber;
 }
 
+const SceneManager::FrameTimes &SceneManager::getFrameTimes() const
+{
+    return frameTimes;
+}
+
 double SceneManager::getTime()
 {
     return t;
@@ -326,22 +398,81 @@ double SceneManager::getElapsedTime()
     return dt;
 }
 
+/**
+ * Converts a screen position and its depth to world coordinates.
+ */
+static vec3d screenToWorld(const mat4d &screenToWorld, const vec4<GLint> &vp, int x, int y, float depth)
+{
+    float winx = (x * 2.0f) / (float) vp.z - 1.0f;
+    float winy = 1.0f - (y * 2.0f) / (float) vp.w;
+    float winz = 2.0f * depth - 1.0f;
+    vec4d p = screenToWorld * vec4d(winx, winy, winz, 1);
+    return vec3d(p.x / p.w, p.y / p.w, p.z / p.w);
+}
+
+/**
+ * A ReadbackManager::Callback to convert the depth read by an asynchronous
+ * SceneManager::getWorldCoordinates request to world coordinates.
+ */
+class DepthReadCallback : public ReadbackManager::Callback
+{
+public:
+    DepthReadCallback(const mat4d &screenToWorld, const vec4<GLint> &vp, int x, int y,
+            ptr<SceneManager::WorldCoordinatesCallback> cb) :
+        screenToWorld(screenToWorld), vp(vp), x(x), y(y), cb(cb)
+    {
+    }
+
+    virtual ~DepthReadCallback()
+    {
+    }
+
+    virtual void dataRead(volatile void *data)
+    {
+        float depth = *((volatile float*) data);
+        cb->worldCoordinatesRead(x, y, ork::screenToWorld(screenToWorld, vp, x, y, depth));
+    }
+
+private:
+    mat4d screenToWorld; ///< the screen to world transform at request time
+
+    vec4<GLint> vp; ///< the viewport at request time
+
+    int x; ///< the horizontal screen position of the request
+
+    int y; ///< the vertical screen position of the request
+
+    ptr<SceneManager::WorldCoordinatesCallback> cb; ///< the user callback
+};
+
+SceneManager::WorldCoordinatesCallback::WorldCoordinatesCallback() :
+    Object("SceneManager::WorldCoordinatesCallback")
+{
+}
+
+SceneManager::WorldCoordinatesCallback::~WorldCoordinatesCallback()
+{
+}
+
 vec3d SceneManager::getWorldCoordinates(int x, int y)
 {
-    float winx, winy, winz;
+    float winz;
     ptr<FrameBuffer> fb = FrameBuffer::getDefault();
     vec4<GLint> vp = fb->getViewport();
-    float width = (float) vp.z;
-    float height = (float) vp.w;
     fb->readPixels(x, vp.w - y, 1, 1, DEPTH_COMPONENT, FLOAT, Buffer::Parameters(), CPUBuffer(&winz));
+    return screenToWorld(getWorldToScreen().inverse(), vp, x, y, winz);
+}
 
-    winx = (x * 2.0f) / width - 1.0f;
-    winy = 1.0f - (y * 2.0f) / height;
-    winz = 2.0f * winz - 1.0f;
-    mat4d screenToWorld = getWorldToScreen().inverse();
-    vec4d p = screenToWorld * vec4d(winx, winy, winz, 1);
-
-    return vec3d(p.x / p.w, p.y / p.w, p.z / p.w);
+bool SceneManager::getWorldCoordinates(int x, int y, ptr<WorldCoordinatesCallback> cb)
+{
+    if (ReadbackManager::INSTANCE == NULL) {
+        cb->worldCoordinatesRead(x, y, getWorldCoordinates(x, y));
+        return true;
+    }
+    ptr<FrameBuffer> fb = FrameBuffer::getDefault();
+    vec4<GLint> vp = fb->getViewport();
+    ptr<ReadbackManager::Callback> r = new DepthReadCallback(getWorldToScreen().inverse(), vp, x, y, cb);
+    return ReadbackManager::INSTANCE->readPixels(fb, x, vp.w - y, 1, 1, DEPTH_COMPONENT, FLOAT, r);
 }
 
 SceneManager::visibility SceneManager::getVisibility(const vec4d &clip, const box3d &b)
@@ -384,13 +515,14 @@ void SceneManager::computeVisibility(ptr<SceneNode> n, visibility v)
 void SceneManager::clearNodeMap()
 {
     nodeMap.clear();
+    ++nodesVersion;
+    ++VERSION;
 }
 
 void SceneManager::buildNodeMap(ptr<SceneNode> node)
 {
-    SceneNode::FlagIterator i = node->getFlags();
-    while (i.hasNext()) {
-        nodeMap.insert(make_pair(i.next(), node));
+    for (unsigned int i = 0; i < node->flags.size(); ++i) {
+        nodeMap.insert(make_pair(node->flags[i], node));
     }
     unsigned int n = node->getChildrenCount();
     for (unsigned int i = 0; i < n; ++i) {
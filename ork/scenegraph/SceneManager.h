@@ -68,7 +68,34 @@ public:
     /**
      * An iterator over a map of SceneNode.
      */
-    typedef MultiMapIterator<std::string, ptr<SceneNode> > NodeIterator;
+    typedef MultiMapIterator<Symbol, ptr<SceneNode> > NodeIterator;
+
+    /**
+     * A callback called with the result of an asynchronous
+     * #getWorldCoordinates request.
+     */
+    class ORK_API WorldCoordinatesCallback : public Object
+    {
+    public:
+        /**
+         * Creates a new callback.
+         */
+        WorldCoordinatesCallback();
+
+        /**
+         * Deletes this callback.
+         */
+        virtual ~WorldCoordinatesCallback();
+
+        /**
+         * Called when the world coordinates of a screen position are known.
+         *
+         * @param x the horizontal screen position of the request.
+         * @param y the vertical screen position of the request.
+         * @param p the 3D coordinates in world space corresponding to x,y.
+         */
+        virtual void worldCoordinatesRead(int x, int y, const vec3d &p) = 0;
+    };
 
     /**
      * Creates an empty SceneManager.
@@ -123,6 +150,27 @@ public:
      */
     NodeIterator getNodes(const std::string &flag);
 
+    /**
+     * Returns the nodes of the scene graph that have the given flag.
+     *
+     * @param flag a SceneNode flag.
+     */
+    NodeIterator getNodes(Symbol flag);
+
+    /**
+     * Returns a number that changes each time the nodes returned by
+     * #getNodes may change, i.e. each time a node is added to or removed
+     * from the scene graph, or when the flags of a node change.
+     */
+    unsigned int getNodesVersion() const;
+
+    /**
+     * Returns the nodes whose local to world transform or world bounds
+     * changed in the current frame, i.e. in the calls to #update since the
+     * last call to #draw. A node may appear several times in this list.
+     */
+    const std::vector< ptr<SceneNode> > &getMovedNodes() const;
+
     /**
      * Returns the SceneNode currently bound to the given loop variable.
      *
@@ -130,6 +178,13 @@ public:
      */
     ptr<SceneNode> getNodeVar(const std::string &name);
 
+    /**
+     * Returns the SceneNode currently bound to the given loop variable.
+     *
+     * @param name a loop variable.
+     */
+    ptr<SceneNode> getNodeVar(Symbol name);
+
     /**
      * Sets the node currently bound to the given loop variable.
      *
@@ -138,6 +193,14 @@ public:
      */
     void setNodeVar(const std::string &name, ptr<SceneNode> node);
 
+    /**
+     * Sets the node currently bound to the given loop variable.
+     *
+     * @param name a loop variable.
+     * @param node the new node bound to this loop variable.
+     */
+    void setNodeVar(Symbol name, ptr<SceneNode> node);
+
     /**
      * Returns the ResourceManager used to manage the resources of the scene
      * graph.
@@ -220,12 +283,32 @@ public:
      */
     void draw();
 
+    /**
+     * The CPU durations of the steps of the last frame, in micro seconds.
+     */
+    struct FrameTimes
+    {
+        double update; ///< time to update the transforms in #update
+
+        double culling; ///< time to compute the visibility of nodes in #update
+
+        double taskGraph; ///< time to build the task graph of the frame in #draw
+
+        double run; ///< time to schedule and execute this task graph in #draw
+    };
+
     /**
      * Returns the current frame number. This number is incremented after each
      * call to #draw.
      */
     unsigned int getFrameNumber();
 
+    /**
+     * Returns the CPU durations of the steps of the last calls to #update
+     * and #draw.
+     */
+    const FrameTimes &getFrameTimes() const;
+
     /**
      * Returns the time of the current frame in micro-seconds. This time is the
      * one passed as argument to the last call to #update.
@@ -248,6 +331,23 @@ public:
      */
     vec3d getWorldCoordinates(int x, int y);
 
+    /**
+     * Computes asynchronously the 3D coordinates in world space corresponding
+     * to the given screen space position. Unlike #getWorldCoordinates(int,int)
+     * this method does not stall the pipeline: the depth is read with the
+     * ReadbackManager#INSTANCE manager, and the result is given to the
+     * callback a few frames later, but computed with the camera of the frame
+     * where the request was made. If there is no ReadbackManager#INSTANCE,
+     * the depth is read synchronously and the callback is called immediately.
+     *
+     * @param x horizontal screen position.
+     * @param y vertical screen position.
+     * @param cb the callback to call with the result.
+     * @return false if the request cannot be started (see
+     *      ReadbackManager#canReadback).
+     */
+    bool getWorldCoordinates(int x, int y, ptr<WorldCoordinatesCallback> cb);
+
 	/**
      * Returns the current FrameBuffer.
      */
@@ -270,6 +370,15 @@ public:
      */
     static void setCurrentProgram(ptr<Program> prog);
 
+    /**
+     * Returns the current version of the scene graphs. This number changes
+     * each time a SceneNode is created, deleted, or modified (flags, values,
+     * modules, meshes, fields, methods or children). It can be used to
+     * invalidate data derived from the scene graphs, such as the bindings
+     * cached by task factories.
+     */
+    static unsigned int getVersion();
+
 private:
     /**
      * The current framebuffer.
@@ -281,6 +390,11 @@ private:
      */
     static Program *CURRENTPROG;
 
+    /**
+     * The current version of the scene graphs.
+     */
+    static unsigned int VERSION;
+
     /**
      * The root node of the scene graph managed by this manager.
      */
@@ -324,12 +438,24 @@ private:
     /**
      * A multimap that associates to each flag all the nodes having this flag.
      */
-    std::multimap<std::string, ptr<SceneNode> > nodeMap;
+    std::multimap<Symbol, ptr<SceneNode> > nodeMap;
+
+    /**
+     * The number returned by #getNodesVersion. Incremented by #clearNodeMap.
+     */
+    unsigned int nodesVersion;
+
+    /**
+     * The nodes whose local to world transform or world bounds changed in
+     * the current frame. Filled by SceneNode#updateLocalToWorld and cleared
+     * at the end of #draw.
+     */
+    std::vector< ptr<SceneNode> > movedNodes;
 
     /**
      * A map that associates to each loop variable its current value.
      */
-    std::map<std::string, ptr<SceneNode> > nodeVariables;
+    std::map<Symbol, ptr<SceneNode> > nodeVariables;
 
     /**
      * The ResourceManager that manages the resources of the scene graph.
@@ -346,6 +472,11 @@ private:
      */
     unsigned int frameNumber;
 
+    /**
+     * The CPU durations of the steps of the last frame.
+     */
+    FrameTimes frameTimes;
+
     /**
      * The value of the t argument of the last call to #update.
      */
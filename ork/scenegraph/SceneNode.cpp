@@ -59,6 +59,7 @@ SceneNode::SceneNode() : Object("SceneNode"), owner(NULL)
     worldToLocalUpToDate = false;
     localBounds = box3d(0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
     localToScreen = mat4d::IDENTITY;
+    ++SceneManager::VERSION;
 }
 
 SceneNode::~SceneNode()
@@ -67,6 +68,7 @@ SceneNode::~SceneNode()
     while (i.hasNext()) {
         i.next()->owner = NULL;
     }
+    ++SceneManager::VERSION;
 }
 
 ptr<SceneManager> SceneNode::getOwner()
@@ -135,12 +137,20 @@ SceneNode::FlagIterator SceneNode::getFlags()
 
 bool SceneNode::hasFlag(const string &flag)
 {
-    return flags.find(flag) != flags.end();
+    return hasFlag(Symbol::find(flag));
+}
+
+bool SceneNode::hasFlag(Symbol flag)
+{
+    return find(flags.begin(), flags.end(), flag) != flags.end();
 }
 
 void SceneNode::addFlag(const string &flag)
 {
-    flags.insert(flag);
+    Symbol s(flag);
+    if (!hasFlag(s)) {
+        flags.push_back(s);
+    }
     if (owner != NULL) {
         owner->clearNodeMap();
     }
@@ -148,7 +158,10 @@ void SceneNode::addFlag(const string &flag)
 
 void SceneNode::removeFlag(const string &flag)
 {
-    flags.erase(flag);
+    vector<Symbol>::iterator i = find(flags.begin(), flags.end(), Symbol::find(flag));
+    if (i != flags.end()) {
+        flags.erase(i);
+    }
     if (owner != NULL) {
         owner->clearNodeMap();
     }
@@ -161,18 +174,25 @@ SceneNode::ValueIterator SceneNode::getValues()
 
 ptr<Value> SceneNode::getValue(const string &name)
 {
-    map<string, ptr<Value> >::iterator i = values.find(name);
-    return i == values.end() ? NULL : (*i).second;
+    return getValue(Symbol::find(name));
+}
+
+ptr<Value> SceneNode::getValue(Symbol name)
+{
+    ptr<Value> *v = values.find(name);
+    return v == NULL ? NULL : *v;
 }
 
 void SceneNode::addValue(ptr<Value> value)
 {
-    values.insert(make_pair(value->getName(), value));
+    values.set(Symbol(value->getName()), value, false);
+    ++SceneManager::VERSION;
 }
 
 void SceneNode::removeValue(const string &name)
 {
-    values.erase(name);
+    values.erase(Symbol::find(name));
+    ++SceneManager::VERSION;
 }
 
 SceneNode::ModuleIterator SceneNode::getModules()
@@ -182,18 +202,25 @@ SceneNode::ModuleIterator SceneNode::getModules()
 
 ptr<Module> SceneNode::getModule(const string &name)
 {
-    map<string, ptr<Module> >::iterator i = modules.find(name);
-    return i == modules.end() ? NULL : (*i).second;
+    return getModule(Symbol::find(name));
+}
+
+ptr<Module> SceneNode::getModule(Symbol name)
+{
+    ptr<Module> *m = modules.find(name);
+    return m == NULL ? NULL : *m;
 }
 
 void SceneNode::addModule(const string &name, ptr<Module> s)
 {
-    modules[name] = s;
+    modules.set(Symbol(name), s);
+    ++SceneManager::VERSION;
 }
 
 void SceneNode::removeModule(const string &name)
 {
-    modules.erase(name);
+    modules.erase(Symbol::find(name));
+    ++SceneManager::VERSION;
 }
 
 SceneNode::MeshIterator SceneNode::getMeshes()
@@ -203,19 +230,26 @@ SceneNode::MeshIterator SceneNode::getMeshes()
 
 ptr<MeshBuffers> SceneNode::getMesh(const string &name)
 {
-    map<string, ptr<MeshBuffers> >::iterator i = meshes.find(name);
-    return i == meshes.end() ? NULL : (*i).second;
+    return getMesh(Symbol::find(name));
+}
+
+ptr<MeshBuffers> SceneNode::getMesh(Symbol name)
+{
+    ptr<MeshBuffers> *m = meshes.find(name);
+    return m == NULL ? NULL : *m;
 }
 
 void SceneNode::addMesh(const string &name, ptr<MeshBuffers> m)
 {
-    meshes[name] = m;
+    meshes.set(Symbol(name), m);
+    ++SceneManager::VERSION;
     localBounds = localBounds.enlarge(m->bounds.cast<double>());
 }
 
 void SceneNode::removeMesh(const string &name)
 {
-    meshes.erase(name);
+    meshes.erase(Symbol::find(name));
+    ++SceneManager::VERSION;
 }
 
 SceneNode::FieldIterator SceneNode::getFields()
@@ -225,22 +259,25 @@ SceneNode::FieldIterator SceneNode::getFields()
 
 ptr<Object> SceneNode::getField(const string &name)
 {
-    map<string, ptr<Object> >::iterator i = fields.find(name);
-    return i == fields.end() ? NULL : (*i).second;
+    return getField(Symbol::find(name));
+}
+
+ptr<Object> SceneNode::getField(Symbol name)
+{
+    ptr<Object> *f = fields.find(name);
+    return f == NULL ? NULL : *f;
 }
 
 void SceneNode::addField(const string &name, ptr<Object> f)
 {
-    removeField(name);
-    fields[name] = f;
+    fields.set(Symbol(name), f);
+    ++SceneManager::VERSION;
 }
 
 void SceneNode::removeField(const string &name)
 {
-    map<string, ptr<Object> >::iterator i = fields.find(name);
-    if (i != fields.end()) {
-        fields.erase(i);
-    }
+    fields.erase(Symbol::find(name));
+    ++SceneManager::VERSION;
 }
 
 SceneNode::MethodIterator SceneNode::getMethods()
@@ -250,23 +287,31 @@ SceneNode::MethodIterator SceneNode::getMethods()
 
 ptr<Method> SceneNode::getMethod(const string &name)
 {
-    map<string, ptr<Method> >::iterator i = methods.find(name);
-    return i == methods.end() ? NULL : (*i).second;
+    return getMethod(Symbol::find(name));
+}
+
+ptr<Method> SceneNode::getMethod(Symbol name)
+{
+    ptr<Method> *m = methods.find(name);
+    return m == NULL ? NULL : *m;
 }
 
 void SceneNode::addMethod(const string &name, ptr<Method> m)
 {
     removeMethod(name);
-    methods[name] = m;
+    methods.set(Symbol(name), m);
+    ++SceneManager::VERSION;
     m->owner = this;
 }
 
 void SceneNode::removeMethod(const string &name)
 {
-    map<string, ptr<Method> >::iterator i = methods.find(name);
-    if (i != methods.end()) {
-        methods.erase(i);
-        (*i).second->owner = NULL;
+    Symbol s = Symbol::find(name);
+    ptr<Method> *m = methods.find(s);
+    if (m != NULL) {
+        (*m)->owner = NULL;
+        methods.erase(s);
+        ++SceneManager::VERSION;
     }
 }
 
@@ -294,28 +339,32 @@ void SceneNode::addChild(ptr<SceneNode> child)
 void SceneNode::removeChild(unsigned int index)
 {
     children.erase(children.begin() + index);
+    if (owner != NULL) {
+        owner->clearNodeMap();
+    } else {
+        ++SceneManager::VERSION;
+    }
 }
 
 void SceneNode::swap(ptr<SceneNode> n)
 {
     std::swap(localToParent, n->localToParent);
     std::swap(flags, n->flags);
-    std::swap(values, n->values);
-    std::swap(modules, n->modules);
-    std::swap(meshes, n->meshes);
-    std::swap(methods, n->methods);
+    values.swap(n->values);
+    modules.swap(n->modules);
+    meshes.swap(n->meshes);
+    methods.swap(n->methods);
     std::swap(children, n->children);
-    map<string, ptr<Method> >::iterator i;
-    i = methods.begin();
-    while (i != methods.end()) {
-        i->second->owner = this;
+    for (unsigned int i = 0; i < methods.size(); ++i) {
+        methods.entries[i].second->owner = this;
     }
-    i = n->methods.begin();
-    while (i != n->methods.end()) {
-        i->second->owner = n.get();
+    for (unsigned int i = 0; i < n->methods.size(); ++i) {
+        n->methods.entries[i].second->owner = n.get();
     }
     if (owner != NULL) {
         owner->clearNodeMap();
+    } else {
+        ++SceneManager::VERSION;
     }
     setOwner(owner);
     n->setOwner(NULL);
@@ -334,6 +383,8 @@ void SceneNode::setOwner(SceneManager *owner)
 
 void SceneNode::updateLocalToWorld(ptr<SceneNode> parent)
 {
+    mat4d oldLocalToWorld = localToWorld;
+    box3d oldWorldBounds = worldBounds;
     if (parent != NULL) {
         localToWorld = parent->localToWorld * localToParent;
     }
@@ -354,6 +405,13 @@ void SceneNode::updateLocalToWorld(ptr<SceneNode> parent)
         ++i;
     }
     worldToLocalUpToDate = false;
+
+    if (owner != NULL && (localToWorld != oldLocalToWorld ||
+            worldBounds.xmin != oldWorldBounds.xmin || worldBounds.xmax != oldWorldBounds.xmax ||
+            worldBounds.ymin != oldWorldBounds.ymin || worldBounds.ymax != oldWorldBounds.ymax ||
+            worldBounds.zmin != oldWorldBounds.zmin || worldBounds.zmax != oldWorldBounds.zmax)) {
+        owner->movedNodes.push_back(this);
+    }
 }
 
 void SceneNode::updateLocalToCamera(const mat4d &worldToCamera, const mat4d &cameraToScreen)
@@ -48,6 +48,7 @@
 #include <string>
 #include "ork/math/box3.h"
 #include "ork/core/Iterator.h"
+#include "ork/core/Symbol.h"
 #include "ork/render/MeshBuffers.h"
 #include "ork/render/Module.h"
 #include "ork/scenegraph/Method.h"
@@ -83,32 +84,32 @@ public:
     /**
      * An iterator to iterate over a set of flags.
      */
-    typedef SetIterator<std::string> FlagIterator;
+    typedef SymbolSetIterator FlagIterator;
 
     /**
      * An iterator to iterate over a map of Value.
      */
-    typedef MapIterator<std::string, ptr<Value> > ValueIterator;
+    typedef SymbolMapIterator< ptr<Value> > ValueIterator;
 
     /**
      * An iterator to iterate over a map of Module.
      */
-    typedef MapIterator<std::string, ptr<Module> > ModuleIterator;
+    typedef SymbolMapIterator< ptr<Module> > ModuleIterator;
 
     /**
      * An iterator to iterate over a map of Mesh.
      */
-    typedef MapIterator<std::string, ptr<MeshBuffers> > MeshIterator;
+    typedef SymbolMapIterator< ptr<MeshBuffers> > MeshIterator;
 
     /**
      * An iterator to iterate over a map of SceneNode fields.
      */
-    typedef MapIterator<std::string, ptr<Object> > FieldIterator;
+    typedef SymbolMapIterator< ptr<Object> > FieldIterator;
 
     /**
      * An iterator to iterate over a map of SceneNode Method.
      */
-    typedef MapIterator<std::string, ptr<Method> > MethodIterator;
+    typedef SymbolMapIterator< ptr<Method> > MethodIterator;
 
     /**
      * True if this scene node is visible, false otherwise.
@@ -198,6 +199,13 @@ public:
      */
     bool hasFlag(const std::string &flag);
 
+    /**
+     * Returns true is this node has the given flag.
+     *
+     * @param flag a flag.
+     */
+    bool hasFlag(Symbol flag);
+
     /**
      * Adds the given flag to the flags of this node.
      *
@@ -224,6 +232,13 @@ public:
      */
     ptr<Value> getValue(const std::string &name);
 
+    /**
+     * Returns the value of this node whose local name is given.
+     *
+     * @param name the local name of a value.
+     */
+    ptr<Value> getValue(Symbol name);
+
     /**
      * Adds a value to this node under the given local name.
      *
@@ -250,6 +265,13 @@ public:
      */
     ptr<Module> getModule(const std::string &name);
 
+    /**
+     * Returns the module of this node whose local name is given.
+     *
+     * @param name the local name of a module.
+     */
+    ptr<Module> getModule(Symbol name);
+
     /**
      * Adds a module to this node under the given local name.
      *
@@ -277,6 +299,13 @@ public:
      */
     ptr<MeshBuffers> getMesh(const std::string &name);
 
+    /**
+     * Returns the mesh of this node whose local name is given.
+     *
+     * @param name the local name of a mesh.
+     */
+    ptr<MeshBuffers> getMesh(Symbol name);
+
     /**
      * Adds a mesh to this node under the given local name.
      *
@@ -304,6 +333,13 @@ public:
      */
     ptr<Object> getField(const std::string &name);
 
+    /**
+     * Returns the field of this node whose name is given.
+     *
+     * @param name the name of a field.
+     */
+    ptr<Object> getField(Symbol name);
+
     /**
      * Adds a field to this node under the given name.
      *
@@ -331,6 +367,13 @@ public:
      */
     ptr<Method> getMethod(const std::string &name);
 
+    /**
+     * Returns the method of this node whose name is given.
+     *
+     * @param name the name of a method.
+     */
+    ptr<Method> getMethod(Symbol name);
+
     /**
      * Adds a method to this node under the given name.
      *
@@ -432,32 +475,32 @@ private:
     /**
      * The flags of this node.
      */
-    std::set<std::string> flags;
+    std::vector<Symbol> flags;
 
     /**
      * The values of this node.
      */
-    std::map<std::string, ptr<Value> > values;
+    SymbolMap< ptr<Value> > values;
 
     /**
      * The modules of this node.
      */
-    std::map<std::string, ptr<Module> > modules;
+    SymbolMap< ptr<Module> > modules;
 
     /**
      * The meshes of this node.
      */
-    std::map<std::string, ptr<MeshBuffers> > meshes;
+    SymbolMap< ptr<MeshBuffers> > meshes;
 
     /**
      * The fields of this node.
      */
-    std::map<std::string, ptr<Object> > fields;
+    SymbolMap< ptr<Object> > fields;
 
     /**
      * The methods of this node.
      */
-    std::map<std::string, ptr<Method> > methods;
+    SymbolMap< ptr<Method> > methods;
 
     /**
      * The child nodes of this node.
@@ -474,7 +517,8 @@ private:
 
     /**
      * Updates the #localToWorld transform. This method also updates #worldBounds
-     * and #worldPos.
+     * and #worldPos, and adds this node to the SceneManager#getMovedNodes of
+     * its owner if its transform or bounds changed.
      *
      * @param parent the parent node of this node.
      */
@@ -75,18 +75,38 @@ ptr<Task> SetProgramTask::getTask(ptr<Object> context)
     ptr<SceneNode> n = context.cast<Method>()->getOwner();
     ptr<SceneManager> m = n->getOwner();
     ptr<Program> p;
+
+    SceneNode *v = NULL;
+    bool cacheable = true;
+    for (unsigned int i = 0; i < modules.size(); ++i) {
+        SceneNode *mv = modules[i].getVariable(n);
+        if (mv != NULL) {
+            cacheable = cacheable && (v == NULL || v == mv);
+            v = mv;
+        }
+    }
+    if (cacheable) {
+        ptr<Program> *cached = programs.find(n.get(), v);
+        if (cached != NULL) {
+            return new Impl(*cached, setUniforms ? n : NULL);
+        }
+    }
+
     try {
         for (unsigned int i = 0; i < modules.size(); ++i) {
             ptr<SceneNode> target = modules[i].getTarget(n);
             if (target == NULL) {
                 name = name + modules[i].name + ";";
             } else {
-                ptr<Module> s = target->getModule(modules[i].name);
+                ptr<Module> s = target->getModule(modules[i].nameSymbol);
                 name = name + dynamic_cast<Resource*>(s.get())->getName() + ";";
             }
         }
         // TODO sort name components!!!
         p = m->getResourceManager()->loadResource(name).cast<Program>();
+        if (cacheable && p != NULL) {
+            programs.put(n.get(), v, p);
+        }
     } catch (...) {
         if (Logger::ERROR_LOGGER != NULL) {
             Logger::ERROR_LOGGER->log("SCENEGRAPH", "SetProgram: cannot find program");
@@ -99,6 +119,8 @@ ptr<Task> SetProgramTask::getTask(ptr<Object> context)
 void SetProgramTask::swap(ptr<SetProgramTask> t)
 {
     std::swap(modules, t->modules);
+    programs.clear();
+    t->programs.clear();
 }
 
 SetProgramTask::Impl::Impl(ptr<Program> p, ptr<SceneNode> n) :
@@ -113,7 +135,7 @@ SetProgramTask::Impl::~Impl()
 bool SetProgramTask::Impl::run()
 {
     if (p != NULL) {
-        if (Logger::DEBUG_LOGGER != NULL) {
+        if (ORK_LOG_ENABLED(SCENEGRAPH, ORK_LOG_DEBUG) && Logger::DEBUG_LOGGER != NULL) {
             Resource *r = dynamic_cast<Resource*>(p.get());
             Logger::DEBUG_LOGGER->log("SCENEGRAPH", r == NULL ? "SetProgram" : "SetProgram '" + r->getName() + "'");
         }
@@ -95,6 +95,12 @@ private:
      */
     bool setUniforms;
 
+    /**
+     * The programs resolved by #getTask. Programs whose modules are looked
+     * up with several distinct loop variables are not cached.
+     */
+    BindingCache< ptr<Program> > programs;
+
     /**
      * A ork::Task to set a program.
      */
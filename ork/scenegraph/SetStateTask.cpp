@@ -1056,9 +1056,7 @@ SetStateTask::Impl::~Impl()
 
 bool SetStateTask::Impl::run()
 {
-    if (Logger::DEBUG_LOGGER != NULL) {
-        Logger::DEBUG_LOGGER->log("SCENEGRAPH", "SetState");
-    }
+    ORK_DEBUG(SCENEGRAPH, "SetState");
     source->run();
     return true;
 }
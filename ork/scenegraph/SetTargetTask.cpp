@@ -42,6 +42,7 @@
 #include "ork/scenegraph/SetTargetTask.h"
 
 #include "ork/render/FrameBuffer.h"
+#include "ork/render/RenderTargetPool.h"
 #include "ork/resource/ResourceTemplate.h"
 #include "ork/scenegraph/SceneManager.h"
 
@@ -52,22 +53,33 @@ namespace ork
 
 BufferId getBufferFromName(const char *v);
 
+void getParameters(const ptr<ResourceDescriptor> desc, const TiXmlElement *e, TextureInternalFormat &ff, TextureFormat &f, PixelType &t);
+
+void getParameters(const ptr<ResourceDescriptor> desc, const TiXmlElement *e, Texture::Parameters &params);
+
 static_ptr<FrameBuffer> SetTargetTask::TARGET_BUFFER;
 
+SetTargetTask::Target::Target() :
+    buffer(COLOR0), level(0), layer(0), transient(false),
+    internalFormat(RGBA8), format(RGBA), type(UNSIGNED_BYTE)
+{
+}
+
 SetTargetTask::SetTargetTask() : AbstractTask("SetTargetTask")
 {
 }
 
-SetTargetTask::SetTargetTask(const vector<Target> &targets, bool autoResize) :
+SetTargetTask::SetTargetTask(const vector<Target> &targets, bool autoResize, const vector<QualifiedName> &releases) :
     AbstractTask("SetTargetTask")
 {
-    init(targets, autoResize);
+    init(targets, autoResize, releases);
 }
 
-void SetTargetTask::init(const vector<Target> &targets, bool autoResize)
+void SetTargetTask::init(const vector<Target> &targets, bool autoResize, const vector<QualifiedName> &releases)
 {
     this->targets = targets;
     this->autoResize = autoResize;
+    this->releases = releases;
 }
 
 SetTargetTask::~SetTargetTask()
@@ -77,18 +89,30 @@ SetTargetTask::~SetTargetTask()
 ptr<Task> SetTargetTask::getTask(ptr<Object> context)
 {
     vector< ptr<Texture> > textures;
+    vector< ptr<SceneNode> > owners;
+    vector< ptr<SceneNode> > releaseOwners;
     ptr<SceneNode> n = context.cast<Method>()->getOwner();
     try {
+        for (unsigned int i = 0; i < releases.size(); ++i) {
+            ptr<SceneNode> owner = releases[i].getTarget(n);
+            releaseOwners.push_back(owner == NULL ? n : owner);
+        }
         for (unsigned int i = 0; i < targets.size(); ++i) {
             Target *target = &(targets[i]);
             string name = target->texture.name;
             ptr<SceneNode> owner = target->texture.getTarget(n);
+            if (target->transient) {
+                textures.push_back(NULL);
+                owners.push_back(owner == NULL ? n : owner);
+                continue;
+            }
+            owners.push_back(NULL);
             if (owner != NULL) {
 //                ptr<Uniform> u = NULL;
                 string::size_type index = name.find(':');
                 ptr<Texture> t = NULL;
                 if (index == string::npos) {
-                    t = owner->getValue(name).cast<ValueSampler>()->get();
+                    t = owner->getValue(target->texture.nameSymbol).cast<ValueSampler>()->get();
                 } else {
                     ptr<Module> module = owner->getModule(name.substr(0, index));
                     set<Program *> progs = module->getUsers();
@@ -117,7 +141,7 @@ ptr<Task> SetTargetTask::getTask(ptr<Object> context)
         throw exception();
     }
 
-    return new Impl(this, textures);
+    return new Impl(this, textures, owners, releaseOwners);
 }
 
 ptr<FrameBuffer> SetTargetTask::getTargetBuffer()
@@ -133,10 +157,12 @@ ptr<FrameBuffer> SetTargetTask::getTargetBuffer()
 void SetTargetTask::swap(ptr<SetTargetTask> t)
 {
     std::swap(targets, t->targets);
+    std::swap(releases, t->releases);
 }
 
-SetTargetTask::Impl::Impl(ptr<SetTargetTask> source, vector< ptr<Texture> > textures) :
-    Task("SetTarget", true, 0), source(source), textures(textures)
+SetTargetTask::Impl::Impl(ptr<SetTargetTask> source, vector< ptr<Texture> > textures,
+        vector< ptr<SceneNode> > owners, vector< ptr<SceneNode> > releaseOwners) :
+    Task("SetTarget", true, 0), source(source), textures(textures), owners(owners), releaseOwners(releaseOwners)
 {
 }
 
@@ -146,7 +172,34 @@ SetTargetTask::Impl::~Impl()
 
 bool SetTargetTask::Impl::run()
 {
-    if (Logger::DEBUG_LOGGER != NULL) {
+    if (releaseOwners.size() > 0 && RenderTargetPool::INSTANCE != NULL) {
+        for (unsigned int i = 0; i < releaseOwners.size(); ++i) {
+            ptr<ValueSampler> v = releaseOwners[i]->getValue(source->releases[i].nameSymbol).cast<ValueSampler>();
+            if (v != NULL && v->get().cast<Texture2D>() != NULL) {
+                RenderTargetPool::INSTANCE->releaseTexture(v->get().cast<Texture2D>());
+            }
+        }
+    }
+    for (unsigned int i = 0; i < textures.size(); ++i) {
+        Target *target = &(source->targets[i]);
+        if (target->transient) {
+            if (RenderTargetPool::INSTANCE == NULL) {
+                RenderTargetPool::INSTANCE = new RenderTargetPool();
+            }
+            vec4<GLint> viewport = FrameBuffer::getDefault()->getViewport();
+            ptr<Texture2D> t = RenderTargetPool::INSTANCE->acquireTexture(viewport.z, viewport.w,
+                target->internalFormat, target->format, target->type, target->params);
+            ptr<ValueSampler> v = owners[i]->getValue(target->texture.nameSymbol).cast<ValueSampler>();
+            if (v == NULL) {
+                owners[i]->addValue(new ValueSampler(SAMPLER_2D, target->texture.name, t));
+            } else {
+                v->set(t);
+            }
+            textures[i] = t;
+        }
+    }
+
+    if (ORK_LOG_ENABLED(SCENEGRAPH, ORK_LOG_DEBUG) && Logger::DEBUG_LOGGER != NULL) {
         ostringstream os;
         os << "SetTarget";
         for (unsigned int i = 0; i < textures.size(); ++i) {
@@ -186,6 +239,8 @@ bool SetTargetTask::Impl::run()
             Resource* r = dynamic_cast<Resource*>(textures[i].get());
             if (r != NULL) {
                 os << " '" << r->getName() << "'";
+            } else if (source->targets[i].transient) {
+                os << " transient '" << source->targets[i].texture.name << "'";
             }
         }
         if (textures.size() == 0) {
@@ -269,11 +324,26 @@ public:
     {
         vector<Target> targets;
         e = e == NULL ? desc->descriptor : e;
-        checkParameters(desc, e, "name,autoResize,");
+        checkParameters(desc, e, "name,autoResize,release,");
         bool autoResize = false;
         if (e->Attribute("autoResize") != NULL) {
             autoResize = strcmp(e->Attribute("autoResize"), "true") == 0;
         }
+        vector<QualifiedName> releases;
+        if (e->Attribute("release") != NULL) {
+            string names = getParameter(desc, e, "release") + ",";
+            string::size_type start = 0;
+            string::size_type index;
+            while ((index = names.find(',', start)) != string::npos) {
+                string name = names.substr(start, index - start);
+                string::size_type first = name.find_first_not_of(" \t\r\n");
+                if (first != string::npos) {
+                    string::size_type last = name.find_last_not_of(" \t\r\n");
+                    releases.push_back(QualifiedName(name.substr(first, last - first + 1)));
+                }
+                start = index + 1;
+            }
+        }
         const TiXmlNode *n = e->FirstChild();
         while (n != NULL) {
             const TiXmlElement *f = n->ToElement();
@@ -285,7 +355,7 @@ public:
                     }
                     throw exception();
                 }
-                checkParameters(desc, f, "name,texture,level,layer,");
+                checkParameters(desc, f, "name,texture,level,layer,transient,internalformat,format,type,min,mag,wraps,wrapt,minLod,maxLod,compare,borderType,borderr,borderg,borderb,bordera,maxAniso,");
                 string name = getParameter(desc, f, "name");
                 try {
                     t.buffer = getBufferFromName(name.c_str());
@@ -304,11 +374,19 @@ public:
                 if (f->Attribute("layer") != NULL) {
                     getIntParameter(desc, f, "layer", &t.layer);
                 }
+                t.transient = false;
+                if (f->Attribute("transient") != NULL) {
+                    t.transient = strcmp(f->Attribute("transient"), "true") == 0;
+                }
+                if (t.transient) {
+                    getParameters(desc, f, t.internalFormat, t.format, t.type);
+                    getParameters(desc, f, t.params);
+                }
                 targets.push_back(t);
             }
             n = n->NextSibling();
         }
-        init(targets, autoResize);
+        init(targets, autoResize, releases);
     }
 };
 
@@ -82,6 +82,42 @@ public:
          * The layer, z slice or cube face of #texture to be attached.
          */
         int layer;
+
+        /**
+         * True if #texture is a transient target. A transient Texture2D, of
+         * the size of the default framebuffer viewport, is acquired from
+         * RenderTargetPool#INSTANCE each time the task is executed, and is
+         * stored in the ValueSampler designated by #texture, in the scene
+         * node designated by #texture (or in the scene node that owns the
+         * task if the qualified name has no target part). Passes can then
+         * read it with a SetProgramTask whose setUniforms option is true.
+         */
+        bool transient;
+
+        /**
+         * The internal format of a transient target.
+         */
+        TextureInternalFormat internalFormat;
+
+        /**
+         * The format of the (undefined) initial pixels of a transient target.
+         */
+        TextureFormat format;
+
+        /**
+         * The type of the (undefined) initial pixels of a transient target.
+         */
+        PixelType type;
+
+        /**
+         * The texture parameters of a transient target.
+         */
+        Texture::Parameters params;
+
+        /**
+         * Creates a non transient target with default values.
+         */
+        Target();
     };
 
     /**
@@ -90,8 +126,13 @@ public:
      * @param targets the framebuffer attachments to be set.
      * @param autoResize true to automatically resize the target textures to
      *      the default framebuffer viewport size.
+     * @param releases the transient targets of previous tasks that are no
+     *      longer used. Their textures are given back to the
+     *      RenderTargetPool#INSTANCE before this task acquires its own
+     *      transient targets, so that they can be reused.
      */
-    SetTargetTask(const std::vector<Target> &targets, bool autoResize);
+    SetTargetTask(const std::vector<Target> &targets, bool autoResize,
+        const std::vector<QualifiedName> &releases = std::vector<QualifiedName>());
 
     /**
      * Deletes this SetTargetTask.
@@ -112,8 +153,11 @@ protected:
      * @param targets the framebuffer attachments to be set.
      * @param autoResize true to automatically resize the target textures to
      *      the default framebuffer viewport size.
+     * @param releases the transient targets of previous tasks that are no
+     *      longer used.
      */
-    void init(const std::vector<Target> &targets, bool autoResize);
+    void init(const std::vector<Target> &targets, bool autoResize,
+        const std::vector<QualifiedName> &releases = std::vector<QualifiedName>());
 
     /**
      * Swaps this SetTargetTask with the given one.
@@ -139,6 +183,11 @@ private:
      */
     bool autoResize;
 
+    /**
+     * The transient targets of previous tasks that are no longer used.
+     */
+    std::vector<QualifiedName> releases;
+
     /**
      * Returns an offscreen framebuffer for use with SetTargetTask.
      */
@@ -160,14 +209,30 @@ private:
          */
         std::vector< ptr<Texture> > textures;
 
+        /**
+         * The scene nodes where the transient targets must be stored (NULL
+         * for non transient targets).
+         */
+        std::vector< ptr<SceneNode> > owners;
+
+        /**
+         * The scene nodes containing the transient targets to be released.
+         */
+        std::vector< ptr<SceneNode> > releaseOwners;
+
         /**
          * Creates a new SetTargetTask::Impl.
          *
          * @param source the SetTargetTask that created this task.
          * @param textures the textures to be set to the framebuffer attachment
-         *      points.
+         *      points (NULL for transient targets).
+         * @param owners the scene nodes where the transient targets must be
+         *      stored.
+         * @param releaseOwners the scene nodes containing the transient
+         *      targets to be released.
          */
-        Impl(ptr<SetTargetTask> source, std::vector< ptr<Texture> > textures);
+        Impl(ptr<SetTargetTask> source, std::vector< ptr<Texture> > textures,
+            std::vector< ptr<SceneNode> > owners, std::vector< ptr<SceneNode> > releaseOwners);
 
         /**
          * Deletes this SetTargetTask::Impl.
@@ -79,15 +79,6 @@ void SetTransformsTask::init(const string &screen, QualifiedName m,
     this->wtos = wtos;
     this->wp = wp;
     this->wd = wd;
-    this->time = NULL;
-    this->localToWorld = NULL;
-    this->localToScreen = NULL;
-    this->cameraToWorld = NULL;
-    this->cameraToScreen = NULL;
-    this->screenToCamera = NULL;
-    this->worldToScreen = NULL;
-    this->worldPos = NULL;
-    this->worldDir = NULL;
 }
 
 SetTransformsTask::~SetTransformsTask()
@@ -100,18 +91,25 @@ ptr<Task> SetTransformsTask::getTask(ptr<Object> context)
     ptr<SceneNode> screenNode;
     if (ltos == NULL || wtos == NULL) {
         if (screen.target.size() > 0) {
-            screenNode = screen.getTarget(n);
-            if (screenNode == NULL) {
-                if (Logger::ERROR_LOGGER != NULL) {
-                    Logger::ERROR_LOGGER->log("SCENEGRAPH", "SetTransforms: cannot find screen node");
+            SceneNode *v = screen.getVariable(n);
+            ptr<SceneNode> *cached = screenNodes.find(n.get(), v);
+            if (cached != NULL) {
+                screenNode = *cached;
+            } else {
+                screenNode = screen.getTarget(n);
+                if (screenNode == NULL) {
+                    if (Logger::ERROR_LOGGER != NULL) {
+                        Logger::ERROR_LOGGER->log("SCENEGRAPH", "SetTransforms: cannot find screen node");
+                    }
+                    throw exception();
                 }
-                throw exception();
+                screenNodes.put(n.get(), v, screenNode);
             }
         }
     }
 
     if (m.target.size() > 0 && module == NULL) {
-        module = m.getTarget(n)->getModule(m.name);
+        module = m.getTarget(n)->getModule(m.nameSymbol);
         if (module == NULL) {
             if (Logger::ERROR_LOGGER != NULL) {
                 Logger::ERROR_LOGGER->log("SCENEGRAPH", "SetTransforms: cannot find " + m.target + "." + m.name + " module");
@@ -144,18 +142,46 @@ void SetTransformsTask::swap(ptr<SetTransformsTask> t)
     std::swap(stoc, t->stoc);
     std::swap(wp, t->wp);
     std::swap(wd, t->wd);
+    programUniforms.clear();
+    t->programUniforms.clear();
+    screenNodes.clear();
+    t->screenNodes.clear();
+}
 
-    if (lastProg != NULL) {
-        time = this->t == NULL ? NULL : lastProg->getUniform2f(this->t);
-        localToWorld = ltow == NULL ? NULL : lastProg->getUniformMatrix4f(ltow);
-        localToScreen = ltos == NULL ? NULL : lastProg->getUniformMatrix4f(ltos);
-        cameraToWorld = ctow == NULL ? NULL : lastProg->getUniformMatrix4f(ctow);
-        cameraToScreen = ctos == NULL ? NULL : lastProg->getUniformMatrix4f(ctos);
-        screenToCamera = stoc == NULL ? NULL : lastProg->getUniformMatrix4f(stoc);
-        worldToScreen = wtos == NULL ? NULL : lastProg->getUniformMatrix4f(wtos);
-        worldPos = wp == NULL ? NULL : lastProg->getUniform3f(wp);
-        worldDir = wd == NULL ? NULL : lastProg->getUniform3f(wd);
+SetTransformsTask::Uniforms *SetTransformsTask::getUniforms(ptr<Program> prog)
+{
+    Uniforms *u = NULL;
+    for (unsigned int i = 0; i < programUniforms.size(); ++i) {
+        if (programUniforms[i].prog == prog.get()) {
+            u = &(programUniforms[i]);
+            if (u->id == prog->getId() && u->version == prog->getVersion()) {
+                return u;
+            }
+            break;
+        }
     }
+    if (u == NULL) {
+        // starts again from an empty cache when it is full, in case this task
+        // is used with many programs created and deleted over time
+        if (programUniforms.size() >= 16) {
+            programUniforms.clear();
+        }
+        programUniforms.push_back(Uniforms());
+        u = &(programUniforms.back());
+        u->prog = prog.get();
+    }
+    u->id = prog->getId();
+    u->version = prog->getVersion();
+    u->time = t == NULL ? NULL : prog->getUniform2f(t);
+    u->localToWorld = ltow == NULL ? NULL : prog->getUniformMatrix4f(ltow);
+    u->localToScreen = ltos == NULL ? NULL : prog->getUniformMatrix4f(ltos);
+    u->cameraToWorld = ctow == NULL ? NULL : prog->getUniformMatrix4f(ctow);
+    u->cameraToScreen = ctos == NULL ? NULL : prog->getUniformMatrix4f(ctos);
+    u->screenToCamera = stoc == NULL ? NULL : prog->getUniformMatrix4f(stoc);
+    u->worldToScreen = wtos == NULL ? NULL : prog->getUniformMatrix4f(wtos);
+    u->worldPos = wp == NULL ? NULL : prog->getUniform3f(wp);
+    u->worldDir = wd == NULL ? NULL : prog->getUniform3f(wd);
+    return u;
 }
 
 SetTransformsTask::Impl::Impl(ptr<SceneNode> screenNode, ptr<SceneNode> context, ptr<SetTransformsTask> source) :
@@ -169,9 +195,7 @@ SetTransformsTask::Impl::~Impl()
 
 bool SetTransformsTask::Impl::run()
 {
-    if (Logger::DEBUG_LOGGER != NULL) {
-        Logger::DEBUG_LOGGER->log("SCENEGRAPH", "SetTransforms");
-    }
+    ORK_DEBUG(SCENEGRAPH, "SetTransforms");
 
     ptr<Program> prog = NULL;
     if (source->module != NULL && !source->module->getUsers().empty()) {
@@ -183,73 +207,60 @@ bool SetTransformsTask::Impl::run()
     if (prog == NULL) {
         return true;
     }
-    if (Logger::DEBUG_LOGGER != NULL) {
-        Logger::DEBUG_LOGGER->logf("SCENEGRAPH", "SetTransforms %d", prog.get());
-    }
+    ORK_DEBUGF(SCENEGRAPH, "SetTransforms %p", prog.get());
 
-    if (prog != source->lastProg) {
-        source->time = source->t == NULL ? NULL : prog->getUniform2f(source->t);
-        source->localToWorld = source->ltow == NULL ? NULL : prog->getUniformMatrix4f(source->ltow);
-        source->localToScreen = source->ltos == NULL ? NULL : prog->getUniformMatrix4f(source->ltos);
-        source->cameraToWorld = source->ctow == NULL ? NULL : prog->getUniformMatrix4f(source->ctow);
-        source->cameraToScreen = source->ctos == NULL ? NULL : prog->getUniformMatrix4f(source->ctos);
-        source->screenToCamera = source->stoc == NULL ? NULL : prog->getUniformMatrix4f(source->stoc);
-        source->worldToScreen = source->wtos == NULL ? NULL : prog->getUniformMatrix4f(source->wtos);
-        source->worldPos = source->wp == NULL ? NULL : prog->getUniform3f(source->wp);
-        source->worldDir = source->wd == NULL ? NULL : prog->getUniform3f(source->wd);
-        source->lastProg = prog;
-    }
+    Uniforms *u = source->getUniforms(prog);
 
-    if (source->time != NULL) {
-        source->time->set(vec2f(context->getOwner()->getTime(), context->getOwner()->getElapsedTime()));
+    if (u->time != NULL) {
+        u->time->set(vec2f(context->getOwner()->getTime(), context->getOwner()->getElapsedTime()));
     }
 
-    if (source->localToWorld != NULL) {
-        source->localToWorld->setMatrix(context->getLocalToWorld().cast<float>());
+    if (u->localToWorld != NULL) {
+        u->localToWorld->setMatrix(context->getLocalToWorld().cast<float>());
     }
 
-    if (source->localToScreen!= NULL) {
+    if (u->localToScreen != NULL) {
         if (source->screen.target.size() == 0) {
-            source->localToScreen->setMatrix(context->getLocalToScreen().cast<float>());
+            u->localToScreen->setMatrix(context->getLocalToScreen().cast<float>());
         } else {
             mat4d ltow = context->getLocalToWorld();
             mat4d wtos = screenNode->getWorldToLocal();
             mat4f ltos = (wtos * ltow).cast<float>();
-            source->localToScreen->setMatrix(ltos);
+            u->localToScreen->setMatrix(ltos);
         }
     }
 
-    if (source->cameraToWorld != NULL) {
+    if (u->cameraToWorld != NULL) {
         mat4d ctow = context->getOwner()->getCameraNode()->getLocalToWorld();
-        source->cameraToWorld->setMatrix(ctow.cast<float>());
+        u->cameraToWorld->setMatrix(ctow.cast<float>());
     }
 
-    if (source->cameraToScreen != NULL) {
+    if (u->cameraToScreen != NULL) {
         mat4d ctos = context->getOwner()->getCameraToScreen();
-        source->cameraToScreen->setMatrix(ctos.cast<float>());
+        u->cameraToScreen->setMatrix(ctos.cast<float>());
     }
 
-    if (source->screenToCamera != NULL) {
+    if (u->screenToCamera != NULL) {
         mat4d ctos = context->getOwner()->getCameraToScreen();
-        source->screenToCamera->setMatrix(ctos.inverse().cast<float>());
+        u->screenToCamera->setMatrix(ctos.inverse().cast<float>());
     }
 
-    if (source->worldToScreen != NULL) {
+    if (u->worldToScreen != NULL) {
         if (source->screen.target.size() == 0) {
-            source->worldToScreen->setMatrix(context->getOwner()->getWorldToScreen().cast<float>());
+            u->worldToScreen->setMatrix(context->getOwner()->getWorldToScreen().cast<float>());
         } else {
             mat4f wtos = screenNode->getWorldToLocal().cast<float>();
-            source->worldToScreen->setMatrix(wtos);
+            u->worldToScreen->setMatrix(wtos);
         }
     }
 
-    if (source->worldPos != NULL) {
-        source->worldPos->set(context->getWorldPos().cast<float>());
+    if (u->worldPos != NULL) {
+        u->worldPos->set(context->getWorldPos().cast<float>());
     }
 
-    if (source->worldDir != NULL) {
+    if (u->worldDir != NULL) {
         vec4d d = context->getLocalToWorld() * vec4d::UNIT_Z;
-        source->worldDir->set(vec3f((float) -d.x, (float) -d.y, (float) -d.z));
+        u->worldDir->set(vec3f((float) -d.x, (float) -d.y, (float) -d.z));
     }
 
     return true;
@@ -130,25 +130,53 @@ private:
 
     ptr<Module> module;
 
-    ptr<Program> lastProg;
+    /**
+     * The uniforms set by this task in a given program.
+     */
+    struct Uniforms
+    {
+        /**
+         * The program containing these uniforms. This is not a smart pointer,
+         * so that this cache does not keep deleted programs alive. It is only
+         * compared with the current program, together with #id, and never
+         * dereferenced.
+         */
+        Program *prog;
+
+        int id; ///< the OpenGL id of #prog when these uniforms were found.
+
+        unsigned int version; ///< the version of #prog used to get these uniforms.
+
+        ptr<Uniform2f> time;
+
+        ptr<UniformMatrix4f> localToWorld;
 
-    ptr<Uniform2f> time;
+        ptr<UniformMatrix4f> localToScreen;
 
-    ptr<UniformMatrix4f> localToWorld;
+        ptr<UniformMatrix4f> cameraToWorld;
 
-    ptr<UniformMatrix4f> localToScreen;
+        ptr<UniformMatrix4f> cameraToScreen;
 
-    ptr<UniformMatrix4f> cameraToWorld;
+        ptr<UniformMatrix4f> screenToCamera;
 
-    ptr<UniformMatrix4f> cameraToScreen;
+        ptr<UniformMatrix4f> worldToScreen;
 
-    ptr<UniformMatrix4f> screenToCamera;
+        ptr<Uniform3f> worldPos;
 
-    ptr<UniformMatrix4f> worldToScreen;
+        ptr<Uniform3f> worldDir;
+    };
 
-    ptr<Uniform3f> worldPos;
+    /**
+     * The uniforms of the programs recently used by this task. This avoids
+     * looking up the uniforms by name each time the current program changes.
+     * This cache is cleared when it reaches 16 programs.
+     */
+    std::vector<Uniforms> programUniforms;
 
-    ptr<Uniform3f> worldDir;
+    /**
+     * The "screen" nodes resolved by #getTask.
+     */
+    BindingCache< ptr<SceneNode> > screenNodes;
 
     const char *t;
 
@@ -168,6 +196,13 @@ private:
 
     const char *wd;
 
+    /**
+     * Returns the uniforms set by this task in the given program.
+     *
+     * @param prog a program.
+     */
+    Uniforms *getUniforms(ptr<Program> prog);
+
     /**
      * An ork::Task to set transformation matrices in programs.
      */
@@ -102,8 +102,6 @@ void initInfoTask(ptr<ResourceManager> manager, const string &name, ptr<Resource
     pos = vec3i(x, y, maxLines);
 }
 
-static_ptr< Mesh<Font::Vertex, unsigned int> > ShowInfoTask::fontMesh;
-
 map<string, string> ShowInfoTask::infos;
 
 ShowInfoTask::ShowInfoTask() : AbstractTask("ShowInfoTask")
@@ -127,10 +125,10 @@ void ShowInfoTask::init(ptr<Font> f, ptr<Program> p, int color, float size, vec3
     fontColor = color;
     position = pos;
     fontHeight = size;
-    if (fontMesh == NULL) {
-        fontMesh = new Mesh<Font::Vertex, unsigned int>(TRIANGLES, GPU_DYNAMIC);
-        fontMesh->addAttributeType(0, 4, A16F, false);
-        fontMesh->addAttributeType(1, 4, A8UI, true);
+    if (text == NULL) {
+        text = new TextBatch(f);
+    } else {
+        text->setFont(f);
     }
 }
 
@@ -150,14 +148,12 @@ void ShowInfoTask::setInfo(const string &topic, const string &info)
 
 void ShowInfoTask::drawLine(const vec4f &vp, float xs, float ys, int color, const string &s)
 {
-    font->addLine(vp, xs, ys, s, fontHeight, color, fontMesh);
+    text->addLine(vp, xs, ys, s, fontHeight, color);
 }
 
 void ShowInfoTask::draw(ptr<Method> context)
 {
-    if (Logger::DEBUG_LOGGER != NULL) {
-        Logger::DEBUG_LOGGER->log("SCENEGRAPH", "ShowInfo");
-    }
+    ORK_DEBUG(SCENEGRAPH, "ShowInfo");
 
     ptr<FrameBuffer> fb = SceneManager::getCurrentFrameBuffer();
     fb->setBlend(true, ADD, SRC_ALPHA, ONE_MINUS_SRC_ALPHA, ADD, ZERO, ONE);
@@ -187,7 +183,7 @@ void ShowInfoTask::draw(ptr<Method> context)
         os << i->second << " FPS";
     }
 
-    fontMesh->clear();
+    text->begin();
     drawLine(vp, xs, ys, fontColor, os.str());
     ys += fontHeight;
 
@@ -202,7 +198,7 @@ void ShowInfoTask::draw(ptr<Method> context)
     infos.clear();
 
     fontU->set(font->getImage());
-    fb->draw(fontProgram, *fontMesh);
+    text->draw(fb, fontProgram);
 
     fb->setBlend(false);
 
@@ -213,6 +209,7 @@ void ShowInfoTask::swap(ptr<ShowInfoTask> t)
     std::swap(fontProgram, t->fontProgram);
     std::swap(fontU, t->fontU);
     std::swap(font, t->font);
+    std::swap(text, t->text);
     std::swap(fontColor, t->fontColor);
     std::swap(fontHeight, t->fontHeight);
     std::swap(position, t->position);
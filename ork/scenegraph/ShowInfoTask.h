@@ -43,10 +43,10 @@
 #define _ORK_SHOW_INFO_TASK_H_
 
 #include <time.h>
-#include "ork/render/Mesh.h"
 #include "ork/render/Program.h"
 #include "ork/scenegraph/AbstractTask.h"
 #include "ork/util/Font.h"
+#include "ork/util/TextBatch.h"
 
 namespace ork
 {
@@ -89,9 +89,11 @@ public:
 
 protected:
     /**
-     * The mesh used to draw character quads, in order to display text.
+     * The character quads of the displayed lines of text. The quads of the
+     * lines that do not change from one frame to the next are not recomputed
+     * nor uploaded again, and all the lines are drawn with one draw call.
      */
-    static static_ptr< Mesh<Font::Vertex, unsigned int> > fontMesh;
+    ptr<TextBatch> text;
 
     /**
      * The current information messages, associated with their topic.
@@ -152,7 +154,7 @@ protected:
     virtual void swap(ptr<ShowInfoTask> t);
 
     /**
-     * Draws a line of text.
+     * Adds a line of text to #text.
      *
      * @param vp the framebuffer viewport, in pixels.
      * @param xs the x coordinate of the first character to display.
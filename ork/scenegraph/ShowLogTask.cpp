@@ -43,6 +43,7 @@
 
 #include "ork/scenegraph/ShowLogTask.h"
 
+#include "ork/core/AsyncLogger.h"
 #include "ork/render/FrameBuffer.h"
 #include "ork/resource/ResourceTemplate.h"
 #include "ork/scenegraph/SceneManager.h"
@@ -82,14 +83,30 @@ public:
     {
         types = new type[capacity];
         lines = new string[capacity];
+        pthread_mutex_init(&mutex, NULL);
     }
 
     virtual ~LogBuffer()
     {
+        pthread_mutex_destroy(&mutex);
         delete[] types;
         delete[] lines;
     }
 
+    /**
+     * Locks this buffer. Lines can be added by several loggers, possibly
+     * from an AsyncLogger writer thread, while they are displayed.
+     */
+    void lock()
+    {
+        pthread_mutex_lock(&mutex);
+    }
+
+    void unlock()
+    {
+        pthread_mutex_unlock(&mutex);
+    }
+
     int getSize()
     {
         return size;
@@ -145,6 +162,8 @@ private:
     int first;
 
     int size;
+
+    pthread_mutex_t mutex;
 };
 
 static_ptr<LogBuffer> LogBuffer::INSTANCE;
@@ -165,9 +184,9 @@ public:
     {
         if (next != NULL) {
             if (next->hasTopic(topic)) {
-                pthread_mutex_lock((pthread_mutex_t*) mutex);
+                buf->lock();
                 buf->addText(type, "[" + topic + "] " + msg + '\n');
-                pthread_mutex_unlock((pthread_mutex_t*) mutex);
+                buf->unlock();
             }
             next->log(topic, msg);
         }
@@ -188,6 +207,22 @@ private:
     ptr<Logger> next;
 };
 
+/**
+ * Returns a logger that logs the messages of the given logger in the given
+ * buffer, and then forwards them to this logger. If the given logger is an
+ * AsyncLogger, the MemLogger is inserted after it, so that lines are added
+ * to the buffer by the writer thread instead of the logging threads.
+ */
+static ptr<Logger> addMemLogger(const string &type, LogBuffer::type t, ptr<LogBuffer> buf, ptr<Logger> logger)
+{
+    ptr<AsyncLogger> async = logger.cast<AsyncLogger>();
+    if (async != NULL) {
+        async->setNext(new MemLogger(type, t, buf, async->getNext()));
+        return async;
+    }
+    return new MemLogger(type, t, buf, logger);
+}
+
 bool ShowLogTask::enabled = false;
 
 ShowLogTask::ShowLogTask() : ShowInfoTask()
@@ -206,11 +241,11 @@ void ShowLogTask::init(ptr<Font> f, ptr<Program> p, float fontHeight, vec3i pos)
         int capacity = 256;
         ptr<LogBuffer> buf = LogBuffer::getInstance(capacity);
         if (Logger::DEBUG_LOGGER != NULL) {
-            Logger::DEBUG_LOGGER = new MemLogger("DEBUG_LOGGER", LogBuffer::DEBUG_LOG, buf, Logger::DEBUG_LOGGER);
+            Logger::DEBUG_LOGGER = addMemLogger("DEBUG_LOGGER", LogBuffer::DEBUG_LOG, buf, Logger::DEBUG_LOGGER);
         }
-        Logger::INFO_LOGGER = new MemLogger("INFO", LogBuffer::INFO_LOG, buf, Logger::INFO_LOGGER);
-        Logger::WARNING_LOGGER = new MemLogger("WARNING", LogBuffer::WARNING_LOG, buf, Logger::WARNING_LOGGER);
-        Logger::ERROR_LOGGER = new MemLogger("ERROR", LogBuffer::ERROR_LOG, buf, Logger::ERROR_LOGGER);
+        Logger::INFO_LOGGER = addMemLogger("INFO", LogBuffer::INFO_LOG, buf, Logger::INFO_LOGGER);
+        Logger::WARNING_LOGGER = addMemLogger("WARNING", LogBuffer::WARNING_LOG, buf, Logger::WARNING_LOGGER);
+        Logger::ERROR_LOGGER = addMemLogger("ERROR", LogBuffer::ERROR_LOG, buf, Logger::ERROR_LOGGER);
         initialized = true;
     }
     ShowInfoTask::init(f, p, 0, fontHeight, pos);
@@ -236,11 +271,12 @@ void ShowLogTask::draw(ptr<Method> context)
     ptr<FrameBuffer> fb = SceneManager::getCurrentFrameBuffer();
     fb->setBlend(true, ADD, SRC_ALPHA, ONE_MINUS_SRC_ALPHA, ADD, ZERO, ONE);
 
-    fontMesh->clear();
+    text->begin();
 
     vec4f vp = fb->getViewport().cast<float>();
 
     float xs = (float) position.x;
+    buf->lock();
     float ys = (float) ((position.y > 0) ? position.y : vp.w + position.y - min(buf->getSize(), position.z) * fontHeight);
     for (int l = max(0, buf->getSize() - position.z); l < buf->getSize(); ++l) {
         LogBuffer::type t = buf->getType(l);
@@ -255,8 +291,9 @@ void ShowLogTask::draw(ptr<Method> context)
         }
         ys += (float) fontHeight;
     }
+    buf->unlock();
 
-    fb->draw(fontProgram, *fontMesh);
+    text->draw(fb, fontProgram);
     fb->setBlend(false);
 }
 
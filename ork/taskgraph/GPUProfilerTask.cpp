@@ -0,0 +1,101 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#include "ork/taskgraph/GPUProfilerTask.h"
+
+#include "ork/core/GPUProfiler.h"
+#include "ork/taskgraph/TaskGraph.h"
+
+using namespace std;
+
+namespace ork
+{
+
+GPUProfilerTask::GPUProfilerTask(const string &name) :
+    Task("GPUProfilerTask", true, 0), name(name), pass(-1)
+{
+}
+
+GPUProfilerTask::GPUProfilerTask(ptr<GPUProfilerTask> begin) :
+    Task("GPUProfilerTask", true, 0), name(begin->name), begin(begin), pass(-1)
+{
+}
+
+GPUProfilerTask::~GPUProfilerTask()
+{
+}
+
+bool GPUProfilerTask::run()
+{
+    GPUProfiler *profiler = GPUProfiler::INSTANCE.get();
+    if (profiler != NULL) {
+        if (begin == NULL) {
+            pass = profiler->beginPass(name);
+        } else if (begin->pass >= 0) {
+            profiler->endPass(begin->pass);
+            begin->pass = -1;
+        }
+    }
+    return true;
+}
+
+ptr<Task> GPUProfilerTask::annotate(ptr<Task> t, const string &name)
+{
+    if (GPUProfiler::INSTANCE == NULL) {
+        return t;
+    }
+    ptr<TaskGraph> tg = t.cast<TaskGraph>();
+    if (tg != NULL && tg->isEmpty()) {
+        // empty task graphs are ignored by the callers, they must remain empty
+        return t;
+    }
+    ptr<GPUProfilerTask> b = new GPUProfilerTask(name);
+    ptr<GPUProfilerTask> e = new GPUProfilerTask(b);
+    ptr<TaskGraph> result = new TaskGraph();
+    result->addTask(b);
+    result->addTask(t);
+    result->addTask(e);
+    result->addDependency(t, b);
+    result->addDependency(e, t);
+    return result;
+}
+
+}
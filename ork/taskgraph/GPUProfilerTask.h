@@ -0,0 +1,113 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#ifndef _ORK_GPU_PROFILER_TASK_H_
+#define _ORK_GPU_PROFILER_TASK_H_
+
+#include <string>
+
+#include "ork/taskgraph/Task.h"
+
+namespace ork
+{
+
+/**
+ * A GPU task that begins or ends a GPUProfiler pass. Such tasks are used to
+ * measure the GPU time of a whole Task or TaskGraph, see #annotate. They
+ * do nothing if GPUProfiler#INSTANCE is NULL.
+ *
+ * @ingroup taskgraph
+ */
+class ORK_API GPUProfilerTask : public Task
+{
+public:
+    /**
+     * Creates a new GPUProfilerTask that begins a pass.
+     *
+     * @param name the pass name.
+     */
+    GPUProfilerTask(const std::string &name);
+
+    /**
+     * Creates a new GPUProfilerTask that ends a pass.
+     *
+     * @param begin the task that begins the pass.
+     */
+    GPUProfilerTask(ptr<GPUProfilerTask> begin);
+
+    /**
+     * Deletes this GPUProfilerTask.
+     */
+    virtual ~GPUProfilerTask();
+
+    virtual bool run();
+
+    /**
+     * Returns a task graph that executes the given task between two
+     * GPUProfilerTask, so that its GPU time is measured in a pass of the
+     * given name. Returns t itself if GPUProfiler#INSTANCE is NULL, or if t
+     * is an empty TaskGraph.
+     *
+     * @param t a task.
+     * @param name the pass name.
+     */
+    static ptr<Task> annotate(ptr<Task> t, const std::string &name);
+
+private:
+    /**
+     * The pass name.
+     */
+    std::string name;
+
+    /**
+     * The task that begins the pass, or NULL if this task begins the pass.
+     */
+    ptr<GPUProfilerTask> begin;
+
+    /**
+     * The pass identifier returned by GPUProfiler#beginPass, or -1.
+     */
+    int pass;
+};
+
+}
+
+#endif
@@ -45,10 +45,16 @@
 #include <time.h>
 #include <fstream>
 
+#include <GL/glew.h>
+
 #include "ork/core/Timer.h"
+#include "ork/core/GPUProfiler.h"
 #include "ork/core/Logger.h"
 #include "ork/resource/ResourceTemplate.h"
+#include "ork/taskgraph/GPUProfilerTask.h"
 #include "ork/taskgraph/TaskGraph.h"
+#include "ork/taskgraph/TaskPool.h"
+#include "ork/taskgraph/TaskTracer.h"
 
 #include <pthread.h>
 
@@ -107,6 +113,16 @@ static void getAbsoluteTime(timespec &ts)
 #endif
 }
 
+/**
+ * Returns the name of the type of the given task, used to group its GPU
+ * profiling results.
+ */
+static string getTaskType(ork::Task *t)
+{
+    const char *type = t->getClass();
+    return type[0] != 0 ? string(type) : string(typeid(*t).name());
+}
+
 namespace ork
 {
 
@@ -125,6 +141,11 @@ bool MultithreadScheduler::taskKeySort::operator()(const taskKey &x, const taskK
 
 bool MultithreadScheduler::taskSort::operator()(const ptr<Task> x, const ptr<Task> y) const
 {
+    double xPriority = x->getQueuePriority();
+    double yPriority = y->getQueuePriority();
+    if (xPriority != yPriority) {
+        return xPriority > yPriority;
+    }
     int xDuration = int(x->getExpectedDuration());
     int yDuration = int(y->getExpectedDuration());
     if (xDuration == yDuration) {
@@ -134,6 +155,17 @@ bool MultithreadScheduler::taskSort::operator()(const ptr<Task> x, const ptr<Tas
     }
 }
 
+bool MultithreadScheduler::prefetchSort::operator()(const ptr<Task> x, const ptr<Task> y) const
+{
+    double xPriority = x->getQueuePriority();
+    double yPriority = y->getQueuePriority();
+    if (xPriority == yPriority) {
+        return x.get() < y.get();
+    } else {
+        return xPriority < yPriority;
+    }
+}
+
 MultithreadScheduler::MultithreadScheduler(int prefetchRate, int prefetchQueue, float frameRate, int nThreads) :
         Scheduler("MultithreadScheduler")
 {
@@ -145,6 +177,7 @@ void MultithreadScheduler::init(int prefetchRate, int prefetchQueue, float frame
     mutex = new pthread_mutex_t;
     allTasksCond = new pthread_cond_t;
     cpuTasksCond = new pthread_cond_t;
+    uploadTasksCond = new pthread_cond_t;
     pthread_mutexattr_t attrs;
     pthread_mutexattr_init(&attrs);
     pthread_mutexattr_settype(&attrs, PTHREAD_MUTEX_RECURSIVE);
@@ -152,15 +185,22 @@ void MultithreadScheduler::init(int prefetchRate, int prefetchQueue, float frame
     pthread_mutexattr_destroy(&attrs);
     pthread_cond_init((pthread_cond_t*) allTasksCond, NULL);
     pthread_cond_init((pthread_cond_t*) cpuTasksCond, NULL);
+    pthread_cond_init((pthread_cond_t*) uploadTasksCond, NULL);
     this->prefetchRate = prefetchRate;
     this->prefetchQueueSize = prefetchQueue;
     framePeriod = frameRate == 0.0f ? 0.0f : 1e6f / frameRate;
     if (prefetchRate > 0 || frameRate > 0.0f) {
         assert(prefetchQueueSize > 0);
     }
+    aging = 0.001f;
+    frameCount = 0;
     lastFrame = 0;
+    scheduleTime = 0;
     time = 2;
     stop = false;
+    uploadThread = NULL;
+    stopUpload = false;
+    uploadStarted = false;
     for (int i = 0; i < nThreads; ++i) {
         pthread_t *thread = new pthread_t;
         pthread_create(thread, NULL, schedulerThread, this);
@@ -173,6 +213,7 @@ void MultithreadScheduler::init(int prefetchRate, int prefetchQueue, float frame
 
 MultithreadScheduler::~MultithreadScheduler()
 {
+    setUploadContext(NULL);
     // we first set the #stop flag to true and signals execution threads to wake
     // them up if they were waiting for tasks to execute; they will then
     // eventually terminate
@@ -192,6 +233,8 @@ MultithreadScheduler::~MultithreadScheduler()
     delete (pthread_cond_t*) cpuTasksCond;
     pthread_cond_destroy((pthread_cond_t*) allTasksCond);
     delete (pthread_cond_t*) allTasksCond;
+    pthread_cond_destroy((pthread_cond_t*) uploadTasksCond);
+    delete (pthread_cond_t*) uploadTasksCond;
     threads.clear();
     if (bufferedFrames > 0) {
         clearBufferedFrames();
@@ -203,13 +246,7 @@ MultithreadScheduler::~MultithreadScheduler()
 
 bool MultithreadScheduler::supportsPrefetch(bool gpuTasks)
 {
-    if (prefetchRate > 0 || framePeriod > 0.0f || (threads.size() > 0 && !gpuTasks)) {
-        if (gpuTasks || threads.empty()) {
-            return prefetchQueue.size() < prefetchQueueSize;
-        }
-        return true;
-    }
-    return false;
+    return prefetchRate > 0 || framePeriod > 0.0f || (threads.size() > 0 && !gpuTasks);
 }
 
 void MultithreadScheduler::schedule(ptr<Task> task)
@@ -218,8 +255,21 @@ void MultithreadScheduler::schedule(ptr<Task> task)
     task->init(initialized);
     pthread_mutex_lock((pthread_mutex_t*) mutex);
     bool noCpuTasks = readyCpuTasks.empty();
-    set< ptr<Task> > addedTasks;
-    addFlattenedTask(task, addedTasks);
+    TaskGraph::TaskSet addedTasks;
+    addFlattenedTask(task, addedTasks, 0.0);
+    if (prefetchQueueSize > 0) {
+        // if the prefetch queue is full, we cancel the tasks with the lowest
+        // priority (cancelTask also removes their successors from the queue)
+        PrefetchQueue::iterator i = prefetchQueue.begin();
+        while (prefetchQueue.size() > prefetchQueueSize && i != prefetchQueue.end()) {
+            ptr<Task> t = *i++;
+            if (cancelTask(t)) {
+                // the successors of t may have been removed too, so that
+                // i may no longer be valid
+                i = prefetchQueue.begin();
+            }
+        }
+    }
     pthread_cond_broadcast((pthread_cond_t*) allTasksCond);
     if (noCpuTasks && !readyCpuTasks.empty()) {
         // if there was no ready CPU tasks before this method was called,
@@ -227,7 +277,10 @@ void MultithreadScheduler::schedule(ptr<Task> task)
         // threads that may be waiting for tasks to execute.
         pthread_cond_broadcast((pthread_cond_t*) cpuTasksCond);
     }
-    assert(allReadyTasks.size() > 0);
+    if (!readyUploadTasks.empty()) {
+        pthread_cond_signal((pthread_cond_t*) uploadTasksCond);
+    }
+    assert(allReadyTasks.size() > 0 || readyUploadTasks.size() > 0 || immediateTasks.empty());
     pthread_mutex_unlock((pthread_mutex_t*) mutex);
 }
 
@@ -236,7 +289,7 @@ void MultithreadScheduler::reschedule(ptr<Task> task, Task::reason r, unsigned i
     pthread_mutex_lock((pthread_mutex_t*) mutex);
     task->setIsDone(false, 0, r);
     if (r == Task::DATA_NEEDED) {
-        set< ptr<Task> > visited;
+        TaskGraph::TaskSet visited;
         setDeadline(task, deadline, visited);
     }
     pthread_mutex_unlock((pthread_mutex_t*) mutex);
@@ -244,10 +297,18 @@ void MultithreadScheduler::reschedule(ptr<Task> task, Task::reason r, unsigned i
 
 void MultithreadScheduler::run(ptr<Task> task)
 {
+    TaskTracer *tracer = TaskTracer::INSTANCE.get();
+    if (tracer != NULL) {
+        tracer->frameBegin();
+    }
+
+    ++frameCount;
+
     Timer timer;
     timer.start();
     schedule(task);
     double schedule = timer.end();
+    scheduleTime = schedule;
 
     if (Logger::DEBUG_LOGGER != NULL) {
         ostringstream oss;
@@ -395,7 +456,21 @@ void MultithreadScheduler::run(ptr<Task> task)
                 previousGpuTask = t;
             }
 
-            if (t->getCompletionDate() >= t->getPredecessorsCompletionDate()) {
+            bool upToDate = t->getCompletionDate() >= t->getPredecessorsCompletionDate();
+
+            // if a GPU profiler is set, we measure the GPU time of t, grouped
+            // by task type (pass markers are not measured themselves)
+            int pass = -1;
+            if (t->isGpuTask() && GPUProfiler::INSTANCE != NULL && !upToDate &&
+                t.cast<GPUProfilerTask>() == NULL)
+            {
+                pass = GPUProfiler::INSTANCE->beginPass(getTaskType(t.get()));
+            }
+            if (tracer != NULL) {
+                tracer->taskBegin(t.get());
+            }
+
+            if (upToDate) {
                 // t is up to date, it is not necessary to run it
             } else if (framePeriod > 0.0 || monitoredTasks.size() > 0) {
                 // if we have a fixed framerate we measure the execution time
@@ -419,6 +494,13 @@ void MultithreadScheduler::run(ptr<Task> task)
                 changes = t->run();
             }
 
+            if (tracer != NULL) {
+                tracer->taskEnd(t.get(), !upToDate, changes);
+            }
+            if (pass >= 0) {
+                GPUProfiler::INSTANCE->endPass(pass);
+            }
+
             ++run;
             if (t->getDeadline() > 0) {
                 ++prefetched;
@@ -441,6 +523,21 @@ void MultithreadScheduler::run(ptr<Task> task)
         Logger::DEBUG_LOGGER->log("SCHEDULER", oss.str());
     }
 
+    // recycles the task objects and dependency sets freed by the scheduler
+    // threads during this frame, so that they can be reused at next frame
+    TaskPool::endFrame();
+
+    if (Logger::DEBUG_LOGGER != NULL) {
+        TaskPool::Statistics s = TaskPool::getFrameStatistics();
+        ostringstream oss;
+        oss << "POOL " << s.poolAllocations << " pool allocations, ";
+        oss << s.heapAllocations << " heap allocations, ";
+        oss << s.chunkAllocations << " new chunks, ";
+        oss << s.remoteFrees << " remote frees, ";
+        oss << s.reservedBytes / 1024 << " KB reserved";
+        Logger::DEBUG_LOGGER->log("SCHEDULER", oss.str());
+    }
+
     if (Logger::DEBUG_LOGGER != NULL && framePeriod > 0.0) {
         Task::logStatistics();
     }
@@ -491,7 +588,97 @@ void MultithreadScheduler::monitorTask(const string &taskType)
     monitoredTasks.push_back(taskType);
 }
 
-void MultithreadScheduler::addFlattenedTask(ptr<Task> t, set< ptr<Task> > &addedTasks)
+double MultithreadScheduler::getScheduleTime() const
+{
+    return scheduleTime;
+}
+
+void MultithreadScheduler::setPriority(ptr<Task> task, float priority)
+{
+    pthread_mutex_lock((pthread_mutex_t*) mutex);
+    TaskGraph::TaskSet visited;
+    offsetPriority(task, priority - task->getPriority(), visited);
+    task->setPriority(priority);
+    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+}
+
+bool MultithreadScheduler::cancel(ptr<Task> task)
+{
+    pthread_mutex_lock((pthread_mutex_t*) mutex);
+    bool cancelled = false;
+    ptr<TaskGraph> tg = task.cast<TaskGraph>();
+    if (tg == NULL) {
+        cancelled = cancelTask(task);
+    } else {
+        TaskGraph::TaskIterator i = tg->getAllTasks();
+        while (i.hasNext()) {
+            cancelled = cancel(i.next()) || cancelled;
+        }
+    }
+    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+    return cancelled;
+}
+
+void MultithreadScheduler::setAging(float aging)
+{
+    this->aging = aging;
+}
+
+bool MultithreadScheduler::setUploadContext(ptr<SharedContext> context)
+{
+    if (uploadThread != NULL) {
+        // stops the current upload thread
+        pthread_mutex_lock((pthread_mutex_t*) mutex);
+        stopUpload = true;
+        pthread_cond_signal((pthread_cond_t*) uploadTasksCond);
+        pthread_mutex_unlock((pthread_mutex_t*) mutex);
+        pthread_join(*((pthread_t*) uploadThread), NULL);
+        // the remaining upload tasks will now be executed by the main thread
+        pthread_mutex_lock((pthread_mutex_t*) mutex);
+        delete (pthread_t*) uploadThread;
+        uploadThread = NULL;
+        uploadContext = NULL;
+        SortedTaskSet::iterator i = readyUploadTasks.begin();
+        while (i != readyUploadTasks.end()) {
+            std::set<ptr<Task>, taskSort>::iterator j = i->second.begin();
+            while (j != i->second.end()) {
+                insertTask(allReadyTasks, *j);
+                ++j;
+            }
+            ++i;
+        }
+        readyUploadTasks.clear();
+        pthread_mutex_unlock((pthread_mutex_t*) mutex);
+    }
+    if (context == NULL) {
+        return true;
+    }
+    // starts a new upload thread, and waits until it has made the context
+    // current, or failed to do so
+    pthread_mutex_lock((pthread_mutex_t*) mutex);
+    uploadContext = context;
+    stopUpload = false;
+    uploadStarted = false;
+    uploadThread = new pthread_t;
+    pthread_create((pthread_t*) uploadThread, NULL, uploadTasks, this);
+    while (!uploadStarted && !stopUpload) {
+        pthread_cond_wait((pthread_cond_t*) allTasksCond, (pthread_mutex_t*) mutex);
+    }
+    bool started = uploadStarted;
+    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+    if (!started) {
+        pthread_join(*((pthread_t*) uploadThread), NULL);
+        delete (pthread_t*) uploadThread;
+        uploadThread = NULL;
+        uploadContext = NULL;
+        if (Logger::ERROR_LOGGER != NULL) {
+            Logger::ERROR_LOGGER->log("SCHEDULER", "Cannot make upload context current");
+        }
+    }
+    return started;
+}
+
+void MultithreadScheduler::addFlattenedTask(ptr<Task> t, TaskGraph::TaskSet &addedTasks, double priority)
 {
     // NOTE: the mutex should be locked before calling this method!
     if (addedTasks.find(t) != addedTasks.end()) {
@@ -501,14 +688,35 @@ void MultithreadScheduler::addFlattenedTask(ptr<Task> t, set< ptr<Task> > &added
     if (t->isDone()) {
         return;
     }
+    priority += t->getPriority();
     ptr<TaskGraph> tg = t.cast<TaskGraph>();
     if (tg == NULL) {
+        if (prefetchQueue.find(t) == prefetchQueue.end()) {
+            // the queue priority of prefetching tasks decreases with the
+            // frame in which they are scheduled, so that older tasks get
+            // a higher priority than newer ones (see #setAging)
+            if (t->getDeadline() > 0) {
+                priority -= double(aging) * frameCount;
+            }
+            if (t->getQueuePriority() != priority) {
+                // the ready sets are sorted by queue priority, we must
+                // remove t before changing its priority
+                removeTask(allReadyTasks, t);
+                removeTask(readyCpuTasks, t);
+                removeTask(readyUploadTasks, t);
+                t->setQueuePriority(priority);
+            }
+        }
         if (t->getDeadline() == 0) {
             immediateTasks.insert(t);
         } else {
             prefetchQueue.insert(t);
         }
-        insertTask(allReadyTasks, t);
+        if (isUploadTask(t)) {
+            insertTask(readyUploadTasks, t);
+        } else {
+            insertTask(allReadyTasks, t);
+        }
 #ifdef STRICT_PREFETCH
         if (!t->isGpuTask() && t->getDeadline() > 0) {
 #else
@@ -521,7 +729,7 @@ void MultithreadScheduler::addFlattenedTask(ptr<Task> t, set< ptr<Task> > &added
         tg->flattenedLastTasks.clear();
         TaskGraph::TaskIterator i = tg->getAllTasks();
         while (i.hasNext()) {
-            addFlattenedTask(i.next(), addedTasks);
+            addFlattenedTask(i.next(), addedTasks, priority);
         }
         i = tg->getFirstTasks();
         while (i.hasNext()) {
@@ -564,7 +772,7 @@ void MultithreadScheduler::addFlattenedDependency(ptr<Task> src, ptr<Task> dst)
     // NOTE: the mutex should be locked before calling this method!
     ptr<TaskGraph> srcTg = src.cast<TaskGraph>();
     if (srcTg != NULL) {
-        set< ptr<Task> >::iterator i = srcTg->flattenedFirstTasks.begin();
+        TaskGraph::TaskSet::iterator i = srcTg->flattenedFirstTasks.begin();
         while (i != srcTg->flattenedFirstTasks.end()) {
             ptr<Task> srcT = *i;
             addFlattenedDependency(srcT, dst);
@@ -573,25 +781,29 @@ void MultithreadScheduler::addFlattenedDependency(ptr<Task> src, ptr<Task> dst)
     } else {
         ptr<TaskGraph> dstTg = dst.cast<TaskGraph>();
         if (dstTg != NULL) {
-            set< ptr<Task> >::iterator i = dstTg->flattenedLastTasks.begin();
+            TaskGraph::TaskSet::iterator i = dstTg->flattenedLastTasks.begin();
             while (i != dstTg->flattenedLastTasks.end()) {
                 ptr<Task> dstT = *i;
                 addFlattenedDependency(src, dstT);
                 ++i;
             }
         } else {
-            set< ptr<Task> > visited;
+            TaskGraph::TaskSet visited;
             removeTask(allReadyTasks, src);
             removeTask(readyCpuTasks, src);
+            removeTask(readyUploadTasks, src);
             dependencies[src].insert(dst);
             inverseDependencies[dst].insert(src);
+            if (TaskTracer::INSTANCE != NULL) {
+                TaskTracer::INSTANCE->dependency(src.get(), dst.get());
+            }
             setDeadline(dst, src->getDeadline(), visited);
             assert(src->getDeadline() >= dst->getDeadline());
         }
     }
 }
 
-void MultithreadScheduler::setDeadline(ptr<Task> t, unsigned int deadline, set< ptr<Task> > &visited)
+void MultithreadScheduler::setDeadline(ptr<Task> t, unsigned int deadline, TaskGraph::TaskSet &visited)
 {
     if (visited.find(t) != visited.end()) {
         return;
@@ -609,6 +821,11 @@ void MultithreadScheduler::setDeadline(ptr<Task> t, unsigned int deadline, set<
     if (t->getDeadline() > deadline) {
         bool b1 = removeTask(allReadyTasks, t);
         bool b2 = removeTask(readyCpuTasks, t);
+        bool b3 = removeTask(readyUploadTasks, t);
+        if (deadline == 0) {
+            // t is no longer a prefetching task, it cannot be cancelled
+            prefetchQueue.erase(t);
+        }
         t->setDeadline(deadline);
         if (b1) {
             insertTask(allReadyTasks, t);
@@ -623,9 +840,12 @@ void MultithreadScheduler::setDeadline(ptr<Task> t, unsigned int deadline, set<
             insertTask(readyCpuTasks, t);
 #endif
         }
-        map< ptr<Task>, set< ptr<Task> > >::iterator i = dependencies.find(t);
+        if (b3) {
+            insertTask(readyUploadTasks, t);
+        }
+        TaskGraph::TaskSetMap::iterator i = dependencies.find(t);
         if (i != dependencies.end()) {
-            set< ptr<Task> >::iterator j = i->second.begin();
+            TaskGraph::TaskSet::iterator j = i->second.begin();
             while (j != i->second.end()) {
                 setDeadline(*j, deadline, visited);
                 j++;
@@ -638,16 +858,16 @@ void MultithreadScheduler::taskDone(ptr<Task> t, bool changes)
 {
     pthread_mutex_lock((pthread_mutex_t*) mutex);
     unsigned int completionDate = changes ? time : t->getCompletionDate();
-    map< ptr<Task>, set< ptr<Task> > >::iterator i = inverseDependencies.find(t);
+    TaskGraph::TaskSetMap::iterator i = inverseDependencies.find(t);
     if (i != inverseDependencies.end()) {
-        set< ptr<Task> >::iterator j = i->second.begin();
-        set< ptr<Task> >::iterator end = i->second.end();
+        TaskGraph::TaskSet::iterator j = i->second.begin();
+        TaskGraph::TaskSet::iterator end = i->second.end();
         while (j != end) { // iterates over the successors of t
             ptr<Task> r = *j; // r is a successor of t
             // the predecessors of r should not be empty, and should contain t
-            map< ptr<Task>, set< ptr<Task> > >::iterator k = dependencies.find(r);
+            TaskGraph::TaskSetMap::iterator k = dependencies.find(r);
             assert(k != dependencies.end());
-            set< ptr<Task> >::iterator l = k->second.find(t);
+            TaskGraph::TaskSet::iterator l = k->second.find(t);
             assert(l != k->second.end());
             // we then remove t from the predecessors of r
             k->second.erase(l);
@@ -658,7 +878,12 @@ void MultithreadScheduler::taskDone(ptr<Task> t, bool changes)
                 // we add it to the set of ready tasks, and signals this to the
                 // execution threads; we do the same for the set of ready CPU
                 // tasks, if r is a CPU tas
-                insertTask(allReadyTasks, r);
+                if (isUploadTask(r)) {
+                    insertTask(readyUploadTasks, r);
+                    pthread_cond_signal((pthread_cond_t*) uploadTasksCond);
+                } else {
+                    insertTask(allReadyTasks, r);
+                }
                 pthread_cond_broadcast((pthread_cond_t*) allTasksCond);
 #ifdef STRICT_PREFETCH
                 if (!r->isGpuTask() && r->getDeadline() > 0) {
@@ -681,6 +906,91 @@ void MultithreadScheduler::taskDone(ptr<Task> t, bool changes)
     pthread_mutex_unlock((pthread_mutex_t*) mutex);
 }
 
+bool MultithreadScheduler::cancelTask(ptr<Task> t)
+{
+    // NOTE: the mutex should be locked before calling this method!
+    if (t->getDeadline() == 0 || prefetchQueue.find(t) == prefetchQueue.end()) {
+        return false;
+    }
+    TaskGraph::TaskSetMap::iterator i = dependencies.find(t);
+    if (i == dependencies.end() && !removeTask(allReadyTasks, t) && !removeTask(readyUploadTasks, t)) {
+        // t is neither waiting for its predecessors nor ready to be
+        // executed, so it is being executed and cannot be cancelled
+        return false;
+    }
+    removeTask(readyCpuTasks, t);
+    prefetchQueue.erase(t);
+    // the successors of t can no longer be executed, we cancel them first
+    i = inverseDependencies.find(t);
+    if (i != inverseDependencies.end()) {
+        TaskGraph::TaskSet successors;
+        successors.swap(i->second);
+        inverseDependencies.erase(i);
+        TaskGraph::TaskSet::iterator j = successors.begin();
+        while (j != successors.end()) {
+            cancelTask(*j);
+            ++j;
+        }
+    }
+    // we then remove t from the successors of its predecessors
+    i = dependencies.find(t);
+    if (i != dependencies.end()) {
+        TaskGraph::TaskSet::iterator j = i->second.begin();
+        while (j != i->second.end()) {
+            TaskGraph::TaskSetMap::iterator k = inverseDependencies.find(*j);
+            if (k != inverseDependencies.end()) {
+                k->second.erase(t);
+                if (k->second.empty()) {
+                    inverseDependencies.erase(k);
+                }
+            }
+            ++j;
+        }
+        dependencies.erase(i);
+    }
+    if (Logger::DEBUG_LOGGER != NULL) {
+        Logger::DEBUG_LOGGER->log("SCHEDULER", "CANCEL " + string(t->getClass()));
+    }
+    return true;
+}
+
+void MultithreadScheduler::offsetPriority(ptr<Task> t, double delta, TaskGraph::TaskSet &visited)
+{
+    // NOTE: the mutex should be locked before calling this method!
+    if (visited.find(t) != visited.end()) {
+        return;
+    }
+    visited.insert(t);
+
+    ptr<TaskGraph> tg = t.cast<TaskGraph>();
+    if (tg != NULL) {
+        TaskGraph::TaskIterator i = tg->getAllTasks();
+        while (i.hasNext()) {
+            offsetPriority(i.next(), delta, visited);
+        }
+        return;
+    }
+    // the queues are sorted by queue priority, so we must remove t from
+    // them before changing its priority, and insert it back afterwards
+    bool b1 = prefetchQueue.erase(t) > 0;
+    bool b2 = removeTask(allReadyTasks, t);
+    bool b3 = removeTask(readyCpuTasks, t);
+    bool b4 = removeTask(readyUploadTasks, t);
+    t->setQueuePriority(t->getQueuePriority() + delta);
+    if (b1) {
+        prefetchQueue.insert(t);
+    }
+    if (b2) {
+        insertTask(allReadyTasks, t);
+    }
+    if (b3) {
+        insertTask(readyCpuTasks, t);
+    }
+    if (b4) {
+        insertTask(readyUploadTasks, t);
+    }
+}
+
 void MultithreadScheduler::schedulerThread()
 {
     Timer timer;
@@ -725,7 +1035,12 @@ void MultithreadScheduler::schedulerThread()
                 }
 
                 // same thing as in the #run method
-                if (t->getCompletionDate() >= t->getPredecessorsCompletionDate()) {
+                bool upToDate = t->getCompletionDate() >= t->getPredecessorsCompletionDate();
+                TaskTracer *tracer = TaskTracer::INSTANCE.get();
+                if (tracer != NULL) {
+                    tracer->taskBegin(t.get());
+                }
+                if (upToDate) {
                     // t is up to date, it is not necessary to run it
                 } else if (framePeriod > 0.0) {
                     timer.start();
@@ -735,6 +1050,9 @@ void MultithreadScheduler::schedulerThread()
                 } else {
                     changes = t->run();
                 }
+                if (tracer != NULL) {
+                    tracer->taskEnd(t.get(), !upToDate, changes);
+                }
             }
             taskDone(t, changes);
         }
@@ -747,6 +1065,119 @@ void* MultithreadScheduler::schedulerThread(void* arg)
     return NULL;
 }
 
+void MultithreadScheduler::uploadTasks()
+{
+    bool current = uploadContext->makeCurrent();
+    pthread_mutex_lock((pthread_mutex_t*) mutex);
+    uploadStarted = current;
+    stopUpload = !current;
+    pthread_cond_broadcast((pthread_cond_t*) allTasksCond);
+    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+    if (!current) {
+        return;
+    }
+
+    Timer timer;
+    ptr<Task> previousTask = NULL; // last upload task executed
+
+    // loop to execute upload tasks, until the upload thread must be stopped
+    while (true) {
+        ptr<Task> t;
+        pthread_mutex_lock((pthread_mutex_t*) mutex);
+        while (readyUploadTasks.empty() && !stopUpload) {
+            if (previousTask != NULL) {
+                // restores the context after the last executed task, before
+                // waiting for new tasks (like the main thread does at the end
+                // of each frame)
+                previousTask->end();
+                previousTask = NULL;
+            }
+            pthread_cond_wait((pthread_cond_t*) uploadTasksCond, (pthread_mutex_t*) mutex);
+        }
+        if (!stopUpload) {
+            // selects a ready task, with the same context as the previous
+            // one if possible, and removes it from the ready tasks
+            t = getTask(readyUploadTasks, previousTask == NULL ? NULL : previousTask->getContext());
+            removeTask(readyUploadTasks, t);
+        }
+        pthread_mutex_unlock((pthread_mutex_t*) mutex);
+
+        if (t == NULL) {
+            break;
+        }
+
+        bool changes = false;
+        if (!t->isDone()) {
+            if (Logger::DEBUG_LOGGER != NULL) {
+                ostringstream oss;
+                oss << "UPLOAD " << t->getClass();
+                Logger::DEBUG_LOGGER->log("SCHEDULER", oss.str());
+            }
+            if (previousTask == NULL) {
+                t->begin();
+            } else if (previousTask->getContext() != t->getContext()) {
+                previousTask->end();
+                t->begin();
+            }
+            previousTask = t;
+
+            // same thing as in the #run method
+            bool upToDate = t->getCompletionDate() >= t->getPredecessorsCompletionDate();
+            TaskTracer *tracer = TaskTracer::INSTANCE.get();
+            if (tracer != NULL) {
+                tracer->taskBegin(t.get());
+            }
+            if (upToDate) {
+                // t is up to date, it is not necessary to run it
+            } else {
+                timer.start();
+                changes = t->run();
+                // the successors of t can use its results in the main context
+                // only when the GPU commands of t are completed, so we wait
+                // for them here, instead of in the main thread
+                GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+                while (status == GL_TIMEOUT_EXPIRED) {
+                    status = glClientWaitSync(fence, 0, 1000000000);
+                }
+                glDeleteSync(fence);
+                double duration = timer.end();
+                if (framePeriod > 0.0) {
+                    t->setActualDuration((float) duration);
+                }
+            }
+            if (tracer != NULL) {
+                tracer->taskEnd(t.get(), !upToDate, changes);
+            }
+        }
+        taskDone(t, changes);
+
+        pthread_mutex_lock((pthread_mutex_t*) mutex);
+        // the main thread waits until all the tasks of the current frame are
+        // completed, so we must signal it when an immediate task is done
+        if (immediateTasks.erase(t) > 0) {
+            pthread_cond_broadcast((pthread_cond_t*) allTasksCond);
+        }
+        pthread_mutex_unlock((pthread_mutex_t*) mutex);
+    }
+
+    if (previousTask != NULL) {
+        previousTask->end();
+    }
+    uploadContext->doneCurrent();
+}
+
+void* MultithreadScheduler::uploadTasks(void* arg)
+{
+    ((MultithreadScheduler*) arg)->uploadTasks();
+    return NULL;
+}
+
+bool MultithreadScheduler::isUploadTask(ptr<Task> t) const
+{
+    return uploadThread != NULL && t->isGpuTask() && t->isUploadTask();
+}
+
 void MultithreadScheduler::clearBufferedFrames()
 {
     if (statisticsFile == NULL) {
@@ -840,7 +1271,7 @@ public:
         int prefetchQueue = 0;
         float frameRate = 0.0;
         int nthreads = 0;
-        checkParameters(desc, e, "name,prefetchRate,prefetchQueue,fps,nthreads,");
+        checkParameters(desc, e, "name,prefetchRate,prefetchQueue,fps,nthreads,aging,");
         if (e->Attribute("prefetchRate") != NULL) {
             getIntParameter(desc, e, "prefetchRate", &prefetchRate);
         }
@@ -854,6 +1285,11 @@ public:
             getIntParameter(desc, e, "nthreads", &nthreads);
         }
         init(prefetchRate, prefetchQueue, frameRate, nthreads);
+        if (e->Attribute("aging") != NULL) {
+            float aging;
+            getFloatParameter(desc, e, "aging", &aging);
+            setAging(aging);
+        }
     }
 };
 
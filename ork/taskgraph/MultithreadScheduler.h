@@ -27,6 +27,7 @@
 #include <vector>
 #include <set>
 #include <sstream>
+#include "ork/core/SharedContext.h"
 #include "ork/taskgraph/Scheduler.h"
 #include "ork/taskgraph/TaskGraph.h"
 
@@ -42,7 +43,10 @@ namespace ork
  * have been executed. Hence if a prefetch rate is specified, or if a fixed frame
  * rate is specified, this scheduler supports prefetching of tasks of any kind.
  * Otherwise, if several threads are used, prefetching of cpu tasks is supported,
- * but not prefetching of gpu tasks.
+ * but not prefetching of gpu tasks. Finally, if an upload context is set (see
+ * #setUploadContext), the GPU tasks that only create or fill GPU resources
+ * (see Task#isUploadTask) are executed by a dedicated upload thread, instead
+ * of the main thread.
  *
  * @ingroup taskgraph
  */
@@ -58,11 +62,13 @@ public:
      *      of gpu tasks is only possible if this rate is not 0.
      * @param prefetchQueue the maximum number of prefetching tasks that can be
      *      queued for execution. If a prefetch rate or a fixed frame rate is
-     *      specified, this value must not be 0. When the queue is full, new
-     *      prefetch tasks are simply discarded and #schedule returns false.
-     *      This maximum queue size prevents the number of prefetching tasks to
-     *      grow unbounded, if new prefetching tasks are generated at a greater
-     *      rate than the rate at which they are executed.
+     *      specified, this value must not be 0. When the queue is full, the
+     *      prefetching tasks with the lowest priority are cancelled (see
+     *      #cancel), which may include the tasks that have just been
+     *      scheduled. This maximum queue size prevents the number of
+     *      prefetching tasks to grow unbounded, if new prefetching tasks are
+     *      generated at a greater rate than the rate at which they are
+     *      executed.
      * @param frameRate a fixed framerate that this scheduler should try to
      *      follow, or 0 to not fix any framerate.
      * @param nThreads the number of threads to use in addition to the main
@@ -78,10 +84,9 @@ public:
 
     /**
      * Returns true if the prefetch rate or the fixed frame rate is not null,
-     * or if there are several threads and gpuTasks is false. In addition,
-     * if there is only one thread for cpu tasks, and for gpu tasks in all
-     * cases, the curent number of prefetching tasks waiting for execution must
-     * be std::less than the prefetch queue size, otherwise this method returns false.
+     * or if there are several threads and gpuTasks is false. If the prefetch
+     * queue is full, new prefetching tasks can still be scheduled: they evict
+     * the queued tasks of lower priority.
      */
     virtual bool supportsPrefetch(bool gpuTasks);
 
@@ -91,11 +96,57 @@ public:
 
     virtual void run(ptr<Task> task);
 
+    /**
+     * Changes the priority of a task, and reorders the queues that contain
+     * this task or its sub tasks. The time already spent waiting in the
+     * prefetch queue is preserved.
+     */
+    virtual void setPriority(ptr<Task> task, float priority);
+
+    virtual bool cancel(ptr<Task> task);
+
+    /**
+     * Sets the aging rate of prefetching tasks. The priority used to sort a
+     * prefetching task is its priority plus this rate times the number of
+     * frames since it was scheduled. Hence old low priority tasks are
+     * eventually executed, and among tasks of equal priority the oldest are
+     * executed first and the newest are evicted first. The default rate is
+     * 0.001.
+     *
+     * @param aging the priority increase per frame of waiting.
+     */
+    void setAging(float aging);
+
+    /**
+     * Sets the OpenGL context used to execute upload tasks (see
+     * Task#isUploadTask). If this context is not NULL, an upload thread is
+     * started with this context, and executes the upload tasks as soon as
+     * they are ready, without waiting for the main thread. The upload thread
+     * waits until the GPU commands of each upload task are completed before
+     * marking this task as done, so that its successors can safely use the
+     * resources it has created in the main context. This method must be
+     * called from the main thread, outside #run.
+     *
+     * @param context an OpenGL context shared with the main context (see
+     *      Window#createSharedContext), or NULL to stop the upload thread
+     *      and execute upload tasks in the main thread.
+     * @return true if the upload thread could be started, or if context is
+     *      NULL.
+     */
+    bool setUploadContext(ptr<SharedContext> context);
+
     /**
      * Adds the given task type to the tasks whose execution times must be monitored (debug).
      */
     void monitorTask(const std::string &taskType);
 
+    /**
+     * Returns the time spent in #schedule during the last call to #run, in
+     * micro seconds. The rest of the #run duration is spent executing tasks
+     * (and waiting for the fixed frame rate deadline, if any).
+     */
+    double getScheduleTime() const;
+
 protected:
     /**
      * Initializes this scheduler.
@@ -124,14 +175,30 @@ private:
     };
 
     /**
-     * A sort operator for tasks. This operator is based on the expected
-     * duration of tasks, so that shorter tasks are executed first.
+     * A sort operator for tasks. This operator is based on the priority of
+     * tasks (see Task#getQueuePriority), so that tasks of higher priority are
+     * executed first, and then on their expected duration, so that shorter
+     * tasks are executed first.
      */
     struct taskSort : public std::less< ptr<Task> >
     {
         bool operator()(const ptr<Task> x, const ptr<Task> y) const;
     };
 
+    /**
+     * A sort operator for prefetching tasks, based on their priority (see
+     * Task#getQueuePriority). The task with the lowest priority comes first.
+     */
+    struct prefetchSort : public std::less< ptr<Task> >
+    {
+        bool operator()(const ptr<Task> x, const ptr<Task> y) const;
+    };
+
+    /**
+     * A set of prefetching tasks, sorted by increasing priority.
+     */
+    typedef std::set<ptr<Task>, prefetchSort, TaskPoolAllocator< ptr<Task> > > PrefetchQueue;
+
     /**
      * A sorted task set, where tasks are sorted based on their deadline,
      * execution context and expected duration.
@@ -156,11 +223,37 @@ private:
      */
     void* cpuTasksCond;
 
+    /**
+     * A condition to signal to the upload thread that new upload tasks are
+     * ready to be executed, or that it must be stopped.
+     */
+    void* uploadTasksCond;
+
     /**
      * The threads used to execute tasks, in addition to the main thread.
      */
     std::vector<void*> threads;
 
+    /**
+     * The thread used to execute upload tasks, or NULL.
+     */
+    void* uploadThread;
+
+    /**
+     * The OpenGL context used by #uploadThread, or NULL.
+     */
+    ptr<SharedContext> uploadContext;
+
+    /**
+     * True if #uploadThread must be stopped.
+     */
+    bool stopUpload;
+
+    /**
+     * True if #uploadContext could be made current in #uploadThread.
+     */
+    bool uploadStarted;
+
     /**
      * Target frame duration in micro seconds, or 0 if no fixed framerate.
      */
@@ -176,15 +269,32 @@ private:
 
     /**
      * Maximum number of prefetching tasks that can be waiting for execution.
-     * When the queue size is reached, new prefetching tasks are discarded.
+     * When the queue size is reached, the tasks of lowest priority are
+     * cancelled.
      */
     unsigned int prefetchQueueSize;
 
+    /**
+     * The priority increase per frame of the prefetching tasks waiting for
+     * execution.
+     */
+    float aging;
+
+    /**
+     * The number of calls to #run so far.
+     */
+    unsigned int frameCount;
+
     /**
      * Time at the end of the last call to #run.
      */
     double lastFrame;
 
+    /**
+     * Time spent in #schedule during the last call to #run.
+     */
+    double scheduleTime;
+
     /**
      * Logical time used for task completion dates. This logical time is a
      * counter incremented by one after each task execution.
@@ -200,7 +310,7 @@ private:
     /**
      * The primitive tasks that must be executed at the current frame.
      */
-    std::set< ptr<Task> > immediateTasks;
+    TaskGraph::TaskSet immediateTasks;
 
     /**
      * The primitive CPU or GPU tasks that are ready to be executed. A task is
@@ -214,20 +324,27 @@ private:
      */
     SortedTaskSet readyCpuTasks;
 
+    /**
+     * The primitive upload tasks that are ready to be executed by the upload
+     * thread. These tasks are not in #allReadyTasks.
+     */
+    SortedTaskSet readyUploadTasks;
+
     /**
      * The predecessors of the tasks that remain to be executed.
      */
-    std::map< ptr<Task>, std::set< ptr<Task> > > dependencies;
+    TaskGraph::TaskSetMap dependencies;
 
     /**
      * The successors of the tasks that remain to be executed.
      */
-    std::map< ptr<Task>, std::set< ptr<Task> > > inverseDependencies;
+    TaskGraph::TaskSetMap inverseDependencies;
 
     /**
-     * The prefetching tasks that remain to be executed.
+     * The prefetching tasks that remain to be executed, sorted by increasing
+     * priority. This includes the tasks that are being executed.
      */
-    std::set< ptr<Task> > prefetchQueue;
+    PrefetchQueue prefetchQueue;
 
     /**
      * The task classes whose execution time must be monitored (debug).
@@ -267,8 +384,10 @@ private:
      * @param t the task whose primitive sub tasks must be added.
      * @param[in,out] addedTasks the already added tasks. This method adds the
      *      tasks it adds to this set.
+     * @param priority the sum of the priorities of the task graphs that
+     *      contain t.
      */
-    void addFlattenedTask(ptr<Task> t, std::set< ptr<Task> > &addedTasks);
+    void addFlattenedTask(ptr<Task> t, TaskGraph::TaskSet &addedTasks, double priority);
 
     /**
      * Adds all the primitive dependencies between the primitive first tasks of
@@ -289,7 +408,7 @@ private:
      * @param deadline the new deadline for this task.
      * @param visited a set of tasks already visited by this method.
      */
-    void setDeadline(ptr<Task> t, unsigned int deadline, std::set< ptr<Task> > &visited);
+    void setDeadline(ptr<Task> t, unsigned int deadline, TaskGraph::TaskSet &visited);
 
     /**
      * Updates the data structures after the execution of a task. This method
@@ -303,6 +422,27 @@ private:
      */
     void taskDone(ptr<Task> t, bool changes);
 
+    /**
+     * Cancels a prefetching task and, recursively, its successors. The mutex
+     * must be locked before calling this method.
+     *
+     * @param t a primitive task (i.e. not a task graph).
+     * @return true if the task was waiting for execution and has been
+     *      cancelled.
+     */
+    bool cancelTask(ptr<Task> t);
+
+    /**
+     * Offsets the queue priority of a task, and of its sub tasks if it is a
+     * task graph, and reorders the queues that contain these tasks. The mutex
+     * must be locked before calling this method.
+     *
+     * @param t a task or task graph.
+     * @param delta the queue priority offset.
+     * @param visited the tasks already visited by this method.
+     */
+    void offsetPriority(ptr<Task> t, double delta, TaskGraph::TaskSet &visited);
+
     /**
      * The method executed by the additional threads of this scheduler. This
      * method contains an infinite loop that executes tasks when they are ready
@@ -310,6 +450,18 @@ private:
      */
     void schedulerThread();
 
+    /**
+     * The method executed by the upload thread of this scheduler. This method
+     * contains an infinite loop that executes upload tasks when they are ready
+     * to be executed. The method returns only when #stopUpload is set to true.
+     */
+    void uploadTasks();
+
+    /**
+     * Returns true if the given task must be executed by the upload thread.
+     */
+    bool isUploadTask(ptr<Task> t) const;
+
     /**
      * Writes the buffered frame statistics to the statisticsFile.
      */
@@ -323,6 +475,14 @@ private:
      */
     static void* schedulerThread(void* arg);
 
+    /**
+     * Static method needed by pthread to launch the upload thread. This method
+     * just calls #uploadTasks on the MultithreadScheduler passed as argument.
+     *
+     * @param arg a MultithreadScheduler.
+     */
+    static void* uploadTasks(void* arg);
+
     /**
      * Returns a tasks from the given set with, if possible, the same execution
      * context as the given one.
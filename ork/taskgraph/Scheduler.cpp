@@ -52,6 +52,16 @@ Scheduler::~Scheduler()
 {
 }
 
+void Scheduler::setPriority(ptr<Task> task, float priority)
+{
+    task->setPriority(priority);
+}
+
+bool Scheduler::cancel(ptr<Task>)
+{
+    return false;
+}
+
 void Scheduler::swap(ptr<Scheduler> s)
 {
 }
@@ -109,6 +109,28 @@ public:
      */
     virtual void run(ptr<Task> task) = 0;
 
+    /**
+     * Changes the priority of a task that may already be scheduled. The
+     * default implementation sets the priority of the task, without
+     * reordering anything.
+     *
+     * @param task a task or task graph.
+     * @param priority the new priority of this task (see Task#getPriority).
+     */
+    virtual void setPriority(ptr<Task> task, float priority);
+
+    /**
+     * Cancels the execution of a prefetching task. Tasks with an immediate
+     * deadline, and tasks that are being executed, cannot be cancelled. The
+     * tasks that depend on a cancelled task are cancelled too. A cancelled
+     * task remains not done, and can be scheduled again later. The default
+     * implementation does nothing and returns false.
+     *
+     * @param task a task or task graph whose deadline is not immediate.
+     * @return true if at least one task has been cancelled.
+     */
+    virtual bool cancel(ptr<Task> task);
+
 protected:
     /**
      * Swaps this scheduler with the given one.
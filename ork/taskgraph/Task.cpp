@@ -45,7 +45,9 @@
 #include <algorithm>
 #include <sstream>
 
+#include "ork/core/Atomic.h"
 #include "ork/core/Logger.h"
+#include "ork/taskgraph/TaskPool.h"
 
 #include <pthread.h>
 
@@ -54,33 +56,298 @@ using namespace std;
 namespace ork
 {
 
-void *Task::mutex = NULL;
+/**
+ * Number of durations accumulated by a thread for a task type before they are
+ * merged into the shared statistics of this type.
+ */
+#define MERGE_PERIOD 16
+
+/**
+ * Maximum number of task types (must be a power of two).
+ */
+#define MAX_TASK_TYPES 1024
+
+/**
+ * Number of buckets of the duration histograms. Bucket i contains the
+ * durations between 2^(i/4) and 2^((i+1)/4) micro seconds.
+ */
+#define HISTOGRAM_SIZE 128
+
+/**
+ * Number of histogram buckets per power of two.
+ */
+#define HISTOGRAM_OCTAVE 4
+
+/**
+ * Weight of new samples in the exponentially weighted moving averages.
+ */
+#define EWMA_ALPHA (1.0f / 16.0f)
+
+/**
+ * Minimum number of samples before the statistics are used to estimate
+ * durations.
+ */
+#define MIN_SAMPLES 64
+
+struct TaskStatistics
+{
+    const type_info *type; ///< the task type described by these statistics.
+
+    int index; ///< the index of these statistics in the per thread buffers.
+
+    void *mutex; ///< mutex used to synchronize merges into these statistics.
+
+    float durationSum; ///< sum of the execution times.
+
+    float durationSquareSum; ///< sum of the squares of the execution times.
+
+    float minDuration; ///< minimum execution time.
+
+    float maxDuration; ///< maximum execution time.
+
+    int n; ///< number of executions.
+
+    float ewmaMean; ///< exponentially weighted moving average of the execution times.
+
+    float ewmaVariance; ///< exponentially weighted moving variance of the execution times.
+
+    unsigned int histogram[HISTOGRAM_SIZE]; ///< log scale histogram of the execution times.
+
+    /**
+     * The expected duration of a task of complexity 1, computed with the
+     * current estimator at the last merge, or 0 if there are not enough
+     * samples yet. Can be read without locking #mutex.
+     */
+    volatile float estimate;
+
+    TaskStatistics(const type_info *type, int index);
+
+    ~TaskStatistics();
+
+    /**
+     * Returns the mean and standard deviation of the execution times, min
+     * and max values excluded.
+     */
+    void getMeanDeviation(float &mean, float &standardDeviation) const;
+
+    /**
+     * Returns the given percentile of the execution times.
+     */
+    float getPercentile(float p) const;
+
+    /**
+     * Merges the given execution times into these statistics, and updates
+     * #estimate. The mutex must be locked by the caller.
+     */
+    void merge(const float *durations, int count);
+
+    /**
+     * Recomputes #estimate. The mutex must be locked by the caller.
+     */
+    void updateEstimate();
+};
+
+/**
+ * The execution times accumulated by a thread, for each task type.
+ */
+struct ThreadStatistics
+{
+    /**
+     * The execution times not yet merged, for each task type. The first
+     * element of each vector is a count, followed by MERGE_PERIOD durations.
+     */
+    vector< vector<float> > samples;
+};
 
-map<type_info const*, Task::TaskStatistics*, Task::TypeInfoSort> Task::statistics;
+static pthread_once_t statisticsOnce = PTHREAD_ONCE_INIT;
 
-bool Task::TypeInfoSort::operator()(const type_info *x, const type_info *y) const
+static pthread_mutex_t statisticsMutex; ///< mutex used to synchronize insertions in statisticsTable
+
+static pthread_key_t statisticsKey; ///< key of the ThreadStatistics of each thread
+
+/**
+ * The execution time statistics for each task type, in an open addressing
+ * hash table indexed by the type names. Slots are only written once, under
+ * statisticsMutex, and can be read without locking.
+ */
+static TaskStatistics *volatile statisticsTable[MAX_TASK_TYPES];
+
+/**
+ * The execution time statistics in creation order, indexed by
+ * TaskStatistics::index.
+ */
+static TaskStatistics *statisticsList[MAX_TASK_TYPES];
+
+static volatile int statisticsCount = 0;
+
+static volatile int currentEstimator = Task::MEAN_DEVIATION;
+
+static volatile float currentPercentile = 0.9f;
+
+static void mergeThreadStatistics(ThreadStatistics *t)
 {
-    return (*x).before(*y) != 0;
+    for (unsigned int i = 0; i < t->samples.size(); ++i) {
+        vector<float> &s = t->samples[i];
+        int count = s.empty() ? 0 : int(s[0]);
+        if (count > 0) {
+            TaskStatistics *stats = statisticsList[i];
+            pthread_mutex_lock((pthread_mutex_t*) stats->mutex);
+            stats->merge(&s[1], count);
+            pthread_mutex_unlock((pthread_mutex_t*) stats->mutex);
+            s[0] = 0.0f;
+        }
+    }
 }
 
-Task::TaskStatistics::TaskStatistics() :
-    durationSum(0.0f), durationSquareSum(0.0f), minDuration(INFINITY), maxDuration(0.0f), corrected(false), n(0)
+static void deleteThreadStatistics(void *t)
 {
+    // merges the durations that remain when a thread exits
+    mergeThreadStatistics((ThreadStatistics*) t);
+    delete (ThreadStatistics*) t;
 }
 
-Task::Task(const char *type, bool gpuTask, unsigned int deadline) :
-    Object(type), completionDate(0), gpuTask(gpuTask), deadline(deadline), predecessorsCompletionDate(1), done(false), expectedDuration(-1.0f)
+static void initStatistics()
+{
+    pthread_mutex_init(&statisticsMutex, NULL);
+    pthread_key_create(&statisticsKey, deleteThreadStatistics);
+}
+
+static ThreadStatistics *getThreadStatistics()
+{
+    ThreadStatistics *t = (ThreadStatistics*) pthread_getspecific(statisticsKey);
+    if (t == NULL) {
+        t = new ThreadStatistics();
+        pthread_setspecific(statisticsKey, t);
+    }
+    return t;
+}
+
+static unsigned int hashTypeName(const char *name)
+{
+    unsigned int h = 5381;
+    while (*name != 0) {
+        h = h * 33 + (unsigned char) (*name++);
+    }
+    return h;
+}
+
+TaskStatistics::TaskStatistics(const type_info *type, int index) :
+    type(type), index(index), durationSum(0.0f), durationSquareSum(0.0f), minDuration(INFINITY), maxDuration(0.0f), n(0),
+    ewmaMean(0.0f), ewmaVariance(0.0f), estimate(0.0f)
+{
+    mutex = new pthread_mutex_t;
+    pthread_mutex_init((pthread_mutex_t*) mutex, NULL);
+    for (int i = 0; i < HISTOGRAM_SIZE; ++i) {
+        histogram[i] = 0;
+    }
+}
+
+TaskStatistics::~TaskStatistics()
+{
+    pthread_mutex_destroy((pthread_mutex_t*) mutex);
+    delete (pthread_mutex_t*) mutex;
+}
+
+void TaskStatistics::getMeanDeviation(float &mean, float &standardDeviation) const
+{
+    float sum = durationSum;
+    float squareSum = durationSquareSum;
+    int count = n;
+    // to get "valid" statistics, we ignore the min and max values
+    if (n > 2) {
+        sum -= maxDuration + minDuration;
+        squareSum -= maxDuration * maxDuration + minDuration * minDuration;
+        count -= 2;
+    }
+    mean = count > 0 ? sum / count : 0.0f;
+    float variance = count > 0 ? squareSum / count - mean * mean : 0.0f;
+    standardDeviation = sqrt(max(variance, 0.0f));
+}
+
+float TaskStatistics::getPercentile(float p) const
 {
-    if (mutex == NULL) {
-        mutex = new pthread_mutex_t;
-        pthread_mutex_init((pthread_mutex_t*) mutex, NULL);
+    unsigned int rank = (unsigned int) ceil(max(0.0f, min(p, 1.0f)) * n);
+    unsigned int count = 0;
+    for (int i = 0; i < HISTOGRAM_SIZE; ++i) {
+        count += histogram[i];
+        if (count >= rank && count > 0) {
+            // geometric center of the bucket, clamped to the observed range
+            float d = pow(2.0f, (i + 0.5f) / HISTOGRAM_OCTAVE);
+            return max(minDuration, min(d, maxDuration));
+        }
     }
+    return maxDuration;
+}
+
+void TaskStatistics::merge(const float *durations, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        float d = durations[i];
+        durationSum += d;
+        durationSquareSum += d * d;
+        minDuration = min(d, minDuration);
+        maxDuration = max(d, maxDuration);
+        if (n == 0) {
+            ewmaMean = d;
+            ewmaVariance = 0.0f;
+        } else {
+            float diff = d - ewmaMean;
+            float increment = EWMA_ALPHA * diff;
+            ewmaMean += increment;
+            ewmaVariance = (1.0f - EWMA_ALPHA) * (ewmaVariance + diff * increment);
+        }
+        int bucket = d > 1.0f ? int(HISTOGRAM_OCTAVE * log2(d)) : 0;
+        histogram[min(bucket, HISTOGRAM_SIZE - 1)] += 1;
+        n += 1;
+    }
+    updateEstimate();
+}
+
+void TaskStatistics::updateEstimate()
+{
+    // to get "valid" statistics, we wait until we have enough samples
+    if (n < MIN_SAMPLES) {
+        estimate = 0.0f;
+        return;
+    }
+    switch (currentEstimator) {
+    case Task::EWMA:
+        estimate = ewmaMean + 2.0f * sqrt(ewmaVariance);
+        break;
+    case Task::PERCENTILE:
+        estimate = getPercentile(currentPercentile);
+        break;
+    default: {
+        float mean;
+        float standardDeviation;
+        getMeanDeviation(mean, standardDeviation);
+        estimate = mean + 2.0f * standardDeviation;
+        break;
+    }
+    }
+}
+
+Task::Task(const char *type, bool gpuTask, unsigned int deadline) :
+    Object(type), completionDate(0), gpuTask(gpuTask), deadline(deadline), uploadTask(false), priority(0.0f), queuePriority(0.0), predecessorsCompletionDate(1), done(false), expectedDuration(-1.0f), typeStatistics(NULL)
+{
 }
 
 Task::~Task()
 {
 }
 
+#ifndef ORK_NO_TASK_POOL
+void *Task::operator new(size_t size)
+{
+    return TaskPool::allocate(size);
+}
+
+void Task::operator delete(void *p, size_t size)
+{
+    TaskPool::deallocate(p, size);
+}
+#endif
+
 void* Task::getContext() const
 {
     return NULL;
@@ -91,6 +358,16 @@ bool Task::isGpuTask() const
     return gpuTask;
 }
 
+bool Task::isUploadTask() const
+{
+    return uploadTask;
+}
+
+void Task::setUploadTask(bool upload)
+{
+    uploadTask = upload;
+}
+
 unsigned int Task::getDeadline() const
 {
     return deadline;
@@ -101,6 +378,26 @@ void Task::setDeadline(unsigned int deadline)
     this->deadline = min(this->deadline, deadline);
 }
 
+float Task::getPriority() const
+{
+    return priority;
+}
+
+void Task::setPriority(float priority)
+{
+    this->priority = priority;
+}
+
+double Task::getQueuePriority() const
+{
+    return queuePriority;
+}
+
+void Task::setQueuePriority(double priority)
+{
+    queuePriority = priority;
+}
+
 int Task::getComplexity() const
 {
     return 1;
@@ -159,55 +456,83 @@ void Task::setPredecessorsCompletionDate(unsigned int t)
 
 float Task::getExpectedDuration()
 {
-    if (expectedDuration == -1.0f) {
-        expectedDuration = 0.0f;
-        const type_info *id = getTypeInfo();
-        pthread_mutex_lock((pthread_mutex_t*) mutex);
-        map<type_info const*, TaskStatistics*, TypeInfoSort>::iterator i = statistics.find(id);
-        if (i != statistics.end()) {
-            TaskStatistics *stats = i->second;
-            // to get "valid" statistics, we wait until we have enough samples,
-            // and we ignore the min and max values
-            const int MIN_SAMPLES = 64;
-            if (stats->n >= MIN_SAMPLES) {
-                if (!stats->corrected) {
-                    float sum = stats->durationSum - stats->maxDuration - stats->minDuration;
-                    float squareSum = stats->durationSum - stats->maxDuration * stats->maxDuration - stats->minDuration * stats->minDuration;
-                    stats->durationSum = (sum * stats->n) / (stats->n - 2) ;
-                    stats->durationSquareSum = (squareSum * stats->n) / (stats->n - 2);
-                    stats->corrected = true;
-                }
-                float mean = stats->durationSum / stats->n;
-                float squareMean = stats->durationSquareSum / stats->n;
-                float variance = squareMean - mean * mean;
-                float standardDeviation = sqrt(variance);
-                expectedDuration = (mean + 2.0f * standardDeviation) * getComplexity();
-            }
-        }
-        pthread_mutex_unlock((pthread_mutex_t*) mutex);
+    if (expectedDuration <= 0.0f) {
+        // no lock needed: the estimate is published atomically by merges
+        expectedDuration = getTypeStatistics()->estimate * getComplexity();
     }
     return expectedDuration;
 }
 
 void Task::setActualDuration(float duration)
 {
-    TaskStatistics *stats;
+    TaskStatistics *stats = getTypeStatistics();
+    ThreadStatistics *t = getThreadStatistics();
+    if (int(t->samples.size()) <= stats->index) {
+        t->samples.resize(stats->index + 1);
+    }
+    vector<float> &s = t->samples[stats->index];
+    if (s.empty()) {
+        s.resize(MERGE_PERIOD + 1, 0.0f);
+    }
+    int count = int(s[0]);
+    s[count + 1] = duration / getComplexity();
+    s[0] = float(++count);
+    if (count == MERGE_PERIOD) {
+        pthread_mutex_lock((pthread_mutex_t*) stats->mutex);
+        stats->merge(&s[1], count);
+        pthread_mutex_unlock((pthread_mutex_t*) stats->mutex);
+        s[0] = 0.0f;
+    }
+}
+
+TaskStatistics *Task::getTypeStatistics()
+{
+    if (typeStatistics != NULL) {
+        return typeStatistics;
+    }
+    pthread_once(&statisticsOnce, initStatistics);
     const type_info *id = getTypeInfo();
-    pthread_mutex_lock((pthread_mutex_t*) mutex);
-    map<type_info const*, TaskStatistics*, TypeInfoSort>::iterator i = statistics.find(id);
-    if (i == statistics.end()) {
-        stats = new TaskStatistics();
-        statistics.insert(make_pair(id, stats));
-    } else {
-        stats = i->second;
-    }
-    duration = duration / getComplexity();
-    stats->durationSum += duration;
-    stats->durationSquareSum += duration * duration;
-    stats->minDuration = min(duration, stats->minDuration);
-    stats->maxDuration = max(duration, stats->maxDuration);
-    stats->n += 1;
-    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+    unsigned int h = hashTypeName(id->name());
+    // lock free lookup of an existing entry
+    for (unsigned int i = 0; i < MAX_TASK_TYPES; ++i) {
+        TaskStatistics *stats = statisticsTable[(h + i) & (MAX_TASK_TYPES - 1)];
+        if (stats == NULL) {
+            break;
+        }
+        if (*stats->type == *id) {
+            typeStatistics = stats;
+            return stats;
+        }
+    }
+    // not found: insertion under lock (once per task type)
+    pthread_mutex_lock(&statisticsMutex);
+    for (unsigned int i = 0; i < MAX_TASK_TYPES; ++i) {
+        unsigned int slot = (h + i) & (MAX_TASK_TYPES - 1);
+        TaskStatistics *stats = statisticsTable[slot];
+        if (stats == NULL) {
+            if (statisticsCount == MAX_TASK_TYPES - 1) {
+                break;
+            }
+            stats = new TaskStatistics(id, statisticsCount);
+            statisticsList[statisticsCount] = stats;
+            // publishes the fully constructed entry before making it visible
+            memory_barrier();
+            statisticsTable[slot] = stats;
+            statisticsCount = statisticsCount + 1;
+        }
+        if (*stats->type == *id) {
+            typeStatistics = stats;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&statisticsMutex);
+    if (typeStatistics == NULL) {
+        if (Logger::ERROR_LOGGER != NULL) {
+            Logger::ERROR_LOGGER->log("SCHEDULER", "Too many task types");
+        }
+        throw exception();
+    }
+    return typeStatistics;
 }
 
 const type_info *Task::getTypeInfo()
@@ -230,23 +555,46 @@ void Task::removeListener(TaskListener *l)
 
 void Task::logStatistics()
 {
-    pthread_mutex_lock((pthread_mutex_t*) mutex);
-    map<type_info const*, TaskStatistics*, TypeInfoSort>::iterator i = statistics.begin();
-    while (i != statistics.end()) {
-        TaskStatistics *stats = i->second;
-        float mean = stats->durationSum / stats->n;
-        float squareMean = stats->durationSquareSum / stats->n;
-        float variance = squareMean - mean * mean;
-        float standardDeviation = sqrt(variance);
-
-        ostringstream oss;
-        oss.setf(ios::fixed,ios::floatfield);
-        oss.precision(3);
-        oss << i->first->name() << ": " << mean / 1000.0 << " +/- " << standardDeviation / 1000.0 << "; min/max " << stats->minDuration / 1000.0 << " " << stats->maxDuration / 1000.0;
-        Logger::DEBUG_LOGGER->log("SCHEDULER", oss.str());
-        i++;
-    }
-    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+    pthread_once(&statisticsOnce, initStatistics);
+    if (pthread_getspecific(statisticsKey) != NULL) {
+        mergeThreadStatistics(getThreadStatistics());
+    }
+    pthread_mutex_lock(&statisticsMutex);
+    for (int i = 0; i < statisticsCount; ++i) {
+        TaskStatistics *stats = statisticsList[i];
+        pthread_mutex_lock((pthread_mutex_t*) stats->mutex);
+        if (stats->n > 0) {
+            float mean;
+            float standardDeviation;
+            stats->getMeanDeviation(mean, standardDeviation);
+
+            ostringstream oss;
+            oss.setf(ios::fixed,ios::floatfield);
+            oss.precision(3);
+            oss << stats->type->name() << ": " << mean / 1000.0 << " +/- " << standardDeviation / 1000.0 << "; min/max " << stats->minDuration / 1000.0 << " " << stats->maxDuration / 1000.0;
+            oss << "; ewma " << stats->ewmaMean / 1000.0 << " +/- " << sqrt(stats->ewmaVariance) / 1000.0;
+            oss << "; p50/p90/p99 " << stats->getPercentile(0.5f) / 1000.0 << " " << stats->getPercentile(0.9f) / 1000.0 << " " << stats->getPercentile(0.99f) / 1000.0;
+            oss << "; n " << stats->n;
+            Logger::DEBUG_LOGGER->log("SCHEDULER", oss.str());
+        }
+        pthread_mutex_unlock((pthread_mutex_t*) stats->mutex);
+    }
+    pthread_mutex_unlock(&statisticsMutex);
+}
+
+void Task::setEstimator(estimator e, float percentile)
+{
+    pthread_once(&statisticsOnce, initStatistics);
+    pthread_mutex_lock(&statisticsMutex);
+    currentEstimator = e;
+    currentPercentile = percentile;
+    for (int i = 0; i < statisticsCount; ++i) {
+        TaskStatistics *stats = statisticsList[i];
+        pthread_mutex_lock((pthread_mutex_t*) stats->mutex);
+        stats->updateEstimate();
+        pthread_mutex_unlock((pthread_mutex_t*) stats->mutex);
+    }
+    pthread_mutex_unlock(&statisticsMutex);
 }
 
 }
@@ -60,6 +60,11 @@ namespace ork
 
 class TaskListener;
 
+/**
+ * Execution time statistics for tasks of a given type. Defined in Task.cpp.
+ */
+struct TaskStatistics;
+
 /**
  * An abstract Task. A task can be a CPU or GPU task, it has a deadline measured
  * as the frame number before which the task must be done. A task also has a
@@ -91,6 +96,16 @@ public:
         DATA_NEEDED ///< result of this task is needed again by a successor task of this task
     };
 
+    /**
+     * Possible estimators for the expected duration of tasks (see
+     * #getExpectedDuration).
+     */
+    enum estimator {
+        MEAN_DEVIATION, ///< mean plus two standard deviations, min and max values excluded (default)
+        EWMA, ///< exponentially weighted moving average plus two weighted standard deviations
+        PERCENTILE ///< a percentile of all the measured durations (see #setEstimator)
+    };
+
     /**
      * Creates a new task.
      *
@@ -106,6 +121,25 @@ public:
      */
     virtual ~Task();
 
+#ifndef ORK_NO_TASK_POOL
+    /**
+     * Allocates the memory for a task or a task graph. Tasks are created and
+     * destroyed at each frame, so they are allocated in a TaskPool instead of
+     * with the global operator new.
+     *
+     * @param size the size of the task object, in bytes.
+     */
+    static void *operator new(size_t size);
+
+    /**
+     * Frees the memory of a task allocated with #operator new.
+     *
+     * @param p the task object.
+     * @param size the size of the task object, in bytes.
+     */
+    static void operator delete(void *p, size_t size);
+#endif
+
     /**
      * Returns the execution context of this task. This context is used to sort
      * GPU tasks that share the same context, in order to save context switches.
@@ -118,6 +152,26 @@ public:
      */
     bool isGpuTask() const;
 
+    /**
+     * Returns true if this task is a GPU task that only creates or fills GPU
+     * resources (buffers, textures), and that can therefore be executed by
+     * the upload thread of the scheduler, if any (see
+     * MultithreadScheduler#setUploadContext).
+     */
+    bool isUploadTask() const;
+
+    /**
+     * Sets the upload flag of this GPU task. An upload task is executed with
+     * an OpenGL context that shares its objects with the main context, but
+     * not its state. Hence it must not use the state managed by the main
+     * thread (bound programs, framebuffers and texture units), and it must
+     * bind the objects it fills itself. This method must be called before the
+     * task is scheduled.
+     *
+     * @param upload true if this task only creates or fills GPU resources.
+     */
+    void setUploadTask(bool upload);
+
     /**
      * Returns the frame number before which this task must be completed.
      */
@@ -130,6 +184,38 @@ public:
      */
     void setDeadline(unsigned int deadline);
 
+    /**
+     * Returns the priority of this task. Prefetching tasks with a higher
+     * priority are executed first, and are evicted last when the prefetch
+     * queue of the scheduler is full. The default priority is 0.
+     */
+    float getPriority() const;
+
+    /**
+     * Sets the priority of this task. This method must be called before the
+     * task is scheduled. Use Scheduler#setPriority to change the priority of
+     * a task that is already scheduled. The priority of the sub tasks of a
+     * task graph is offset by the priority of this graph.
+     *
+     * @param priority the new priority of this task.
+     */
+    void setPriority(float priority);
+
+    /**
+     * Returns the key used to sort this task in the queues of a scheduler.
+     * This key is the priority of this task, plus a term taking into account
+     * the time this task has been waiting for execution (see
+     * MultithreadScheduler#setAging). <i>For internal use only</i>.
+     */
+    double getQueuePriority() const;
+
+    /**
+     * Sets the key used to sort this task in the queues of a scheduler.
+     * <i>For internal use only</i>. This method is called by schedulers, it
+     * must not called directly by users.
+     */
+    void setQueuePriority(double priority);
+
     /**
      * Returns the complexity of this task. This number is used to estimate the
      * duration d of this task as d=k*complexity, where k is estimated based on
@@ -230,7 +316,9 @@ public:
 
     /**
      * Returns the expected duration of this task in micro seconds. The result
-     * is based on the complexity of this task (see #getComplexity).
+     * is based on the complexity of this task (see #getComplexity), and on
+     * the estimator selected with #setEstimator. This method does not lock
+     * any mutex.
      */
     float getExpectedDuration();
 
@@ -238,7 +326,10 @@ public:
      * Sets the actual duration of this task. This actual duration is used to
      * improve the estimator for the duration of tasks of this type (see
      * #getTypeInfo). <i>For internal use only</i>. This method is called by
-     * schedulers, it must not called directly by users.
+     * schedulers, it must not called directly by users. Durations are
+     * accumulated per thread, and merged into the statistics of the task
+     * type every few calls, so that threads executing tasks concurrently do
+     * not contend on a lock.
      *
      * @param duration the actual duration of this task in micro seconds.
      */
@@ -260,10 +351,21 @@ public:
 
     /**
      * Logs the statistics about the execution time of the tasks, depending on
-     * their type.
+     * their type. Durations not yet merged by their thread are not included.
      */
     static void logStatistics();
 
+    /**
+     * Sets the estimator used to compute the expected duration of tasks.
+     * The estimates are updated each time new durations are merged into the
+     * statistics of a task type.
+     *
+     * @param e the estimator to use.
+     * @param percentile the percentile to use with the PERCENTILE estimator,
+     *      between 0 and 1.
+     */
+    static void setEstimator(estimator e, float percentile = 0.9f);
+
 protected:
     unsigned int completionDate; ///< time at which this task was completed.
 
@@ -276,37 +378,15 @@ protected:
     virtual const std::type_info *getTypeInfo();
 
 private:
-    /**
-     * Sort operator forstd::type_info objects.
-     */
-    struct TypeInfoSort : public std::less<std::type_info*>
-    {
-        bool operator()(const std::type_info *x, const std::type_info *y) const;
-    };
-
-    /**
-     * Execution time statistics for tasks of a given type.
-     */
-    struct TaskStatistics
-    {
-        float durationSum; ///< sum of the execution times.
-
-        float durationSquareSum; ///< sum of the squares of the execution times.
-
-        float minDuration; ///< minimum execution time.
-
-        float maxDuration; ///< maximum execution time.
-
-        bool corrected; ///< true if min and max values have been removed from sum and squareSum
+    bool gpuTask; ///< true is this task is a GPU task.
 
-        int n; ///< number of executions.
+    unsigned int deadline; ///< frame number before which this tasks must be completed.
 
-        TaskStatistics();
-    };
+    bool uploadTask; ///< true if this GPU task only creates or fills GPU resources.
 
-    bool gpuTask; ///< true is this task is a GPU task.
+    float priority; ///< priority of this task, for prefetching.
 
-    unsigned int deadline; ///< frame number before which this tasks must be completed.
+    double queuePriority; ///< key used to sort this task in the scheduler queues.
 
     unsigned int predecessorsCompletionDate; ///< last completion date of the predecessors of this task.
 
@@ -314,13 +394,17 @@ private:
 
     float expectedDuration; ///< expected duration of this task.
 
-    static void* mutex; ///< mutex used to synchronize accesses to #statistics
+    /**
+     * The execution time statistics for the type of this task, or NULL if
+     * they have not been looked up yet. These statistics are shared by all
+     * the tasks of the same type, and are never deleted.
+     */
+    TaskStatistics *typeStatistics;
 
     /**
-     * The execution time statistics for each task type. Maps TaskStatistics to
-     *std::type_info objects.
+     * Returns the execution time statistics for the type of this task.
      */
-    static std::map<std::type_info const*, TaskStatistics*, TypeInfoSort> statistics;
+    TaskStatistics *getTypeStatistics();
 };
 
 /**
@@ -136,18 +136,17 @@ TaskGraph::TaskIterator TaskGraph::getLastTasks()
 
 TaskGraph::TaskIterator TaskGraph::getDependencies(ptr<Task> t)
 {
-    map< ptr<Task>, set< ptr<Task> > >::iterator i;
+    TaskSetMap::iterator i;
     i = dependencies.find(t);
     if (i != dependencies.end()) {
-        set< ptr<Task> > s = i->second;
-        return TaskIterator(s);
+        return TaskIterator(i->second);
     }
     return TaskIterator();
 }
 
 TaskGraph::TaskIterator TaskGraph::getInverseDependencies(ptr<Task> t)
 {
-    map< ptr<Task>, set< ptr<Task> > >::iterator i;
+    TaskSetMap::iterator i;
     i = inverseDependencies.find(t);
     if (i != inverseDependencies.end()) {
         return TaskIterator(i->second);
@@ -170,7 +169,7 @@ void TaskGraph::addTask(ptr<Task> t)
 
 void TaskGraph::removeTask(ptr<Task> t)
 {
-    set< ptr<Task> >::iterator i = allTasks.find(t);
+    TaskSet::iterator i = allTasks.find(t);
     if (i != allTasks.end()) {
         // we remove ourselves from the listeners of t
         t->removeListener(this);
@@ -219,15 +218,15 @@ void TaskGraph::removeDependency(ptr<Task> src, ptr<Task> dst)
     }
 }
 
-void TaskGraph::removeAndGetDependencies(ptr<Task> src, set< ptr<Task> >& deletedDependencies)
+void TaskGraph::removeAndGetDependencies(ptr<Task> src, TaskSet &deletedDependencies)
 {
     // find the set of dependencies for this task
-    map< ptr<Task>, set< ptr<Task> > >::iterator it = dependencies.find(src);
+    TaskSetMap::iterator it = dependencies.find(src);
     if (it != dependencies.end()) { // there are dependencies
-        set< ptr<Task> > dests = it->second;
-        for (set< ptr<Task> >::iterator i = dests.begin(); i != dests.end(); ++i) {
+        TaskSet &dests = it->second;
+        for (TaskSet::iterator i = dests.begin(); i != dests.end(); ++i) {
             deletedDependencies.insert(*i);
-            set< ptr<Task> > dstSet = inverseDependencies[*i];
+            TaskSet &dstSet = inverseDependencies[*i];
             bool removed = dstSet.erase(src) != 0;
             assert(removed); // should exist in inverse dependencies
             if (dstSet.empty()) {
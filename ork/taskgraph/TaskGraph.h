@@ -46,6 +46,7 @@
 #include <map>
 #include "ork/core/Iterator.h"
 #include "ork/taskgraph/Task.h"
+#include "ork/taskgraph/TaskPool.h"
 
 namespace ork
 {
@@ -64,10 +65,21 @@ namespace ork
 class ORK_API TaskGraph : public Task, public TaskListener
 {
 public:
+    /**
+     * A set of tasks. The nodes of this set are allocated in the TaskPool.
+     */
+    typedef std::set< ptr<Task>, std::less< ptr<Task> >, TaskPoolAllocator< ptr<Task> > > TaskSet;
+
+    /**
+     * A map from tasks to sets of tasks. The nodes of this map are allocated
+     * in the TaskPool.
+     */
+    typedef std::map< ptr<Task>, TaskSet, std::less< ptr<Task> >, TaskPoolAllocator< std::pair< const ptr<Task>, TaskSet > > > TaskSetMap;
+
     /**
      * An iterator to iterate over a set of tasks.
      */
-    typedef SetIterator< ptr<Task> > TaskIterator;
+    typedef SetIterator< ptr<Task>, TaskPoolAllocator< ptr<Task> > > TaskIterator;
 
     /**
      * Creates a new, empty task graph.
@@ -179,7 +191,7 @@ public:
      * @param src a sub task of this graph.
      * @param[out] deletedDependencies the dependencies that src had.
      */
-    void removeAndGetDependencies(ptr<Task> src, std::set< ptr<Task> >& deletedDependencies);
+    void removeAndGetDependencies(ptr<Task> src, TaskSet &deletedDependencies);
 
     /**
      * Removes all the dependencies between the sub tasks of this task graph.
@@ -208,27 +220,27 @@ protected:
     void cleanup();
 
 private:
-    std::set< ptr<Task> > allTasks; ///< all the tasks of this graph
+    TaskSet allTasks; ///< all the tasks of this graph
 
-    std::set< ptr<Task> > firstTasks; ///< the tasks without predecessors
+    TaskSet firstTasks; ///< the tasks without predecessors
 
-    std::set< ptr<Task> > lastTasks; ///< the tasks without successors
+    TaskSet lastTasks; ///< the tasks without successors
 
-    std::set< ptr<Task> > flattenedFirstTasks; ///< the primitive tasks without predecessors
+    TaskSet flattenedFirstTasks; ///< the primitive tasks without predecessors
 
-    std::set< ptr<Task> > flattenedLastTasks; ///< the primitive tasks without successors
+    TaskSet flattenedLastTasks; ///< the primitive tasks without successors
 
     /**
      * The predecessors of the sub tasks of this graph.
      * Maps each task to its set of predecessors.
      */
-    std::map< ptr<Task>, std::set< ptr<Task> > > dependencies;
+    TaskSetMap dependencies;
 
     /**
      * The successors of the sub tasks of this graph.
      * Maps each task to its set of successors.
      */
-    std::map< ptr<Task>, std::set< ptr<Task> > > inverseDependencies;
+    TaskSetMap inverseDependencies;
 
     friend class MultithreadScheduler;
 };
@@ -0,0 +1,314 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+
+#include "ork/taskgraph/TaskPool.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
+
+#include "ork/core/Atomic.h"
+
+#if defined( _WIN64 ) || defined( _WIN32 )
+#include <malloc.h>
+#endif
+
+namespace ork
+{
+
+#define CHUNK_SIZE 65536 // must be a power of two
+
+#define CHUNK_HEADER_SIZE 64
+
+#define SIZE_CLASS_STEP 16
+
+#define SIZE_CLASSES (TaskPool::MAX_BLOCK_SIZE / SIZE_CLASS_STEP)
+
+struct ThreadPool;
+
+/**
+ * The header at the beginning of each chunk. Since chunks are aligned on
+ * CHUNK_SIZE boundaries, the chunk containing a block can be found directly
+ * from the block address.
+ */
+struct ChunkHeader
+{
+    ThreadPool *owner; ///< the pool of the thread that allocated this chunk
+};
+
+/**
+ * The pool of a thread.
+ */
+struct ThreadPool
+{
+    void *freeBlocks[SIZE_CLASSES]; ///< the free blocks for each size class, linked through their first word
+
+    void *volatile remoteBlocks[SIZE_CLASSES]; ///< the blocks freed by other threads, for each size class
+
+    char *chunkEnd[SIZE_CLASSES]; ///< the end of the current chunk for each size class
+
+    char *chunkPos[SIZE_CLASSES]; ///< the first never used block of the current chunk for each size class
+
+    TaskPool::Statistics total; ///< the statistics since the creation of this pool
+
+    TaskPool::Statistics frameStart; ///< the value of #total at the beginning of the current frame
+
+    TaskPool::Statistics lastFrame; ///< the statistics of the last frame
+
+    ThreadPool *next; ///< the next pool in the list of all pools
+
+    bool orphaned; ///< true if the thread of this pool has exited
+
+    ThreadPool()
+    {
+        memset(this, 0, sizeof(ThreadPool));
+    }
+};
+
+static pthread_once_t poolOnce = PTHREAD_ONCE_INIT;
+
+static pthread_key_t poolKey; ///< key of the ThreadPool of each thread
+
+static pthread_mutex_t poolMutex; ///< mutex used to synchronize insertions in allPools
+
+/**
+ * All the thread pools. Pools are never deleted, even when their thread
+ * exits, because blocks allocated in them may still be in use. Instead the
+ * pool of an exited thread is adopted by the next thread that needs a pool
+ * (see #getThreadPool), which then recycles the blocks freed in this pool.
+ */
+static ThreadPool *allPools = NULL;
+
+/**
+ * Marks the pool of an exiting thread as orphaned.
+ */
+static void releaseThreadPool(void *pool)
+{
+    pthread_mutex_lock(&poolMutex);
+    ((ThreadPool*) pool)->orphaned = true;
+    pthread_mutex_unlock(&poolMutex);
+}
+
+static void initPools()
+{
+    pthread_mutex_init(&poolMutex, NULL);
+    pthread_key_create(&poolKey, releaseThreadPool);
+}
+
+static ThreadPool *getThreadPool()
+{
+    ThreadPool *p = (ThreadPool*) pthread_getspecific(poolKey);
+    if (p == NULL) {
+        pthread_mutex_lock(&poolMutex);
+        // we reuse the pool of an exited thread, if any, so that its chunks
+        // and the blocks freed in it by other threads are not lost
+        p = allPools;
+        while (p != NULL && !p->orphaned) {
+            p = p->next;
+        }
+        if (p == NULL) {
+            p = new ThreadPool();
+            p->next = allPools;
+            allPools = p;
+        }
+        p->orphaned = false;
+        pthread_setspecific(poolKey, p);
+        pthread_mutex_unlock(&poolMutex);
+    }
+    return p;
+}
+
+static void *allocateChunk()
+{
+#if defined( _WIN64 ) || defined( _WIN32 )
+    return _aligned_malloc(CHUNK_SIZE, CHUNK_SIZE);
+#else
+    void *chunk = NULL;
+    if (posix_memalign(&chunk, CHUNK_SIZE, CHUNK_SIZE) != 0) {
+        return NULL;
+    }
+    return chunk;
+#endif
+}
+
+/**
+ * Moves the blocks freed by other threads in the free list of the given
+ * size class, and returns the head of this free list.
+ */
+static void *recycleRemoteBlocks(ThreadPool *p, int c)
+{
+    void *head;
+    do {
+        head = p->remoteBlocks[c];
+    } while (head != NULL && !atomic_compare_and_swap_ptr(&(p->remoteBlocks[c]), head, (void*) NULL));
+    if (head != NULL) {
+        void *tail = head;
+        while (*((void**) tail) != NULL) {
+            tail = *((void**) tail);
+        }
+        *((void**) tail) = p->freeBlocks[c];
+        p->freeBlocks[c] = head;
+    }
+    return p->freeBlocks[c];
+}
+
+void *TaskPool::allocate(size_t size)
+{
+    pthread_once(&poolOnce, initPools);
+    ThreadPool *p = getThreadPool();
+    if (size > MAX_BLOCK_SIZE || size == 0) {
+        p->total.heapAllocations += 1;
+        void *block = malloc(size == 0 ? 1 : size);
+        if (block == NULL) {
+            throw std::bad_alloc();
+        }
+        return block;
+    }
+    int c = int((size - 1) / SIZE_CLASS_STEP);
+    p->total.poolAllocations += 1;
+    void *block = p->freeBlocks[c];
+    if (block == NULL) {
+        block = recycleRemoteBlocks(p, c);
+    }
+    if (block != NULL) {
+        p->freeBlocks[c] = *((void**) block);
+        return block;
+    }
+    size_t blockSize = (c + 1) * SIZE_CLASS_STEP;
+    if (p->chunkPos[c] == NULL || p->chunkPos[c] + blockSize > p->chunkEnd[c]) {
+        char *chunk = (char*) allocateChunk();
+        if (chunk == NULL) {
+            throw std::bad_alloc();
+        }
+        ((ChunkHeader*) chunk)->owner = p;
+        p->chunkPos[c] = chunk + CHUNK_HEADER_SIZE;
+        p->chunkEnd[c] = chunk + CHUNK_SIZE;
+        p->total.chunkAllocations += 1;
+        p->total.reservedBytes += CHUNK_SIZE;
+    }
+    block = p->chunkPos[c];
+    p->chunkPos[c] += blockSize;
+    return block;
+}
+
+void TaskPool::deallocate(void *block, size_t size)
+{
+    if (block == NULL) {
+        return;
+    }
+    if (size > MAX_BLOCK_SIZE || size == 0) {
+        free(block);
+        return;
+    }
+    int c = int((size - 1) / SIZE_CLASS_STEP);
+    ChunkHeader *chunk = (ChunkHeader*) (size_t(block) & ~size_t(CHUNK_SIZE - 1));
+    ThreadPool *owner = chunk->owner;
+    if (owner == (ThreadPool*) pthread_getspecific(poolKey)) {
+        *((void**) block) = owner->freeBlocks[c];
+        owner->freeBlocks[c] = block;
+    } else {
+        // the owner thread may be allocating or recycling blocks at the
+        // same time, so we use a lock free push on its remote list
+        void *head;
+        do {
+            head = owner->remoteBlocks[c];
+            *((void**) block) = head;
+        } while (!atomic_compare_and_swap_ptr(&(owner->remoteBlocks[c]), head, block));
+        ThreadPool *p = getThreadPool();
+        p->total.remoteFrees += 1;
+    }
+}
+
+void TaskPool::endFrame()
+{
+    pthread_once(&poolOnce, initPools);
+    ThreadPool *p = getThreadPool();
+    for (int c = 0; c < int(SIZE_CLASSES); ++c) {
+        recycleRemoteBlocks(p, c);
+    }
+    pthread_mutex_lock(&poolMutex);
+    ThreadPool *q = allPools;
+    while (q != NULL) {
+        // the counters of other threads are read without synchronization,
+        // which is sufficient for statistics
+        q->lastFrame.poolAllocations = q->total.poolAllocations - q->frameStart.poolAllocations;
+        q->lastFrame.heapAllocations = q->total.heapAllocations - q->frameStart.heapAllocations;
+        q->lastFrame.chunkAllocations = q->total.chunkAllocations - q->frameStart.chunkAllocations;
+        q->lastFrame.remoteFrees = q->total.remoteFrees - q->frameStart.remoteFrees;
+        q->lastFrame.reservedBytes = q->total.reservedBytes;
+        q->frameStart = q->total;
+        q = q->next;
+    }
+    pthread_mutex_unlock(&poolMutex);
+}
+
+static TaskPool::Statistics sumStatistics(bool frame)
+{
+    TaskPool::Statistics s;
+    memset(&s, 0, sizeof(TaskPool::Statistics));
+    pthread_once(&poolOnce, initPools);
+    pthread_mutex_lock(&poolMutex);
+    ThreadPool *p = allPools;
+    while (p != NULL) {
+        const TaskPool::Statistics &t = frame ? p->lastFrame : p->total;
+        s.poolAllocations += t.poolAllocations;
+        s.heapAllocations += t.heapAllocations;
+        s.chunkAllocations += t.chunkAllocations;
+        s.remoteFrees += t.remoteFrees;
+        s.reservedBytes += t.reservedBytes;
+        p = p->next;
+    }
+    pthread_mutex_unlock(&poolMutex);
+    return s;
+}
+
+TaskPool::Statistics TaskPool::getFrameStatistics()
+{
+    return sumStatistics(true);
+}
+
+TaskPool::Statistics TaskPool::getTotalStatistics()
+{
+    return sumStatistics(false);
+}
+
+}
@@ -0,0 +1,212 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+
+#ifndef _ORK_TASK_POOL_H_
+#define _ORK_TASK_POOL_H_
+
+#include <cstddef>
+#include <new>
+
+namespace ork
+{
+
+/**
+ * A memory pool for the objects that are created and destroyed at each frame
+ * by the task graph framework: Task and TaskGraph objects (see Task#operator
+ * new), and the nodes of the sets and maps used to store their dependencies
+ * (see TaskPoolAllocator). Small blocks are allocated in size classes from
+ * 64KB chunks owned by the allocating thread, without locking. Blocks freed
+ * by their owner thread are immediately reusable. Blocks freed by other
+ * threads (e.g. the scheduler threads) are pushed on a lock free list, which
+ * is recycled in bulk by the owner thread in #endFrame, called at the end of
+ * MultithreadScheduler#run. Chunks are never returned to the system, so the
+ * memory used by the pool is the peak memory used by the task graphs. When a
+ * thread exits, its chunks are reused by the next thread using the pool.
+ * Blocks larger than #MAX_BLOCK_SIZE are allocated with malloc.
+ * @ingroup taskgraph
+ */
+class ORK_API TaskPool
+{
+public:
+    /**
+     * The maximum size of the blocks allocated in the pool.
+     */
+    static const size_t MAX_BLOCK_SIZE = 512;
+
+    /**
+     * Allocation statistics.
+     */
+    struct Statistics
+    {
+        unsigned int poolAllocations; ///< number of blocks allocated from the pool
+
+        unsigned int heapAllocations; ///< number of blocks allocated with malloc
+
+        unsigned int chunkAllocations; ///< number of new chunks allocated
+
+        unsigned int remoteFrees; ///< number of blocks freed by another thread than their owner
+
+        size_t reservedBytes; ///< total size of the allocated chunks
+    };
+
+    /**
+     * Allocates a block of the given size.
+     *
+     * @param size the block size in bytes.
+     */
+    static void *allocate(size_t size);
+
+    /**
+     * Frees a block allocated with #allocate.
+     *
+     * @param p the block to be freed.
+     * @param size the size that was passed to #allocate for this block.
+     */
+    static void deallocate(void *p, size_t size);
+
+    /**
+     * Recycles the blocks owned by the current thread that have been freed
+     * by other threads, and ends the statistics of the current frame.
+     */
+    static void endFrame();
+
+    /**
+     * Returns the allocation statistics of the last frame (i.e. between the
+     * last two calls to #endFrame), for all threads.
+     */
+    static Statistics getFrameStatistics();
+
+    /**
+     * Returns the allocation statistics since the creation of the pool, for
+     * all threads.
+     */
+    static Statistics getTotalStatistics();
+};
+
+/**
+ * A standard allocator using the TaskPool.
+ * @ingroup taskgraph
+ */
+template <class T>
+class TaskPoolAllocator
+{
+public:
+    typedef T value_type;
+
+    typedef T *pointer;
+
+    typedef const T *const_pointer;
+
+    typedef T &reference;
+
+    typedef const T &const_reference;
+
+    typedef size_t size_type;
+
+    typedef ptrdiff_t difference_type;
+
+    template <class U>
+    struct rebind
+    {
+        typedef TaskPoolAllocator<U> other;
+    };
+
+    TaskPoolAllocator()
+    {
+    }
+
+    template <class U>
+    TaskPoolAllocator(const TaskPoolAllocator<U> &)
+    {
+    }
+
+    pointer address(reference x) const
+    {
+        return &x;
+    }
+
+    const_pointer address(const_reference x) const
+    {
+        return &x;
+    }
+
+    pointer allocate(size_type n, const void * = 0)
+    {
+        return (pointer) TaskPool::allocate(n * sizeof(T));
+    }
+
+    void deallocate(pointer p, size_type n)
+    {
+        TaskPool::deallocate(p, n * sizeof(T));
+    }
+
+    size_type max_size() const
+    {
+        return size_type(-1) / sizeof(T);
+    }
+
+    void construct(pointer p, const T &v)
+    {
+        new ((void*) p) T(v);
+    }
+
+    void destroy(pointer p)
+    {
+        p->~T();
+    }
+
+    template <class U>
+    bool operator==(const TaskPoolAllocator<U> &) const
+    {
+        return true;
+    }
+
+    template <class U>
+    bool operator!=(const TaskPoolAllocator<U> &) const
+    {
+        return false;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,349 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#include "ork/taskgraph/TaskTracer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+
+#include "ork/core/Atomic.h"
+
+#include <pthread.h>
+
+using namespace std;
+
+namespace ork
+{
+
+/**
+ * A recorded event, with the index of the thread that recorded it.
+ */
+template<typename E>
+struct ThreadEvent
+{
+    const E *e;
+
+    int thread;
+
+    bool operator<(const ThreadEvent &o) const
+    {
+        return e->time < o.e->time;
+    }
+};
+
+/**
+ * Writes a string as a JSON string.
+ */
+static void writeString(ostream &out, const char *s)
+{
+    out << '"';
+    for (; *s != 0; ++s) {
+        if (*s == '"' || *s == '\\') {
+            out << '\\';
+        }
+        out << *s;
+    }
+    out << '"';
+}
+
+static_ptr<TaskTracer> TaskTracer::INSTANCE(NULL);
+
+TaskTracer::Buffer::Buffer(int thread, unsigned int capacity) :
+    thread(thread), events(capacity), head(0), first(0)
+{
+}
+
+TaskTracer::TaskTracer(unsigned int capacity) :
+    Object("TaskTracer"), capacity(max(capacity, 1u)), frames(0)
+{
+    mutex = new pthread_mutex_t;
+    pthread_mutex_init((pthread_mutex_t*) mutex, NULL);
+    key = new pthread_key_t;
+    pthread_key_create((pthread_key_t*) key, NULL);
+}
+
+TaskTracer::~TaskTracer()
+{
+    pthread_key_delete(*((pthread_key_t*) key));
+    delete (pthread_key_t*) key;
+    pthread_mutex_destroy((pthread_mutex_t*) mutex);
+    delete (pthread_mutex_t*) mutex;
+    for (unsigned int i = 0; i < buffers.size(); ++i) {
+        delete buffers[i];
+    }
+}
+
+void TaskTracer::frameBegin()
+{
+    Buffer *b = getBuffer();
+    Event &e = newEvent(b, FRAME, NULL);
+    e.deadline = frames++;
+    publish(b);
+}
+
+void TaskTracer::taskBegin(Task *t)
+{
+    Buffer *b = getBuffer();
+    newEvent(b, BEGIN, t);
+    publish(b);
+}
+
+void TaskTracer::taskEnd(Task *t, bool run, bool changes)
+{
+    Buffer *b = getBuffer();
+    Event &e = newEvent(b, END, t);
+    e.run = run;
+    e.changes = changes;
+    publish(b);
+}
+
+void TaskTracer::dependency(Task *src, Task *dst)
+{
+    Buffer *b = getBuffer();
+    Event &e = newEvent(b, DEPENDENCY, src);
+    e.other = dst;
+    publish(b);
+}
+
+void TaskTracer::clear()
+{
+    pthread_mutex_lock((pthread_mutex_t*) mutex);
+    for (unsigned int i = 0; i < buffers.size(); ++i) {
+        buffers[i]->first = buffers[i]->head;
+    }
+    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+}
+
+void TaskTracer::write(ostream &out)
+{
+    // copies the events of all threads, without blocking them
+    pthread_mutex_lock((pthread_mutex_t*) mutex);
+    vector< vector<Event> > copies(buffers.size());
+    vector<int> threads(buffers.size());
+    for (unsigned int i = 0; i < buffers.size(); ++i) {
+        getEvents(buffers[i], copies[i]);
+        threads[i] = buffers[i]->thread;
+    }
+    pthread_mutex_unlock((pthread_mutex_t*) mutex);
+
+    vector< ThreadEvent<Event> > events;
+    double origin = 0.0;
+    for (unsigned int i = 0; i < copies.size(); ++i) {
+        for (unsigned int j = 0; j < copies[i].size(); ++j) {
+            ThreadEvent<Event> e;
+            e.e = &copies[i][j];
+            e.thread = threads[i];
+            events.push_back(e);
+        }
+    }
+    sort(events.begin(), events.end());
+    if (!events.empty()) {
+        origin = events[0].e->time;
+    }
+
+    // finds the begin and end events of each task, in time order, in
+    // order to bind the dependency events to them
+    map< Task*, vector<unsigned int> > begins;
+    map< Task*, vector<unsigned int> > ends;
+    for (unsigned int i = 0; i < events.size(); ++i) {
+        const Event *e = events[i].e;
+        if (e->type == BEGIN) {
+            begins[e->task].push_back(i);
+        } else if (e->type == END) {
+            ends[e->task].push_back(i);
+        }
+    }
+
+    out.setf(ios::fixed, ios::floatfield);
+    out.precision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool firstEvent = true;
+    for (unsigned int i = 0; i < threads.size(); ++i) {
+        // the thread that records the frames is the one that runs the
+        // MultithreadScheduler#run method, i.e., the main thread
+        bool main = false;
+        for (unsigned int j = 0; j < copies[i].size() && !main; ++j) {
+            main = copies[i][j].type == FRAME;
+        }
+        out << (firstEvent ? "" : ",\n");
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << threads[i];
+        out << ",\"args\":{\"name\":\"" << (main ? "main" : "thread") << " " << threads[i] << "\"}}";
+        firstEvent = false;
+    }
+    int flowId = 0;
+    for (unsigned int i = 0; i < events.size(); ++i) {
+        const Event *e = events[i].e;
+        int tid = events[i].thread;
+        double ts = e->time - origin;
+        if (e->type == FRAME) {
+            out << (firstEvent ? "" : ",\n");
+            out << "{\"name\":\"frame " << e->deadline << "\",\"cat\":\"frame\",\"ph\":\"i\",\"s\":\"g\"";
+            out << ",\"ts\":" << ts << ",\"pid\":0,\"tid\":" << tid << "}";
+        } else if (e->type == BEGIN || e->type == END) {
+            out << (firstEvent ? "" : ",\n");
+            out << "{\"name\":";
+            writeString(out, e->name);
+            out << ",\"cat\":\"" << (e->gpu ? "gpu" : "cpu") << "\",\"ph\":\"" << (e->type == BEGIN ? "B" : "E") << "\"";
+            out << ",\"ts\":" << ts << ",\"pid\":0,\"tid\":" << tid << ",\"args\":{";
+            if (e->type == BEGIN) {
+                out << "\"task\":\"" << (void*) e->task << "\",\"deadline\":" << e->deadline;
+                out << ",\"context\":\"" << e->context << "\",\"complexity\":" << e->complexity;
+            } else {
+                out << "\"run\":" << (e->run ? "true" : "false") << ",\"changes\":" << (e->changes ? "true" : "false");
+            }
+            out << "}}";
+        } else {
+            // a dependency src -> dst is drawn as a flow from the end of the
+            // first execution of dst to the beginning of the first execution
+            // of src, after the dependency was recorded
+            const ThreadEvent<Event> *dstEnd = NULL;
+            const ThreadEvent<Event> *srcBegin = NULL;
+            map< Task*, vector<unsigned int> >::iterator j = ends.find(e->other);
+            if (j != ends.end()) {
+                for (unsigned int k = 0; k < j->second.size() && dstEnd == NULL; ++k) {
+                    if (j->second[k] > i) {
+                        dstEnd = &events[j->second[k]];
+                    }
+                }
+            }
+            j = begins.find(e->task);
+            if (j != begins.end()) {
+                for (unsigned int k = 0; k < j->second.size() && srcBegin == NULL; ++k) {
+                    if (j->second[k] > i) {
+                        srcBegin = &events[j->second[k]];
+                    }
+                }
+            }
+            if (dstEnd != NULL && srcBegin != NULL) {
+                out << (firstEvent ? "" : ",\n");
+                out << "{\"name\":\"dependency\",\"cat\":\"dependency\",\"ph\":\"s\",\"id\":" << flowId;
+                out << ",\"ts\":" << (dstEnd->e->time - origin) << ",\"pid\":0,\"tid\":" << dstEnd->thread << "},\n";
+                out << "{\"name\":\"dependency\",\"cat\":\"dependency\",\"ph\":\"f\",\"bp\":\"e\",\"id\":" << flowId;
+                out << ",\"ts\":" << (srcBegin->e->time - origin) << ",\"pid\":0,\"tid\":" << srcBegin->thread << "}";
+                ++flowId;
+            } else {
+                continue;
+            }
+        }
+        firstEvent = false;
+    }
+    out << "\n]}\n";
+}
+
+bool TaskTracer::write(const string &file)
+{
+    ofstream out(file.c_str());
+    if (!out) {
+        return false;
+    }
+    write(out);
+    return out.good();
+}
+
+TaskTracer::Buffer *TaskTracer::getBuffer()
+{
+    Buffer *b = (Buffer*) pthread_getspecific(*((pthread_key_t*) key));
+    if (b == NULL) {
+        // first event recorded by this thread: registers a new buffer
+        pthread_mutex_lock((pthread_mutex_t*) mutex);
+        b = new Buffer((int) buffers.size(), capacity);
+        buffers.push_back(b);
+        pthread_mutex_unlock((pthread_mutex_t*) mutex);
+        pthread_setspecific(*((pthread_key_t*) key), b);
+    }
+    return b;
+}
+
+TaskTracer::Event &TaskTracer::newEvent(Buffer *b, eventType type, Task *t)
+{
+    Event &e = b->events[b->head % capacity];
+    e.type = type;
+    e.time = b->timer.start();
+    e.task = t;
+    e.other = NULL;
+    e.name = "";
+    e.context = NULL;
+    e.deadline = 0;
+    e.complexity = 0;
+    e.gpu = false;
+    e.run = false;
+    e.changes = false;
+    if (t != NULL) {
+        e.name = t->getClass();
+        if (e.name[0] == 0) {
+            e.name = typeid(*t).name();
+        }
+        e.context = t->getContext();
+        e.deadline = t->getDeadline();
+        e.complexity = t->getComplexity();
+        e.gpu = t->isGpuTask();
+    }
+    return e;
+}
+
+void TaskTracer::publish(Buffer *b)
+{
+    // the event must be completely written before it becomes visible
+    memory_barrier();
+    b->head = b->head + 1;
+}
+
+void TaskTracer::getEvents(Buffer *b, vector<Event> &events)
+{
+    unsigned int head = b->head;
+    memory_barrier();
+    unsigned int start = head > capacity ? head - capacity : 0;
+    start = max(start, b->first);
+    for (unsigned int i = start; i < head; ++i) {
+        events.push_back(b->events[i % capacity]);
+    }
+    memory_barrier();
+    // discards the events that may have been overwritten during the copy;
+    // the event being written is at index b->head, in slot b->head - capacity
+    unsigned int newHead = b->head;
+    if (newHead + 1 > capacity && newHead + 1 - capacity > start) {
+        unsigned int overwritten = min(newHead + 1 - capacity - start, (unsigned int) events.size());
+        events.erase(events.begin(), events.begin() + overwritten);
+    }
+}
+
+}
@@ -0,0 +1,243 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#ifndef _ORK_TASK_TRACER_H_
+#define _ORK_TASK_TRACER_H_
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "ork/core/Timer.h"
+#include "ork/taskgraph/Task.h"
+
+namespace ork
+{
+
+/**
+ * A recorder of task execution timelines. When the static #INSTANCE tracer
+ * is not NULL, the MultithreadScheduler records the begin and end of each
+ * executed task, on each thread, with its deadline, execution context and
+ * complexity, as well as the dependencies between tasks and the frame
+ * boundaries. Events are recorded without locks, in a fixed size ring
+ * buffer per thread (the oldest events are overwritten when a buffer is
+ * full). The recorded events can be written at any time in the Chrome trace
+ * event format (JSON), which can be loaded in chrome://tracing or Perfetto.
+ *
+ * @ingroup taskgraph
+ */
+class ORK_API TaskTracer : public Object
+{
+public:
+    /**
+     * The tracer used by the task scheduler. NULL by default.
+     */
+    static static_ptr<TaskTracer> INSTANCE;
+
+    /**
+     * Creates a new TaskTracer.
+     *
+     * @param capacity the maximum number of events recorded per thread.
+     */
+    TaskTracer(unsigned int capacity = 65536);
+
+    /**
+     * Deletes this TaskTracer.
+     */
+    virtual ~TaskTracer();
+
+    /**
+     * Records the start of a new frame.
+     */
+    void frameBegin();
+
+    /**
+     * Records the beginning of the execution of a task, on the current thread.
+     *
+     * @param t a task.
+     */
+    void taskBegin(Task *t);
+
+    /**
+     * Records the end of the execution of a task, on the current thread.
+     *
+     * @param t a task.
+     * @param run false if the task was up to date and was not run.
+     * @param changes the result of Task#run.
+     */
+    void taskEnd(Task *t, bool run, bool changes);
+
+    /**
+     * Records a dependency between two primitive tasks.
+     *
+     * @param src a task that must be executed after dst.
+     * @param dst a task that must be executed before src.
+     */
+    void dependency(Task *src, Task *dst);
+
+    /**
+     * Discards all the events recorded so far.
+     */
+    void clear();
+
+    /**
+     * Writes the recorded events in the Chrome trace event format.
+     *
+     * @param out the stream where the events must be written.
+     */
+    void write(std::ostream &out);
+
+    /**
+     * Writes the recorded events in the Chrome trace event format.
+     *
+     * @param file the name of the file where the events must be written.
+     * @return true if the file was successfully written.
+     */
+    bool write(const std::string &file);
+
+private:
+    /**
+     * Possible event types.
+     */
+    enum eventType {
+        FRAME, ///< start of a frame
+        BEGIN, ///< beginning of the execution of a task
+        END, ///< end of the execution of a task
+        DEPENDENCY ///< dependency between two tasks
+    };
+
+    /**
+     * A recorded event.
+     */
+    struct Event
+    {
+        eventType type; ///< the event type.
+
+        double time; ///< the event time in micro seconds.
+
+        Task *task; ///< the task (or src task for dependencies). Not owned.
+
+        Task *other; ///< the dst task for dependencies. Not owned.
+
+        const char *name; ///< the task type name (static storage).
+
+        void *context; ///< the task execution context.
+
+        unsigned int deadline; ///< the task deadline, or the frame number for FRAME events.
+
+        int complexity; ///< the task complexity.
+
+        bool gpu; ///< true for GPU tasks.
+
+        bool run; ///< false if the task was up to date (END only).
+
+        bool changes; ///< the result of Task#run (END only).
+    };
+
+    /**
+     * The ring buffer of events of a thread. Events are written only by the
+     * thread that owns the buffer.
+     */
+    struct Buffer
+    {
+        int thread; ///< the thread index.
+
+        std::vector<Event> events; ///< the event ring buffer.
+
+        volatile unsigned int head; ///< the number of events written so far.
+
+        unsigned int first; ///< index of the first event not cleared.
+
+        Timer timer; ///< timer used to get the event times.
+
+        Buffer(int thread, unsigned int capacity);
+    };
+
+    /**
+     * The capacity of each buffer.
+     */
+    unsigned int capacity;
+
+    /**
+     * The number of frames recorded so far.
+     */
+    unsigned int frames;
+
+    /**
+     * The buffers of all the threads that recorded events.
+     */
+    std::vector<Buffer*> buffers;
+
+    /**
+     * A mutex used only to register new thread buffers.
+     */
+    void *mutex;
+
+    /**
+     * The pthread key used to find the buffer of the current thread.
+     */
+    void *key;
+
+    /**
+     * Returns the buffer of the current thread, creating it if necessary.
+     */
+    Buffer *getBuffer();
+
+    /**
+     * Returns a new event in the buffer of the current thread. The event
+     * must be published with #publish.
+     */
+    Event &newEvent(Buffer *b, eventType type, Task *t);
+
+    /**
+     * Publishes the last event returned by #newEvent.
+     */
+    void publish(Buffer *b);
+
+    /**
+     * Returns a copy of the valid events of the given buffer.
+     */
+    void getEvents(Buffer *b, std::vector<Event> &events);
+};
+
+}
+
+#endif
@@ -67,6 +67,36 @@ using namespace std;
 namespace ork
 {
 
+/**
+ * A SharedContext implemented with a hidden GLFW window.
+ */
+class GlfwSharedContext : public SharedContext
+{
+public:
+    GlfwSharedContext(GLFWwindow *window) : SharedContext(), window(window)
+    {
+    }
+
+    virtual ~GlfwSharedContext()
+    {
+        glfwDestroyWindow(window);
+    }
+
+protected:
+    virtual bool makeContextCurrent()
+    {
+        glfwMakeContextCurrent(window);
+        return glfwGetCurrentContext() == window;
+    }
+
+    virtual void releaseContext()
+    {
+        glfwMakeContextCurrent(NULL);
+    }
+
+private:
+    GLFWwindow *window;
+};
 
 GlfwWindow::GlfwWindow(const Parameters &params) : Window(params), glfwWindowHandle(NULL)
 {
@@ -207,6 +237,22 @@ int GlfwWindow::getHeight() const
     return size.y;
 }
 
+ptr<SharedContext> GlfwWindow::createSharedContext()
+{
+    // same context version and profile as in the constructor
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    GLFWwindow* gwd = glfwCreateWindow(1, 1, "", NULL, (GLFWwindow*)glfwWindowHandle);
+    glfwWindowHint(GLFW_VISIBLE, GL_TRUE);
+    if (gwd == NULL) {
+        if (Logger::ERROR_LOGGER != NULL) {
+            Logger::ERROR_LOGGER->log("UI", "Could not create GLFW shared context!");
+            Logger::ERROR_LOGGER->flush();
+        }
+        return NULL;
+    }
+    return new GlfwSharedContext(gwd);
+}
+
 void GlfwWindow::getMousePosition(int* x, int* y)
 {
     GLFWwindow* gwd = (GLFWwindow*)glfwWindowHandle;
@@ -86,6 +86,11 @@ public:
 
     virtual void idle(bool damaged);
 
+    /**
+     * Creates a hidden GLFW window whose context shares its objects with the
+     * context of this window.
+     */
+    virtual ptr<SharedContext> createSharedContext();
 
     /**
      * Tells the windowing system wether to wait for a vertical
@@ -0,0 +1,375 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#include "ork/ui/HeadlessWindow.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <cstring>
+#include <exception>
+
+#include "ork/core/Logger.h"
+#include "ork/ui/DebugCallback.h"
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+using namespace std;
+
+namespace ork
+{
+
+/**
+ * Returns true if the given space separated extension list contains the
+ * given extension.
+ */
+static bool hasEGLExtension(const char *extensions, const char *extension)
+{
+    if (extensions == NULL) {
+        return false;
+    }
+    size_t n = strlen(extension);
+    const char *p = extensions;
+    while ((p = strstr(p, extension)) != NULL) {
+        if ((p == extensions || p[-1] == ' ') && (p[n] == ' ' || p[n] == '\0')) {
+            return true;
+        }
+        p += n;
+    }
+    return false;
+}
+
+/**
+ * A SharedContext implemented with an EGL context.
+ */
+class EGLSharedContext : public SharedContext
+{
+public:
+    EGLSharedContext(EGLDisplay display, EGLSurface surface, EGLContext context) :
+        SharedContext(), display(display), surface(surface), context(context)
+    {
+    }
+
+    virtual ~EGLSharedContext()
+    {
+        eglDestroyContext(display, context);
+        if (surface != EGL_NO_SURFACE) {
+            eglDestroySurface(display, surface);
+        }
+    }
+
+protected:
+    virtual bool makeContextCurrent()
+    {
+        return eglMakeCurrent(display, surface, surface, context) == EGL_TRUE;
+    }
+
+    virtual void releaseContext()
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+
+private:
+    EGLDisplay display;
+
+    EGLSurface surface;
+
+    EGLContext context;
+};
+
+void HeadlessWindow::eglError(const char *message)
+{
+    if (Logger::ERROR_LOGGER != NULL) {
+        Logger::ERROR_LOGGER->logf("UI", "%s (EGL error 0x%x)", message, eglGetError());
+        Logger::ERROR_LOGGER->flush();
+    }
+    // the destructor is not called when the constructor throws
+    destroy();
+    throw exception();
+}
+
+HeadlessWindow::HeadlessWindow(const Parameters &params, unsigned int maxFrames) :
+    Window(params), display(EGL_NO_DISPLAY), surface(EGL_NO_SURFACE), context(EGL_NO_CONTEXT),
+    config(NULL), params(params), maxFrames(maxFrames), frameCount(0), closed(false), t(0.0), dt(0.0), vao(0)
+{
+    EGLDisplay dpy = (EGLDisplay) getHeadlessDisplay();
+    EGLint major, minor;
+    if (dpy == EGL_NO_DISPLAY || !eglInitialize(dpy, &major, &minor)) {
+        eglError("Could not init EGL!");
+    }
+    display = dpy;
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        eglError("EGL does not support OpenGL!");
+    }
+
+    int width = params.width() > 0 ? params.width() : 640;
+    int height = params.height() > 0 ? params.height() : 480;
+
+    // sizes are minimum sizes, and configs with the smallest depth and stencil
+    // buffers come first, so that unrequested buffers are not allocated
+    EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, params.alpha() ? 8 : 0,
+        EGL_DEPTH_SIZE, params.depth() ? 24 : 0,
+        EGL_STENCIL_SIZE, params.stencil() ? 8 : 0,
+        EGL_SAMPLE_BUFFERS, params.multiSample() ? 1 : 0,
+        EGL_SAMPLES, params.multiSample() ? 4 : 0,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(dpy, configAttribs, &config, 1, &configCount) || configCount == 0) {
+        eglError("Could not find an EGL pbuffer config!");
+    }
+    this->config = config;
+
+    EGLint surfaceAttribs[] = {
+        EGL_WIDTH, width,
+        EGL_HEIGHT, height,
+        EGL_NONE
+    };
+    surface = eglCreatePbufferSurface(dpy, config, surfaceAttribs);
+    if (surface == EGL_NO_SURFACE) {
+        eglError("Could not create EGL pbuffer!");
+    }
+
+    context = createContext(EGL_NO_CONTEXT);
+    if (context == EGL_NO_CONTEXT) {
+        eglError("Could not create EGL OpenGL context!");
+    }
+    if (!eglMakeCurrent(dpy, (EGLSurface) surface, (EGLSurface) surface, (EGLContext) context)) {
+        eglError("Could not make EGL context current!");
+    }
+
+    glewExperimental = GL_TRUE;
+    GLenum err = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // GLEW built for GLX fails to load the GLX entry points without an X
+    // display, but the OpenGL entry points are correctly loaded
+    if (err == GLEW_ERROR_NO_GLX_DISPLAY) {
+        err = GLEW_OK;
+    }
+#endif
+    // flushes the GL_INVALID_ENUM error that glewInit can generate
+    GLenum errAfterGlewInit = glGetError();
+    if (err != GLEW_OK || !(errAfterGlewInit == GL_NO_ERROR || errAfterGlewInit == GL_INVALID_ENUM)) {
+        if (Logger::ERROR_LOGGER != NULL) {
+            Logger::ERROR_LOGGER->logf("UI", "Could not init GLEW, Error: %s", glewGetErrorString(err));
+            Logger::ERROR_LOGGER->flush();
+        }
+        destroy();
+        throw exception();
+    }
+
+    if (Logger::INFO_LOGGER != NULL) {
+        Logger::INFO_LOGGER->logf("UI", "Headless EGL %d.%d context: %s %s", major, minor, glGetString(GL_RENDERER), glGetString(GL_VERSION));
+    }
+
+    if (params.debug() && glDebugMessageCallbackARB != NULL) {
+        glDebugMessageCallbackARB(debugCallback, NULL);
+    }
+
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    reshape(width, height);
+    timer.start();
+}
+
+HeadlessWindow::~HeadlessWindow()
+{
+    destroy();
+}
+
+void HeadlessWindow::destroy()
+{
+    EGLDisplay dpy = (EGLDisplay) display;
+    if (context != EGL_NO_CONTEXT) {
+        if (vao != 0) {
+            glDeleteVertexArrays(1, &vao);
+        }
+        eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(dpy, (EGLContext) context);
+        context = EGL_NO_CONTEXT;
+        vao = 0;
+    }
+    if (surface != EGL_NO_SURFACE) {
+        eglDestroySurface(dpy, (EGLSurface) surface);
+        surface = EGL_NO_SURFACE;
+    }
+    if (dpy != EGL_NO_DISPLAY) {
+        eglTerminate(dpy);
+        display = EGL_NO_DISPLAY;
+    }
+}
+
+int HeadlessWindow::getWidth() const
+{
+    return size.x;
+}
+
+int HeadlessWindow::getHeight() const
+{
+    return size.y;
+}
+
+void HeadlessWindow::start()
+{
+    // as GlfwWindow, calls reshape first because many applications set some
+    // states based on it
+    reshape(getWidth(), getHeight());
+    while (!closed && (maxFrames == 0 || frameCount < maxFrames)) {
+        redisplay(t, dt);
+        idle(false);
+    }
+}
+
+void HeadlessWindow::redisplay(double, double)
+{
+    eglSwapBuffers((EGLDisplay) display, (EGLSurface) surface);
+    ++frameCount;
+    double newT = timer.end();
+    dt = newT - t;
+    t = newT;
+}
+
+void HeadlessWindow::reshape(int x, int y)
+{
+    size = vec2i(x, y);
+}
+
+void HeadlessWindow::idle(bool)
+{
+}
+
+void HeadlessWindow::close()
+{
+    closed = true;
+}
+
+unsigned int HeadlessWindow::getFrameCount() const
+{
+    return frameCount;
+}
+
+ptr<SharedContext> HeadlessWindow::createSharedContext()
+{
+    EGLDisplay dpy = (EGLDisplay) display;
+    EGLSurface s = EGL_NO_SURFACE;
+    if (!hasEGLExtension(eglQueryString(dpy, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+        EGLint surfaceAttribs[] = {
+            EGL_WIDTH, 1,
+            EGL_HEIGHT, 1,
+            EGL_NONE
+        };
+        s = eglCreatePbufferSurface(dpy, (EGLConfig) config, surfaceAttribs);
+        if (s == EGL_NO_SURFACE) {
+            if (Logger::ERROR_LOGGER != NULL) {
+                Logger::ERROR_LOGGER->logf("UI", "Could not create EGL shared context surface (EGL error 0x%x)", eglGetError());
+            }
+            return NULL;
+        }
+    }
+    EGLContext c = (EGLContext) createContext(context);
+    if (c == EGL_NO_CONTEXT) {
+        if (Logger::ERROR_LOGGER != NULL) {
+            Logger::ERROR_LOGGER->logf("UI", "Could not create EGL shared context (EGL error 0x%x)", eglGetError());
+        }
+        if (s != EGL_NO_SURFACE) {
+            eglDestroySurface(dpy, s);
+        }
+        return NULL;
+    }
+    return new EGLSharedContext(dpy, s, c);
+}
+
+void *HeadlessWindow::getHeadlessDisplay()
+{
+    const char *extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = NULL;
+    if (hasEGLExtension(extensions, "EGL_EXT_platform_base")) {
+        getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    }
+    if (getPlatformDisplay != NULL) {
+        // Mesa drivers, including llvmpipe, without any windowing system
+        if (hasEGLExtension(extensions, "EGL_MESA_platform_surfaceless")) {
+            EGLDisplay dpy = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+            if (dpy != EGL_NO_DISPLAY) {
+                return dpy;
+            }
+        }
+        // other drivers (e.g. NVIDIA), using the first GPU device
+        if (hasEGLExtension(extensions, "EGL_EXT_platform_device")) {
+            PFNEGLQUERYDEVICESEXTPROC queryDevices = (PFNEGLQUERYDEVICESEXTPROC) eglGetProcAddress("eglQueryDevicesEXT");
+            EGLDeviceEXT device;
+            EGLint deviceCount = 0;
+            if (queryDevices != NULL && queryDevices(1, &device, &deviceCount) && deviceCount > 0) {
+                EGLDisplay dpy = getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, device, NULL);
+                if (dpy != EGL_NO_DISPLAY) {
+                    return dpy;
+                }
+            }
+        }
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+void *HeadlessWindow::createContext(void *share)
+{
+    vec2<int> version = params.version();
+    bool core = version.x > 3 || (version.x == 3 && version.y >= 2);
+    EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION_KHR, version.x,
+        EGL_CONTEXT_MINOR_VERSION_KHR, version.y,
+        EGL_CONTEXT_FLAGS_KHR, params.debug() ? EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR : 0,
+        core ? EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR : EGL_NONE, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+        EGL_NONE
+    };
+    return eglCreateContext((EGLDisplay) display, (EGLConfig) config, (EGLContext) share, contextAttribs);
+}
+
+}
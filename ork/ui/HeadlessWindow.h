@@ -0,0 +1,210 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#ifndef _ORK_HEADLESS_WINDOW_H_
+#define _ORK_HEADLESS_WINDOW_H_
+
+#include <GL/glew.h>
+
+#include "ork/math/vec2.h"
+#include "ork/core/Timer.h"
+#include "ork/ui/Window.h"
+
+namespace ork
+{
+
+/**
+ * A Window without display, implemented with EGL. The OpenGL context is
+ * created without any windowing system (with the Mesa surfaceless platform,
+ * or with the first EGL device, or with the default EGL display), and the
+ * default framebuffer is an offscreen pbuffer of the size given in the window
+ * parameters. This window does not receive any user interface event. Its
+ * #start method calls #redisplay and #idle in a loop, until #close is called
+ * or until the maximum number of frames is reached. It can be used to render
+ * images on servers without X display, or to run tests and benchmarks in
+ * batch mode (e.g. with Mesa llvmpipe). The content of the default
+ * framebuffer can be read with FrameBuffer#readPixels.
+ * @ingroup ui
+ */
+class ORK_API HeadlessWindow : public Window
+{
+public:
+    /**
+     * Creates a new headless window.
+     *
+     * @param params the parameters of the window. The window name is ignored.
+     * @param maxFrames the number of frames after which #start returns, or 0
+     *      to return only when #close is called.
+     */
+    HeadlessWindow(const Window::Parameters &params, unsigned int maxFrames = 0);
+
+    /**
+     * Deletes this window.
+     */
+    virtual ~HeadlessWindow();
+
+    virtual int getWidth() const;
+
+    virtual int getHeight() const;
+
+    virtual void start();
+
+    virtual void redisplay(double t, double dt);
+
+    virtual void reshape(int x, int y);
+
+    virtual void idle(bool damaged);
+
+    /**
+     * Creates an EGL context that shares its objects with the context of
+     * this window. This context uses a 1x1 pbuffer surface, or no surface
+     * at all if EGL_KHR_surfaceless_context is supported.
+     */
+    virtual ptr<SharedContext> createSharedContext();
+
+    /**
+     * Requests the end of the #start loop. The loop ends after the current
+     * frame.
+     */
+    void close();
+
+    /**
+     * Returns the number of frames displayed since the creation of this
+     * window.
+     */
+    unsigned int getFrameCount() const;
+
+private:
+    /**
+     * The EGL display (an EGLDisplay).
+     */
+    void *display;
+
+    /**
+     * The EGL pbuffer surface used as default framebuffer (an EGLSurface).
+     */
+    void *surface;
+
+    /**
+     * The EGL OpenGL context (an EGLContext).
+     */
+    void *context;
+
+    /**
+     * The EGL framebuffer configuration of #surface (an EGLConfig).
+     */
+    void *config;
+
+    /**
+     * The parameters of this window.
+     */
+    Window::Parameters params;
+
+    /**
+     * The current size of this window.
+     */
+    vec2i size;
+
+    /**
+     * The number of frames after which #start returns, or 0.
+     */
+    unsigned int maxFrames;
+
+    /**
+     * The number of frames displayed since the creation of this window.
+     */
+    unsigned int frameCount;
+
+    /**
+     * True if #close has been called.
+     */
+    bool closed;
+
+    /**
+     * Timer used for computing the parameters of redisplay.
+     */
+    Timer timer;
+
+    /**
+     * The time at the end of the last execution of #redisplay.
+     */
+    double t;
+
+    /**
+     * The elapsed time bewteen the two previous calls to #redisplay.
+     */
+    double dt;
+
+    /**
+     * The default vertex array object, bound during the whole lifetime of
+     * the context (core profile contexts do not have one).
+     */
+    GLuint vao;
+
+    /**
+     * Returns an EGL display that does not need a windowing system.
+     */
+    static void *getHeadlessDisplay();
+
+    /**
+     * Creates an EGL OpenGL context for #config.
+     *
+     * @param share the context whose objects must be shared with the new
+     *      context (an EGLContext), or EGL_NO_CONTEXT.
+     * @return the new context (an EGLContext), or EGL_NO_CONTEXT.
+     */
+    void *createContext(void *share);
+
+    /**
+     * Logs the given message with the current EGL error, destroys the EGL
+     * objects created so far, and throws an exception.
+     */
+    void eglError(const char *message);
+
+    /**
+     * Destroys the EGL objects created so far, and terminates #display.
+     */
+    void destroy();
+};
+
+}
+
+#endif
@@ -150,4 +150,9 @@ Window::~Window()
 {
 }
 
+ptr<SharedContext> Window::createSharedContext()
+{
+    return NULL;
+}
+
 }
@@ -44,6 +44,7 @@
 
 #include <string>
 
+#include "ork/core/SharedContext.h"
 #include "ork/math/vec2.h"
 #include "ork/ui/EventHandler.h"
 
@@ -219,6 +220,15 @@ public:
      * Starts the user interface event processing loop.
      */
     virtual void start() = 0;
+
+    /**
+     * Creates a new OpenGL context that shares its objects with the context
+     * of this window. This method must be called from the main thread. The
+     * default implementation returns NULL.
+     *
+     * @return the new context, or NULL if shared contexts are not supported.
+     */
+    virtual ptr<SharedContext> createSharedContext();
 };
 
 }
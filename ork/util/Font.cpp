@@ -138,6 +138,18 @@ vec2f Font::getSize(const string &line, float height) const
 vec2f Font::addLine(const vec4f &viewport, float xs, float ys, const string &line, float height,
     int color, ptr< Mesh<Vertex, unsigned int> > textMesh)
 {
+    vector<Vertex> vertices;
+    vec2f end = addLine(viewport, xs, ys, line, height, color, vertices);
+    if (!vertices.empty()) {
+        textMesh->addVertices(&vertices[0], int(vertices.size()));
+    }
+    return end;
+}
+
+vec2f Font::addLine(const vec4f &viewport, float xs, float ys, const string &line, float height,
+    int color, vector<Vertex> &vertices)
+{
+    vertices.reserve(vertices.size() + 6 * line.size());
     for (unsigned int i = 0; i < line.size(); ++i) {
 
         int index = charCount(line[i]);
@@ -169,12 +181,12 @@ vec2f Font::addLine(const vec4f &viewport, float xs, float ys, const string &lin
         vec4h pos_uv2 = vec4f(xs1 * 2.0f - 1.0f, 1.0f - ys0 * 2.0f, u1, v1).cast<half>();
         vec4h pos_uv3 = vec4f(xs0 * 2.0f - 1.0f, 1.0f - ys0 * 2.0f, u0, v1).cast<half>();
 
-        textMesh->addVertex(Vertex(pos_uv0, color));
-        textMesh->addVertex(Vertex(pos_uv1, color));
-        textMesh->addVertex(Vertex(pos_uv2, color));
-        textMesh->addVertex(Vertex(pos_uv2, color));
-        textMesh->addVertex(Vertex(pos_uv3, color));
-        textMesh->addVertex(Vertex(pos_uv0, color));
+        vertices.push_back(Vertex(pos_uv0, color));
+        vertices.push_back(Vertex(pos_uv1, color));
+        vertices.push_back(Vertex(pos_uv2, color));
+        vertices.push_back(Vertex(pos_uv2, color));
+        vertices.push_back(Vertex(pos_uv3, color));
+        vertices.push_back(Vertex(pos_uv0, color));
 
         xs += (height * width) / getTileWidth();
     }
@@ -157,6 +157,21 @@ public:
     vec2f addLine(const vec4f &viewport, float xs, float ys, const std::string &line, float height,
             int color, ptr< Mesh<Vertex, unsigned int> > textMesh);
 
+    /**
+     * Add a given line of text in a given vertex array and returns the final
+     * position of the line.
+     *
+     * @param viewport the framebuffer viewport, in pixels.
+     * @param xs the x coordinate of the first character to display.
+     * @param ys the y coordinate of the first character to display.
+     * @param line the line of text to display.
+     * @param height height of a char in pixels.
+     * @param color color of this line of text (in RGBA8 format).
+     * @param vertices the vertex array to write into, as a list of triangles.
+     */
+    vec2f addLine(const vec4f &viewport, float xs, float ys, const std::string &line, float height,
+            int color, std::vector<Vertex> &vertices);
+
     /**
      * Add a given line of text in a given Mesh centered at a given
      * position and returns the size of the line.
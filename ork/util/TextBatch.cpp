@@ -0,0 +1,132 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#include "ork/util/TextBatch.h"
+
+using namespace std;
+
+namespace ork
+{
+
+TextBatch::TextBatch(ptr<Font> font) :
+    Object("TextBatch"), font(font), lineCount(0), vertexCount(0)
+{
+    mesh = new Mesh<Font::Vertex, unsigned int>(TRIANGLES, GPU_DYNAMIC);
+    mesh->addAttributeType(0, 4, A16F, false);
+    mesh->addAttributeType(1, 4, A8UI, true);
+}
+
+TextBatch::~TextBatch()
+{
+}
+
+ptr<Font> TextBatch::getFont() const
+{
+    return font;
+}
+
+void TextBatch::setFont(ptr<Font> font)
+{
+    if (font != this->font) {
+        this->font = font;
+        lines.clear();
+    }
+}
+
+int TextBatch::getVertexCount() const
+{
+    return vertexCount;
+}
+
+void TextBatch::begin()
+{
+    lineCount = 0;
+    vertexCount = 0;
+}
+
+void TextBatch::addLine(const vec4f &viewport, float xs, float ys, const string &line, float height, int color)
+{
+    if (lineCount == lines.size()) {
+        lines.push_back(Line());
+        lines.back().first = -1;
+    }
+    Line &l = lines[lineCount++];
+    if (l.first < 0 || l.text != line || l.xs != xs || l.ys != ys || l.height != height ||
+        l.color != color || l.viewport != viewport)
+    {
+        // the line has changed: we recompute its character quads
+        l.viewport = viewport;
+        l.xs = xs;
+        l.ys = ys;
+        l.height = height;
+        l.color = color;
+        l.text = line;
+        l.vertices.clear();
+        font->addLine(viewport, xs, ys, line, height, color, l.vertices);
+        l.first = -1;
+    }
+    if (l.first != vertexCount) {
+        // the line has changed, or has moved in the mesh because a previous
+        // line has changed length: we copy its quads in the mesh
+        int n = int(l.vertices.size());
+        int m = max(0, min(n, mesh->getVertexCount() - vertexCount));
+        for (int i = 0; i < m; ++i) {
+            mesh->setVertex(vertexCount + i, l.vertices[i]);
+        }
+        if (m < n) {
+            mesh->addVertices(&l.vertices[m], n - m);
+        }
+        l.first = vertexCount;
+    }
+    vertexCount += int(l.vertices.size());
+}
+
+void TextBatch::draw(ptr<FrameBuffer> fb, ptr<Program> p)
+{
+    // the lines of the previous frame that have not been replaced are
+    // removed; the vertices after vertexCount are simply not drawn
+    lines.resize(lineCount);
+    if (vertexCount > 0) {
+        fb->draw(p, *(mesh->getBuffers()), TRIANGLES, 0, vertexCount);
+    }
+}
+
+}
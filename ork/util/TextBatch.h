@@ -0,0 +1,172 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#ifndef _ORK_TEXT_BATCH_H_
+#define _ORK_TEXT_BATCH_H_
+
+#include "ork/render/FrameBuffer.h"
+#include "ork/util/Font.h"
+
+namespace ork
+{
+
+/**
+ * A retained batch of text lines, drawn with a single draw call. The lines
+ * are added at each frame between #begin and #draw, always in the same
+ * order. The character quads of each line are cached, and a line that did
+ * not change since the previous frame, and is still at the same position in
+ * the batch, costs no quad generation and no upload. All the lines are
+ * stored in one GPU_DYNAMIC mesh, whose GPU buffer is only updated in the
+ * vertex ranges of the modified lines.
+ *
+ * @ingroup util
+ */
+class ORK_API TextBatch : public Object
+{
+public:
+    /**
+     * Creates a new TextBatch.
+     *
+     * @param font the Font used to display the text lines.
+     */
+    TextBatch(ptr<Font> font);
+
+    /**
+     * Deletes this TextBatch.
+     */
+    virtual ~TextBatch();
+
+    /**
+     * Returns the Font used to display the text lines.
+     */
+    ptr<Font> getFont() const;
+
+    /**
+     * Sets the Font used to display the text lines.
+     */
+    void setFont(ptr<Font> font);
+
+    /**
+     * Returns the number of vertices currently stored in this batch.
+     */
+    int getVertexCount() const;
+
+    /**
+     * Starts a new frame. The lines added after this call replace those of
+     * the previous frame.
+     */
+    void begin();
+
+    /**
+     * Adds a line of text to this batch. See Font#addLine.
+     *
+     * @param viewport the framebuffer viewport, in pixels.
+     * @param xs the x coordinate of the first character to display.
+     * @param ys the y coordinate of the first character to display.
+     * @param line the line of text to display.
+     * @param height height of a char in pixels.
+     * @param color color of this line of text (in RGBA8 format).
+     */
+    void addLine(const vec4f &viewport, float xs, float ys, const std::string &line, float height, int color);
+
+    /**
+     * Draws the lines added since the last call to #begin, with a single
+     * draw call. The font texture must be set in the given program.
+     *
+     * @param fb the framebuffer to draw into.
+     * @param p the program to be used to draw characters.
+     */
+    void draw(ptr<FrameBuffer> fb, ptr<Program> p);
+
+private:
+    /**
+     * A line of text with its cached character quads.
+     */
+    struct Line
+    {
+        vec4f viewport; ///< the framebuffer viewport used to compute #vertices
+
+        float xs; ///< the x coordinate of the first character
+
+        float ys; ///< the y coordinate of the first character
+
+        float height; ///< the height of a char in pixels
+
+        int color; ///< the color of this line, in RGBA8 format
+
+        std::string text; ///< the text of this line
+
+        int first; ///< the offset of #vertices in #mesh
+
+        std::vector<Font::Vertex> vertices; ///< the character quads of #text
+    };
+
+    /**
+     * The Font used to display the text lines.
+     */
+    ptr<Font> font;
+
+    /**
+     * The mesh containing the quads of all the lines.
+     */
+    ptr< Mesh<Font::Vertex, unsigned int> > mesh;
+
+    /**
+     * The lines of the current frame, followed by those of the previous frame
+     * that have not been replaced yet.
+     */
+    std::vector<Line> lines;
+
+    /**
+     * The number of lines added since the last call to #begin.
+     */
+    unsigned int lineCount;
+
+    /**
+     * The number of vertices used by the lines added since the last call to
+     * #begin.
+     */
+    int vertexCount;
+};
+
+}
+
+#endif
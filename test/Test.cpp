@@ -43,7 +43,11 @@
 
 #include "ork/core/FileLogger.h"
 #include "ork/render/FrameBuffer.h"
+#ifdef HEADLESS_TESTS
+#include "ork/ui/HeadlessWindow.h"
+#else
 #include "ork/ui/GlfwWindow.h"
+#endif
 
 #if defined( _WIN64 ) || defined( _WIN32 )
 #include "process.h"
@@ -68,11 +72,11 @@ TestSuite *TestSuite::getInstance()
 
 TestSuite *TestSuite::INSTANCE = NULL;
 
-Test::Test(const char *name, testFunction test, int majorVersion)
+Test::Test(const char *name, testFunction test, int majorVersion, int minorVersion)
 {
     TestSuite::getInstance()->tests.push_back(test);
     TestSuite::getInstance()->testNames.push_back(name);
-    TestSuite::getInstance()->testVersions.push_back(majorVersion);
+    TestSuite::getInstance()->testVersions.push_back(10 * majorVersion + minorVersion);
 }
 
 const char* testName = NULL;
@@ -93,7 +97,13 @@ void test(bool result, const char *file, int line)
     }
 }
 
-class TestWindow : public GlfwWindow
+#ifdef HEADLESS_TESTS
+typedef HeadlessWindow TestWindowBase;
+#else
+typedef GlfwWindow TestWindowBase;
+#endif
+
+class TestWindow : public TestWindowBase
 {
 public:
     const char* tests;
@@ -101,7 +111,7 @@ public:
     unsigned int currentTest;
 
     TestWindow(const char *tests, int major = 3, int minor = 3) :
-        GlfwWindow(Window::Parameters().name("Test").size(128, 128).version(major, minor, true)),
+        TestWindowBase(Window::Parameters().name("Test").size(128, 128).version(major, minor, true).alpha(true).depth(true).stencil(true)),
         tests(tests), currentTest(0)
     {
         Logger::INFO_LOGGER = new FileLogger("INFO", new FileLogger::File("testLog.html"), NULL);
@@ -115,7 +125,7 @@ public:
             if (strcmp(tests, "ALL") == 0 || strcmp(tests, testName) == 0) {
                 printf("%s...%*s", testName, 60 - strlen(testName), "");
                 fflush(NULL);
-                if (TestSuite::getInstance()->testVersions[currentTest] <= FrameBuffer::getMajorVersion()) {
+                if (TestSuite::getInstance()->testVersions[currentTest] <= 10 * FrameBuffer::getMajorVersion() + FrameBuffer::getMinorVersion()) {
                     TestSuite::getInstance()->tests[currentTest]();
                 } else {
                     printf("[SKIPPED]\n");
@@ -137,13 +147,13 @@ public:
             }
         }
 
-        GlfwWindow::redisplay(t, dt);
+        TestWindowBase::redisplay(t, dt);
     }
 
     void reshape(int x, int y)
     {
         FrameBuffer::getDefault()->setViewport(vec4<GLint>(0, 0, x, y));
-        GlfwWindow::reshape(x, y);
+        TestWindowBase::reshape(x, y);
         idle(false);
     }
 
@@ -152,6 +162,11 @@ public:
 
 static_ptr<Window> TestWindow::app;
 
+ptr<SharedContext> createSharedContext()
+{
+    return TestWindow::app->createSharedContext();
+}
+
 #if defined( _WIN64 ) || defined( _WIN32 )
 
 bool testProcess(const char *cmd, int argc, const char *const *argv)
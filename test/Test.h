@@ -65,7 +65,7 @@ private:
 class Test
 {
 public:
-    Test(const char *name, testFunction test, int majorVersion = 3);
+    Test(const char *name, testFunction test, int majorVersion = 3, int minorVersion = 0);
 };
 
 void test(bool result, const char* file, int line);
@@ -74,6 +74,8 @@ void test(bool result, const char* file, int line);
 
 #define TEST4(x) void x(); Test _##x(#x, x, 4); void x()
 
+#define TEST43(x) void x(); Test _##x(#x, x, 4, 3); void x()
+
 #define ASSERT(x) test(x, __FILE__, __LINE__)
 
 #endif
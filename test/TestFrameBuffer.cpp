@@ -42,6 +42,10 @@
 #include "test/Test.h"
 
 #include "ork/render/FrameBuffer.h"
+#include "ork/render/ReadbackManager.h"
+#include "ork/render/RenderTargetPool.h"
+#include "ork/render/TransientBuffer.h"
+#include "ork/util/TextBatch.h"
 
 using namespace std;
 using namespace ork;
@@ -967,12 +971,18 @@ TEST(cpuMeshModificationIndices)
         pixels2[l] == 1 && pixels2[l + 1] == 2 && pixels2[l + 2] == 3 && pixels2[l + 3] == 4);
 }
 
-TEST(gpuMeshModificationDirect)
+ptr<FrameBuffer> getMeshFrameBuffer()
 {
     ptr<FrameBuffer> fb = new FrameBuffer();
     fb->setTextureBuffer(COLOR0, new Texture2D(8, 8, RGBA8I, RGBA_INTEGER, INT,
         Texture::Parameters().mag(NEAREST),  Buffer::Parameters(), CPUBuffer(NULL)), 0);
     fb->setViewport(vec4<GLint>(0, 0, 8, 8));
+    return fb;
+}
+
+TEST(gpuMeshModificationDirect)
+{
+    ptr<FrameBuffer> fb = getMeshFrameBuffer();
     ptr<Program> p = new Program(new Module(330, FRAGMENT_SHADER));
     ptr< Mesh<vec4f, unsigned int> > quad = new Mesh<vec4f, unsigned int>(TRIANGLE_STRIP, GPU_DYNAMIC);
     quad->addAttributeType(0, 4, A32F, false);
@@ -997,14 +1007,11 @@ TEST(gpuMeshModificationDirect)
         pixels2[l] == 1 && pixels2[l + 1] == 2 && pixels2[l + 2] == 3 && pixels2[l + 3] == 4);
 }
 
-TEST(gpuMeshModificationIndices)
+bool checkMeshModificationIndices(MeshUsage usage)
 {
-    ptr<FrameBuffer> fb = new FrameBuffer();
-    fb->setTextureBuffer(COLOR0, new Texture2D(8, 8, RGBA8I, RGBA_INTEGER, INT,
-        Texture::Parameters().mag(NEAREST),  Buffer::Parameters(), CPUBuffer(NULL)), 0);
-    fb->setViewport(vec4<GLint>(0, 0, 8, 8));
+    ptr<FrameBuffer> fb = getMeshFrameBuffer();
     ptr<Program> p = new Program(new Module(330, FRAGMENT_SHADER));
-    ptr< Mesh<vec4f, unsigned int> > quad = new Mesh<vec4f, unsigned int>(TRIANGLE_STRIP, GPU_DYNAMIC);
+    ptr< Mesh<vec4f, unsigned int> > quad = new Mesh<vec4f, unsigned int>(TRIANGLE_STRIP, usage);
     quad->addAttributeType(0, 4, A32F, false);
     quad->addVertex(vec4f(-1, -1, 0, 1));
     quad->addVertex(vec4f(1, -1, 0, 1));
@@ -1019,14 +1026,242 @@ TEST(gpuMeshModificationIndices)
     int pixels2[4 * 8 * 8];
     int l = 4 * (8 * 8 - 1);
     fb->readPixels(0, 0, 8, 8, RGBA_INTEGER, INT, Buffer::Parameters(), CPUBuffer(pixels1));
+    if (usage == GPU_TRANSIENT) {
+        TransientBuffer::INSTANCE->endFrame();
+    }
     quad->setIndice(0, 2);
     quad->setIndice(1, 1);
     quad->setIndice(2, 3);
     fb->clear(true, true, true);
     fb->draw(p, *quad);
     fb->readPixels(0, 0, 8, 8, RGBA_INTEGER, INT, Buffer::Parameters(), CPUBuffer(pixels2));
-    ASSERT(pixels1[0] == 1 && pixels1[1] == 2 && pixels1[2] == 3 && pixels1[3] == 4 &&
+    if (usage == GPU_TRANSIENT) {
+        TransientBuffer::INSTANCE->endFrame();
+    }
+    return pixels1[0] == 1 && pixels1[1] == 2 && pixels1[2] == 3 && pixels1[3] == 4 &&
         pixels1[l] == 0 && pixels1[l + 1] == 0 && pixels1[l + 2] == 0 && pixels1[l + 3] == 0 &&
         pixels2[0] == 0 && pixels2[1] == 0 && pixels2[2] == 0 && pixels2[3] == 0 &&
+        pixels2[l] == 1 && pixels2[l + 1] == 2 && pixels2[l + 2] == 3 && pixels2[l + 3] == 4;
+}
+
+TEST(gpuMeshModificationIndices)
+{
+    ASSERT(checkMeshModificationIndices(GPU_DYNAMIC));
+}
+
+TEST(gpuMeshClearAndPartialModification)
+{
+    ptr<FrameBuffer> fb = getMeshFrameBuffer();
+    ptr<Program> p = new Program(new Module(330, FRAGMENT_SHADER));
+    ptr< Mesh<vec4f, unsigned int> > mesh = new Mesh<vec4f, unsigned int>(TRIANGLES, GPU_DYNAMIC, 3);
+    mesh->addAttributeType(0, 4, A32F, false);
+    mesh->addVertex(vec4f(-1, -1, 0, 1));
+    mesh->addVertex(vec4f(1, -1, 0, 1));
+    mesh->addVertex(vec4f(-1, 1, 0, 1));
+    fb->clear(true, true, true);
+    fb->draw(p, *mesh);
+    // refills the mesh with more vertices than its initial capacity
+    mesh->clear();
+    vec4f vertices[6] = {
+        vec4f(-1, -1, 0, 1), vec4f(0, -1, 0, 1), vec4f(-1, 0, 0, 1),
+        vec4f(-1, 1, 0, 1), vec4f(1, -1, 0, 1), vec4f(1, 1, 0, 1)
+    };
+    mesh->addVertices(vertices, 6);
+    int pixels1[4 * 8 * 8];
+    int pixels2[4 * 8 * 8];
+    int l = 4 * (8 * 8 - 1);
+    fb->clear(true, true, true);
+    fb->draw(p, *mesh);
+    fb->readPixels(0, 0, 8, 8, RGBA_INTEGER, INT, Buffer::Parameters(), CPUBuffer(pixels1));
+    // modifies only the first triangle, which then covers no pixel center
+    mesh->setVertex(1, vec4f(-1, -1, 0, 1));
+    mesh->setVertex(2, vec4f(-1, -1, 0, 1));
+    fb->clear(true, true, true);
+    fb->draw(p, *mesh);
+    fb->readPixels(0, 0, 8, 8, RGBA_INTEGER, INT, Buffer::Parameters(), CPUBuffer(pixels2));
+    ASSERT(mesh->getVertexCount() == 6 &&
+        pixels1[0] == 1 && pixels1[1] == 2 && pixels1[2] == 3 && pixels1[3] == 4 &&
+        pixels1[l] == 1 && pixels1[l + 1] == 2 && pixels1[l + 2] == 3 && pixels1[l + 3] == 4 &&
+        pixels2[0] == 0 && pixels2[1] == 0 && pixels2[2] == 0 && pixels2[3] == 0 &&
         pixels2[l] == 1 && pixels2[l + 1] == 2 && pixels2[l + 2] == 3 && pixels2[l + 3] == 4);
 }
+
+TEST(gpuStaticMeshGrowth)
+{
+    ptr<FrameBuffer> fb = getMeshFrameBuffer();
+    ptr<Program> p = new Program(new Module(330, FRAGMENT_SHADER));
+    ptr< Mesh<vec4f, unsigned int> > quad = new Mesh<vec4f, unsigned int>(TRIANGLES, GPU_STATIC, 6, 6);
+    quad->addAttributeType(0, 4, A32F, false);
+    quad->addVertex(vec4f(-1, -1, 0, 1));
+    quad->addVertex(vec4f(1, -1, 0, 1));
+    quad->addVertex(vec4f(-1, 1, 0, 1));
+    fb->clear(true, true, true);
+    fb->draw(p, *quad);
+    int pixels1[4 * 8 * 8];
+    int pixels2[4 * 8 * 8];
+    int l = 4 * (8 * 8 - 1);
+    fb->readPixels(0, 0, 8, 8, RGBA_INTEGER, INT, Buffer::Parameters(), CPUBuffer(pixels1));
+    // the new vertices fit in the vertex array allocated on the CPU, but not
+    // in the GPU buffer created by the first draw
+    quad->addVertex(vec4f(1, -1, 0, 1));
+    quad->addVertex(vec4f(1, 1, 0, 1));
+    quad->addVertex(vec4f(-1, 1, 0, 1));
+    fb->clear(true, true, true);
+    fb->draw(p, *quad);
+    fb->readPixels(0, 0, 8, 8, RGBA_INTEGER, INT, Buffer::Parameters(), CPUBuffer(pixels2));
+    ASSERT(pixels1[0] == 1 && pixels1[1] == 2 && pixels1[2] == 3 && pixels1[3] == 4 &&
+        pixels1[l] == 0 && pixels1[l + 1] == 0 && pixels1[l + 2] == 0 && pixels1[l + 3] == 0 &&
+        pixels2[0] == 1 && pixels2[1] == 2 && pixels2[2] == 3 && pixels2[3] == 4 &&
+        pixels2[l] == 1 && pixels2[l + 1] == 2 && pixels2[l + 2] == 3 && pixels2[l + 3] == 4);
+}
+
+TEST(gpuTransientMeshModificationIndices)
+{
+    TransientBuffer::INSTANCE = new TransientBuffer(1024 * 1024, 2);
+    // allocates some data before the mesh, to test non zero offsets
+    int padding[5] = { 0, 0, 0, 0, 0 };
+    TransientBuffer::INSTANCE->upload(padding, sizeof(padding));
+    bool result = checkMeshModificationIndices(GPU_TRANSIENT);
+    TransientBuffer::INSTANCE = NULL;
+    ASSERT(result);
+}
+
+class TestReadbackCallback : public ReadbackManager::Callback
+{
+public:
+    float pixels[4 * 8 * 8];
+
+    TestReadbackCallback()
+    {
+        pixels[0] = 0.0f;
+    }
+
+    virtual void dataRead(volatile void *data)
+    {
+        for (int i = 0; i < 4 * 8 * 8; ++i) {
+            pixels[i] = ((volatile float*) data)[i];
+        }
+    }
+};
+
+TEST(asyncReadback)
+{
+    ptr<FrameBuffer> fb = new FrameBuffer();
+    ptr<Texture2D> t = new Texture2D(8, 8, RGBA32F, RGBA, FLOAT,
+        Texture::Parameters().mag(NEAREST), Buffer::Parameters(), CPUBuffer(NULL));
+    fb->setTextureBuffer(COLOR0, t, 0);
+    fb->setViewport(vec4<GLint>(0, 0, 8, 8));
+    fb->setClearColor(vec4f(1.0f, 2.0f, 3.0f, 4.0f));
+    fb->clear(true, false, false);
+    ptr<ReadbackManager> r = new ReadbackManager(1, 4 * 8 * 8 * sizeof(float));
+    ptr<TestReadbackCallback> cb1 = new TestReadbackCallback();
+    ptr<TestReadbackCallback> cb2 = new TestReadbackCallback();
+    bool ok1 = r->readPixels(fb, 0, 0, 8, 8, RGBA, FLOAT, cb1);
+    bool full = !r->canReadback() && !r->getImage(t, 0, RGBA, FLOAT, cb2);
+    r->flush();
+    bool ok2 = r->getImage(t, 0, RGBA, FLOAT, cb2);
+    r->flush();
+    int l = 4 * (8 * 8 - 1);
+    ASSERT(ok1 && full && ok2 && r->getPendingCount() == 0 &&
+        cb1->pixels[0] == 1.0f && cb1->pixels[1] == 2.0f && cb1->pixels[2] == 3.0f && cb1->pixels[3] == 4.0f &&
+        cb2->pixels[l] == 1.0f && cb2->pixels[l + 1] == 2.0f && cb2->pixels[l + 2] == 3.0f && cb2->pixels[l + 3] == 4.0f);
+}
+
+TEST(asyncReadbackTooLarge)
+{
+    ptr<FrameBuffer> fb = new FrameBuffer();
+    ptr<Texture2D> t = new Texture2D(16, 16, RGBA32F, RGBA, FLOAT,
+        Texture::Parameters().mag(NEAREST), Buffer::Parameters(), CPUBuffer(NULL));
+    fb->setTextureBuffer(COLOR0, t, 0);
+    fb->setViewport(vec4<GLint>(0, 0, 16, 16));
+    ptr<ReadbackManager> r = new ReadbackManager(1, 4 * 8 * 8 * sizeof(float));
+    ptr<TestReadbackCallback> cb = new TestReadbackCallback();
+    bool tooLarge1 = !r->readPixels(fb, 0, 0, 8, 9, RGBA, FLOAT, cb);
+    bool tooLarge2 = !r->getImage(t, 0, RGBA, FLOAT, cb);
+    bool free = r->canReadback();
+    bool ok = r->readPixels(fb, 0, 0, 8, 8, RGBA, FLOAT, cb);
+    r->flush();
+    ASSERT(tooLarge1 && tooLarge2 && free && ok && r->getPendingCount() == 0);
+}
+
+TEST(renderTargetPoolAliasing)
+{
+    ptr<RenderTargetPool> pool = new RenderTargetPool(1);
+    Texture::Parameters params = Texture::Parameters().min(NEAREST).mag(NEAREST);
+    ptr<Texture2D> t1 = pool->acquireTexture(8, 8, RGBA8, RGBA, UNSIGNED_BYTE, params);
+    ptr<Texture2D> t2 = pool->acquireTexture(8, 8, RGBA8, RGBA, UNSIGNED_BYTE, params);
+    pool->releaseTexture(t1);
+    // same format, size and parameters: reuses t1
+    ptr<Texture2D> t3 = pool->acquireTexture(8, 8, RGBA8, RGBA, UNSIGNED_BYTE, params);
+    // different size: allocates a new texture
+    ptr<Texture2D> t4 = pool->acquireTexture(16, 16, RGBA8, RGBA, UNSIGNED_BYTE, params);
+    int count1 = pool->getTextureCount();
+    pool->endFrame();
+    int used = pool->getUsedCount();
+    pool->acquireTexture(8, 8, RGBA8, RGBA, UNSIGNED_BYTE, params);
+    pool->endFrame();
+    // the 16x16 texture and the other 8x8 one were not used in the last frame
+    int count2 = pool->getTextureCount();
+    ASSERT(t1 != t2 && t3 == t1 && t4 != t1 && t4 != t2 && t4->getWidth() == 16 &&
+        count1 == 3 && used == 0 && count2 == 1);
+}
+
+TEST(renderTargetPoolParameters)
+{
+    ptr<RenderTargetPool> pool = new RenderTargetPool(1);
+    Texture::Parameters params = Texture::Parameters().min(NEAREST).mag(NEAREST);
+    ptr<Texture2D> t1 = pool->acquireTexture(8, 8, RGBA8, RGBA, UNSIGNED_BYTE, params);
+    pool->releaseTexture(t1);
+    // other parameters than the filters and S and T wrap modes must match
+    ptr<Texture2D> t2 = pool->acquireTexture(8, 8, RGBA8, RGBA, UNSIGNED_BYTE,
+        Texture::Parameters().min(NEAREST).mag(NEAREST).compareFunc(LEQUAL));
+    ptr<Texture2D> t3 = pool->acquireTexture(8, 8, RGBA8, RGBA, UNSIGNED_BYTE,
+        Texture::Parameters().min(NEAREST).mag(NEAREST).lodMax(0.0f));
+    ptr<Texture2D> t4 = pool->acquireTexture(8, 8, RGBA8, RGBA, UNSIGNED_BYTE,
+        Texture::Parameters().min(NEAREST).mag(NEAREST).borderf(1.0f, 0.0f, 0.0f, 0.0f));
+    ptr<Texture2D> t5 = pool->acquireTexture(8, 8, RGBA8, RGBA, UNSIGNED_BYTE, params);
+    ASSERT(t2 != t1 && t3 != t1 && t4 != t1 && t5 == t1 && pool->getTextureCount() == 4);
+}
+
+TEST(textBatch)
+{
+    ptr<FrameBuffer> fb = new FrameBuffer();
+    fb->setTextureBuffer(COLOR0, new Texture2D(4, 1, RGBA8, RGBA, UNSIGNED_BYTE,
+        Texture::Parameters().mag(NEAREST), Buffer::Parameters(), CPUBuffer(NULL)), 0);
+    fb->setViewport(vec4<GLint>(0, 0, 4, 1));
+    ptr<Program> p = new Program(new Module(330, "\
+        #ifdef _VERTEX_\n\
+        layout(location=0) in vec4 pos_uv;\n\
+        layout(location=1) in vec4 c;\n\
+        out vec4 col;\n\
+        void main() { gl_Position = vec4(pos_uv.xy, 0.0, 1.0); col = c; }\n\
+        #endif\n\
+        #ifdef _FRAGMENT_\n\
+        in vec4 col;\n\
+        layout(location=0) out vec4 color;\n\
+        void main() { color = col; }\n\
+        #endif\n"));
+    // a font with 1 pixel wide characters
+    ptr<Texture2D> fontTex = new Texture2D(1, 1, RGBA8, RGBA, UNSIGNED_BYTE,
+        Texture::Parameters(), Buffer::Parameters(), CPUBuffer(NULL));
+    ptr<Font> font = new Font(fontTex, 1, 1, 32, 127, 32, false, vector<int>(96, 1));
+    ptr<TextBatch> text = new TextBatch(font);
+    vec4f vp = vec4f(0.0f, 0.0f, 4.0f, 1.0f);
+    unsigned char pixels[3][16];
+    int counts[3];
+    for (int frame = 0; frame < 3; ++frame) {
+        text->begin();
+        text->addLine(vp, 0.0f, 0.0f, frame < 2 ? "ab" : "a", 1.0f, 0xFF0000FF);
+        text->addLine(vp, 3.0f, 0.0f, "c", 1.0f, 0x00FF00FF);
+        fb->clear(true, true, true);
+        text->draw(fb, p);
+        counts[frame] = text->getVertexCount();
+        fb->readPixels(0, 0, 4, 1, RGBA, UNSIGNED_BYTE, Buffer::Parameters(), CPUBuffer(pixels[frame]));
+    }
+    // frame 1 reuses the quads of frame 0; in frame 2 the second line is
+    // moved in the mesh because the first one is shorter
+    ASSERT(counts[0] == 18 && counts[1] == 18 && counts[2] == 12 &&
+        memcmp(pixels[0], pixels[1], 16) == 0 &&
+        pixels[0][0] == 255 && pixels[0][4] == 255 && pixels[0][8] == 0 && pixels[0][13] == 255 &&
+        pixels[2][0] == 255 && pixels[2][4] == 0 && pixels[2][8] == 0 && pixels[2][13] == 255);
+}
@@ -288,3 +288,34 @@ TEST4(testTransformFeedback3)
     fb->readPixels(0, 0, 1, 1, RGBA, FLOAT, Buffer::Parameters(), CPUBuffer(&data));
     ASSERT(data[0] == 1.0f && data[1] == 2.0f && data[2] == 3.0f && data[3] == 4.0f);
 }
+
+TEST4(testComputeProgram)
+{
+    ptr<FrameBuffer> fb = getFrameBuffer(RenderBuffer::R32F, 1, 1);
+    ptr<Texture2D> t = new Texture2D(4, 4, R32F, RED, FLOAT,
+        Texture::Parameters().min(NEAREST).mag(NEAREST), Buffer::Parameters(), CPUBuffer(NULL));
+    // TEST4 tests run with an OpenGL 4.0 context, which needs extensions
+    // for compute shaders and image stores
+    ptr<Program> p = new Program(new Module(400, "\
+        #extension GL_ARB_compute_shader : require\n\
+        #extension GL_ARB_shader_image_load_store : require\n\
+        #ifdef _COMPUTE_\n\
+        layout(local_size_x=2, local_size_y=2) in;\n\
+        layout(r32f) writeonly uniform image2D img;\n\
+        void main() {\n\
+            ivec2 i = ivec2(gl_GlobalInvocationID.xy);\n\
+            imageStore(img, i, vec4(float(i.x + 4 * i.y)));\n\
+        }\n\
+        #endif\n"));
+    t->bindToImageUnit(0, 0, WRITE_ONLY);
+    p->getUniform1i("img")->set(0);
+    fb->dispatch(p, 2, 2);
+    FrameBuffer::memoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+    float pixels[16];
+    t->getImage(0, RED, FLOAT, pixels);
+    bool ok = true;
+    for (int i = 0; i < 16; ++i) {
+        ok = ok && pixels[i] == float(i);
+    }
+    ASSERT(ok);
+}
@@ -0,0 +1,84 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+#include "test/Test.h"
+
+#include "ork/core/GPUProfiler.h"
+#include "ork/render/FrameBuffer.h"
+
+using namespace ork;
+using namespace std;
+
+ptr<FrameBuffer> getFrameBuffer(RenderBuffer::RenderBufferFormat f, int w, int h);
+
+TEST(testTimestampQuery)
+{
+    ptr<FrameBuffer> fb = getFrameBuffer(RenderBuffer::R32F, 1, 1);
+    ptr<Program> p = new Program(new Module(330, NULL, "\
+        layout(location=0) out vec4 color;\n\
+        void main() { color = vec4(1.0, 0.0, 0.0, 0.0); }\n"));
+    ptr<Query> q0 = new Query(TIME_STAMP);
+    ptr<Query> q1 = new Query(TIME_STAMP);
+    q0->timestamp();
+    fb->drawQuad(p);
+    q1->timestamp();
+    GLfloat pixels[4];
+    fb->readPixels(0, 0, 1, 1, RGBA, FLOAT, Buffer::Parameters(), CPUBuffer(&pixels));
+    ASSERT(q1->getResult() >= q0->getResult() && q0->available() && q1->available());
+}
+
+TEST(testGPUProfiler)
+{
+    ptr<FrameBuffer> fb = getFrameBuffer(RenderBuffer::R32F, 1, 1);
+    ptr<Program> p = new Program(new Module(330, NULL, "\
+        layout(location=0) out vec4 color;\n\
+        void main() { color = vec4(1.0, 0.0, 0.0, 0.0); }\n"));
+    ptr<GPUProfiler> profiler = new GPUProfiler(2);
+    for (int i = 0; i < 4; ++i) {
+        int pass = profiler->beginPass("quad");
+        fb->drawQuad(p);
+        profiler->endPass(pass);
+        glFinish();
+        profiler->endFrame();
+    }
+    const GPUProfiler::PassStatistics *s = profiler->getPass("quad");
+    ASSERT(s != NULL && s->n == 3 && profiler->getDroppedFrames() == 0);
+}
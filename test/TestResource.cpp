@@ -41,6 +41,10 @@
 
 #include "test/Test.h"
 
+#include <sstream>
+#include <utime.h>
+
+#include "ork/resource/CompactXML.h"
 #include "ork/resource/XMLResourceLoader.h"
 #include "ork/resource/ResourceManager.h"
 #include "ork/render/FrameBuffer.h"
@@ -145,6 +149,194 @@ TEST(textureResourceUpdate)
     remove("test.tga");
 }
 
+void setFileTime(const char *name, time_t t)
+{
+    utimbuf times;
+    times.actime = t;
+    times.modtime = t;
+    utime(name, &times);
+}
+
+TEST(textureResourceContentHash)
+{
+    const char *xml = "<?xml version=\"1.0\" ?>\n<texture2D name=\"test\" source=\"test.tga\" internalformat=\"RGB8\" min=\"NEAREST\" mag=\"NEAREST\"/>\n";
+    unsigned char img1[] = { 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 24, 0, 2, 1, 0 };
+    unsigned char img2[] = { 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 24, 0, 5, 4, 3 };
+    time_t t = time(NULL);
+    createFile("test.xml", xml);
+    createFile("test.tga", 21, img1);
+    setFileTime("test.xml", t);
+    setFileTime("test.tga", t);
+    createFile("test2.xml", "<?xml version=\"1.0\" ?>\n<texture2D name=\"test2\" source=\"test.tga\" internalformat=\"RGB8\" min=\"NEAREST\" mag=\"NEAREST\"/>\n");
+
+    ptr<XMLResourceLoader> resLoader = new XMLResourceLoader();
+    resLoader->addPath(".");
+    ptr<ResourceManager> resManager = new ResourceManager(resLoader);
+    ptr<Texture2D> tex = resManager->loadResource("test").cast<Texture2D>();
+    // the second texture uses the decoded image cache
+    ptr<Texture2D> tex2 = resManager->loadResource("test2").cast<Texture2D>();
+
+    // modifies the texture in GPU memory, to detect if it is reloaded or not
+    unsigned char marker[3] = { 7, 7, 7 };
+    tex->setSubImage(0, 0, 0, 1, 1, RGB, UNSIGNED_BYTE, Buffer::Parameters(), CPUBuffer(marker));
+
+    // touches the files without changing their content: no reload
+    createFile("test.xml", xml);
+    createFile("test.tga", 21, img1);
+    setFileTime("test.xml", t + 10);
+    setFileTime("test.tga", t + 10);
+    resManager->updateResources();
+    unsigned char pixel1[3] = { 0, 0, 0 };
+    tex->getImage(0, RGB, UNSIGNED_BYTE, pixel1);
+
+    // changes the image content: reload
+    createFile("test.tga", 21, img2);
+    setFileTime("test.tga", t + 20);
+    resManager->updateResources();
+    unsigned char pixel2[3] = { 0, 0, 0 };
+    tex->getImage(0, RGB, UNSIGNED_BYTE, pixel2);
+    unsigned char pixel3[3] = { 0, 0, 0 };
+    tex2->getImage(0, RGB, UNSIGNED_BYTE, pixel3);
+
+    ASSERT(pixel1[0] == 7 && pixel1[1] == 7 && pixel1[2] == 7 &&
+        pixel2[0] == 3 && pixel2[1] == 4 && pixel2[2] == 5 &&
+        pixel3[0] == 3 && pixel3[1] == 4 && pixel3[2] == 5);
+
+    remove("test.xml");
+    remove("test2.xml");
+    remove("test.tga");
+}
+
+TEST(textureResourceBatchLoading)
+{
+    vector<string> names;
+    for (int i = 0; i < 8; ++i) {
+        ostringstream xml;
+        xml << "<?xml version=\"1.0\" ?>\n<texture2D name=\"test" << i << "\" source=\"test" << i <<
+            ".tga\" internalformat=\"RGB8\" min=\"NEAREST\" mag=\"NEAREST\"/>\n";
+        ostringstream xmlFile;
+        xmlFile << "test" << i << ".xml";
+        createFile(xmlFile.str().c_str(), xml.str().c_str());
+        unsigned char img[] = { 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 24, 0, 0, 0, 0 };
+        img[20] = (unsigned char) i; // red component
+        ostringstream tgaFile;
+        tgaFile << "test" << i << ".tga";
+        createFile(tgaFile.str().c_str(), 21, img);
+        ostringstream name;
+        name << "test" << i;
+        names.push_back(name.str());
+    }
+    // a float image stored in a half float texture
+    createFile("testHalf.xml", "<?xml version=\"1.0\" ?>\n<texture2D name=\"testHalf\" source=\"testHalf.raw\" internalformat=\"R16F\" min=\"NEAREST\" mag=\"NEAREST\"/>\n");
+    float raw[7] = { 0.5f, 2.0f, 0.0f, 2.0f, 1.0f, 0.0f, 1.0f };
+    ((unsigned int*) raw)[2] = 0xCAFEBABE;
+    ((int*) raw)[3] = 2;
+    ((int*) raw)[4] = 1;
+    ((int*) raw)[5] = 0;
+    ((int*) raw)[6] = 1;
+    createFile("testHalf.raw", sizeof(raw), (unsigned char*) raw);
+    names.push_back("testHalf");
+    names.push_back("testMissing");
+    names.push_back("test0");
+
+    ptr<XMLResourceLoader> resLoader = new XMLResourceLoader();
+    resLoader->addPath(".");
+    resLoader->setDecodeThreads(4);
+    ptr<ResourceManager> resManager = new ResourceManager(resLoader);
+    vector< ptr<Object> > textures;
+    resManager->loadResources(names, textures);
+
+    bool ok = textures.size() == 11 && textures[9] == NULL && textures[10] == textures[0];
+    for (int i = 0; ok && i < 8; ++i) {
+        unsigned char pixel[3] = { 255, 255, 255 };
+        textures[i].cast<Texture2D>()->getImage(0, RGB, UNSIGNED_BYTE, pixel);
+        ok = pixel[0] == i && pixel[1] == 0 && pixel[2] == 0;
+    }
+    float halfPixels[2] = { 0.0f, 0.0f };
+    if (ok) {
+        textures[8].cast<Texture2D>()->getImage(0, RED, FLOAT, halfPixels);
+    }
+    ASSERT(ok && halfPixels[0] == 0.5f && halfPixels[1] == 2.0f);
+
+    for (int i = 0; i < 8; ++i) {
+        remove((names[i] + ".xml").c_str());
+        remove((names[i] + ".tga").c_str());
+    }
+    remove("testHalf.xml");
+    remove("testHalf.raw");
+}
+
+TEST(resourceBatchLoadingDependency)
+{
+    createFile("test.glsl", "#ifdef _VERTEX_\nlayout(location=0) in vec4 p; out vec4 q; void main() { q = p; }\n#endif\n");
+    createFile("test.xml", "<?xml version=\"1.0\" ?>\n<module name=\"test\" version=\"330\" source=\"test.glsl\" feedback=\"interleaved\" varyings=\"q\"/>\n");
+    ptr<XMLResourceLoader> resLoader = new XMLResourceLoader();
+    resLoader->addPath(".");
+    ptr<ResourceManager> resManager = new ResourceManager(resLoader);
+    vector<string> names;
+    // the program loads the module as a dependency before it is created
+    names.push_back("test;");
+    names.push_back("test");
+    vector< ptr<Object> > resources;
+    resManager->loadResources(names, resources);
+    ptr<Program> p = resources[0].cast<Program>();
+    ASSERT(p != NULL && p->getModule(0).get() == resources[1].get() && resManager->loadResource("test") == resources[1]);
+    remove("test.glsl");
+    remove("test.xml");
+}
+
+TEST(compactXMLDescriptors)
+{
+    const char *xml = "<?xml version=\"1.0\" ?>\n<!-- archive -->\n<archive>\n\
+        <texture2D name=\"tex\" source=\"test.tga\" internalformat=\"RGB8\" min=\"NEAREST\" mag=\"NEAREST\"/>\n\
+        <node name=\"n\" flags='a&amp;b &#65;&lt;'>\n  <!-- comment -->\n  <method id=\"draw\" value=\"x\"></method>\n  text\n  <field/>\n</node>\n\
+        </archive>\n";
+    char *text = new char[strlen(xml) + 1];
+    strcpy(text, xml);
+    CompactXML compact;
+    bool parsed = compact.parse(text);
+    TiXmlDocument doc;
+    doc.Parse(xml);
+    CompactXML copy(doc.RootElement());
+
+    const CompactXML::Element *node = parsed ? compact.findChild("n") : NULL;
+    bool ok = parsed && CompactXML::equal(compact.getRoot(), copy.getRoot()) &&
+        compact.findChild("tex") != NULL && compact.findChild("missing") == NULL &&
+        node != NULL && strcmp(node->getAttribute(CompactXML::getKey("flags")), "a&b A<") == 0 &&
+        node->getAttribute(CompactXML::getKey("id")) == NULL &&
+        strcmp(node->firstChild->getAttribute(CompactXML::getKey("id")), "draw") == 0 &&
+        node->firstChild->nextSibling->tag == CompactXML::getKey("field") &&
+        node->firstChild->nextSibling->nextSibling == NULL;
+    // the TinyXml conversion gives an equal descriptor
+    if (ok) {
+        TiXmlElement *e = CompactXML::toElement(node);
+        CompactXML back(e);
+        ok = CompactXML::equal(back.getRoot(), node) && !CompactXML::equal(back.getRoot(), compact.findChild("tex"));
+        delete e;
+    }
+    char *bad = new char[16];
+    strcpy(bad, "<a><b></a>");
+    CompactXML invalid;
+    ok = ok && !invalid.parse(bad) && invalid.getRoot() == NULL;
+
+    // descriptors can be loaded from an archive
+    createFile("archive.xml", xml);
+    unsigned char img[] = { 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 24, 0, 3, 2, 1 };
+    createFile("test.tga", 21, img);
+    ptr<XMLResourceLoader> resLoader = new XMLResourceLoader();
+    resLoader->addArchive("archive.xml");
+    resLoader->addPath(".");
+    ptr<ResourceManager> resManager = new ResourceManager(resLoader);
+    ptr<Texture2D> t = resManager->loadResource("tex").cast<Texture2D>();
+    unsigned char pixel[3] = { 0, 0, 0 };
+    if (t != NULL) {
+        t->getImage(0, RGB, UNSIGNED_BYTE, pixel);
+    }
+    ASSERT(ok && pixel[0] == 1 && pixel[1] == 2 && pixel[2] == 3);
+    remove("archive.xml");
+    remove("test.tga");
+}
+
 TEST(moduleResourceUpdate)
 {
     createFile("test.xml", "<?xml version=\"1.0\" ?>\n<module name=\"test\" version=\"330\" source=\"test.glsl\">\n<uniform1i name=\"u\" x=\"1\"/>\n</module>\n");
@@ -191,6 +383,49 @@ TEST(moduleResourceUpdate)
     remove("test.glsl");
 }
 
+TEST(moduleResourceSharedInclude)
+{
+    time_t t = time(NULL);
+    createFile("common.glsl", "uniform int a;\nint f() { return a; }\n");
+    setFileTime("common.glsl", t);
+    for (int i = 1; i <= 2; ++i) {
+        ostringstream xml;
+        xml << "<?xml version=\"1.0\" ?>\n<module name=\"test" << i << "\" version=\"330\" source=\"test" << i << ".glsl\"/>\n";
+        ostringstream xmlFile;
+        xmlFile << "test" << i << ".xml";
+        createFile(xmlFile.str().c_str(), xml.str().c_str());
+        ostringstream glsl;
+        glsl << "#include \"common.glsl\"\n#ifdef _VERTEX_\nvoid main() { gl_Position = vec4(float(f() + " << i << ")); }\n#endif\n";
+        ostringstream glslFile;
+        glslFile << "test" << i << ".glsl";
+        createFile(glslFile.str().c_str(), glsl.str().c_str());
+    }
+
+    ptr<XMLResourceLoader> resLoader = new XMLResourceLoader();
+    resLoader->addPath(".");
+    ptr<ResourceManager> resManager = new ResourceManager(resLoader);
+    ptr<Program> p1 = resManager->loadResource("test1;").cast<Program>();
+    // modifies the included file: the second module must not use the cached
+    // content of the first version
+    createFile("common.glsl", "uniform int b;\nint f() { return b; }\n");
+    setFileTime("common.glsl", t + 10);
+    ptr<Program> p2 = resManager->loadResource("test2;").cast<Program>();
+    bool loaded = p1->getUniform("a") != NULL && p2->getUniform("b") != NULL && p2->getUniform("a") == NULL;
+
+    // the modification of the included file must also update the first module
+    resManager->updateResources();
+    bool updated = p1->getUniform("b") != NULL && p2->getUniform("b") != NULL &&
+        p1->getUniform("a") == NULL && p2->getUniform("a") == NULL;
+
+    ASSERT(loaded && updated);
+
+    remove("common.glsl");
+    remove("test1.xml");
+    remove("test1.glsl");
+    remove("test2.xml");
+    remove("test2.glsl");
+}
+
 TEST(moduleResourceUpdateWithUniformSamplers)
 {
     unsigned char img1[] = { 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 24, 0, 2, 1, 0 };
@@ -0,0 +1,144 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+
+#include "test/Test.h"
+
+#include "ork/render/FrameBuffer.h"
+#include "ork/resource/XMLResourceLoader.h"
+#include "ork/scenegraph/DrawMeshIndirectTask.h"
+#include "ork/scenegraph/SceneManager.h"
+#include "ork/taskgraph/MultithreadScheduler.h"
+
+using namespace std;
+using namespace ork;
+
+ptr<FrameBuffer> getFrameBuffer(RenderBuffer::RenderBufferFormat f, int w, int h);
+
+class TestDrawMeshIndirectTask : public DrawMeshIndirectTask
+{
+public:
+    TestDrawMeshIndirectTask() : DrawMeshIndirectTask(QualifiedName("this.quad"), "object", "Visible")
+    {
+    }
+};
+
+ptr<SceneNode> createIndirectNode(const vec3d &position)
+{
+    ptr<SceneNode> n = new SceneNode();
+    n->addFlag("object");
+    n->setLocalToParent(mat4d::translate(position));
+    n->setLocalBounds(box3d(-0.5, 0.5, -0.5, 0.5, -0.1, 0.1));
+    return n;
+}
+
+// counts the covered pixels in each quadrant of a 4x4 framebuffer, in the
+// bottom left, bottom right, top left and top right order
+vec4i countQuadrantPixels(ptr<FrameBuffer> fb)
+{
+    float pixels[16];
+    fb->readPixels(0, 0, 4, 4, RED, FLOAT, Buffer::Parameters(), CPUBuffer(pixels));
+    vec4i count(0, 0, 0, 0);
+    for (int i = 0; i < 16; ++i) {
+        if (pixels[i] > 0.0f) {
+            int x = (i % 4) / 2;
+            int y = (i / 4) / 2;
+            count[x + 2 * y] += 1;
+        }
+    }
+    return count;
+}
+
+TEST43(drawMeshIndirectMovedNode)
+{
+    ptr<FrameBuffer> fb = getFrameBuffer(RenderBuffer::R32F, 4, 4);
+    ptr<Program> p = new Program(new Module(430, "\
+        #ifdef _VERTEX_\n\
+        layout(location=0) in vec4 vertex;\n\
+        layout(std430, row_major) readonly buffer Visible { mat4 localToWorld[]; };\n\
+        void main() { gl_Position = localToWorld[gl_InstanceID] * vertex; }\n\
+        #endif\n\
+        #ifdef _FRAGMENT_\n\
+        layout(location=0) out vec4 color;\n\
+        void main() { color = vec4(1.0); }\n\
+        #endif\n"));
+    ptr< Mesh<vec4f, unsigned int> > quad = new Mesh<vec4f, unsigned int>(TRIANGLE_STRIP, GPU_STATIC);
+    quad->addAttributeType(0, 4, A32F, false);
+    quad->addVertex(vec4f(-0.5f, -0.5f, 0.0f, 1.0f));
+    quad->addVertex(vec4f(0.5f, -0.5f, 0.0f, 1.0f));
+    quad->addVertex(vec4f(-0.5f, 0.5f, 0.0f, 1.0f));
+    quad->addVertex(vec4f(0.5f, 0.5f, 0.0f, 1.0f));
+
+    ptr<SceneNode> camera = new SceneNode();
+    camera->addFlag("camera");
+    camera->addMesh("quad", quad->getBuffers());
+    camera->addMethod("draw", new Method(new TestDrawMeshIndirectTask()));
+    ptr<SceneNode> a = createIndirectNode(vec3d(-0.5, -0.5, 0.0));
+    ptr<SceneNode> b = createIndirectNode(vec3d(0.5, 0.5, 0.0));
+    ptr<SceneNode> root = new SceneNode();
+    root->addChild(camera);
+    root->addChild(a);
+    root->addChild(b);
+
+    ptr<SceneManager> manager = new SceneManager();
+    manager->setResourceManager(new ResourceManager(new XMLResourceLoader()));
+    manager->setScheduler(new MultithreadScheduler());
+    manager->setRoot(root);
+    manager->setCameraNode("camera");
+    manager->setCameraMethod("draw");
+    manager->setCameraToScreen(mat4d::IDENTITY);
+    SceneManager::setCurrentFrameBuffer(fb);
+    SceneManager::setCurrentProgram(p);
+
+    fb->clear(true, true, true);
+    manager->update(0.0, 0.0);
+    manager->draw();
+    vec4i count1 = countQuadrantPixels(fb);
+    // moves one node, the other one is not uploaded again
+    b->setLocalToParent(mat4d::translate(vec3d(0.5, -0.5, 0.0)));
+    fb->clear(true, true, true);
+    manager->update(0.0, 0.0);
+    manager->draw();
+    vec4i count2 = countQuadrantPixels(fb);
+    SceneManager::setCurrentFrameBuffer(NULL);
+    SceneManager::setCurrentProgram(NULL);
+    ASSERT(count1 == vec4i(4, 0, 0, 4) && count2 == vec4i(4, 4, 0, 0));
+}
@@ -0,0 +1,146 @@
+/*
+ * Ork: a small object-oriented OpenGL Rendering Kernel.
+ * Website : http://ork.gforge.inria.fr/
+ * Copyright (c) 2008-2015 INRIA - LJK (CNRS - Grenoble University)
+ * All rights reserved.
+ * Redistribution and use in source and binary forms, with or without 
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, 
+ * this list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice, 
+ * this list of conditions and the following disclaimer in the documentation 
+ * and/or other materials provided with the distribution.
+ * 
+ * 3. Neither the name of the copyright holder nor the names of its contributors 
+ * may be used to endorse or promote products derived from this software without 
+ * specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND 
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, 
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, 
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, 
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF 
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE 
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED 
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+/*
+ * Ork is distributed under the BSD3 Licence. 
+ * For any assistance, feedback and remarks, you can check out the 
+ * mailing list on the project page : 
+ * http://ork.gforge.inria.fr/
+ */
+/*
+ * Main authors: Eric Bruneton, Antoine Begault, Guillaume Piolat.
+ */
+
+
+#include <sstream>
+
+#include "test/Test.h"
+
+#include "ork/render/FrameBuffer.h"
+
+using namespace std;
+using namespace ork;
+
+ptr<FrameBuffer> getFrameBuffer(RenderBuffer::RenderBufferFormat f, int w, int h);
+
+TEST43(testStorageBlock)
+{
+    ptr<FrameBuffer> fb = getFrameBuffer(RenderBuffer::R32F, 1, 1);
+    ptr<Program> p = new Program(new Module(430, "\
+        #ifdef _COMPUTE_\n\
+        layout(local_size_x=1) in;\n\
+        buffer b { float u; vec4 v; float r; };\n\
+        void main() { r = u + v.x + v.y + v.z + v.w; }\n\
+        #endif\n"));
+    ptr<StorageBlock> b = p->getStorageBlock("b");
+    ASSERT(b != NULL && b->getArrayStride() == 0);
+    b->getUniform1f("u")->set(1.0f);
+    p->getUniform4f("v")->set(vec4f(2.0f, 3.0f, 4.0f, 5.0f));
+    fb->dispatch(p, 1);
+    FrameBuffer::memoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    GLfloat r;
+    b->getBuffer()->getSubData(32, 4, &r);
+    ASSERT(r == 15.0f);
+}
+
+TEST43(testStorageBlockUnsizedArray)
+{
+    ptr<FrameBuffer> fb = getFrameBuffer(RenderBuffer::R32F, 1, 1);
+    ptr<Program> p = new Program(new Module(430, "\
+        #ifdef _COMPUTE_\n\
+        layout(local_size_x=1) in;\n\
+        struct light { vec4 color; float intensity; };\n\
+        layout(std430) buffer b { float sum; light lights[]; };\n\
+        void main() {\n\
+            float s = 0.0;\n\
+            for (int i = 0; i < lights.length(); ++i) {\n\
+                s += lights[i].color.x * lights[i].intensity;\n\
+            }\n\
+            sum = s;\n\
+        }\n\
+        #endif\n"));
+    ptr<StorageBlock> b = p->getStorageBlock("b");
+    ASSERT(b != NULL && b->getArrayOffset() == 16 && b->getArrayStride() == 32);
+    ASSERT(b->getUniform4f("lights[1].color") == NULL);
+    b->setArraySize(100);
+    ASSERT(b->getArraySize() == 100 && b->getUniform4f("lights[100].color") == NULL);
+    for (int i = 0; i < 100; ++i) {
+        ostringstream color;
+        ostringstream intensity;
+        color << "lights[" << i << "].color";
+        intensity << "lights[" << i << "].intensity";
+        b->getUniform4f(color.str())->set(vec4f(float(i), 0.0f, 0.0f, 0.0f));
+        b->getUniform1f(intensity.str())->set(2.0f);
+    }
+    fb->dispatch(p, 1);
+    FrameBuffer::memoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    GLfloat sum;
+    b->getBuffer()->getSubData(0, 4, &sum);
+    ASSERT(sum == 9900.0f);
+}
+
+TEST43(testStorageBlockWrittenByShader)
+{
+    ptr<FrameBuffer> fb = getFrameBuffer(RenderBuffer::R32F, 1, 1);
+    ptr<Program> p = new Program(new Module(430, "\
+        #ifdef _COMPUTE_\n\
+        layout(local_size_x=1) in;\n\
+        buffer b { float u; float count; };\n\
+        void main() { count += u; }\n\
+        #endif\n"));
+    ptr<StorageBlock> b = p->getStorageBlock("b");
+    b->getUniform1f("u")->set(1.0f);
+    fb->dispatch(p, 1);
+    FrameBuffer::memoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    // the value written by the shader must not be overwritten by this update
+    b->getUniform1f("u")->set(2.0f);
+    fb->dispatch(p, 1);
+    FrameBuffer::memoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    ASSERT(b->getUniform1f("count")->get() == 3.0f);
+}
+
+TEST43(testStorageBlockSharedName)
+{
+    ptr<Program> p1 = new Program(new Module(430, "\
+        #ifdef _COMPUTE_\n\
+        layout(local_size_x=1) in;\n\
+        layout(std140) uniform b { vec4 v; };\n\
+        layout(std140) buffer c { vec4 r; };\n\
+        void main() { r = v; }\n\
+        #endif\n"));
+    ptr<Program> p2 = new Program(new Module(430, "\
+        #ifdef _COMPUTE_\n\
+        layout(local_size_x=1) in;\n\
+        layout(std140) buffer b { vec4 v; };\n\
+        void main() { v = vec4(1.0); }\n\
+        #endif\n"));
+    ASSERT(p1->getUniformBlock("b")->getBuffer() != p2->getStorageBlock("b")->getBuffer());
+}
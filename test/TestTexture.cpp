@@ -41,13 +41,18 @@
 
 #include "test/Test.h"
 
+#include "ork/core/SharedContext.h"
 #include "ork/render/FrameBuffer.h"
+#include "ork/taskgraph/MultithreadScheduler.h"
+#include "ork/taskgraph/TaskGraph.h"
 
 using namespace std;
 using namespace ork;
 
 ptr<FrameBuffer> getFrameBuffer(RenderBuffer::RenderBufferFormat f, int w, int h);
 
+ptr<SharedContext> createSharedContext();
+
 TEST(textureBuffer)
 {
     GLbyte in[4] = { 1, 2, 3, 4 };
@@ -300,3 +305,67 @@ TEST(automaticSamplerBinding)
     }
     ASSERT(ok);
 }
+
+class UploadTextureTask : public Task
+{
+public:
+    ptr<Texture2D> texture;
+
+    bool sharedContext;
+
+    UploadTextureTask() : Task("UploadTextureTask", true, 0), sharedContext(false)
+    {
+        setUploadTask(true);
+    }
+
+    virtual bool run()
+    {
+        GLint in[4] = { 1, 2, 3, 4 };
+        sharedContext = SharedContext::getCurrent() != NULL;
+        texture = new Texture2D(2, 2, R32I, RED_INTEGER, INT,
+            Texture::Parameters().mag(NEAREST),  Buffer::Parameters(), CPUBuffer(in));
+        return true;
+    }
+};
+
+class ReadTextureTask : public Task
+{
+public:
+    ptr<UploadTextureTask> upload;
+
+    GLint out[4];
+
+    ReadTextureTask(ptr<UploadTextureTask> upload) : Task("ReadTextureTask", true, 0), upload(upload)
+    {
+        out[0] = 0;
+    }
+
+    virtual bool run()
+    {
+        upload->texture->getImage(0, RED_INTEGER, INT, out);
+        return true;
+    }
+};
+
+TEST(textureUploadTask)
+{
+    // a texture bound in the main context before the upload
+    GLint in[4] = { 5, 6, 7, 8 };
+    GLint out[4];
+    ptr<Texture2D> t = new Texture2D(2, 2, R32I, RED_INTEGER, INT,
+        Texture::Parameters().mag(NEAREST),  Buffer::Parameters(), CPUBuffer(in));
+    ptr<MultithreadScheduler> scheduler = new MultithreadScheduler();
+    bool started = scheduler->setUploadContext(createSharedContext());
+    ptr<UploadTextureTask> upload = new UploadTextureTask();
+    ptr<ReadTextureTask> read = new ReadTextureTask(upload);
+    ptr<TaskGraph> graph = new TaskGraph();
+    graph->addTask(upload);
+    graph->addTask(read);
+    graph->addDependency(read, upload);
+    scheduler->run(graph);
+    scheduler->setUploadContext(NULL);
+    t->getImage(0, RED_INTEGER, INT, out);
+    ASSERT(started && upload->sharedContext &&
+        read->out[0] == 1 && read->out[1] == 2 && read->out[2] == 3 && read->out[3] == 4 &&
+        out[0] == 5 && out[1] == 6 && out[2] == 7 && out[3] == 8);
+}